@@ -11,34 +11,56 @@
 #include <ituGL/lighting/PointLight.h>
 #include <ituGL/scene/SceneLight.h>
 
+#include <ituGL/shader/ShaderBuildBatch.h>
 #include <ituGL/shader/ShaderUniformCollection.h>
 #include <ituGL/shader/Material.h>
 #include <ituGL/geometry/Model.h>
+#include <ituGL/geometry/GeometryArena.h>
 #include <ituGL/scene/SceneModel.h>
 
 #include <ituGL/renderer/SkyboxRenderPass.h>
 #include <ituGL/renderer/GBufferRenderPass.h>
 #include <ituGL/renderer/DeferredRenderPass.h>
+#include <ituGL/renderer/ForwardRenderPass.h>
 #include <ituGL/renderer/PostFXRenderPass.h>
+#include <ituGL/renderer/BloomRenderPass.h>
+#include <ituGL/renderer/PostFXChain.h>
+#include <ituGL/renderer/RenderGraph.h>
+#include <ituGL/application/Benchmark.h>
 #include <ituGL/scene/RendererSceneVisitor.h>
 
 #include <ituGL/scene/ImGuiSceneVisitor.h>
 #include <imgui.h>
 #include <ituGL/asset/Texture2DLoader.h> 
+#include <glm/gtc/constants.hpp>
 #include <iostream>
 
-PostFXSceneViewerApplication::PostFXSceneViewerApplication()
-    : Application(1024, 1024, "Post FX Scene Viewer demo")
+const double PostFXSceneViewerApplication::c_assetJobBudget = 4.0;
+
+PostFXSceneViewerApplication::PostFXSceneViewerApplication(const RunSettings& runSettings, Benchmark* benchmark)
+    : Application(1024, 1024, "Post FX Scene Viewer demo", runSettings)
+    , m_shaderProgramCache("shader_cache")
+    , m_uniformBufferArena(256 * 1024)
+    , m_textureStagingRing(8, 4 * 1024 * 1024)
+    , m_benchmark(benchmark)
     , m_renderer(GetDevice())
+    , m_forwardCollectionIndex(0)
+    , m_bloomRenderPass(nullptr)
+    , m_composeEffect(0)
+    , m_chromaticAbEffect(0)
+    , m_noiseEffect(0)
+    , m_vignetteEffect(0)
+    , m_barrelEffect(0)
+    , m_scanlinesEffect(0)
     , m_sceneFramebuffer(std::make_shared<FramebufferObject>())
     , m_exposure(1.0f)
     , m_contrast(1.0f)
     , m_hueShift(0.0f)
     , m_saturation(0.5f)
     , m_colorFilter(1.0f)
-    , m_blurIterations(1)
-    , m_bloomRange(1.0f, 2.0f)
+    , m_bloomRange(2.0f, 3.0f)
     , m_bloomIntensity(1.0f)
+    , m_bloomRadius(1.0f)
 	, m_scanlinesLineDensity(360.0f)
 	, m_scanlinesIntensity(0.6f)
 	, m_vignettingIntensity(0.4f)
@@ -55,22 +77,91 @@ void PostFXSceneViewerApplication::Initialize()
     // Initialize DearImGUI
     m_imGui.Initialize(GetMainWindow());
 
+    // Before loading any shader, so they can be deferred
+    m_shaderProgramCache.Initialize();
+
     InitializeCamera();
+    InitializeCameraPath();
     InitializeLights();
-    InitializeMaterials();
-    InitializeModels();
-    InitializeRenderer();
+    {
+        // The programs are built in a batch, so the driver compiles them in parallel
+        // They can't be used, or have their uniforms queried, until the batch finishes
+        ShaderBuildBatch shaderBuildBatch;
+        ShaderPrograms shaderPrograms = BuildShaderPrograms();
+
+        // The model loader needs the default material, only its program is waited for
+        // The models and the skybox texture load while the driver compiles the others
+        shaderBuildBatch.FinishProgram(*shaderPrograms.defaultProgram);
+        InitializeDefaultMaterial(shaderPrograms.defaultProgram);
+        InitializeModels();
+
+        // Wait for the driver, the renderer and the other materials need the uniforms of the linked programs
+        shaderBuildBatch.Finish();
+        InitializeMaterials(shaderPrograms);
+        InitializeRenderer(shaderPrograms);
+    }
+
+    // Every program is built, release the shared shaders and the file contents
+    ShaderLoader::ClearCache();
+
+    // The benchmark must record the complete scene from the first frame
+    if (m_benchmark)
+    {
+        m_assetJobQueue.Flush();
+    }
+
+    const ShaderProgramCache::Stats& shaderCacheStats = m_shaderProgramCache.GetStats();
+    std::cout << "Shader cache: " << shaderCacheStats.hitCount << " hits, " << shaderCacheStats.missCount << " misses ("
+        << shaderCacheStats.rejectedCount << " rejected), " << shaderCacheStats.savedTime << " ms saved" << std::endl;
 }
 
 
 void PostFXSceneViewerApplication::Update()
 {
     Application::Update();
+
+    if (m_benchmark)
+    {
+        m_benchmark->BeginFrame(GetFrameIndex());
+        GetDevice().ResetStateChangeStats();
+        GetDevice().ResetDrawcallCount();
+        ShaderUniformCollection::ResetUploadStats();
+    }
+
+    // Finish the assets decoded since the last frame, without stalling it
+    m_assetJobQueue.ProcessMainThreadJobs(c_assetJobBudget);
+
     m_elapsedTime += GetDeltaTime();
-    m_cameraController.Update(GetMainWindow(), GetDeltaTime());
+
+    // The benchmark replays the camera path instead of the user input
+    if (m_benchmark && !m_cameraPath.IsEmpty())
+    {
+        m_cameraPath.Apply(*m_cameraController.GetCamera(), GetCurrentTime());
+    }
+    else
+    {
+        m_cameraController.Update(GetMainWindow(), GetDeltaTime());
+    }
+    m_renderer.SetTime(m_elapsedTime);
 
     RendererSceneVisitor rendererSceneVisitor(m_renderer);
     m_scene.AcceptVisitor(rendererSceneVisitor);
+    rendererSceneVisitor.Flush();
+
+    // Opaque geometry, group by state to reduce the changes between drawcalls
+    m_renderer.SortDrawcallCollection(0, Renderer::DrawcallSortMode::State);
+
+    // Copies of the same submesh and material are now next to each other, draw them together
+    m_renderer.MergeInstancedDrawcalls(0);
+
+    // Submeshes of the same model stored in the geometry arena can be drawn with a single call
+    m_renderer.MergeMultiDrawcalls(0);
+
+    // Transparent geometry, blended from the farthest
+    m_renderer.SortDrawcallCollection(m_forwardCollectionIndex, Renderer::DrawcallSortMode::BackToFront);
+
+    // Recompile the fused post FX shader if an effect was toggled
+    m_postFXChain->Build();
 }
 
 
@@ -82,24 +173,19 @@ void PostFXSceneViewerApplication::Render()
     GetDevice().Clear(true, Color(0.0f, 0.0f, 0.0f, 1.0f), true, 1.0f);
 
     // pass time to the shaders
-    if (m_scanlinesMaterial)
-    {
-        m_scanlinesMaterial->SetUniformValue("Time", m_elapsedTime);
-    }
-    if(m_noiseMaterial)
-	{
-		m_noiseMaterial->SetUniformValue("Time", m_elapsedTime);
-	}
-    if (m_tvScreenMaterial)
-    {
-        m_tvScreenMaterial->SetUniformValue("Time", m_elapsedTime);
-    }
+    m_postFXChain->SetUniformValue(m_scanlinesEffect, "Time", m_elapsedTime);
 
     // Render the scene
     m_renderer.Render();
 
     // Render the debug user interface
     RenderGUI();
+
+    if (m_benchmark)
+    {
+        RecordBenchmarkFrame();
+        m_benchmark->EndFrame();
+    }
 }
 
 void PostFXSceneViewerApplication::Cleanup()
@@ -127,6 +213,36 @@ void PostFXSceneViewerApplication::InitializeCamera()
     m_cameraController.SetCamera(sceneCamera);
 }
 
+void PostFXSceneViewerApplication::InitializeCameraPath()
+{
+    if (!m_benchmark)
+    {
+        return;
+    }
+
+    // The GPU times of the passes are part of the results
+    m_renderer.GetProfiler().SetEnabled(true);
+
+    const std::string& cameraPath = m_benchmark->GetSettings().cameraPath;
+    if (!cameraPath.empty())
+    {
+        if (m_cameraPath.Load(cameraPath.c_str()))
+        {
+            return;
+        }
+        std::cout << "Failed to load camera path " << cameraPath << ", using the default path" << std::endl;
+    }
+
+    // Default path: orbit around the scene, looking at the center
+    const unsigned int keyframeCount = 8;
+    for (unsigned int i = 0; i <= keyframeCount; ++i)
+    {
+        float angle = glm::two_pi<float>() * i / keyframeCount;
+        glm::vec3 position(-2.0f * std::cos(angle), 1.0f + 0.25f * std::sin(2.0f * angle), -2.0f * std::sin(angle));
+        m_cameraPath.AddKeyframe(static_cast<float>(i), position, glm::vec3(0.0f, 0.5f, 0.0f));
+    }
+}
+
 void PostFXSceneViewerApplication::InitializeLights()
 {
     // Create a directional light and add it to the scene
@@ -142,71 +258,143 @@ void PostFXSceneViewerApplication::InitializeLights()
     //m_scene.AddSceneNode(std::make_shared<SceneLight>("point light", pointLight));
 }
 
-void PostFXSceneViewerApplication::InitializeMaterials()
+PostFXSceneViewerApplication::ShaderPrograms PostFXSceneViewerApplication::BuildShaderPrograms()
 {
-    // G-buffer material
+    ShaderPrograms shaderPrograms;
+
+    // G-buffer shader
+    shaderPrograms.defaultProgram = std::make_shared<ShaderProgram>();
     {
         // Load and build shader
         std::vector<const char*> vertexShaderPaths;
         vertexShaderPaths.push_back("shaders/version330.glsl");
+        vertexShaderPaths.push_back("shaders/frameconstants.glsl");
+        vertexShaderPaths.push_back("shaders/objectmatrices.glsl");
         vertexShaderPaths.push_back("shaders/default.vert");
-        Shader vertexShader = ShaderLoader(Shader::VertexShader).Load(vertexShaderPaths);
+        std::shared_ptr<Shader> vertexShader = ShaderLoader(Shader::VertexShader).LoadShared(vertexShaderPaths);
 
         std::vector<const char*> fragmentShaderPaths;
         fragmentShaderPaths.push_back("shaders/version330.glsl");
         fragmentShaderPaths.push_back("shaders/utils.glsl");
         fragmentShaderPaths.push_back("shaders/default.frag");
-        Shader fragmentShader = ShaderLoader(Shader::FragmentShader).Load(fragmentShaderPaths);
-
-        std::shared_ptr<ShaderProgram> shaderProgramPtr = std::make_shared<ShaderProgram>();
-        shaderProgramPtr->Build(vertexShader, fragmentShader);
+        std::shared_ptr<Shader> fragmentShader = ShaderLoader(Shader::FragmentShader).LoadShared(fragmentShaderPaths);
 
-        // Get transform related uniform locations
-        ShaderProgram::Location worldViewMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewMatrix");
-        ShaderProgram::Location worldViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewProjMatrix");
+        shaderPrograms.defaultProgram->Build(*vertexShader, *fragmentShader);
+    }
 
-        // Register shader with renderer
-        m_renderer.RegisterShaderProgram(shaderProgramPtr,
-            [=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
-            {
-                shaderProgram.SetUniform(worldViewMatrixLocation, camera.GetViewMatrix() * worldMatrix);
-                shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
-            },
-            nullptr
-        );
+    // Deferred shader
+    shaderPrograms.deferredProgram = std::make_shared<ShaderProgram>();
+    {
+        std::vector<const char*> vertexShaderPaths;
+        vertexShaderPaths.push_back("shaders/version330.glsl");
+        vertexShaderPaths.push_back("shaders/renderer/deferred.vert");
+        std::shared_ptr<Shader> vertexShader = ShaderLoader(Shader::VertexShader).LoadShared(vertexShaderPaths);
 
-        // Filter out uniforms that are not material properties
-        ShaderUniformCollection::NameSet filteredUniforms;
-        filteredUniforms.insert("WorldViewMatrix");
-        filteredUniforms.insert("WorldViewProjMatrix");
+        // The lighting functions include the files they depend on
+        std::vector<const char*> fragmentShaderPaths;
+        fragmentShaderPaths.push_back("shaders/version330.glsl");
+        fragmentShaderPaths.push_back("shaders/lighting.glsl");
+        fragmentShaderPaths.push_back("shaders/renderer/deferred.frag");
+        std::shared_ptr<Shader> fragmentShader = ShaderLoader(Shader::FragmentShader).LoadShared(fragmentShaderPaths);
 
-        // Create material
-        m_defaultMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
-        m_defaultMaterial->SetUniformValue("Color", glm::vec3(1.0f));
+        shaderPrograms.deferredProgram->Build(*vertexShader, *fragmentShader);
     }
 
-    // Deferred material
+    // Forward shader, lit with all the lights of each cluster in a single pass
+    shaderPrograms.forwardProgram = std::make_shared<ShaderProgram>();
     {
         std::vector<const char*> vertexShaderPaths;
         vertexShaderPaths.push_back("shaders/version330.glsl");
-        vertexShaderPaths.push_back("shaders/renderer/deferred.vert");
-        Shader vertexShader = ShaderLoader(Shader::VertexShader).Load(vertexShaderPaths);
+        vertexShaderPaths.push_back("shaders/frameconstants.glsl");
+        vertexShaderPaths.push_back("shaders/objectmatrices.glsl");
+        vertexShaderPaths.push_back("shaders/forward.vert");
+        std::shared_ptr<Shader> vertexShader = ShaderLoader(Shader::VertexShader).LoadShared(vertexShaderPaths);
 
+        // The lighting functions include the files they depend on
         std::vector<const char*> fragmentShaderPaths;
         fragmentShaderPaths.push_back("shaders/version330.glsl");
-        fragmentShaderPaths.push_back("shaders/utils.glsl");
-        fragmentShaderPaths.push_back("shaders/lambert-ggx.glsl");
         fragmentShaderPaths.push_back("shaders/lighting.glsl");
-        fragmentShaderPaths.push_back("shaders/renderer/deferred.frag");
-        Shader fragmentShader = ShaderLoader(Shader::FragmentShader).Load(fragmentShaderPaths);
+        fragmentShaderPaths.push_back("shaders/forward.frag");
+        std::shared_ptr<Shader> fragmentShader = ShaderLoader(Shader::FragmentShader).LoadShared(fragmentShaderPaths);
+
+        shaderPrograms.forwardProgram->Build(*vertexShader, *fragmentShader);
+    }
+
+    //We need to make material for the tv screen
+    //So we need a new a new shader builder
+    //This is taken from above
+    std::vector<const char*> vsPaths;
+    vsPaths.push_back("shaders/version330.glsl");
+    vsPaths.push_back("shaders/frameconstants.glsl");
+    vsPaths.push_back("shaders/objectmatrices.glsl");
+    vsPaths.push_back("shaders/tvscreen.vert");
+    std::shared_ptr<Shader> tvVS = ShaderLoader(Shader::VertexShader).LoadShared(vsPaths);
+
+    std::vector<const char*> fsPaths;
+    fsPaths.push_back("shaders/version330.glsl");
+    fsPaths.push_back("shaders/frameconstants.glsl");
+    fsPaths.push_back("shaders/tvscreen.frag");
+    std::shared_ptr<Shader> tvFS = ShaderLoader(Shader::FragmentShader).LoadShared(fsPaths);
+
+    shaderPrograms.tvScreenProgram = std::make_shared<ShaderProgram>();
+    shaderPrograms.tvScreenProgram->Build(*tvVS, *tvFS);
+
+    // Post FX programs, the materials are created by the renderer
+    shaderPrograms.bloomDownsampleProgram = CreatePostFXShaderProgram("shaders/postfx/bloomdownsample.frag");
+    shaderPrograms.bloomUpsampleProgram = CreatePostFXShaderProgram("shaders/postfx/bloomupsample.frag");
+    shaderPrograms.skyboxProgram = SkyboxRenderPass::CreateShaderProgram();
+
+    // Compose and VHS effects, fused in a single shader that writes to the default framebuffer
+    {
+        std::vector<const char*> vertexShaderPaths;
+        vertexShaderPaths.push_back("shaders/version330.glsl");
+        vertexShaderPaths.push_back("shaders/renderer/fullscreen.vert");
+        std::shared_ptr<Shader> vertexShader = ShaderLoader(Shader::VertexShader).LoadShared(vertexShaderPaths);
+
+        std::vector<const char*> headerPaths;
+        headerPaths.push_back("shaders/version330.glsl");
+        headerPaths.push_back("shaders/utils.glsl");
+        m_postFXChain = std::make_shared<PostFXChain>(vertexShader, headerPaths);
+    }
+
+    m_composeEffect = m_postFXChain->AddEffect("Compose", PostFXChain::EffectType::Color, "shaders/postfx/effects/compose.glsl");
+    m_chromaticAbEffect = m_postFXChain->AddEffect("ChromaticAberration", PostFXChain::EffectType::Remap, "shaders/postfx/effects/chromatic.glsl");
+    m_noiseEffect = m_postFXChain->AddEffect("Noise", PostFXChain::EffectType::Color, "shaders/postfx/effects/noise.glsl");
+    m_vignetteEffect = m_postFXChain->AddEffect("Vignette", PostFXChain::EffectType::Color, "shaders/postfx/effects/vignette.glsl");
+    m_barrelEffect = m_postFXChain->AddEffect("Barrel", PostFXChain::EffectType::Remap, "shaders/postfx/effects/barrel.glsl");
+    m_scanlinesEffect = m_postFXChain->AddEffect("Scanlines", PostFXChain::EffectType::Color, "shaders/postfx/effects/scanline.glsl");
+    m_postFXChain->SubmitProgram();
 
-        std::shared_ptr<ShaderProgram> shaderProgramPtr = std::make_shared<ShaderProgram>();
-        shaderProgramPtr->Build(vertexShader, fragmentShader);
+    return shaderPrograms;
+}
+
+void PostFXSceneViewerApplication::InitializeDefaultMaterial(std::shared_ptr<ShaderProgram> shaderProgram)
+{
+    // Register shader with renderer. Transforms come from the frame constants and the object matrices
+    m_renderer.RegisterShaderProgram(shaderProgram, nullptr, nullptr);
 
+    // Filter out uniforms that are not material properties
+    ShaderUniformCollection::NameSet filteredUniforms;
+    filteredUniforms.insert("ObjectMatrices");
+    filteredUniforms.insert("ObjectIndex");
+
+    // Create material
+    m_defaultMaterial = std::make_shared<Material>(shaderProgram, filteredUniforms);
+    m_defaultMaterial->SetUniformValue("Color", glm::vec3(1.0f));
+}
+
+void PostFXSceneViewerApplication::InitializeMaterials(const ShaderPrograms& shaderPrograms)
+{
+    // The skybox is the environment of the lit materials
+    m_skyboxTexture->Bind();
+    float maxLod;
+    m_skyboxTexture->GetParameter(TextureObject::ParameterFloat::MaxLod, maxLod);
+    TextureCubemapObject::Unbind();
+
+    // Deferred material
+    {
         // Filter out uniforms that are not material properties
         ShaderUniformCollection::NameSet filteredUniforms;
-        filteredUniforms.insert("InvViewMatrix");
-        filteredUniforms.insert("InvProjMatrix");
         filteredUniforms.insert("WorldViewProjMatrix");
         filteredUniforms.insert("LightIndirect");
         filteredUniforms.insert("LightColor");
@@ -214,56 +402,64 @@ void PostFXSceneViewerApplication::InitializeMaterials()
         filteredUniforms.insert("LightDirection");
         filteredUniforms.insert("LightAttenuation");
 
-        // Get transform related uniform locations
-        ShaderProgram::Location invViewMatrixLocation = shaderProgramPtr->GetUniformLocation("InvViewMatrix");
-        ShaderProgram::Location invProjMatrixLocation = shaderProgramPtr->GetUniformLocation("InvProjMatrix");
-        ShaderProgram::Location worldViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewProjMatrix");
+        // Get transform related uniform locations. Inverse camera matrices come from the frame constants
+        ShaderProgram::Location worldViewProjMatrixLocation = shaderPrograms.deferredProgram->GetUniformLocation("WorldViewProjMatrix");
 
         // Register shader with renderer
-        m_renderer.RegisterShaderProgram(shaderProgramPtr,
+        m_renderer.RegisterShaderProgram(shaderPrograms.deferredProgram,
             [=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
             {
-                if (cameraChanged)
-                {
-                    shaderProgram.SetUniform(invViewMatrixLocation, glm::inverse(camera.GetViewMatrix()));
-                    shaderProgram.SetUniform(invProjMatrixLocation, glm::inverse(camera.GetProjectionMatrix()));
-                }
                 shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
             },
-            m_renderer.GetDefaultUpdateLightsFunction(*shaderProgramPtr)
+            m_renderer.GetDefaultUpdateLightsFunction(*shaderPrograms.deferredProgram)
         );
 
         // Create material
-        m_deferredMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
+        m_deferredMaterial = std::make_shared<Material>(shaderPrograms.deferredProgram, filteredUniforms);
+        m_deferredMaterial->SetUniformValue("EnvironmentTexture", m_skyboxTexture);
+        m_deferredMaterial->SetUniformValue("EnvironmentMaxLod", maxLod);
     }
-    //We need to make material for the tv screen
-    //So we need a new a new shader builder
-    //This is taken from above
-    std::vector<const char*> vsPaths;
-    vsPaths.push_back("shaders/version330.glsl");
-    vsPaths.push_back("shaders/tvscreen.vert");
-    Shader tvVS = ShaderLoader(Shader::VertexShader).Load(vsPaths);
 
-    std::vector<const char*> fsPaths;
-    fsPaths.push_back("shaders/version330.glsl");
-    fsPaths.push_back("shaders/tvscreen.frag");
-    Shader tvFS = ShaderLoader(Shader::FragmentShader).Load(fsPaths);
+    // Screen glass material
+    {
+        // Transforms come from the frame constants and the object matrices, the lights from the forward pass
+        m_renderer.RegisterShaderProgram(shaderPrograms.forwardProgram, nullptr, nullptr);
 
-    std::shared_ptr<ShaderProgram> tvProg = std::make_shared<ShaderProgram>();
-    tvProg->Build(tvVS, tvFS);
+        // Filter out uniforms that are not material properties
+        ShaderUniformCollection::NameSet filteredUniforms;
+        filteredUniforms.insert("ObjectMatrices");
+        filteredUniforms.insert("ObjectIndex");
+        filteredUniforms.insert("ClusterLights");
+        filteredUniforms.insert("ClusterRanges");
+        filteredUniforms.insert("ClusterLightIndices");
+        filteredUniforms.insert("ClusterGlobalLightCount");
+        filteredUniforms.insert("ClusterCount");
+        filteredUniforms.insert("ClusterTileScale");
+        filteredUniforms.insert("ClusterDepthParams");
+
+        // Create material. Blending moves its drawcalls to the forward collection
+        m_screenGlassMaterial = std::make_shared<Material>(shaderPrograms.forwardProgram, filteredUniforms);
+        m_screenGlassMaterial->SetUniformValue("Color", glm::vec3(0.02f));
+        m_screenGlassMaterial->SetUniformValue("Opacity", 0.2f);
+        m_screenGlassMaterial->SetUniformValue("Roughness", 0.1f);
+        m_screenGlassMaterial->SetUniformValue("Metalness", 0.0f);
+        m_screenGlassMaterial->SetBlendEquation(Material::BlendEquation::Add);
+        m_screenGlassMaterial->SetBlendParams(Material::BlendParam::SourceAlpha, Material::BlendParam::OneMinusSourceAlpha);
+        m_screenGlassMaterial->SetDepthTestFunction(Material::TestFunction::LessEqual);
+        m_screenGlassMaterial->SetDepthWrite(false);
+        m_screenGlassMaterial->SetUniformValue("EnvironmentTexture", m_skyboxTexture);
+        m_screenGlassMaterial->SetUniformValue("EnvironmentMaxLod", maxLod);
+    }
 
-    ShaderProgram::Location tvWvpLoc = tvProg->GetUniformLocation("WorldViewProjMatrix");
+    // Transforms and time come from the frame constants and the object matrices
+    m_renderer.RegisterShaderProgram(shaderPrograms.tvScreenProgram, nullptr, nullptr);
 
-    m_renderer.RegisterShaderProgram(tvProg,
-        [=](const ShaderProgram& shader, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
-        {
-            shader.SetUniform(tvWvpLoc,camera.GetViewProjectionMatrix() * worldMatrix);
-        },
-        nullptr
-    );
+    ShaderUniformCollection::NameSet tvFilteredUniforms;
+    tvFilteredUniforms.insert("ObjectMatrices");
+    tvFilteredUniforms.insert("ObjectIndex");
 
     // Tv material
-    m_tvScreenMaterial = std::make_shared<Material>(tvProg);
+    m_tvScreenMaterial = std::make_shared<Material>(shaderPrograms.tvScreenProgram, tvFilteredUniforms);
 
     // Resolution babi
     int winWidth = 0;
@@ -278,18 +474,13 @@ void PostFXSceneViewerApplication::InitializeModels()
 {
     m_skyboxTexture = TextureCubemapLoader::LoadTextureShared("models/skybox/forest.hdr", TextureObject::FormatRGB, TextureObject::InternalFormatRGB16F);
 
-    m_skyboxTexture->Bind();
-    float maxLod;
-    m_skyboxTexture->GetParameter(TextureObject::ParameterFloat::MaxLod, maxLod);
-    TextureCubemapObject::Unbind();
-
-    // Set the environment texture on the deferred material
-    m_deferredMaterial->SetUniformValue("EnvironmentTexture", m_skyboxTexture);
-    m_deferredMaterial->SetUniformValue("EnvironmentMaxLod", maxLod);
-
     // Configure loader
     ModelLoader loader(m_defaultMaterial);
 
+    // Store all the models in the same buffers
+    m_geometryArena = std::make_shared<GeometryArena>(256 * 1024, 1024 * 1024);
+    loader.SetGeometryArena(m_geometryArena);
+
     // Create a new material copy for each submaterial
     loader.SetCreateMaterials(true);
 
@@ -309,15 +500,25 @@ void PostFXSceneViewerApplication::InitializeModels()
     loader.SetMaterialProperty(ModelLoader::MaterialProperty::NormalTexture, "NormalTexture");
     loader.SetMaterialProperty(ModelLoader::MaterialProperty::SpecularTexture, "SpecularTexture");
 
-    // Load tv models and add to scene
-    std::shared_ptr<Model> Television = loader.LoadShared("models/tv/Television.obj");
-    m_scene.AddSceneNode(std::make_shared<SceneModel>("Television", Television));
+    // Load tv models in the background, and add them to scene when they are ready
+    // The callbacks run in the main thread jobs, after all the materials are created
+    loader.LoadAsync("models/tv/Television.obj").OnReady([this](std::shared_ptr<Model> Television)
+        {
+            m_scene.AddSceneNode(std::make_shared<SceneModel>("Television", Television));
+        });
 
-    std::shared_ptr<Model> TelevisionScreen = loader.LoadShared("models/tv/TelevisionScreen.obj");
-    // set the material
-    TelevisionScreen->SetMaterial(0, m_tvScreenMaterial);
-    
-    m_scene.AddSceneNode(std::make_shared<SceneModel>("TelevisionScreen", TelevisionScreen));
+    loader.LoadAsync("models/tv/TelevisionScreen.obj").OnReady([this](std::shared_ptr<Model> TelevisionScreen)
+        {
+            // set the material
+            TelevisionScreen->SetMaterial(0, m_tvScreenMaterial);
+
+            m_scene.AddSceneNode(std::make_shared<SceneModel>("TelevisionScreen", TelevisionScreen));
+
+            // Same mesh with the glass material, drawn on top of the screen
+            std::shared_ptr<Model> TelevisionGlass = std::make_shared<Model>(*TelevisionScreen);
+            TelevisionGlass->SetMaterial(0, m_screenGlassMaterial);
+            m_scene.AddSceneNode(std::make_shared<SceneModel>("TelevisionGlass", TelevisionGlass));
+        });
 
 
 }
@@ -331,6 +532,8 @@ void PostFXSceneViewerApplication::InitializeFramebuffers()
     m_sceneTexture = std::make_shared<Texture2DObject>();
     m_sceneTexture->Bind();
     m_sceneTexture->SetImage(0, width, height, TextureObject::FormatRGBA, TextureObject::InternalFormat::InternalFormatRGBA16F);
+    m_sceneTexture->SetParameter(TextureObject::ParameterEnum::WrapS, GL_CLAMP_TO_EDGE);
+    m_sceneTexture->SetParameter(TextureObject::ParameterEnum::WrapT, GL_CLAMP_TO_EDGE);
     m_sceneTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR);
     m_sceneTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
     Texture2DObject::Unbind();
@@ -341,32 +544,21 @@ void PostFXSceneViewerApplication::InitializeFramebuffers()
     m_sceneFramebuffer->SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Color0, *m_sceneTexture);
     m_sceneFramebuffer->SetDrawBuffers(std::array<FramebufferObject::Attachment, 1>({ FramebufferObject::Attachment::Color0 }));
     FramebufferObject::Unbind();
-
-    // Add temp textures and frame buffers
-    for (int i = 0; i < m_tempFramebuffers.size(); ++i)
-    {
-        m_tempTextures[i] = std::make_shared<Texture2DObject>();
-        m_tempTextures[i]->Bind();
-        m_tempTextures[i]->SetImage(0, width, height, TextureObject::FormatRGBA, TextureObject::InternalFormat::InternalFormatRGBA16F);
-        m_tempTextures[i]->SetParameter(TextureObject::ParameterEnum::WrapS, GL_CLAMP_TO_EDGE);
-        m_tempTextures[i]->SetParameter(TextureObject::ParameterEnum::WrapT, GL_CLAMP_TO_EDGE);
-        m_tempTextures[i]->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR);
-        m_tempTextures[i]->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
-
-        m_tempFramebuffers[i] = std::make_shared<FramebufferObject>();
-        m_tempFramebuffers[i]->Bind();
-        m_tempFramebuffers[i]->SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Color0, *m_tempTextures[i]);
-        m_tempFramebuffers[i]->SetDrawBuffers(std::array<FramebufferObject::Attachment, 1>({ FramebufferObject::Attachment::Color0 }));
-    }
-    Texture2DObject::Unbind();
-    FramebufferObject::Unbind();
 }
 
-void PostFXSceneViewerApplication::InitializeRenderer()
+void PostFXSceneViewerApplication::InitializeRenderer(const ShaderPrograms& shaderPrograms)
 {
     int width, height;
     GetMainWindow().GetDimensions(width, height);
 
+    // Passes declare the textures they read and write. The graph creates the temporary textures
+    RenderGraph::TextureDesc hdrTextureDesc{ width, height, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA16F };
+    RenderGraph::ResourceId sceneResource;
+
+    // The g-buffer only has the opaque drawcalls, blended ones are drawn by the forward pass
+    m_renderer.SetDrawcallCollectionSupportedFunction(0, [](const Renderer::DrawcallInfo& drawcallInfo) { return !drawcallInfo.GetMaterial().HasBlend(); });
+    m_forwardCollectionIndex = m_renderer.AddDrawcallCollection([](const Renderer::DrawcallInfo& drawcallInfo) { return drawcallInfo.GetMaterial().HasBlend(); });
+
     // Set up deferred passes
     {
         std::unique_ptr<GBufferRenderPass> gbufferRenderPass(std::make_unique<GBufferRenderPass>(width, height));
@@ -380,103 +572,98 @@ void PostFXSceneViewerApplication::InitializeRenderer()
         // Get the depth texture from the gbuffer pass - This could be reworked
         m_depthTexture = gbufferRenderPass->GetDepthTexture();
 
-        // Add the render passes
-        m_renderer.AddRenderPass(std::move(gbufferRenderPass));
-        m_renderer.AddRenderPass(std::make_unique<DeferredRenderPass>(m_deferredMaterial, m_sceneFramebuffer));
-    }
-
-    // Initialize the framebuffers and the textures they use
-    InitializeFramebuffers();
-
-    // Skybox pass
-    m_renderer.AddRenderPass(std::make_unique<SkyboxRenderPass>(m_skyboxTexture));
+        // The g-buffer is created by the pass
+        std::vector<RenderGraph::ResourceId> gbufferResources;
+        gbufferResources.push_back(m_renderGraph.ImportTexture("GBufferDepth", gbufferRenderPass->GetDepthTexture()));
+        gbufferResources.push_back(m_renderGraph.ImportTexture("GBufferAlbedo", gbufferRenderPass->GetAlbedoTexture()));
+        gbufferResources.push_back(m_renderGraph.ImportTexture("GBufferNormal", gbufferRenderPass->GetNormalTexture()));
+        gbufferResources.push_back(m_renderGraph.ImportTexture("GBufferOthers", gbufferRenderPass->GetOthersTexture()));
 
-    // Create a copy pass from m_sceneTexture to the first temporary texture
-    std::shared_ptr<Material> copyMaterial = CreatePostFXMaterial("shaders/postfx/copy.frag", m_sceneTexture);
-    m_renderer.AddRenderPass(std::make_unique<PostFXRenderPass>(copyMaterial, m_tempFramebuffers[0]));
+        // Initialize the framebuffers and the textures they use
+        InitializeFramebuffers();
+        sceneResource = m_renderGraph.ImportTexture("Scene", m_sceneTexture);
 
-    // Replace the copy pass with a new bloom pass
-    m_bloomMaterial = CreatePostFXMaterial("shaders/postfx/bloom.frag", m_sceneTexture);
-    m_bloomMaterial->SetUniformValue("Range", glm::vec2(2.0f, 3.0f));
-    m_bloomMaterial->SetUniformValue("Intensity", 1.0f);
-    m_renderer.AddRenderPass(std::make_unique<PostFXRenderPass>(m_bloomMaterial, m_tempFramebuffers[0]));
-
-    // Add blur passes
-    std::shared_ptr<Material> blurHorizontalMaterial = CreatePostFXMaterial("shaders/postfx/blur.frag", m_tempTextures[0]);
-    blurHorizontalMaterial->SetUniformValue("Scale", glm::vec2(1.0f / width, 0.0f));
-    std::shared_ptr<Material> blurVerticalMaterial = CreatePostFXMaterial("shaders/postfx/blur.frag", m_tempTextures[1]);
-    blurVerticalMaterial->SetUniformValue("Scale", glm::vec2(0.0f, 1.0f / height));
-    for (int i = 0; i < m_blurIterations; ++i)
-    {
-        m_renderer.AddRenderPass(std::make_unique<PostFXRenderPass>(blurHorizontalMaterial, m_tempFramebuffers[1]));
-        m_renderer.AddRenderPass(std::make_unique<PostFXRenderPass>(blurVerticalMaterial, m_tempFramebuffers[0]));
+        // Add the render passes
+        m_renderGraph.AddPass("GBuffer", std::move(gbufferRenderPass), {}, gbufferResources);
+        m_renderGraph.AddPass("Deferred", std::make_unique<DeferredRenderPass>(m_deferredMaterial, m_sceneFramebuffer), gbufferResources, { sceneResource });
+
+        // Skybox pass, drawn where the scene depth is empty
+        std::unique_ptr<SkyboxRenderPass> skyboxRenderPass(std::make_unique<SkyboxRenderPass>(m_skyboxTexture, shaderPrograms.skyboxProgram));
+        skyboxRenderPass->SetTargetFramebuffer(m_sceneFramebuffer);
+        m_renderGraph.AddPass("Skybox", std::move(skyboxRenderPass), { sceneResource }, { sceneResource });
+
+        // Forward pass, blends the transparent drawcalls over the lit scene. Depth tested with the g-buffer depth
+        std::unique_ptr<ForwardRenderPass> forwardRenderPass(std::make_unique<ForwardRenderPass>(m_forwardCollectionIndex));
+        forwardRenderPass->SetTargetFramebuffer(m_sceneFramebuffer);
+        m_renderGraph.AddPass("Forward", std::move(forwardRenderPass), { sceneResource, gbufferResources[0] }, { sceneResource });
     }
 
-    // Final pass
-    m_composeMaterial = CreatePostFXMaterial("shaders/postfx/compose.frag", m_sceneTexture);
+    // Bloom pass: thresholds while downsampling to a pyramid of half size textures, then upsamples and adds them back
+    std::shared_ptr<Material> bloomDownsampleMaterial = CreatePostFXMaterial(shaderPrograms.bloomDownsampleProgram);
+    std::shared_ptr<Material> bloomUpsampleMaterial = CreatePostFXMaterial(shaderPrograms.bloomUpsampleProgram);
+    std::unique_ptr<BloomRenderPass> bloomRenderPass(std::make_unique<BloomRenderPass>(width, height, bloomDownsampleMaterial, bloomUpsampleMaterial));
+    bloomRenderPass->SetRange(m_bloomRange);
+    bloomRenderPass->SetIntensity(m_bloomIntensity);
+    bloomRenderPass->SetRadius(m_bloomRadius);
+    m_bloomRenderPass = bloomRenderPass.get();
+
+    // The pyramid is created by the pass, the result is its first level
+    RenderGraph::ResourceId bloomResource = m_renderGraph.ImportTexture("Bloom", bloomRenderPass->GetBloomTexture());
+    m_renderGraph.AddPass("Bloom", std::move(bloomRenderPass), { sceneResource }, { bloomResource },
+        [this, sceneResource](const RenderGraph& renderGraph) { m_bloomRenderPass->SetSourceTexture(renderGraph.GetTexture(sceneResource)); });
+    // Final pass: the fused compose and VHS effects. Their program was submitted with the others, the material uses it now
+    m_postFXChain->Build();
 
-    // Set exposure uniform default value
-    m_composeMaterial->SetUniformValue("Exposure", m_exposure);
     // Set uniform default values
-    m_composeMaterial->SetUniformValue("Contrast", m_contrast);
-    m_composeMaterial->SetUniformValue("HueShift", m_hueShift);
-    m_composeMaterial->SetUniformValue("Saturation", m_saturation);
-    m_composeMaterial->SetUniformValue("ColorFilter", m_colorFilter);
-    // Set the bloom texture uniform
-    m_composeMaterial->SetUniformValue("BloomTexture", m_tempTextures[0]);
-    m_renderer.AddRenderPass(std::make_unique<PostFXRenderPass>(m_composeMaterial, m_tempFramebuffers[1]));
-
-
-    //Here is the postfx frags i have made
-	//chromatic aberration
-    m_chromaticAbMaterial = CreatePostFXMaterial("shaders/postfx/chromatic.frag", m_tempTextures[1]);
-    m_chromaticAbMaterial->SetUniformValue("AbAmount", m_abAmount);
-    m_renderer.AddRenderPass(std::make_unique<PostFXRenderPass>(m_chromaticAbMaterial, m_tempFramebuffers[0]));
-
-    //noise
-    m_noiseMaterial = CreatePostFXMaterial("shaders/postfx/noise.frag", m_tempTextures[0]);
-    m_renderer.AddRenderPass(std::make_unique<PostFXRenderPass>(m_noiseMaterial, m_tempFramebuffers[1]));
-
-    //vignetting
-    m_vignetteMaterial = CreatePostFXMaterial("shaders/postfx/vignette.frag", m_tempTextures[1]);
-    m_vignetteMaterial->SetUniformValue("VignetteIntensity", m_vignettingIntensity);
-    m_vignetteMaterial->SetUniformValue("VignetteSmoothness", m_vignettingSmoothness);
-    m_renderer.AddRenderPass(std::make_unique<PostFXRenderPass>(m_vignetteMaterial, m_tempFramebuffers[0]));
-
-    //barrel
-    m_barrelMaterial = CreatePostFXMaterial("shaders/postfx/barrel.frag", m_tempTextures[0]);
-    m_barrelMaterial->SetUniformValue("Distortion", m_distortion);
-    m_renderer.AddRenderPass(std::make_unique<PostFXRenderPass>(m_barrelMaterial, m_tempFramebuffers[1]));
- 
-    //scanline
-    m_scanlinesMaterial = CreatePostFXMaterial("shaders/postfx/scanline.frag", m_tempTextures[1]);
-    m_scanlinesMaterial->SetUniformValue("LineDensity", m_scanlinesLineDensity);
-    m_scanlinesMaterial->SetUniformValue("Intensity", m_scanlinesIntensity);
-    m_scanlinesMaterial->SetUniformValue("Time", m_elapsedTime);
-    m_renderer.AddRenderPass(std::make_unique<PostFXRenderPass>(m_scanlinesMaterial, m_tempFramebuffers[0]));
-
-    //copypass for the final, cuz the last pfx needs to use defualtframebuffer
-    std::shared_ptr<Material> finalCopyMaterial = CreatePostFXMaterial("shaders/postfx/copy.frag", m_tempTextures[0]);
-    m_renderer.AddRenderPass(std::make_unique<PostFXRenderPass>(finalCopyMaterial, m_renderer.GetDefaultFramebuffer()));
+    m_postFXChain->SetUniformValue("SourceTexture", m_sceneTexture);
+    m_postFXChain->SetUniformValue(m_composeEffect, "Exposure", m_exposure);
+    m_postFXChain->SetUniformValue(m_composeEffect, "Contrast", m_contrast);
+    m_postFXChain->SetUniformValue(m_composeEffect, "HueShift", m_hueShift);
+    m_postFXChain->SetUniformValue(m_composeEffect, "Saturation", m_saturation);
+    m_postFXChain->SetUniformValue(m_composeEffect, "ColorFilter", m_colorFilter);
+    m_postFXChain->SetUniformValue(m_chromaticAbEffect, "AbAmount", m_abAmount);
+    m_postFXChain->SetUniformValue(m_vignetteEffect, "VignetteIntensity", m_vignettingIntensity);
+    m_postFXChain->SetUniformValue(m_vignetteEffect, "VignetteSmoothness", m_vignettingSmoothness);
+    m_postFXChain->SetUniformValue(m_barrelEffect, "Distortion", m_distortion);
+    m_postFXChain->SetUniformValue(m_scanlinesEffect, "LineDensity", m_scanlinesLineDensity);
+    m_postFXChain->SetUniformValue(m_scanlinesEffect, "Intensity", m_scanlinesIntensity);
+    m_postFXChain->SetUniformValue(m_scanlinesEffect, "Time", m_elapsedTime);
+
+
+    // The output of the graph, rendered directly to the default framebuffer
+    RenderGraph::ResourceId finalResource = m_renderGraph.CreateTexture("Final", hdrTextureDesc);
+    m_renderGraph.SetOutput(finalResource);
+    m_renderGraph.AddPass("PostFX", std::make_unique<PostFXRenderPass>(m_postFXChain->GetMaterial()), { sceneResource, bloomResource }, { finalResource },
+        [this, bloomResource](const RenderGraph& renderGraph) { m_postFXChain->SetUniformValue(m_composeEffect, "BloomTexture", renderGraph.GetTexture(bloomResource)); });
+
+    // The compiled graph is shown in the "Render Graph" window
+    if (!m_renderGraph.Compile(m_renderer))
+    {
+        Terminate(-3, m_renderGraph.GetErrorMessage().c_str());
+    }
 }
 
-std::shared_ptr<Material> PostFXSceneViewerApplication::CreatePostFXMaterial(const char* fragmentShaderPath, std::shared_ptr<Texture2DObject> sourceTexture)
+std::shared_ptr<ShaderProgram> PostFXSceneViewerApplication::CreatePostFXShaderProgram(const char* fragmentShaderPath)
 {
-    // We could keep this vertex shader and reuse it, but it looks simpler this way
+    // The loader compiles the vertex shader once, and shares it with all the post FX materials
     std::vector<const char*> vertexShaderPaths;
     vertexShaderPaths.push_back("shaders/version330.glsl");
     vertexShaderPaths.push_back("shaders/renderer/fullscreen.vert");
-    Shader vertexShader = ShaderLoader(Shader::VertexShader).Load(vertexShaderPaths);
+    std::shared_ptr<Shader> vertexShader = ShaderLoader(Shader::VertexShader).LoadShared(vertexShaderPaths);
 
     std::vector<const char*> fragmentShaderPaths;
     fragmentShaderPaths.push_back("shaders/version330.glsl");
     fragmentShaderPaths.push_back("shaders/utils.glsl");
     fragmentShaderPaths.push_back(fragmentShaderPath);
-    Shader fragmentShader = ShaderLoader(Shader::FragmentShader).Load(fragmentShaderPaths);
+    std::shared_ptr<Shader> fragmentShader = ShaderLoader(Shader::FragmentShader).LoadShared(fragmentShaderPaths);
 
     std::shared_ptr<ShaderProgram> shaderProgramPtr = std::make_shared<ShaderProgram>();
-    shaderProgramPtr->Build(vertexShader, fragmentShader);
+    shaderProgramPtr->Build(*vertexShader, *fragmentShader);
+    return shaderProgramPtr;
+}
 
+std::shared_ptr<Material> PostFXSceneViewerApplication::CreatePostFXMaterial(std::shared_ptr<ShaderProgram> shaderProgramPtr, std::shared_ptr<Texture2DObject> sourceTexture)
+{
     // Create material
     std::shared_ptr<Material> material = std::make_shared<Material>(shaderProgramPtr);
     material->SetUniformValue("SourceTexture", sourceTexture);
@@ -503,6 +690,30 @@ Renderer::UpdateTransformsFunction PostFXSceneViewerApplication::GetFullscreenTr
         };
 }
 
+void PostFXSceneViewerApplication::RecordBenchmarkFrame()
+{
+    const DeviceGL& device = GetDevice();
+    m_benchmark->AddSample("drawcalls", device.GetDrawcallCount());
+    m_benchmark->AddSample("state_changes_issued", device.GetIssuedStateChanges());
+    m_benchmark->AddSample("state_changes_skipped", device.GetSkippedStateChanges(), Benchmark::Direction::Informational);
+    m_benchmark->AddSample("uniform_uploads_issued", ShaderUniformCollection::GetIssuedUploads());
+    m_benchmark->AddSample("uniform_uploads_skipped", ShaderUniformCollection::GetSkippedUploads(), Benchmark::Direction::Informational);
+
+    // GPU times are from an earlier frame, the profiler doesn't wait for the results
+    const RenderProfiler::Frame& frame = m_renderer.GetProfiler().GetLastFrame();
+    if (!frame.timings.empty())
+    {
+        m_benchmark->AddSample("gpu_frame_ms", frame.gpuTime);
+        for (const RenderProfiler::Timing& timing : frame.timings)
+        {
+            if (timing.gpuTime >= 0.0)
+            {
+                m_benchmark->AddSample("gpu_ms." + timing.name, timing.gpuTime);
+            }
+        }
+    }
+}
+
 void PostFXSceneViewerApplication::RenderGUI()
 {
     m_imGui.BeginFrame();
@@ -514,91 +725,155 @@ void PostFXSceneViewerApplication::RenderGUI()
     // Draw GUI for camera controller
     m_cameraController.DrawGUI(m_imGui);
 
+    m_renderer.GetProfiler().DrawGUI(m_imGui);
+
+    // Record a camera path for the benchmark, one keyframe per second
+    if (auto window = m_imGui.UseWindow("Camera Path"))
+    {
+        ImGui::Text("Keyframes: %u", static_cast<unsigned int>(m_cameraPath.GetKeyframes().size()));
+        if (ImGui::Button("Add Keyframe"))
+        {
+            m_cameraPath.AddKeyframe(*m_cameraController.GetCamera()->GetCamera());
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Clear"))
+        {
+            m_cameraPath.Clear();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Save"))
+        {
+            m_cameraPath.Save("camera_path.txt");
+        }
+    }
+
     if (auto window = m_imGui.UseWindow("Post FX"))
     {
-        if (m_composeMaterial)
+        if (m_postFXChain)
         {
+            // Toggling an effect rebuilds the fused shader in the next update
+            for (unsigned int effectIndex = 0; effectIndex < m_postFXChain->GetEffectCount(); ++effectIndex)
+            {
+                bool enabled = m_postFXChain->IsEffectEnabled(effectIndex);
+                if (ImGui::Checkbox(m_postFXChain->GetEffectName(effectIndex), &enabled))
+                {
+                    m_postFXChain->SetEffectEnabled(effectIndex, enabled);
+                }
+            }
+
+            ImGui::Separator();
+
             if (ImGui::DragFloat("Exposure", &m_exposure, 0.01f, 0.01f, 5.0f))
             {
-                m_composeMaterial->SetUniformValue("Exposure", m_exposure);
+                m_postFXChain->SetUniformValue(m_composeEffect, "Exposure", m_exposure);
             }
 
             ImGui::Separator();
 
             if (ImGui::SliderFloat("Contrast", &m_contrast, 0.5f, 1.5f))
             {
-                m_composeMaterial->SetUniformValue("Contrast", m_contrast);
+                m_postFXChain->SetUniformValue(m_composeEffect, "Contrast", m_contrast);
             }
             if (ImGui::SliderFloat("Hue Shift", &m_hueShift, -0.5f, 0.5f))
             {
-                m_composeMaterial->SetUniformValue("HueShift", m_hueShift);
+                m_postFXChain->SetUniformValue(m_composeEffect, "HueShift", m_hueShift);
             }
             if (ImGui::SliderFloat("Saturation", &m_saturation, 0.0f, 2.0f))
             {
-                m_composeMaterial->SetUniformValue("Saturation", m_saturation);
+                m_postFXChain->SetUniformValue(m_composeEffect, "Saturation", m_saturation);
             }
             if (ImGui::ColorEdit3("Color Filter", &m_colorFilter[0]))
             {
-                m_composeMaterial->SetUniformValue("ColorFilter", m_colorFilter);
+                m_postFXChain->SetUniformValue(m_composeEffect, "ColorFilter", m_colorFilter);
             }
 
             ImGui::Separator();
 
             if (ImGui::DragFloat2("Bloom Range", &m_bloomRange[0], 0.1f, 0.1f, 10.0f))
             {
-                m_bloomMaterial->SetUniformValue("Range", m_bloomRange);
+                m_bloomRenderPass->SetRange(m_bloomRange);
             }
             if (ImGui::DragFloat("Bloom Intensity", &m_bloomIntensity, 0.1f, 0.0f, 5.0f))
             {
-                m_bloomMaterial->SetUniformValue("Intensity", m_bloomIntensity);
+                m_bloomRenderPass->SetIntensity(m_bloomIntensity);
+            }
+            if (ImGui::SliderFloat("Bloom Radius", &m_bloomRadius, 0.5f, 3.0f))
+            {
+                m_bloomRenderPass->SetRadius(m_bloomRadius);
             }
 
-			ImGui::Separator();
+            ImGui::Separator();
 
-            if (m_scanlinesMaterial)
+            if (ImGui::DragFloat("Scanline Density", &m_scanlinesLineDensity, 1.0f, 50.0f, 500.0f))
             {
+                m_postFXChain->SetUniformValue(m_scanlinesEffect, "LineDensity", m_scanlinesLineDensity);
+            }
+            if (ImGui::SliderFloat("Scanline Intensity", &m_scanlinesIntensity, 0.0f, 1.0f))
+            {
+                m_postFXChain->SetUniformValue(m_scanlinesEffect, "Intensity", m_scanlinesIntensity);
+            }
 
-                if (ImGui::DragFloat("Scanline Density", &m_scanlinesLineDensity, 1.0f, 50.0f, 500.0f))
-                {
-                    m_scanlinesMaterial->SetUniformValue("LineDensity", m_scanlinesLineDensity);
-                }
-                if (ImGui::SliderFloat("Scanline Intensity", &m_scanlinesIntensity, 0.0f, 1.0f))
-                {
-                    m_scanlinesMaterial->SetUniformValue("Intensity", m_scanlinesIntensity);
-                }
+            ImGui::Separator();
+
+            if (ImGui::SliderFloat("Vignette Intensity", &m_vignettingIntensity, 0.0f, 1.0f))
+            {
+                m_postFXChain->SetUniformValue(m_vignetteEffect, "VignetteIntensity", m_vignettingIntensity);
+            }
+            if (ImGui::SliderFloat("Vignette Smoothness", &m_vignettingSmoothness, 0.0f, 1.0f))
+            {
+                m_postFXChain->SetUniformValue(m_vignetteEffect, "VignetteSmoothness", m_vignettingSmoothness);
             }
 
             ImGui::Separator();
 
-			if (m_vignetteMaterial)
-			{
-				if (ImGui::SliderFloat("Vignette Intensity", &m_vignettingIntensity, 0.0f, 1.0f))
-				{
-					m_vignetteMaterial->SetUniformValue("VignetteIntensity", m_vignettingIntensity);
-				}
-				if (ImGui::SliderFloat("Vignette Smoothness", &m_vignettingSmoothness, 0.0f, 1.0f))
-				{
-					m_vignetteMaterial->SetUniformValue("VignetteSmoothness", m_vignettingSmoothness);
-				}
-			}
-			ImGui::Separator();
-            if (m_chromaticAbMaterial)
+            if (ImGui::SliderFloat("Chromatic Aberration Amount", &m_abAmount, 0.0f, 1.0f))
             {
-                if (ImGui::SliderFloat("Chromatic Aberration Amount", &m_abAmount, 0.0f, 1.0f))
-                {
-                    m_chromaticAbMaterial->SetUniformValue("AbAmount", m_abAmount);
-                }
+                m_postFXChain->SetUniformValue(m_chromaticAbEffect, "AbAmount", m_abAmount);
             }
-			ImGui::Separator();
-            if (m_barrelMaterial)
+
+            ImGui::Separator();
+
+            if (ImGui::SliderFloat("Distortion", &m_distortion, 0.0f, 1.0f))
             {
-                if (ImGui::SliderFloat("Distortion", &m_distortion, 0.0f, 1.0f))
-                {
-                    m_barrelMaterial->SetUniformValue("Distortion", m_distortion);
-                }
+                m_postFXChain->SetUniformValue(m_barrelEffect, "Distortion", m_distortion);
             }
         }
     }
 
+    if (auto window = m_imGui.UseWindow("Render Graph"))
+    {
+        ImGui::TextUnformatted(m_renderGraph.GetDebugDump().c_str());
+    }
+
+    if (auto window = m_imGui.UseWindow("Shader Cache"))
+    {
+        const ShaderProgramCache::Stats& stats = m_shaderProgramCache.GetStats();
+        ImGui::Text("Enabled: %s", m_shaderProgramCache.IsEnabled() ? "yes" : "no");
+        ImGui::Text("Hits: %u", stats.hitCount);
+        ImGui::Text("Misses: %u (%u rejected by the driver)", stats.missCount, stats.rejectedCount);
+        ImGui::Text("Time saved: %.1f ms", stats.savedTime);
+    }
+
+    if (auto window = m_imGui.UseWindow("Asset Loading"))
+    {
+        ImGui::Text("Workers: %u", m_assetJobQueue.GetWorkerCount());
+        ImGui::Text("Status: %s", m_assetJobQueue.IsIdle() ? "idle" : "loading");
+        ImGui::Text("Staging slots: %u / %u free (%.0f KB each)", m_textureStagingRing.GetFreeSlotCount(), m_textureStagingRing.GetSlotCount(),
+            m_textureStagingRing.GetSlotSize() / 1024.0f);
+        ImGui::Text("Staged uploads: %u (%u retries)", m_textureStagingRing.GetUploadCount(), m_textureStagingRing.GetBusyCount());
+    }
+
+    if (m_geometryArena)
+    {
+        if (auto window = m_imGui.UseWindow("Geometry Arena"))
+        {
+            GeometryArena::Stats stats = m_geometryArena->GetStats();
+            ImGui::Text("Pools: %u", stats.poolCount);
+            ImGui::Text("Vertices: %u / %u (%u free blocks, largest %u)", stats.vertexCount, stats.vertexCapacity, stats.vertexFreeBlockCount, stats.vertexLargestFreeBlock);
+            ImGui::Text("Elements: %u / %u (%u free blocks, largest %u)", stats.elementCount, stats.elementCapacity, stats.elementFreeBlockCount, stats.elementLargestFreeBlock);
+            ImGui::Text("Element fragmentation: %.1f%%", stats.elementFragmentation * 100.0f);
+        }
+    }
+
     m_imGui.EndFrame();
 }
@@ -5,7 +5,13 @@
 #include <ituGL/scene/Scene.h>
 #include <ituGL/texture/FramebufferObject.h>
 #include <ituGL/renderer/Renderer.h>
+#include <ituGL/renderer/RenderGraph.h>
 #include <ituGL/camera/CameraController.h>
+#include <ituGL/camera/CameraPath.h>
+#include <ituGL/shader/ShaderProgramCache.h>
+#include <ituGL/shader/UniformBufferArena.h>
+#include <ituGL/texture/TextureStagingRing.h>
+#include <ituGL/asset/AssetJobQueue.h>
 #include <ituGL/utils/DearImGui.h>
 #include <array>
 #include <vector>
@@ -15,11 +21,15 @@
 class Texture2DObject;
 class TextureCubemapObject;
 class Material;
+class PostFXChain;
+class BloomRenderPass;
+class Benchmark;
 
 class PostFXSceneViewerApplication : public Application
 {
 public:
-    PostFXSceneViewerApplication();
+    // The benchmark is optional, it records the metrics of every frame when provided
+    PostFXSceneViewerApplication(const RunSettings& runSettings = RunSettings(), Benchmark* benchmark = nullptr);
 
 protected:
     void Initialize() override;
@@ -27,62 +37,111 @@ protected:
     void Render() override;
     void Cleanup() override;
 
+private:
+    // Programs submitted together in a ShaderBuildBatch. The materials and passes using them are created once they are linked
+    struct ShaderPrograms
+    {
+        std::shared_ptr<ShaderProgram> defaultProgram;
+        std::shared_ptr<ShaderProgram> deferredProgram;
+        std::shared_ptr<ShaderProgram> forwardProgram;
+        std::shared_ptr<ShaderProgram> tvScreenProgram;
+        std::shared_ptr<ShaderProgram> bloomDownsampleProgram;
+        std::shared_ptr<ShaderProgram> bloomUpsampleProgram;
+        std::shared_ptr<ShaderProgram> skyboxProgram;
+    };
+
 private:
     void InitializeCamera();
+    void InitializeCameraPath();
     void InitializeLights();
-    void InitializeMaterials();
+    ShaderPrograms BuildShaderPrograms();
+    void InitializeDefaultMaterial(std::shared_ptr<ShaderProgram> shaderProgram);
+    void InitializeMaterials(const ShaderPrograms& shaderPrograms);
     void InitializeModels();
     void InitializeFramebuffers();
-    void InitializeRenderer();
+    void InitializeRenderer(const ShaderPrograms& shaderPrograms);
 
-    std::shared_ptr<Material> CreatePostFXMaterial(const char* fragmentShaderPath, std::shared_ptr<Texture2DObject> sourceTexture = nullptr);
+    std::shared_ptr<ShaderProgram> CreatePostFXShaderProgram(const char* fragmentShaderPath);
+    std::shared_ptr<Material> CreatePostFXMaterial(std::shared_ptr<ShaderProgram> shaderProgramPtr, std::shared_ptr<Texture2DObject> sourceTexture = nullptr);
 
     Renderer::UpdateTransformsFunction GetFullscreenTransformFunction(std::shared_ptr<ShaderProgram> shaderProgramPtr) const;
 
     void RenderGUI();
 
+    void RecordBenchmarkFrame();
+
 private:
     // Helper object for debug GUI
     DearImGui m_imGui;
 
+    // Linked programs stored on disk, to skip building them in the next runs
+    ShaderProgramCache m_shaderProgramCache;
+
+    // Storage for the "MaterialParams" blocks. Declared before anything holding materials, so it is destroyed after them
+    UniformBufferArena m_uniformBufferArena;
+
+    // Pixel buffers the decoded textures are copied to, so they are uploaded without stalling the frame
+    TextureStagingRing m_textureStagingRing;
+
+    // Workers decoding the models and textures. Declared after the arena and the staging ring,
+    // so pending jobs release their materials and staging memory before those are destroyed
+    AssetJobQueue m_assetJobQueue;
+
+    // Time in milliseconds per frame for the main thread jobs of the asset loading (buffer and texture uploads)
+    static const double c_assetJobBudget;
+
     // Camera controller
     CameraController m_cameraController;
 
+    // Camera movement replayed by the benchmark
+    CameraPath m_cameraPath;
+
+    Benchmark* m_benchmark;
+
     // Global scene
     Scene m_scene;
 
     // Renderer
     Renderer m_renderer;
 
+    // Drawcalls with blending, drawn by the forward pass over the lit scene. The opaque ones stay in collection 0
+    unsigned int m_forwardCollectionIndex;
+
+    // Passes of the renderer, and the temporary textures they use
+    RenderGraph m_renderGraph;
+
+    // Bloom pass, owned by the render graph
+    BloomRenderPass* m_bloomRenderPass;
+
+    // Shared storage for the geometry of the loaded models
+    std::shared_ptr<GeometryArena> m_geometryArena;
+
     // Skybox texture
     std::shared_ptr<TextureCubemapObject> m_skyboxTexture;
 
     // Materials
     std::shared_ptr<Material> m_defaultMaterial;
     std::shared_ptr<Material> m_deferredMaterial;
-    std::shared_ptr<Material> m_composeMaterial;
-    std::shared_ptr<Material> m_bloomMaterial;
-    //scanlines
-    std::shared_ptr<Material> m_scanlinesMaterial;
-	//vignetting
-	std::shared_ptr<Material> m_vignetteMaterial;
-	//chromatic aberration
-	std::shared_ptr<Material> m_chromaticAbMaterial;
     //fog effect
 	std::shared_ptr<Material> m_fogMaterial;
-    //noise
-	std::shared_ptr<Material> m_noiseMaterial;
 	//tv screen
 	std::shared_ptr<Material> m_tvScreenMaterial;
-	//barrel
-	std::shared_ptr<Material> m_barrelMaterial;
+    // Glass over the tv screen, transparent and lit with clustered lighting in the forward pass
+    std::shared_ptr<Material> m_screenGlassMaterial;
+
+    // Compose and VHS effects, fused in a single pass
+    std::shared_ptr<PostFXChain> m_postFXChain;
+    unsigned int m_composeEffect;
+    unsigned int m_chromaticAbEffect;
+    unsigned int m_noiseEffect;
+    unsigned int m_vignetteEffect;
+    unsigned int m_barrelEffect;
+    unsigned int m_scanlinesEffect;
 
     // Framebuffers
     std::shared_ptr<FramebufferObject> m_sceneFramebuffer;
     std::shared_ptr<Texture2DObject> m_depthTexture;
     std::shared_ptr<Texture2DObject> m_sceneTexture;
-    std::array<std::shared_ptr<FramebufferObject>, 4> m_tempFramebuffers;
-    std::array<std::shared_ptr<Texture2DObject>, 4> m_tempTextures;
 
     // Configuration values
     float m_exposure;
@@ -90,9 +149,9 @@ private:
     float m_hueShift;
     float m_saturation;
     glm::vec3 m_colorFilter;
-    int m_blurIterations;
     glm::vec2 m_bloomRange;
     float m_bloomIntensity;
+    float m_bloomRadius;
 	
     //Scanlines
 	float m_scanlinesIntensity;
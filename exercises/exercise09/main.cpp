@@ -1,7 +1,21 @@
 #include "PostFXSceneViewerApplication.h"
 
-int main()
+#include <ituGL/application/Benchmark.h>
+
+int main(int argc, char* argv[])
 {
-    PostFXSceneViewerApplication sceneViewerApplication;
-    return sceneViewerApplication.Run();
+    Application::RunSettings runSettings = Application::ParseRunSettings(argc, argv);
+
+    // With --benchmark, the frames are recorded with a fixed timestep and the results written when the application ends
+    Benchmark benchmark(Benchmark::ParseSettings(argc, argv));
+    benchmark.AdjustRunSettings(runSettings);
+
+    PostFXSceneViewerApplication sceneViewerApplication(runSettings, benchmark.IsEnabled() ? &benchmark : nullptr);
+    int exitCode = sceneViewerApplication.Run();
+
+    if (exitCode == 0 && benchmark.IsEnabled())
+    {
+        exitCode = benchmark.Finish();
+    }
+    return exitCode;
 }
@@ -10,7 +10,12 @@ out vec2 FragNormal;
 out vec4 FragOthers;
 
 //Uniforms
-uniform vec3 Color;
+// Values of the material, packed in its own range of a shared uniform buffer
+layout (std140) uniform MaterialParams
+{
+	vec3 Color;
+};
+
 uniform sampler2D ColorTexture;
 uniform sampler2D NormalTexture;
 uniform sampler2D SpecularTexture;
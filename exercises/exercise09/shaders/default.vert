@@ -11,24 +11,24 @@ out vec3 ViewTangent;
 out vec3 ViewBitangent;
 out vec2 TexCoord;
 
-//Uniforms
-uniform mat4 WorldViewMatrix;
-uniform mat4 WorldViewProjMatrix;
+// Transforms come from the frame constants and the object matrices
 
 void main()
 {
+	mat4 worldViewMatrix = ViewMatrix * GetWorldMatrix();
+
 	// normal in view space (for lighting computation)
-	ViewNormal = (WorldViewMatrix * vec4(VertexNormal, 0.0)).xyz;
+	ViewNormal = (worldViewMatrix * vec4(VertexNormal, 0.0)).xyz;
 
 	// tangent in view space (for lighting computation)
-	ViewTangent = (WorldViewMatrix * vec4(VertexTangent, 0.0)).xyz;
+	ViewTangent = (worldViewMatrix * vec4(VertexTangent, 0.0)).xyz;
 
 	// bitangent in view space (for lighting computation)
-	ViewBitangent = (WorldViewMatrix * vec4(VertexBitangent, 0.0)).xyz;
+	ViewBitangent = (worldViewMatrix * vec4(VertexBitangent, 0.0)).xyz;
 
 	// texture coordinates
 	TexCoord = VertexTexCoord;
 
 	// final vertex position (for opengl rendering, not for lighting)
-	gl_Position = WorldViewProjMatrix * vec4(VertexPosition, 1.0);
+	gl_Position = ProjMatrix * worldViewMatrix * vec4(VertexPosition, 1.0);
 }
@@ -0,0 +1,36 @@
+//Inputs
+in vec3 WorldPosition;
+in vec3 WorldNormal;
+in vec2 TexCoord;
+
+//Outputs
+out vec4 FragColor;
+
+//Uniforms
+// Values of the material, packed in its own range of a shared uniform buffer
+layout (std140) uniform MaterialParams
+{
+	vec3 Color;
+	float Opacity;
+	float Roughness;
+	float Metalness;
+};
+
+// Lit in the forward pass, with all the lights of the cluster of the fragment at once
+void main()
+{
+	vec3 position = WorldPosition;
+	vec3 viewDir = GetDirection(position, CameraPosition);
+
+	// Set surface material data
+	SurfaceData data;
+	data.normal = normalize(WorldNormal);
+	data.albedo = Color;
+	data.ambientOcclusion = 1.0f;
+	data.roughness = Roughness;
+	data.metalness = Metalness;
+
+	// Compute lighting, blended over the lit scene
+	vec3 lighting = ComputeClusteredLighting(position, data, viewDir, true);
+	FragColor = vec4(lighting, Opacity);
+}
@@ -0,0 +1,31 @@
+//Inputs
+layout (location = 0) in vec3 VertexPosition;
+layout (location = 1) in vec3 VertexNormal;
+layout (location = 2) in vec3 VertexTangent;
+layout (location = 3) in vec3 VertexBitangent;
+layout (location = 4) in vec2 VertexTexCoord;
+
+//Outputs
+out vec3 WorldPosition;
+out vec3 WorldNormal;
+out vec2 TexCoord;
+
+// Same position as the g-buffer shaders, so surfaces drawn on top of them pass a LessEqual depth test
+invariant gl_Position;
+
+// Transforms come from the frame constants and the object matrices
+
+void main()
+{
+	mat4 worldMatrix = GetWorldMatrix();
+
+	// position and normal in world space (for lighting computation)
+	WorldPosition = (worldMatrix * vec4(VertexPosition, 1.0)).xyz;
+	WorldNormal = (worldMatrix * vec4(VertexNormal, 0.0)).xyz;
+
+	// texture coordinates
+	TexCoord = VertexTexCoord;
+
+	// final vertex position (for opengl rendering, not for lighting)
+	gl_Position = ViewProjMatrix * worldMatrix * vec4(VertexPosition, 1.0);
+}
@@ -0,0 +1,12 @@
+
+// Camera and time values, uploaded once per frame by the renderer
+layout (std140) uniform FrameConstants
+{
+	mat4 ViewMatrix;
+	mat4 ProjMatrix;
+	mat4 ViewProjMatrix;
+	mat4 InvViewMatrix;
+	mat4 InvProjMatrix;
+	vec3 CameraPosition;
+	float Time;
+};
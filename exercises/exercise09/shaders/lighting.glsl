@@ -1,3 +1,15 @@
+#include "utils.glsl"
+#include "lambert-ggx.glsl"
+#include "frameconstants.glsl"
+
+// Values of a light, from the light uniforms or from the clustered light buffer
+struct LightData
+{
+	vec3 color;
+	vec3 position;
+	vec3 direction;
+	vec4 attenuation;
+};
 
 uniform bool LightIndirect;
 uniform vec3 LightColor;
@@ -5,59 +17,79 @@ uniform vec3 LightPosition;
 uniform vec3 LightDirection;
 uniform vec4 LightAttenuation;
 
-float ComputeDistanceAttenuation(vec3 position)
+// Clustered lighting: every light is stored in a buffer, 4 texels per light, and each cluster has a list of light indices
+// Lights without range come first and are applied to every fragment
+uniform samplerBuffer ClusterLights;
+uniform usamplerBuffer ClusterRanges;
+uniform usamplerBuffer ClusterLightIndices;
+uniform int ClusterGlobalLightCount;
+uniform ivec3 ClusterCount;
+uniform vec2 ClusterTileScale;
+uniform vec2 ClusterDepthParams;
+
+LightData GetUniformLight()
+{
+	return LightData(LightColor, LightPosition, LightDirection, LightAttenuation);
+}
+
+float ComputeDistanceAttenuation(LightData light, vec3 position)
 {
-	// Compute distance attenuation, reading the range from LightAttenuation.x (fade start) and LightAttenuation.y (fade end)
-	return smoothstep(LightAttenuation.y, LightAttenuation.x, distance(position, LightPosition));
+	// Compute distance attenuation, reading the range from attenuation.x (fade start) and attenuation.y (fade end)
+	return smoothstep(light.attenuation.y, light.attenuation.x, distance(position, light.position));
 }
 
-float ComputeAngularAttenuation(vec3 lightDir)
+float ComputeAngularAttenuation(LightData light, vec3 lightDir)
 {
-	float angle = acos(dot(LightDirection, lightDir));
-	vec2 attAngle = LightAttenuation.zw;
+	float angle = acos(dot(light.direction, lightDir));
+	vec2 attAngle = light.attenuation.zw;
 	return smoothstep(attAngle.y, attAngle.x, angle);
 }
 
-float ComputeAttenuation(vec3 position, vec3 lightDir)
+float ComputeAttenuation(LightData light, vec3 position, vec3 lightDir)
 {
 	float attenuation = 1.0f;
-	if (LightAttenuation.y > 0)
+	if (light.attenuation.y > 0)
 	{
-		attenuation *= ComputeDistanceAttenuation(position);
+		attenuation *= ComputeDistanceAttenuation(light, position);
 	}
-	if (LightAttenuation.w > 0)
+	if (light.attenuation.w > 0)
 	{
-		attenuation *= ComputeAngularAttenuation(lightDir);
+		attenuation *= ComputeAngularAttenuation(light, lightDir);
 	}
 	return attenuation;
 }
 
-vec3 ComputeLightDirection(vec3 position)
+vec3 ComputeLightDirection(LightData light, vec3 position)
 {
-	return LightAttenuation.y >= 0 ? GetDirection(position, LightPosition) : -LightDirection;
+	return light.attenuation.y >= 0 ? GetDirection(position, light.position) : -light.direction;
 }
 
-vec3 ComputeLight(SurfaceData data, vec3 viewDir, vec3 position)
+vec3 ComputeLight(LightData light, SurfaceData data, vec3 viewDir, vec3 position)
 {
-	vec3 lightDir = ComputeLightDirection(position);
+	vec3 lightDir = ComputeLightDirection(light, position);
 
 	vec3 diffuse = ComputeDiffuseLighting(data, lightDir);
 	vec3 specular = ComputeSpecularLighting(data, lightDir, viewDir);
-	vec3 light = CombineLighting(diffuse, specular, data, lightDir, viewDir);
+	vec3 lighting = CombineLighting(diffuse, specular, data, lightDir, viewDir);
+
+	float attenuation = ComputeAttenuation(light, position, lightDir);
+	return lighting * light.color * attenuation;
+}
 
-	float attenuation = ComputeAttenuation(position, lightDir);
-	return light * LightColor * attenuation;
+vec3 ComputeIndirectLighting(SurfaceData data, vec3 viewDir)
+{
+	vec3 diffuseIndirect = ComputeDiffuseIndirectLighting(data);
+	vec3 specularIndirect = ComputeSpecularIndirectLighting(data, viewDir);
+	return CombineIndirectLighting(diffuseIndirect, specularIndirect, data, viewDir);
 }
 
 vec3 ComputeLighting(vec3 position, SurfaceData data, vec3 viewDir, bool indirect)
 {
-	vec3 light = ComputeLight(data, viewDir, position);
+	vec3 light = ComputeLight(GetUniformLight(), data, viewDir, position);
 	
 	if (indirect && LightIndirect)
 	{
-		vec3 diffuseIndirect = ComputeDiffuseIndirectLighting(data);
-		vec3 specularIndirect = ComputeSpecularIndirectLighting(data, viewDir);
-		light += CombineIndirectLighting(diffuseIndirect, specularIndirect, data, viewDir);
+		light += ComputeIndirectLighting(data, viewDir);
 	}
 
 	return light;
@@ -67,3 +99,50 @@ vec3 ComputeLighting(vec3 position, SurfaceData data, vec3 viewDir)
 {
 	return ComputeLighting(position, data, viewDir, true);
 }
+
+LightData GetClusterLight(int lightIndex)
+{
+	int texel = lightIndex * 4;
+	return LightData(texelFetch(ClusterLights, texel).rgb,
+		texelFetch(ClusterLights, texel + 1).xyz,
+		texelFetch(ClusterLights, texel + 2).xyz,
+		texelFetch(ClusterLights, texel + 3));
+}
+
+// Cluster containing a world space position. Uses the view matrix from the frame constants
+int GetClusterIndex(vec3 position)
+{
+	float depth = -(ViewMatrix * vec4(position, 1)).z;
+
+	ivec3 cluster;
+	cluster.xy = ivec2(gl_FragCoord.xy * ClusterTileScale);
+	cluster.z = int(log(max(depth, ClusterDepthParams.x) / ClusterDepthParams.x) * ClusterDepthParams.y);
+	cluster = clamp(cluster, ivec3(0), ClusterCount - 1);
+
+	return (cluster.z * ClusterCount.y + cluster.y) * ClusterCount.x + cluster.x;
+}
+
+// All the lights in a single pass. Only in fragment shaders, the cluster depends on the fragment coordinates
+vec3 ComputeClusteredLighting(vec3 position, SurfaceData data, vec3 viewDir, bool indirect)
+{
+	vec3 light = vec3(0);
+
+	for (int i = 0; i < ClusterGlobalLightCount; ++i)
+	{
+		light += ComputeLight(GetClusterLight(i), data, viewDir, position);
+	}
+
+	uvec2 range = texelFetch(ClusterRanges, GetClusterIndex(position)).xy;
+	for (uint i = 0u; i < range.y; ++i)
+	{
+		int lightIndex = int(texelFetch(ClusterLightIndices, int(range.x + i)).x);
+		light += ComputeLight(GetClusterLight(lightIndex), data, viewDir, position);
+	}
+
+	if (indirect)
+	{
+		light += ComputeIndirectLighting(data, viewDir);
+	}
+
+	return light;
+}
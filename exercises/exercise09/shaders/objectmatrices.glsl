@@ -0,0 +1,14 @@
+
+// World matrices of all the drawcalls in the frame, stored as 4 columns per matrix
+uniform samplerBuffer ObjectMatrices;
+uniform int ObjectIndex;
+
+// World matrix of the current drawcall, or of the current instance if instanced
+mat4 GetWorldMatrix()
+{
+	int index = (ObjectIndex + gl_InstanceID) * 4;
+	return mat4(texelFetch(ObjectMatrices, index),
+		texelFetch(ObjectMatrices, index + 1),
+		texelFetch(ObjectMatrices, index + 2),
+		texelFetch(ObjectMatrices, index + 3));
+}
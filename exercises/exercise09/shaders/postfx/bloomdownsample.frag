@@ -0,0 +1,52 @@
+//Inputs
+in vec2 TexCoord;
+
+//Outputs
+out vec4 FragColor;
+
+//Uniforms
+uniform sampler2D SourceTexture;
+uniform vec2 SourceTexelSize;
+uniform bool Prefilter; // Keep only the bright pixels, for the first level
+uniform vec2 Range;
+uniform float Intensity;
+
+vec3 SampleSource(vec2 offset)
+{
+	return texture(SourceTexture, TexCoord + offset * SourceTexelSize).rgb;
+}
+
+void main()
+{
+	// 13 samples, the linear filtering averages 2x2 texels in each one. Inner box has half of the weight, the 4 outer boxes the other half
+	vec3 a = SampleSource(vec2(-2.0f, 2.0f));
+	vec3 b = SampleSource(vec2(0.0f, 2.0f));
+	vec3 c = SampleSource(vec2(2.0f, 2.0f));
+	vec3 d = SampleSource(vec2(-2.0f, 0.0f));
+	vec3 e = SampleSource(vec2(0.0f, 0.0f));
+	vec3 f = SampleSource(vec2(2.0f, 0.0f));
+	vec3 g = SampleSource(vec2(-2.0f, -2.0f));
+	vec3 h = SampleSource(vec2(0.0f, -2.0f));
+	vec3 i = SampleSource(vec2(2.0f, -2.0f));
+	vec3 j = SampleSource(vec2(-1.0f, 1.0f));
+	vec3 k = SampleSource(vec2(1.0f, 1.0f));
+	vec3 l = SampleSource(vec2(-1.0f, -1.0f));
+	vec3 m = SampleSource(vec2(1.0f, -1.0f));
+
+	vec3 color = e * 0.125f;
+	color += (a + c + g + i) * 0.03125f;
+	color += (b + d + f + h) * 0.0625f;
+	color += (j + k + l + m) * 0.125f;
+
+	if (Prefilter)
+	{
+		// Remap the luminance to the valid range, and clamp it between 0 and 1
+		float luminance = GetLuminance(color);
+		float result = (luminance - Range.x) / max(Range.y - Range.x, 0.0001f);
+		result = clamp(result, 0.0f, 1.0f);
+
+		color *= result * Intensity;
+	}
+
+	FragColor = vec4(color, 1.0f);
+}
@@ -0,0 +1,25 @@
+//Inputs
+in vec2 TexCoord;
+
+//Outputs
+out vec4 FragColor;
+
+//Uniforms
+uniform sampler2D SourceTexture;
+uniform vec2 SourceTexelSize;
+uniform float Radius; // Distance of the samples, in texels of the source
+
+vec3 SampleSource(vec2 offset)
+{
+	return texture(SourceTexture, TexCoord + offset * Radius * SourceTexelSize).rgb;
+}
+
+void main()
+{
+	// 3x3 tent filter: weight 4 in the center, 2 in the sides and 1 in the corners
+	vec3 color = SampleSource(vec2(0.0f, 0.0f)) * 4.0f;
+	color += (SampleSource(vec2(-1.0f, 0.0f)) + SampleSource(vec2(1.0f, 0.0f)) + SampleSource(vec2(0.0f, -1.0f)) + SampleSource(vec2(0.0f, 1.0f))) * 2.0f;
+	color += SampleSource(vec2(-1.0f, -1.0f)) + SampleSource(vec2(1.0f, -1.0f)) + SampleSource(vec2(-1.0f, 1.0f)) + SampleSource(vec2(1.0f, 1.0f));
+
+	FragColor = vec4(color / 16.0f, 1.0f);
+}
@@ -0,0 +1,22 @@
+//Uniforms
+uniform float Distortion;
+
+// Barrel lens distortion, so it looks like you are looking through a camera lens
+vec4 ApplyEffect(vec2 uv)
+{
+	vec2 centered = uv * 2.0 - 1.0;
+
+	// radial distortion factor
+	float r2 = dot(centered, centered);
+	float k = 1.0 + Distortion * r2;
+
+	// apply and remap back
+	vec2 warped = centered * k * 0.5 + 0.5;
+
+	// outside is black
+	if (warped.x < 0.0 || warped.x > 1.0 || warped.y < 0.0 || warped.y > 1.0)
+	{
+		return vec4(0.0);
+	}
+	return SampleInput(warped);
+}
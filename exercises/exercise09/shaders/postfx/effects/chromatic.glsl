@@ -0,0 +1,21 @@
+//Uniforms
+uniform float AbAmount;
+
+// Chromatic aberration, giving it a retro look
+vec4 ApplyEffect(vec2 uv)
+{
+	// center-origin coords in range [-1, 1]
+	vec2 centered = uv * 2.0 - 1.0;
+
+	// compute offset based on distance from center
+	float dist = length(centered);
+	vec2 dir = centered / dist;
+	float offset = dist * AbAmount;
+
+	// sample each channel slightly shifted
+	float r = SampleInput(uv + dir * offset).r;
+	float g = SampleInput(uv).g;
+	float b = SampleInput(uv - dir * offset).b;
+
+	return vec4(r, g, b, 1.0);
+}
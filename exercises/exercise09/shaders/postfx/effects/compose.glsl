@@ -1,12 +1,4 @@
-//Inputs
-in vec2 TexCoord;
-
-//Outputs
-out vec4 FragColor;
-
 //Uniforms
-uniform sampler2D SourceTexture;
-
 uniform float Exposure;
 
 uniform float Contrast;
@@ -41,17 +33,14 @@ vec3 ApplyColorFilter(vec3 color)
 	return color * ColorFilter;
 }
 
-
-void main()
+// Bloom, exposure and color grading of the HDR color
+vec4 ApplyEffect(vec4 hdrColor, vec2 uv)
 {
-	// Read from the HDR framebuffer
-	vec3 hdrColor = texture(SourceTexture, TexCoord).rgb;
-
 	// Add bloom
-	hdrColor += texture(BloomTexture, TexCoord).rgb;
+	vec3 color = hdrColor.rgb + texture(BloomTexture, uv).rgb;
 
 	// Apply exposure
-	vec3 color = vec3(1.0f) - exp(-hdrColor * Exposure);
+	color = vec3(1.0f) - exp(-color * Exposure);
 
 	// Color grading
 	color = AdjustContrast(color);
@@ -59,6 +48,5 @@ void main()
 	color = AdjustSaturation(color);
 	color = ApplyColorFilter(color);
 
-	// Assign the fragment color
-	FragColor = vec4(color, 1.0f);
+	return vec4(color, 1.0f);
 }
@@ -0,0 +1,13 @@
+// Film grain of an old movie
+float GetFilmNoise(vec2 p)
+{
+	return fract(sin(dot(p, vec2(12.9898, 78.233))) * 43758.5453);
+}
+
+vec4 ApplyEffect(vec4 color, vec2 uv)
+{
+	float noiseIntensity = 0.05f;
+
+	// Blend noise with the scene
+	return vec4(color.rgb + GetFilmNoise(uv) * noiseIntensity, 1.0f);
+}
@@ -0,0 +1,20 @@
+//Uniforms
+uniform float LineDensity;
+uniform float Intensity;
+uniform float Time;
+
+// Scrolling scanlines, to help make it look like an old camera recording
+vec4 ApplyEffect(vec4 color, vec2 uv)
+{
+	// scroll speed: stripes per second
+	float speed = 0.5;
+	float y = fract(uv.y * LineDensity - Time * speed);
+
+	// make each stripe cover 80% of its cell
+	float mask = step(0.1, y) - step(0.9, y);
+
+	// tint inside the fat band
+	color.rgb = mix(color.rgb, vec3(0, 0, 0), mask * Intensity);
+
+	return color;
+}
@@ -0,0 +1,20 @@
+//Uniforms
+uniform float VignetteIntensity;
+uniform float VignetteSmoothness;
+
+// Darkens the corners of the screen
+vec4 ApplyEffect(vec4 color, vec2 uv)
+{
+	vec2 pos = uv * 2.0 - 1.0;
+	float d = length(pos);
+
+	// create a smooth mask: start darkening around d0, fully dark by d1
+	float d0 = 1.0 - VignetteSmoothness;
+	float d1 = 1.0;
+	float vignette = smoothstep(d0, d1, d);
+
+	// darken by mixing to black
+	color.rgb *= mix(1.0, 1.0 - VignetteIntensity, vignette);
+
+	return color;
+}
@@ -1,6 +1,3 @@
-//Inputs
-in vec2 TexCoord;
-
 //Outputs
 out vec4 FragColor;
 
@@ -9,11 +6,12 @@ uniform sampler2D DepthTexture;
 uniform sampler2D AlbedoTexture;
 uniform sampler2D NormalTexture;
 uniform sampler2D OthersTexture;
-uniform mat4 InvViewMatrix;
-uniform mat4 InvProjMatrix;
 
 void main()
 {
+	// Texture coordinates from the pixel position, the light volumes are not fullscreen
+	vec2 TexCoord = gl_FragCoord.xy / textureSize(DepthTexture, 0);
+
 	// Extract information from g-buffers
 	vec3 position = ReconstructViewPosition(DepthTexture, TexCoord, InvProjMatrix);
 	vec3 albedo = texture(AlbedoTexture, TexCoord).rgb;
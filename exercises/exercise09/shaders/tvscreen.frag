@@ -1,6 +1,5 @@
 ﻿in vec2 FragUV;
 
-uniform float Time;
 uniform vec2 Resolution;
 
 out vec4 FragColor;
@@ -1,12 +1,13 @@
 layout(location = 0) in vec3 VertexPosition;
 layout(location = 1) in vec2 VertexTexCoord;
 
-uniform mat4 WorldViewProjMatrix;
-
 out vec2 FragUV;
 
+// The screen glass is drawn on top in the forward pass, with the same position and a LessEqual depth test
+invariant gl_Position;
+
 // This is the vertex shader for the TV screen effect.
 void main() {
     FragUV = VertexTexCoord;
-    gl_Position = WorldViewProjMatrix * vec4(VertexPosition, 1.0);
+    gl_Position = ViewProjMatrix * GetWorldMatrix() * vec4(VertexPosition, 1.0);
 }
@@ -6,9 +6,24 @@
 
 class Application
 {
+public:
+    // Options to run without supervision, for automated rendering and benchmarks
+    struct RunSettings
+    {
+        // Hidden window with a fixed size. Build with ITUGL_USE_OSMESA to run on machines without a display
+        bool headless = false;
+        // Stop after this number of frames, 0 for no limit
+        unsigned int frameCount = 0;
+        // Stop after this application time in seconds, 0 for no limit
+        float duration = 0.0f;
+        // Advance the application time by this step every frame, instead of using the real time. 0 to use the real time
+        float fixedDeltaTime = 0.0f;
+    };
+
 public:
     // Construct the application specifying the dimensions of the window and its title
     Application(int width, int height, const char* title);
+    Application(int width, int height, const char* title, const RunSettings& runSettings);
 
     // Destroy de application
     virtual ~Application();
@@ -16,6 +31,9 @@ public:
     // Start the application
     int Run();
 
+    // Read the run settings from the command line: --headless, --frames <count>, --duration <seconds>, --timestep <seconds>
+    static RunSettings ParseRunSettings(int argc, char* argv[]);
+
 protected:
     // (C++) 1
     // Get the OpenGL device
@@ -33,6 +51,11 @@ protected:
     // Get time in seconds of the current frame
     float GetDeltaTime() const { return m_deltaTime; }
 
+    // Get the number of frames completed since the start of the application
+    unsigned int GetFrameIndex() const { return m_frameIndex; }
+
+    const RunSettings& GetRunSettings() const { return m_runSettings; }
+
     // Test if the application is currently running
     bool IsRunning() const;
 
@@ -60,6 +83,9 @@ private:
     // Set the new current time and compute the delta since the last time
     void UpdateTime(float newCurrentTime);
 
+    // Check the frame and time limits of the run settings
+    bool IsRunLimitReached() const;
+
 private:
     // OpenGL device
     DeviceGL m_device;
@@ -72,6 +98,10 @@ private:
     // Time in seconds of the current frame
     float m_deltaTime;
 
+    unsigned int m_frameIndex;
+
+    RunSettings m_runSettings;
+
     // Exit code
     int m_exitCode;
     // Error message to display on exit
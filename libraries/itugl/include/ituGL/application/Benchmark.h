@@ -0,0 +1,106 @@
+#pragma once
+
+#include <ituGL/application/Application.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+// Records metrics every frame after a warm up, and reports their statistics as JSON
+// The results can be compared with a previous run, to detect regressions
+class Benchmark
+{
+public:
+    struct Settings
+    {
+        // File where the results are written. The benchmark is enabled if it is not empty
+        std::string outputPath;
+        // Results of a previous run to compare with, optional
+        std::string baselinePath;
+        // Relative change from the baseline, in the bad direction of the metric, that counts as a regression
+        float threshold = 0.1f;
+        // Frames run before recording, to let the caches and the driver settle
+        unsigned int warmupFrames = 60;
+        // Recorded camera path to replay, optional
+        std::string cameraPath;
+    };
+
+    // Which values are better for a metric, so only changes in the other direction are regressions
+    enum class Direction
+    {
+        LowerIsBetter,  // Times, counts of work done
+        HigherIsBetter, // Hit rates
+        Informational   // Reported, but never compared. Counts of work avoided, that drop when the work is removed at the source
+    };
+
+    struct Stats
+    {
+        unsigned int count;
+        double min;
+        double median;
+        double p95;
+        double p99;
+        double mean;
+    };
+
+public:
+    Benchmark(const Settings& settings);
+
+    // Read the settings from the command line: --benchmark <output.json>, --compare <baseline.json>,
+    // --threshold <fraction>, --warmup <frames>, --camera-path <path>
+    static Settings ParseSettings(int argc, char* argv[]);
+
+    bool IsEnabled() const { return !m_settings.outputPath.empty(); }
+    const Settings& GetSettings() const { return m_settings; }
+
+    // Use a fixed timestep, so every run renders the same frames, and a frame limit if there is none
+    void AdjustRunSettings(Application::RunSettings& runSettings) const;
+
+    // The CPU time of the frame is measured between BeginFrame and EndFrame
+    void BeginFrame(unsigned int frameIndex);
+    void EndFrame();
+
+    // Samples are only added after the warm up
+    bool IsRecording() const { return m_recording; }
+    void AddSample(const std::string& metric, double value, Direction direction = Direction::LowerIsBetter);
+
+    Stats GetStats(const std::string& metric) const;
+
+    std::string ToJson() const;
+    bool Save() const;
+
+    // Compare the median and p95 of each metric with the baseline, in the bad direction of the metric. Informational ones are skipped
+    // Returns false if the baseline can't be read
+    bool Compare(std::vector<std::string>& regressions) const;
+
+    // Save the results and compare them with the baseline, if any, printing the regressions
+    // Returns the exit code: 0 if passed, 1 if there are regressions, 2 if the files can't be written or read
+    int Finish() const;
+
+private:
+    struct Metric
+    {
+        std::vector<double> values;
+        Direction direction = Direction::LowerIsBetter;
+    };
+
+private:
+    // Read the stats of the metrics from a JSON written by ToJson
+    static bool ParseJson(const std::string& json, std::map<std::string, Stats>& metrics);
+
+    static double GetPercentile(const std::vector<double>& sortedValues, double percentile);
+
+private:
+    Settings m_settings;
+
+    bool m_recording;
+    unsigned int m_recordedFrames;
+    std::chrono::steady_clock::time_point m_frameStart;
+
+    // Sorted by name, so the output is always in the same order
+    std::map<std::string, Metric> m_samples;
+
+    // Frames recorded when no limit is set
+    static constexpr unsigned int c_defaultFrameCount = 600;
+    static constexpr float c_defaultFixedDeltaTime = 1.0f / 60.0f;
+};
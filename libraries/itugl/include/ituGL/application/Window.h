@@ -6,7 +6,8 @@
 class Window
 {
 public:
-    Window(int width, int height, const char* title);
+    // Hidden windows can't be resized, their default framebuffer keeps the initial size
+    Window(int width, int height, const char* title, bool visible = true);
     ~Window();
 
     // (C++) 1
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Result of an asynchronous load, shared between the loader and whoever requested it
+// Only used from the main thread, the loaders complete it from a main thread job of the AssetJobQueue
+template <typename T>
+class AssetHandle
+{
+public:
+    using Callback = std::function<void(std::shared_ptr<T>)>;
+
+public:
+    // Handles are empty by default, Create() makes a new pending one
+    AssetHandle();
+    static AssetHandle Create();
+
+    inline bool IsValid() const { return m_state != nullptr; }
+
+    // The asset is completely loaded
+    inline bool IsReady() const { return m_state && m_state->ready; }
+
+    // Pointer to the asset. Some loaders provide it before the asset is ready, for example
+    // textures are created right away, and receive their image when it is decoded
+    inline std::shared_ptr<T> Get() const { return m_state ? m_state->asset : nullptr; }
+
+    // Call the function once the asset is ready, right now if it already is
+    void OnReady(Callback callback);
+
+    // Set the asset pointer, before it is ready
+    void SetAsset(std::shared_ptr<T> asset);
+
+    // Set the asset as ready, and call the pending callbacks
+    void SetReady(std::shared_ptr<T> asset);
+
+private:
+    struct State
+    {
+        std::shared_ptr<T> asset;
+        bool ready = false;
+        std::vector<Callback> callbacks;
+    };
+
+    std::shared_ptr<State> m_state;
+};
+
+template <typename T>
+AssetHandle<T>::AssetHandle()
+{
+}
+
+template <typename T>
+AssetHandle<T> AssetHandle<T>::Create()
+{
+    AssetHandle handle;
+    handle.m_state = std::make_shared<State>();
+    return handle;
+}
+
+template <typename T>
+void AssetHandle<T>::OnReady(Callback callback)
+{
+    if (IsReady())
+    {
+        callback(m_state->asset);
+    }
+    else if (m_state)
+    {
+        m_state->callbacks.push_back(std::move(callback));
+    }
+}
+
+template <typename T>
+void AssetHandle<T>::SetAsset(std::shared_ptr<T> asset)
+{
+    m_state->asset = std::move(asset);
+}
+
+template <typename T>
+void AssetHandle<T>::SetReady(std::shared_ptr<T> asset)
+{
+    m_state->asset = std::move(asset);
+    m_state->ready = true;
+
+    // Taken out first, so the list doesn't change while they are called
+    std::vector<Callback> callbacks = std::move(m_state->callbacks);
+    m_state->callbacks.clear();
+    for (Callback& callback : callbacks)
+    {
+        callback(m_state->asset);
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <functional>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Runs the slow part of asset loading (file reads, parsing, decoding) on worker threads
+// Anything touching OpenGL is queued back to the main thread, and runs there under a time budget every frame
+// Implemented as a Singleton pattern, the loaders use the current instance for their async methods
+class AssetJobQueue
+{
+public:
+    using Job = std::function<void()>;
+
+public:
+    // With 0 workers, it uses one thread for each core except the main one
+    AssetJobQueue(unsigned int workerCount = 0);
+    // Waits for the running jobs to finish. Queued jobs are discarded
+    ~AssetJobQueue();
+
+    AssetJobQueue(const AssetJobQueue&) = delete;
+    void operator = (const AssetJobQueue&) = delete;
+
+    // Singleton method to get a pointer to the instance, null if there is none
+    inline static AssetJobQueue* GetInstancePointer() { return m_instance; }
+
+    inline unsigned int GetWorkerCount() const { return static_cast<unsigned int>(m_workers.size()); }
+
+    // Queue a job to run on any worker thread. Can be called from any thread
+    void EnqueueWorkerJob(Job job);
+
+    // Queue a job to run on the main thread, in the same order they were queued. Can be called from any thread
+    void EnqueueMainThreadJob(Job job);
+
+    // Run main thread jobs until there are no more, or until the budget in milliseconds is spent
+    // At least one job runs, if there is any. Jobs queued meanwhile wait for the next call. Returns the number of jobs that ran
+    unsigned int ProcessMainThreadJobs(double budget);
+
+    // Run main thread jobs, waiting for the workers, until every queued job is complete
+    void Flush();
+
+    // No job is queued or running
+    bool IsIdle() const;
+
+private:
+    // Loop of the worker threads, running jobs until the queue is destroyed
+    void RunWorker();
+
+    // Take the next main thread job, if there is any
+    bool PopMainThreadJob(Job& job);
+
+    // Count a job as completed, and wake up Flush() if it was the last one
+    void CompleteJob();
+
+private:
+    std::vector<std::thread> m_workers;
+
+    // Protects the queues and the counters
+    mutable std::mutex m_mutex;
+
+    // Wakes up the workers when there is a new job or when stopping
+    std::condition_variable m_workerCondition;
+
+    // Wakes up Flush() when there is a new main thread job or when everything is complete
+    std::condition_variable m_mainThreadCondition;
+
+    std::deque<Job> m_workerJobs;
+    std::deque<Job> m_mainThreadJobs;
+
+    // Jobs queued or running. Jobs queue their continuations before they complete, so it is never 0 in between
+    unsigned int m_pendingCount;
+
+    bool m_stopping;
+
+    // Singleton instance
+    static AssetJobQueue* m_instance;
+};
@@ -30,6 +30,13 @@ public:
     inline bool GetKeepShared() const { return m_keepShared; }
     inline void SetKeepShared(bool keepShared) { m_keepShared = keepShared; }
 
+protected:
+    // Find an asset previously loaded as shared, null if there is none
+    std::shared_ptr<T> FindSharedAsset(const std::string& path) const;
+
+    // Keep the shared asset, if enabled, so it is not loaded twice
+    void AddSharedAsset(const std::string& path, std::shared_ptr<T> asset);
+
 private:
     // If true, keep a reference to assets loaded as shared, to avoid loading twice
     bool m_keepShared;
@@ -69,24 +76,33 @@ std::shared_ptr<T> AssetLoader<T>::LoadShared(const char* path)
     {
         // Try to find the asset on the previously loaded
         std::string pathString(path);
-        auto itAsset = m_sharedAssets.find(pathString);
-        if (itAsset != m_sharedAssets.end())
-        {
-            t = itAsset->second;
-        }
-        else
+        t = FindSharedAsset(pathString);
+        if (!t)
         {
             // If not found, create a new one
             t = std::make_shared<T>(Load(path));
-            if (m_keepShared)
-            {
-                m_sharedAssets.insert(std::make_pair(pathString, t));
-            }
+            AddSharedAsset(pathString, t);
         }
     }
     return t;
 }
 
+template <typename T>
+std::shared_ptr<T> AssetLoader<T>::FindSharedAsset(const std::string& path) const
+{
+    auto itAsset = m_sharedAssets.find(path);
+    return itAsset != m_sharedAssets.end() ? itAsset->second : nullptr;
+}
+
+template <typename T>
+void AssetLoader<T>::AddSharedAsset(const std::string& path, std::shared_ptr<T> asset)
+{
+    if (m_keepShared)
+    {
+        m_sharedAssets.insert(std::make_pair(path, asset));
+    }
+}
+
 template <typename T>
 bool AssetLoader<T>::LoadInto(const char* path, T& t)
 {
@@ -1,12 +1,14 @@
 #pragma once
 
 #include <ituGL/asset/AssetLoader.h>
+#include <ituGL/asset/AssetHandle.h>
 
 #include <ituGL/geometry/Model.h>
 #include <ituGL/geometry/Mesh.h>
 #include <ituGL/asset/Texture2DLoader.h>
 #include <vector>
 
+struct aiScene;
 struct aiMesh;
 struct aiMaterial;
 class VertexFormat;
@@ -30,9 +32,20 @@ public:
     Texture2DLoader& GetTexture2DLoader();
     const Texture2DLoader& GetTexture2DLoader() const;
 
+    // If set, the geometry of the loaded models is stored in the arena instead of in buffers owned by each mesh
+    std::shared_ptr<GeometryArena> GetGeometryArena() const;
+    void SetGeometryArena(std::shared_ptr<GeometryArena> geometryArena);
+
     // Load the model from the path
     Model Load(const char* path) override;
 
+    // Parse the model on a worker of the AssetJobQueue, and create its buffers and materials later on the main thread
+    // The jobs use a copy of the loader, so changes after the call don't affect them. The model is not kept as shared
+    // The copy shares the texture loader, so textures used by several models are loaded once
+    // Textures are decoded on the workers too, and the model can be ready before they are
+    // If there is no AssetJobQueue, it is loaded before returning
+    AssetHandle<Model> LoadAsync(const char* path);
+
     // Maps a semantic to an attribute in the shader program used by the material
     bool SetMaterialAttribute(VertexAttribute::Semantic semantic, const char* attributeName);
 
@@ -40,15 +53,31 @@ public:
     bool SetMaterialProperty(MaterialProperty materialProperty, const char* uniformName);
 
 private:
-    // Generate a submesh from the loaded mesh data
-    void GenerateSubmesh(Mesh& mesh, const aiMesh& meshData);
+    // Vertex and element data of a mesh, collected without OpenGL calls so it can be done by a worker
+    struct MeshData;
+
+    // Model being loaded by LoadAsync(), shared by its jobs
+    struct AsyncLoad;
+
+    // Set the folder of the model, textures are relative to it
+    void SetBaseFolder(const char* path);
+
+    // Add the submeshes of the mesh to the model, with their material
+    // Materials are generated once for each material of the scene, and stored in the list
+    void AddMesh(Model& model, MeshData& meshData, const aiScene& scene, std::vector<std::shared_ptr<Material>>& materials, bool loadTexturesAsync);
+
+    // Collect the vertex and element data of the mesh, and its bounds
+    static MeshData CollectMeshData(const aiMesh& meshData);
+
+    // Generate a submesh from the collected mesh data
+    void GenerateSubmesh(Mesh& mesh, MeshData& meshData);
 
     // Generate a material from the loaded material data
-    std::shared_ptr<Material> GenerateMaterial(const aiMaterial& materialData);
+    std::shared_ptr<Material> GenerateMaterial(const aiMaterial& materialData, bool loadTexturesAsync);
 
     // Load a texture of the specific type in the location
     void LoadTexture(const aiMaterial& materialData, int textureType, Material& material, ShaderProgram::Location location,
-        TextureObject::Format format, TextureObject::InternalFormat internalFormat) const;
+        TextureObject::Format format, TextureObject::InternalFormat internalFormat, bool loadTexturesAsync) const;
 
     // Build the vertex data from the mesh data
     static std::vector<GLubyte> CollectVertexData(const aiMesh& meshData, VertexFormat& vertexFormat, bool interleaved);
@@ -57,6 +86,9 @@ private:
     static std::vector<GLubyte> CollectElementData(const aiMesh& meshData, Data::Type& elementType,
         std::vector<Drawcall::Primitive>& primitives, std::vector<int>& elementCounts);
 
+    // Convert element data of any supported type to 32-bit elements, as used in the geometry arena
+    static std::vector<GLuint> WidenElementData(std::span<const GLubyte> elementData, Data::Type elementType);
+
     // Get the correct vertex data pointer for a specific semantic
     static const void* GetVertexDataPointer(const aiMesh& meshData, VertexAttribute::Semantic semantic, int& stride);
 
@@ -66,6 +98,9 @@ private:
     // Get the type of primitive depending on the number of elements
     static Drawcall::Primitive GetPrimitiveType(int elementCount);
 
+    // Flags used to read the files with Assimp
+    static const unsigned int c_importFlags;
+
 private:
     // Path to the base folder where we are loading the current model
     std::string m_baseFolder;
@@ -82,8 +117,11 @@ private:
     // Should create new materials for each submesh or use the reference material
     bool m_createMaterials;
 
-    // Texture loader to cache already loaded shared textures
-    mutable Texture2DLoader m_textureLoader;
+    // Texture loader to cache already loaded shared textures. Copies of the loader share it, and its cache
+    std::shared_ptr<Texture2DLoader> m_textureLoader;
+
+    // Optional arena shared by the geometry of all the loaded models
+    std::shared_ptr<GeometryArena> m_geometryArena;
 };
 
 enum class ModelLoader::MaterialProperty
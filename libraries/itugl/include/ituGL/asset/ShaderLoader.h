@@ -2,8 +2,18 @@
 
 #include <ituGL/asset/AssetLoader.h>
 #include <ituGL/shader/Shader.h>
+#include <cstdint>
+#include <filesystem>
 #include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 
+// Loads shaders from one or more files, concatenated in order
+// - Files can include other files with #include "path", relative to the including file
+// - Each file is added once per shader, like with include guards, so shared files can be listed and included freely
+// - File contents are cached, and LoadShared() returns the same compiled shader for the same type and resolved source
 class ShaderLoader : AssetLoader<Shader>
 {
 public:
@@ -15,15 +25,45 @@ public:
     Shader Load(const char* path) override;
     using AssetLoader<Shader>::LoadNew;
     using AssetLoader<Shader>::LoadInto;
+    using AssetLoader<Shader>::GetKeepShared;
+    using AssetLoader<Shader>::SetKeepShared;
 
     Shader Load(std::span<const char*> paths);
     Shader* LoadNew(std::span<const char*> paths);
     bool LoadInto(Shader& shader, std::span<const char*> paths);
 
+    // Shaders with the same type and resolved source are compiled once, and shared by all the programs using them
+    std::shared_ptr<Shader> LoadShared(const char* path) override;
+    std::shared_ptr<Shader> LoadShared(std::span<const char*> paths);
+
+    // Compile a shader from source code in memory, instead of files
+    Shader LoadSource(std::span<const char*> sourceCode);
+
     static Shader Load(Shader::Type type, const char* path);
 
+    // Source code of the files with the #include directives resolved
+    static std::string Preprocess(std::span<const char*> paths);
+
+    // Forget the cached files and shared shaders, so they are loaded again. Programs already built keep working
+    static void ClearCache();
+
 private:
     void Compile(Shader& shader);
 
+    // Append a file to the source, replacing its #include directives. Files already included are skipped
+    static void AppendFile(const std::filesystem::path& path, std::string& source, std::unordered_set<std::string>& includedFiles);
+
+    // Find an #include "path" directive in the line
+    static bool FindInclude(std::string_view line, std::string_view& includePath);
+
+    // Contents of a file, read only the first time
+    static const std::string& ReadFile(const std::filesystem::path& path);
+
     Shader::Type m_type;
+
+    // Contents of the files, by normalized path
+    static std::unordered_map<std::string, std::string> s_files;
+
+    // Shared shaders, by hash of their type and resolved source
+    static std::unordered_map<std::uint64_t, std::shared_ptr<Shader>> s_sharedShaders;
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ituGL/asset/TextureLoader.h>
+#include <ituGL/asset/AssetHandle.h>
 #include <ituGL/texture/Texture2DObject.h>
 
 // Asset loader for Texture2DObject
@@ -13,6 +14,11 @@ public:
     // Load the texture from the path
     Texture2DObject Load(const char* path) override;
 
+    // Decode the texture on a worker of the AssetJobQueue, and upload it later on the main thread
+    // The texture object is available right away in the handle, and shared as in LoadShared()
+    // If there is no AssetJobQueue, it is loaded before returning
+    AssetHandle<Texture2DObject> LoadSharedAsync(const char* path);
+
     // Helper to easily load a shared texture
     static std::shared_ptr<Texture2DObject> LoadTextureShared(const char* path,
         TextureObject::Format format, TextureObject::InternalFormat internalFormat,
@@ -21,8 +27,40 @@ public:
     inline bool GetFlipVertical() const { return m_flipVertical; }
     inline void SetFlipVertical(bool flipVertical) { m_flipVertical = flipVertical; }
 
+private:
+    // Image decoded by a worker, released when the last job using it is done
+    struct DecodedImage
+    {
+        DecodedImage() = default;
+        ~DecodedImage();
+
+        // Owns the data, it can't be copied
+        DecodedImage(const DecodedImage&) = delete;
+        void operator = (const DecodedImage&) = delete;
+
+        int width = 0;
+        int height = 0;
+        Data::Type dataType = Data::Type::None;
+        std::span<const std::byte> data;
+    };
+
+    // Texture being loaded by LoadSharedAsync(), shared by its jobs
+    struct AsyncLoad;
+
+    // Copy the decoded data to the texture and set its filtering parameters
+    // If a slot of the TextureStagingRing is provided, the data is read from the slot instead
+    static void UploadImage(Texture2DObject& texture2D, const DecodedImage& image,
+        TextureObject::Format format, TextureObject::InternalFormat internalFormat, bool generateMipmap, int stagingSlot = -1);
+
+    // Main thread part of LoadSharedAsync(). Stages the image if there is a TextureStagingRing, and uploads it
+    // If all the staging slots are in use, it tries again in the next frame
+    static void UploadAsync(std::shared_ptr<AsyncLoad> load);
+
 private:
     // If true, the texture will be flipped vertically on load
     // This option exists because some systems define the vertical origin as "up", and others as "down"
     bool m_flipVertical;
+
+    // Handles of the textures requested with LoadSharedAsync(), to return the same one if requested again
+    std::unordered_map<std::string, AssetHandle<Texture2DObject>> m_asyncTextures;
 };
@@ -43,6 +43,7 @@ public:
     static std::span<const std::byte> LoadTexture2DData(const char* path, int& width, int& height, Data::Type& dataType, TextureObject::Format format, TextureObject::InternalFormat internalFormat, bool flipVertical);
     static void FreeTexture2DData(std::span<const std::byte> data);
 private:
+    static void FlipVertical(std::byte* data, size_t rowSize, int rowCount);
     static bool IsHDR(TextureObject::InternalFormat internalFormat);
 };
 
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <vector>
+
+class Camera;
+class SceneCamera;
+
+// Camera positions and targets at given times, to replay the same camera movement in every run
+// Keyframes are interpolated with Catmull-Rom splines, and the path loops after the last keyframe
+class CameraPath
+{
+public:
+    struct Keyframe
+    {
+        float time;
+        glm::vec3 position;
+        glm::vec3 lookAt;
+    };
+
+public:
+    CameraPath();
+
+    bool IsEmpty() const { return m_keyframes.empty(); }
+    const std::vector<Keyframe>& GetKeyframes() const { return m_keyframes; }
+
+    // Time of the last keyframe
+    float GetDuration() const;
+
+    // Keyframes must be added in time order
+    void AddKeyframe(float time, const glm::vec3& position, const glm::vec3& lookAt);
+
+    // Add a keyframe with the current view of the camera, some time after the last keyframe
+    void AddKeyframe(const Camera& camera, float timeStep = 1.0f);
+
+    void Clear() { m_keyframes.clear(); }
+
+    // Get the position and target at any time
+    void Evaluate(float time, glm::vec3& position, glm::vec3& lookAt) const;
+
+    // Set the view of the camera, and match the transform of the scene camera to it
+    void Apply(SceneCamera& sceneCamera, float time) const;
+
+    // Text file with one keyframe per line: time, position xyz and look at xyz
+    bool Load(const char* path);
+    bool Save(const char* path) const;
+
+private:
+    std::vector<Keyframe> m_keyframes;
+};
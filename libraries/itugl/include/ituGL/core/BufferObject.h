@@ -13,6 +13,12 @@ public:
         ArrayBuffer = GL_ARRAY_BUFFER,
         // Element Buffer Object
         ElementArrayBuffer = GL_ELEMENT_ARRAY_BUFFER,
+        // Storage for a buffer texture
+        TextureBuffer = GL_TEXTURE_BUFFER,
+        // Uniform Buffer Object
+        UniformBuffer = GL_UNIFORM_BUFFER,
+        // Source of the texture uploads
+        PixelUnpackBuffer = GL_PIXEL_UNPACK_BUFFER,
         // TODO: There are more types, add them when they are supported
     };
 
@@ -58,6 +64,13 @@ public:
     // Modify the contents of the buffer, starting at offset
     void UpdateData(std::span<const std::byte> data, size_t offset = 0);
 
+    // Map a range of the buffer to client memory, with GL_MAP_* access flags. Empty if it failed
+    // The memory can be written from any thread, but the buffer can't be used by OpenGL until it is unmapped
+    std::span<std::byte> MapRange(size_t offset, size_t size, GLbitfield access);
+
+    // Unmap the buffer. Returns false if the contents were lost while mapped, and need to be written again
+    bool Unmap();
+
 protected:
     // Bind the specific target. Used by the Bind() method in derived classes
     void Bind(Target target) const;
@@ -2,10 +2,18 @@
 
 #include <ituGL/core/Color.h>
 #include <glad/glad.h>
+#include <glm/vec4.hpp>
+#include <array>
 
 class Window;
+class GLStub;
 struct GLFWwindow;
 
+// Parallel shader compilation is an extension, not declared by glad
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
 // Class that represent the device where we run OpenGL
 // Implemented as a Singleton pattern, as there can only be one
 class DeviceGL
@@ -26,8 +34,15 @@ public:
     // Set the window that OpenGL will use for rendering
     void SetCurrentWindow(Window &window);
 
+#ifdef ITUGL_GL_STUB
+    // Use the recording stub instead of the context of a window, to run without GL
+    void SetCurrentStub(GLStub& stub);
+#endif
+
     // Set the dimensions of the viewport
     void SetViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    // Get the viewport as (x, y, width, height). Only queries GL the first time, later it is the last one set
+    glm::ivec4 GetViewport() const;
 
     // Poll the events in the window event queue
     void PollEvents();
@@ -52,10 +67,152 @@ public:
     // enable / disable v-sync
     void SetVSyncEnabled(bool enabled);
 
+    // GL_KHR_parallel_shader_compile or GL_ARB_parallel_shader_compile: shaders and programs compile in driver threads,
+    // and GL_COMPLETION_STATUS_KHR can be queried without waiting for them
+    inline bool IsParallelShaderCompileSupported() const { return m_maxShaderCompilerThreads != nullptr; }
+
+    // Number of threads the driver can use to compile shaders. 0xFFFFFFFF lets the driver decide
+    void SetMaxShaderCompilerThreads(GLuint count);
+
+    // State shadowing: DeviceGL keeps a copy of the GL state it has set, and skips the calls that would not change it.
+    // All the state changes must go through these methods, or InvalidateState() must be called after changing it directly
+
+    // Set the shader program in use
+    void UseProgram(GLuint handle);
+    // Bind a vertex array object
+    void BindVertexArray(GLuint handle);
+    // Bind a framebuffer to GL_FRAMEBUFFER, GL_READ_FRAMEBUFFER or GL_DRAW_FRAMEBUFFER
+    void BindFramebuffer(GLenum target, GLuint handle);
+    // Set the texture unit affected by BindTexture
+    void SetActiveTextureUnit(GLint textureUnit);
+    // Bind a texture to the target in the active texture unit
+    void BindTexture(GLenum target, GLuint handle);
+    // Bind a sampler object to a texture unit
+    void BindSampler(GLuint textureUnit, GLuint handle);
+
+    // Depth test function and depth write
+    void SetDepthFunction(GLenum function);
+    void SetDepthWrite(bool enabled);
+
+    // Stencil functions and operations. Face can be GL_FRONT, GL_BACK or GL_FRONT_AND_BACK
+    void SetStencilFunction(GLenum face, GLenum function, GLint refValue, GLuint mask);
+    void SetStencilOperations(GLenum face, GLenum stencilFail, GLenum depthFail, GLenum depthPass);
+
+    // Blend equations, blend params and blend color, for color and alpha
+    void SetBlendEquation(GLenum equationColor, GLenum equationAlpha);
+    void SetBlendFunction(GLenum sourceColor, GLenum destColor, GLenum sourceAlpha, GLenum destAlpha);
+    void SetBlendColor(const Color& color);
+
+    // Faces culled when GL_CULL_FACE is enabled: GL_FRONT, GL_BACK or GL_FRONT_AND_BACK
+    void SetCullFace(GLenum face);
+
+    // Rectangle of the scissor test, in pixels
+    void SetScissor(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    // Objects being deleted are unbound by GL, and their handles can be reused by new objects
+    void OnProgramDeleted(GLuint handle);
+    void OnVertexArrayDeleted(GLuint handle);
+    void OnFramebufferDeleted(GLuint handle);
+    void OnTextureDeleted(GLuint handle);
+    void OnSamplerDeleted(GLuint handle);
+
+    // Forget all the shadowed state, the next calls will always reach GL
+    void InvalidateState();
+
+    // Categories of state changes, for the statistics
+    enum class StateChange
+    {
+        Program,
+        VertexArray,
+        Framebuffer,
+        ActiveTexture,
+        Texture,
+        Sampler,
+        Feature,
+        Depth,
+        Stencil,
+        Blend,
+        Viewport,
+        CullFace,
+        Scissor,
+        Count
+    };
+
+    // Number of GL calls issued and skipped since the last reset
+    unsigned int GetIssuedStateChanges(StateChange stateChange) const { return m_issuedStateChanges[static_cast<int>(stateChange)]; }
+    unsigned int GetSkippedStateChanges(StateChange stateChange) const { return m_skippedStateChanges[static_cast<int>(stateChange)]; }
+    unsigned int GetIssuedStateChanges() const;
+    unsigned int GetSkippedStateChanges() const;
+    void ResetStateChangeStats();
+
+    // Number of draw calls issued since the last reset, counted by Drawcall and the renderer multi-draws
+    unsigned int GetDrawcallCount() const { return m_drawcallCount; }
+    void AddDrawcall() { ++m_drawcallCount; }
+    void ResetDrawcallCount() { m_drawcallCount = 0; }
+
+private:
+    // Returns true if the call needs to be issued, and updates the counters
+    bool UpdateState(StateChange stateChange, bool changed) const;
+
+    // Index of the shadowed feature or texture target, -1 if it is not shadowed
+    static int GetFeatureSlot(GLenum feature);
+    static int GetTextureTargetSlot(GLenum target);
+
+    // Load the extensions that are used when available
+    void LoadExtensions();
+
+    // Check if the context exposes an extension
+    static bool HasExtension(const char* name);
+
 private:
     // Has a context been loaded? We use the context of the current window
     bool m_contextLoaded;
 
+    // glMaxShaderCompilerThreadsKHR / ARB, null if parallel shader compilation is not supported
+    using MaxShaderCompilerThreadsFunction = void (APIENTRYP)(GLuint count);
+    MaxShaderCompilerThreadsFunction m_maxShaderCompilerThreads;
+
+    // Value used for state that is not known yet
+    static constexpr GLuint c_unknownState = ~0u;
+
+    static constexpr int c_featureSlotCount = 14;
+    static constexpr int c_textureTargetSlotCount = 11;
+    static constexpr int c_textureUnitCount = 32;
+
+    struct StencilFaceState
+    {
+        GLenum function, stencilFail, depthFail, depthPass;
+        GLint refValue;
+        GLuint mask;
+    };
+
+    // Shadowed state. Mutable, because the enabled features are cached when queried
+    GLuint m_program;
+    GLuint m_vertexArray;
+    GLuint m_readFramebuffer;
+    GLuint m_drawFramebuffer;
+    GLint m_activeTextureUnit;
+    std::array<std::array<GLuint, c_textureTargetSlotCount>, c_textureUnitCount> m_textures;
+    std::array<GLuint, c_textureUnitCount> m_samplers;
+    mutable std::array<GLuint, c_featureSlotCount> m_features;
+    GLuint m_depthFunction;
+    GLuint m_depthWrite;
+    std::array<StencilFaceState, 2> m_stencilFaces;
+    std::array<GLenum, 2> m_blendEquations;
+    std::array<GLenum, 4> m_blendParams;
+    Color m_blendColor;
+    bool m_blendColorKnown;
+    mutable glm::ivec4 m_viewport;
+    mutable bool m_viewportKnown;
+    GLenum m_cullFace;
+    glm::ivec4 m_scissor;
+    bool m_scissorKnown;
+
+    mutable std::array<unsigned int, static_cast<int>(StateChange::Count)> m_issuedStateChanges;
+    mutable std::array<unsigned int, static_cast<int>(StateChange::Count)> m_skippedStateChanges;
+
+    unsigned int m_drawcallCount;
+
 private:
     // Singleton instance
     static DeviceGL* m_instance;
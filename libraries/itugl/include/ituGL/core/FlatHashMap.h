@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Map from hashes to values, with open addressing and linear probing in a single array
+// - The keys are hashes already, like the ones from Hash, so they are used directly to find the slot
+// - Meant for small tables that are built once and searched often: there is no removal, only Clear()
+// - The key 0 marks the empty slots, and can't be used
+template<typename T>
+class FlatHashMap
+{
+public:
+    FlatHashMap();
+
+    // Number of values stored
+    inline std::size_t GetSize() const { return m_size; }
+
+    // Make room for a number of values, so inserting them doesn't grow the table
+    void Reserve(std::size_t count);
+
+    // Insert a value, or replace it if the key is already there
+    void Insert(std::uint64_t key, const T& value);
+
+    // Find the value of a key, null if it is not there
+    const T* Find(std::uint64_t key) const;
+
+    // Remove all the values
+    void Clear();
+
+private:
+    struct Slot
+    {
+        std::uint64_t key;
+        T value;
+    };
+
+    // Index of the slot with the key, or of the empty slot where it would go
+    std::size_t FindSlot(std::uint64_t key) const;
+
+private:
+    // Power of two, so the slot index is a mask of the key
+    std::vector<Slot> m_slots;
+
+    std::size_t m_size;
+
+    static constexpr std::uint64_t c_emptyKey = 0;
+
+    // Minimum number of slots, when the first value is inserted
+    static constexpr std::size_t c_minSlotCount = 16;
+};
+
+template<typename T>
+FlatHashMap<T>::FlatHashMap() : m_size(0)
+{
+}
+
+template<typename T>
+void FlatHashMap<T>::Reserve(std::size_t count)
+{
+    // Keep the load under 50%, so the probe sequences stay short
+    std::size_t slotCount = c_minSlotCount;
+    while (slotCount < count * 2)
+    {
+        slotCount *= 2;
+    }
+    if (slotCount <= m_slots.size())
+    {
+        return;
+    }
+
+    std::vector<Slot> oldSlots(slotCount, Slot{ c_emptyKey, T() });
+    oldSlots.swap(m_slots);
+    for (const Slot& slot : oldSlots)
+    {
+        if (slot.key != c_emptyKey)
+        {
+            m_slots[FindSlot(slot.key)] = slot;
+        }
+    }
+}
+
+template<typename T>
+void FlatHashMap<T>::Insert(std::uint64_t key, const T& value)
+{
+    assert(key != c_emptyKey);
+
+    Reserve(m_size + 1);
+
+    Slot& slot = m_slots[FindSlot(key)];
+    if (slot.key == c_emptyKey)
+    {
+        slot.key = key;
+        ++m_size;
+    }
+    slot.value = value;
+}
+
+template<typename T>
+const T* FlatHashMap<T>::Find(std::uint64_t key) const
+{
+    if (m_slots.empty() || key == c_emptyKey)
+    {
+        return nullptr;
+    }
+
+    const Slot& slot = m_slots[FindSlot(key)];
+    return slot.key == key ? &slot.value : nullptr;
+}
+
+template<typename T>
+void FlatHashMap<T>::Clear()
+{
+    m_slots.clear();
+    m_size = 0;
+}
+
+template<typename T>
+std::size_t FlatHashMap<T>::FindSlot(std::uint64_t key) const
+{
+    assert(!m_slots.empty());
+
+    std::size_t mask = m_slots.size() - 1;
+    std::size_t index = static_cast<std::size_t>(key) & mask;
+    while (m_slots[index].key != key && m_slots[index].key != c_emptyKey)
+    {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+#ifdef ITUGL_GL_STUB
+
+#include <glad/glad.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Replaces the GL functions used by the library with a recording stub, to run without a GL context
+// Only available when the library is built with the ITUGL_GL_STUB option
+// - Every call is counted, and recorded with its arguments while recording is enabled
+// - Object handles are generated, shaders always compile and programs always link
+// - Programs report the uniforms declared in the stub, and buffers keep the size of their data
+// - Queries and texture parameters read back 0. Functions not used by the library are left unset
+// - Mapped buffers return client memory, and fences are signaled. Both can be made to fail, to test the fallbacks
+// Implemented as a Singleton pattern, like DeviceGL
+class GLStub
+{
+public:
+    // Value of an argument in a recorded call
+    struct Argument
+    {
+        enum class Type
+        {
+            Integer,
+            Float,
+            Pointer,
+        };
+
+        template<typename T>
+        Argument(T value);
+
+        Type type;
+        std::int64_t integer;
+        double real;
+        const void* pointer;
+    };
+
+    struct Call
+    {
+        // Name of the GL function, like "glUseProgram"
+        const char* function;
+        std::vector<Argument> arguments;
+    };
+
+public:
+    GLStub();
+    ~GLStub();
+
+    // Singleton method to get a reference to the instance. Will crash if there is none
+    inline static GLStub& GetInstance() { return *m_instance; }
+
+    // Singleton method to get a pointer to the instance
+    inline static GLStub* GetInstancePointer() { return m_instance; }
+
+    // Set the stub functions in the glad table
+    void Install();
+
+    // Keep every call with its arguments. Disabled by default, only the counters are updated
+    bool IsRecording() const { return m_recording; }
+    void SetRecording(bool recording) { m_recording = recording; }
+
+    // Calls recorded since the last reset
+    const std::vector<Call>& GetCalls() const { return m_calls; }
+
+    // Number of calls since the last reset, in total or to one function
+    unsigned int GetCallCount() const { return m_callCount; }
+    unsigned int GetCallCount(std::string_view function) const;
+
+    // Number of calls that change the pipeline state: bindings, enabled features, depth, stencil, blend, viewport...
+    unsigned int GetStateChangeCount() const { return m_stateChangeCount; }
+
+    // Clear the recorded calls and the counters
+    void ResetCalls();
+
+    // Uniform reported as active by every program. Arrays take consecutive locations
+    void DeclareUniform(const char* name, GLenum type, GLint size = 1);
+
+    // Uniform block reported by every program, indexed in declaration order, with the size of its data
+    void DeclareUniformBlock(const char* name, GLint dataSize = 0);
+
+    // Uniform inside a declared uniform block, with its std140 offset and strides. It has no location
+    void DeclareBlockUniform(const char* name, GLenum type, GLint size, GLint blockIndex, GLint offset,
+        GLint arrayStride = 0, GLint matrixStride = 0);
+
+    // Remove the declared uniforms and uniform blocks
+    void ClearUniforms();
+
+    // Size of the data store of a buffer object, 0 if it has no data
+    GLsizeiptr GetBufferSize(GLuint handle) const;
+
+    // Fences report the commands as complete. If false, waiting on them times out, like while the GPU is busy
+    void SetFencesSignaled(bool signaled) { m_fencesSignaled = signaled; }
+
+    // Mapping a buffer returns null
+    void SetMapFailing(bool failing) { m_mapFailing = failing; }
+
+    // Unmapping a buffer reports that its contents were lost while it was mapped
+    void SetUnmapFailing(bool failing) { m_unmapFailing = failing; }
+
+private:
+    struct Uniform
+    {
+        std::string name;
+        GLenum type;
+        GLint size;
+        GLint location;
+        GLint blockIndex;
+        GLint offset;
+        GLint arrayStride;
+        GLint matrixStride;
+    };
+
+    struct UniformBlock
+    {
+        std::string name;
+        GLint dataSize;
+    };
+
+private:
+    // Called by every stub function
+    void Record(const char* function, std::initializer_list<Argument> arguments, bool stateChange);
+
+    GLuint CreateHandle() { return m_nextHandle++; }
+
+    // Location of "name" or "name[i]", -1 if it is not declared
+    GLint FindUniformLocation(const char* name) const;
+
+    // Copy a string to a GL output buffer, truncated to the buffer size
+    static void CopyString(const std::string& source, GLsizei bufSize, GLsizei* length, GLchar* destination);
+
+    // Post callback of glad, replacing the default one that calls glGetError
+    static void SkipErrorCheck(const char*, void*, int, ...);
+
+private:
+    bool m_recording;
+    std::vector<Call> m_calls;
+    std::unordered_map<std::string_view, unsigned int> m_callCounts;
+    unsigned int m_callCount;
+    unsigned int m_stateChangeCount;
+
+    // Simulated state
+    GLuint m_nextHandle;
+    std::unordered_map<GLenum, GLuint> m_boundBuffers;
+    std::unordered_map<GLuint, GLsizeiptr> m_bufferSizes;
+    std::unordered_map<GLuint, std::vector<std::byte>> m_mappedData;
+    std::unordered_map<GLuint, GLenum> m_shaderTypes;
+    std::unordered_set<GLuint> m_compiledShaders;
+    std::unordered_set<GLuint> m_linkedPrograms;
+    GLint m_activeTexture;
+    std::array<GLint, 4> m_viewport;
+    std::array<GLint, 4> m_scissor;
+    std::unordered_set<GLenum> m_enabledFeatures;
+
+    // Simulated failures
+    bool m_fencesSignaled;
+    bool m_mapFailing;
+    bool m_unmapFailing;
+
+    std::vector<Uniform> m_uniforms;
+    std::vector<UniformBlock> m_uniformBlocks;
+
+private:
+    // Singleton instance
+    static GLStub* m_instance;
+};
+
+template<typename T>
+GLStub::Argument::Argument(T value) : integer(0), real(0.0), pointer(nullptr)
+{
+    if constexpr (std::is_pointer_v<T>)
+    {
+        type = Type::Pointer;
+        pointer = value;
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+        type = Type::Float;
+        real = value;
+    }
+    else
+    {
+        type = Type::Integer;
+        integer = static_cast<std::int64_t>(value);
+    }
+}
+
+#endif // ITUGL_GL_STUB
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// 64-bit FNV-1a hash, to identify data like shader sources. Simple and fast, but not meant for security
+class Hash
+{
+public:
+    static constexpr std::uint64_t c_seed = 14695981039346656037ull;
+
+    // Hash of the bytes of a string. Pass the result of a previous call as the seed to hash several strings together
+    static constexpr std::uint64_t FNV1a(std::string_view data, std::uint64_t hash = c_seed)
+    {
+        for (char c : data)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= c_prime;
+        }
+        return hash;
+    }
+
+    // Add an integer value to a hash, byte by byte
+    static constexpr std::uint64_t Combine(std::uint64_t hash, std::uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            hash ^= (value >> (i * 8)) & 0xFF;
+            hash *= c_prime;
+        }
+        return hash;
+    }
+
+private:
+    static constexpr std::uint64_t c_prime = 1099511628211ull;
+};
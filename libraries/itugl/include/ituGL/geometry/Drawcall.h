@@ -26,19 +26,28 @@ public:
 public:
     Drawcall();
     Drawcall(Primitive primitive, GLsizei count, GLint first = 0);
-    Drawcall(Primitive primitive, GLsizei count, Data::Type eboType, GLint first = 0);
+    Drawcall(Primitive primitive, GLsizei count, Data::Type eboType, GLint first = 0, GLint baseVertex = 0);
 
     // Check if the drawcall is valid
     inline bool IsValid() const { return m_primitive != Primitive::Invalid && m_count > 0; }
 
+    inline Primitive GetPrimitive() const { return m_primitive; }
+    inline GLint GetFirst() const { return m_first; }
+    inline GLsizei GetCount() const { return m_count; }
+    inline Data::Type GetEboType() const { return m_eboType; }
+    inline GLint GetBaseVertex() const { return m_baseVertex; }
+
     // Execute the drawcall
     void Draw() const;
 
+    // Execute the drawcall several times, with gl_InstanceID going from 0 to instanceCount - 1
+    void Draw(GLsizei instanceCount) const;
+
 private:
     // Type of primitive to be rendered
     Primitive m_primitive;
 
-    // Position of the first vertex or element that we want to render
+    // Position of the first vertex, or byte offset of the first element, that we want to render
     GLint m_first;
 
     // Number of vertices or elements that we want to render
@@ -46,4 +55,7 @@ private:
 
     // Data type of the elements in the EBO (int, uint, short, byte, etc.). A value of None means no EBO
     Data::Type m_eboType;
+
+    // Value added to each element before fetching the vertex. Used when several meshes share the same VBO
+    GLint m_baseVertex;
 };
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <ituGL/geometry/VertexBufferObject.h>
+#include <ituGL/geometry/ElementBufferObject.h>
+#include <ituGL/geometry/VertexArrayObject.h>
+#include <ituGL/geometry/VertexFormat.h>
+#include <ituGL/geometry/RangeAllocator.h>
+#include <ituGL/shader/ShaderProgram.h>
+#include <vector>
+#include <memory>
+#include <span>
+#include <unordered_map>
+
+// Large buffers shared by the geometry of many meshes, so consecutive drawcalls don't need to switch VAO
+// Vertices are grouped in pools by vertex format, each one with its own VBO and VAO, and located with a base vertex
+// All the pools share a single EBO, with 32-bit indices relative to the base vertex
+class GeometryArena
+{
+public:
+    // Maps vertex attribute semantics with their location on a shader program
+    using SemanticMap = std::unordered_map<VertexAttribute::Semantic, ShaderProgram::Location>;
+
+    // Range of vertices and elements reserved in the arena
+    struct Allocation
+    {
+        unsigned int poolIndex = ~0u;
+        unsigned int baseVertex = 0;
+        unsigned int vertexCount = 0;
+        unsigned int firstElement = 0;
+        unsigned int elementCount = 0;
+
+        inline bool IsValid() const { return poolIndex != ~0u; }
+    };
+
+    // Occupancy of the arena, added over all the pools
+    struct Stats
+    {
+        unsigned int poolCount;
+        unsigned int vertexCapacity;
+        unsigned int vertexCount;
+        unsigned int vertexFreeBlockCount;
+        unsigned int vertexLargestFreeBlock;
+        unsigned int elementCapacity;
+        unsigned int elementCount;
+        unsigned int elementFreeBlockCount;
+        unsigned int elementLargestFreeBlock;
+        float elementFragmentation;
+    };
+
+public:
+    // Capacity of each vertex pool, in vertices, and of the shared EBO, in elements. Both are fixed
+    GeometryArena(unsigned int poolVertexCapacity, unsigned int elementCapacity);
+
+    // Copy the data to the pool matching the vertex format, creating a new pool if none has enough free space
+    // Vertex data must be interleaved. Returns an invalid allocation if the elements don't fit in the EBO
+    Allocation Allocate(const VertexFormat& vertexFormat, std::span<const std::byte> vertexData, std::span<const GLuint> elements,
+        const SemanticMap& locations = SemanticMap());
+
+    // Release the ranges of an allocation, so they can be reused
+    void Free(const Allocation& allocation);
+
+    inline unsigned int GetPoolCount() const { return static_cast<unsigned int>(m_pools.size()); }
+
+    // VAO with the vertex pool and the shared EBO bound, to draw an allocation
+    const VertexArrayObject& GetVertexArray(unsigned int poolIndex) const;
+
+    Stats GetStats() const;
+
+private:
+    // VBO and VAO of vertices sharing the same format
+    struct Pool
+    {
+        Pool(const VertexFormat& vertexFormat, const SemanticMap& locations, unsigned int vertexCapacity);
+
+        VertexFormat vertexFormat;
+        SemanticMap locations;
+        VertexBufferObject vbo;
+        VertexArrayObject vao;
+        RangeAllocator allocator;
+    };
+
+private:
+    // Index of a pool with the same format and locations, and at least vertexCount contiguous free vertices
+    unsigned int FindOrCreatePool(const VertexFormat& vertexFormat, const SemanticMap& locations, unsigned int vertexCount);
+
+    static bool IsSameFormat(const VertexFormat& a, const VertexFormat& b);
+
+private:
+    std::vector<std::unique_ptr<Pool>> m_pools;
+
+    unsigned int m_poolVertexCapacity;
+
+    // Element buffer shared by all the pools
+    ElementBufferObject m_ebo;
+    RangeAllocator m_elementAllocator;
+};
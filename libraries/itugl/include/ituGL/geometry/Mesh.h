@@ -5,8 +5,11 @@
 #include <ituGL/geometry/VertexArrayObject.h>
 #include <ituGL/geometry/VertexAttribute.h>
 #include <ituGL/geometry/Drawcall.h>
+#include <ituGL/geometry/GeometryArena.h>
 #include <ituGL/shader/ShaderProgram.h>
+#include <ituGL/scene/Bounds.h>
 #include <vector>
+#include <memory>
 #include <unordered_map>
 
 // Class that groups several VBO, EBO and VAO that are part of the same object
@@ -19,6 +22,7 @@ public:
 
 public:
     Mesh();
+    ~Mesh();
 
     // Adds a new VBO with uninitialized data
     unsigned int AddVertexData(size_t size);
@@ -100,6 +104,15 @@ public:
         std::span<const TVertex> vertices, std::span<const TElement> elements,
         TIterator it, const TIterator itEnd, const SemanticMap& locations = SemanticMap());
 
+    // Stores the vertex and element data in a geometry arena, instead of in new buffers owned by the mesh
+    // All the arena data of a mesh must be in the same arena, and it is released when the mesh is destroyed
+    // Returns an invalid allocation if the arena is full
+    GeometryArena::Allocation AddArenaData(std::shared_ptr<GeometryArena> arena, const VertexFormat& vertexFormat,
+        std::span<const std::byte> vertexData, std::span<const GLuint> elements, const SemanticMap& locations = SemanticMap());
+
+    // Adds a new submesh drawing a range of the elements of an arena allocation. firstElement is relative to the allocation
+    unsigned int AddArenaSubmesh(const GeometryArena::Allocation& allocation, Drawcall::Primitive primitive, int firstElement, int elementCount);
+
     inline unsigned int GetVertexBufferCount() const { return static_cast<unsigned int>(m_vbos.size()); }
     inline const VertexBufferObject& GetVertexBuffer(unsigned int vboIndex) const { return m_vbos[vboIndex]; }
 
@@ -110,9 +123,18 @@ public:
     inline const VertexArrayObject& GetVertexArray(unsigned int vaoIndex) const { return m_vaos[vaoIndex]; }
 
     inline unsigned int GetSubmeshCount() const { return static_cast<unsigned int>(m_submeshes.size()); }
-    inline const VertexArrayObject& GetSubmeshVertexArray(unsigned int submeshIndex) const { return m_vaos[m_submeshes[submeshIndex].vaoIndex]; }
+    const VertexArrayObject& GetSubmeshVertexArray(unsigned int submeshIndex) const;
     inline const Drawcall& GetSubmeshDrawcall(unsigned int submeshIndex) const { return m_submeshes[submeshIndex].drawcall; }
 
+    // Local space bounds of a submesh. Submeshes without bounds are never culled
+    inline bool HasSubmeshBounds(unsigned int submeshIndex) const { return m_submeshes[submeshIndex].hasBounds; }
+    inline const AabbBounds& GetSubmeshBounds(unsigned int submeshIndex) const { return m_submeshes[submeshIndex].bounds; }
+    void SetSubmeshBounds(unsigned int submeshIndex, const AabbBounds& bounds);
+
+    // Local space bounds containing all the submeshes. Only valid if all the submeshes have bounds
+    inline bool HasBounds() const { return m_hasBounds; }
+    inline const AabbBounds& GetBounds() const { return m_bounds; }
+
     // Draws a submesh
     void DrawSubmesh(int submeshIndex) const;
 
@@ -123,6 +145,10 @@ private:
     {
         unsigned int vaoIndex;
         Drawcall drawcall;
+        AabbBounds bounds;
+        bool hasBounds;
+        // If the submesh is stored in the arena, vaoIndex is the index of the arena pool instead
+        bool inArena;
     };
 
 private:
@@ -139,6 +165,9 @@ private:
     // Set a vertex attribute in a VAO, using the specified layout, and increases the location index according to the size of the attribute
     void SetupVertexAttribute(VertexArrayObject& vao, const VertexAttribute::Layout& attributeLayout, GLuint& location, const SemanticMap& locations);
 
+    // Recompute the bounds of the whole mesh from the submeshes
+    void UpdateBounds();
+
 private:
     // All the VBOs used in this mesh
     std::vector<VertexBufferObject> m_vbos;
@@ -151,6 +180,14 @@ private:
 
     // Submeshes contained in this mesh
     std::vector<Submesh> m_submeshes;
+
+    // Arena storing part of the data of this mesh, and the ranges reserved in it
+    std::shared_ptr<GeometryArena> m_arena;
+    std::vector<GeometryArena::Allocation> m_arenaAllocations;
+
+    // Bounds of the whole mesh, in local space
+    AabbBounds m_bounds;
+    bool m_hasBounds;
 };
 
 template<typename T>
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <map>
+
+// Allocates ranges inside a fixed capacity, using the first free block big enough for the request
+// Released ranges are merged with their free neighbours. It only manages offsets, the memory lives somewhere else
+class RangeAllocator
+{
+public:
+    // Offset returned when there is no free block big enough
+    static constexpr unsigned int InvalidOffset = ~0u;
+
+public:
+    RangeAllocator(unsigned int capacity);
+
+    // Reserve a range of the given size. Returns InvalidOffset if it doesn't fit
+    unsigned int Allocate(unsigned int size);
+
+    // Release a range returned by Allocate, with the same size
+    void Free(unsigned int offset, unsigned int size);
+
+    // Release all the ranges at once
+    void Clear();
+
+    inline unsigned int GetCapacity() const { return m_capacity; }
+    inline unsigned int GetUsedSize() const { return m_usedSize; }
+    inline unsigned int GetFreeSize() const { return m_capacity - m_usedSize; }
+    inline unsigned int GetFreeBlockCount() const { return static_cast<unsigned int>(m_freeBlocks.size()); }
+    unsigned int GetLargestFreeBlock() const;
+
+    // 0 when all the free space is in one block, close to 1 when it is split in many small blocks
+    float GetFragmentation() const;
+
+private:
+    // Free blocks, sorted by offset: offset -> size
+    std::map<unsigned int, unsigned int> m_freeBlocks;
+
+    unsigned int m_capacity;
+    unsigned int m_usedSize;
+};
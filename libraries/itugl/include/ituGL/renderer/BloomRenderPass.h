@@ -0,0 +1,68 @@
+#pragma once
+
+#include <ituGL/renderer/RenderPass.h>
+
+#include <glm/glm.hpp>
+#include <vector>
+
+class Material;
+class Texture2DObject;
+class FramebufferObject;
+
+// Bloom computed in a pyramid of textures, each one half the size of the previous one
+// - Downsample: the source is thresholded into the first level, then each level is filtered into the next one
+// - Upsample: from the smallest level, each level is filtered and added to the one above
+// The result is in the first level, at half the size of the source
+class BloomRenderPass : public RenderPass
+{
+public:
+    // The level count is clamped so the smallest level is at least 2x2 pixels
+    BloomRenderPass(int width, int height, std::shared_ptr<Material> downsampleMaterial, std::shared_ptr<Material> upsampleMaterial,
+        unsigned int levelCount = 6);
+
+    void Render() override;
+
+    void SetSourceTexture(std::shared_ptr<Texture2DObject> sourceTexture) { m_sourceTexture = sourceTexture; }
+
+    // Texture with the result, the first level of the pyramid
+    std::shared_ptr<Texture2DObject> GetBloomTexture() const { return m_levels.front().texture; }
+
+    unsigned int GetLevelCount() const { return static_cast<unsigned int>(m_levels.size()); }
+
+    // Luminance range where the bloom fades in
+    const glm::vec2& GetRange() const { return m_range; }
+    void SetRange(const glm::vec2& range) { m_range = range; }
+
+    float GetIntensity() const { return m_intensity; }
+    void SetIntensity(float intensity) { m_intensity = intensity; }
+
+    // Scale of the upsample filter, in texels of each level. Larger values spread the bloom further
+    float GetRadius() const { return m_radius; }
+    void SetRadius(float radius) { m_radius = radius; }
+
+private:
+    struct Level
+    {
+        int width;
+        int height;
+        std::shared_ptr<Texture2DObject> texture;
+        std::shared_ptr<FramebufferObject> framebuffer;
+    };
+
+    void InitLevels(int width, int height, unsigned int levelCount);
+
+    void DrawLevel(Material& material, std::shared_ptr<Texture2DObject> sourceTexture, const glm::vec2& sourceTexelSize, const Level& targetLevel);
+
+private:
+    std::shared_ptr<Material> m_downsampleMaterial;
+    std::shared_ptr<Material> m_upsampleMaterial;
+
+    std::shared_ptr<Texture2DObject> m_sourceTexture;
+    glm::vec2 m_sourceTexelSize;
+
+    std::vector<Level> m_levels;
+
+    glm::vec2 m_range;
+    float m_intensity;
+    float m_radius;
+};
@@ -4,10 +4,15 @@
 
 #include <ituGL/shader/ShaderProgram.h>
 #include <ituGL/geometry/Mesh.h>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
 #include <memory>
 
 class Texture2DObject;
 class Material;
+class Light;
+class Camera;
+class FrustumBounds;
 
 class DeferredRenderPass: public RenderPass
 {
@@ -17,8 +22,37 @@ public:
     void Render() override;
 
 private:
+    // How the pixels affected by a light are drawn
+    enum class LightVolume
+    {
+        // Not visible, skip the light
+        Culled,
+        // Fullscreen triangle, for lights without range
+        Fullscreen,
+        // Fullscreen triangle limited to the projected bounds of the light
+        Scissor,
+        // Sphere or cone mesh around the light range
+        Mesh,
+    };
+
     void InitializeMeshes();
 
+    // Selects the volume of a light. Returns the world matrix for Mesh, and the scissor rectangle for Scissor
+    LightVolume GetLightVolume(const Light& light, const Camera& camera, const FrustumBounds& frustum,
+        const Mesh*& mesh, glm::mat4& worldMatrix, glm::ivec4& scissor) const;
+
+    // Pixel rectangle containing the projection of a view space sphere
+    glm::ivec4 ComputeScissor(const glm::mat4& projMatrix, const glm::vec3& center, float radius) const;
+
 private:
     std::shared_ptr<Material> m_material;
+
+    // Unit sphere, for point lights
+    Mesh m_sphereMesh;
+
+    // Cone with the apex in the origin and a base of radius 1 at Z = -1, for spot lights
+    Mesh m_coneMesh;
+
+    // Current viewport, to convert the projected bounds to pixels
+    glm::ivec4 m_viewport;
 };
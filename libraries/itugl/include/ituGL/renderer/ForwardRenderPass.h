@@ -1,7 +1,10 @@
 #pragma once
 
 #include <ituGL/renderer/RenderPass.h>
+#include <ituGL/renderer/LightClusterGrid.h>
 
+// Draws the drawcalls of a collection with lighting
+// Programs with clustered lighting are drawn once with all the lights. Other programs are drawn once per light, additively
 class ForwardRenderPass : public RenderPass
 {
 public:
@@ -10,6 +13,11 @@ public:
 
     void Render() override;
 
+    const LightClusterGrid& GetLightClusterGrid() const { return m_lightClusterGrid; }
+
 private:
     int m_drawcallCollectionIndex;
+
+    // Lights binned once per frame, only if a program uses them
+    LightClusterGrid m_lightClusterGrid;
 };
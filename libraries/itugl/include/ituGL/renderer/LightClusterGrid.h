@@ -0,0 +1,82 @@
+#pragma once
+
+#include <ituGL/shader/ShaderProgram.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <vector>
+#include <span>
+#include <memory>
+
+class Camera;
+class Light;
+class TextureBufferObject;
+
+// Bins the lights in a grid of clusters: screen tiles split in depth slices, exponentially distributed between near and far
+// Each fragment then only loops over the lights of its cluster. Lights without range reach every cluster
+// Light data and the light lists of the clusters are stored in buffer textures, read by the clustered lighting shader code
+class LightClusterGrid
+{
+public:
+    LightClusterGrid(unsigned int countX = 16, unsigned int countY = 9, unsigned int countZ = 24);
+
+    // Assign the lights to the clusters of the camera view and upload the data. The viewport size sets the size of the tiles
+    void Build(const Camera& camera, std::span<const Light* const> lights, const glm::ivec2& viewportSize);
+
+    // Check if the shader program declares the clustered lighting uniforms
+    static bool IsSupported(const ShaderProgram& shaderProgram);
+
+    // Set the buffers and grid parameters on the program, that must be in use
+    void SetUniforms(const ShaderProgram& shaderProgram) const;
+
+    inline glm::uvec3 GetClusterCounts() const { return m_counts; }
+    inline unsigned int GetClusterCount() const { return m_counts.x * m_counts.y * m_counts.z; }
+
+    // Lights that reach every cluster, stored first in the light buffer
+    inline unsigned int GetGlobalLightCount() const { return m_globalLightCount; }
+
+    // Total number of entries in the cluster light lists
+    inline unsigned int GetLightIndexCount() const { return static_cast<unsigned int>(m_lightIndices.size()); }
+
+private:
+    // Min and max cluster coordinates, inclusive
+    struct ClusterBounds
+    {
+        glm::uvec3 min;
+        glm::uvec3 max;
+    };
+
+private:
+    // Find the clusters touched by a sphere in view space. Returns false if it is out of the view depth range
+    bool ComputeClusterBounds(const glm::mat4& projMatrix, const glm::vec3& center, float radius, ClusterBounds& bounds) const;
+
+    unsigned int GetSlice(float depth) const;
+
+    void AddLightData(const Light& light);
+
+private:
+    // Texture units used by the buffers, below the one reserved for the object matrices
+    static constexpr GLint c_lightsTextureUnit = 12;
+    static constexpr GLint c_rangesTextureUnit = 13;
+    static constexpr GLint c_lightIndicesTextureUnit = 14;
+
+    glm::uvec3 m_counts;
+
+    // Parameters of the last build
+    float m_near;
+    float m_far;
+    float m_sliceScale;
+    glm::vec2 m_tileScale;
+    unsigned int m_globalLightCount;
+
+    // CPU copies of the buffers, reused between frames
+    std::vector<glm::vec4> m_lightData;
+    std::vector<glm::uvec2> m_ranges;
+    std::vector<GLuint> m_lightIndices;
+    std::vector<ClusterBounds> m_lightBounds;
+
+    std::shared_ptr<TextureBufferObject> m_lightsTexture;
+    std::shared_ptr<TextureBufferObject> m_rangesTexture;
+    std::shared_ptr<TextureBufferObject> m_lightIndicesTexture;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <ituGL/shader/Shader.h>
+#include <ituGL/shader/Material.h>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Fuses a chain of per-pixel post-processing effects in a single fragment shader, so they run in one fullscreen pass
+// Each effect is a GLSL snippet that declares its uniforms and a function:
+// - Color effects: vec4 ApplyEffect(vec4 color, vec2 uv), receives the color of the previous effects in the same pixel
+// - Remap effects: vec4 ApplyEffect(vec2 uv), reads the previous effects in other coordinates with SampleInput(uv)
+// The uniforms of each effect are renamed to "<effect>_<uniform>". Other functions in the snippets need unique names
+// The input of the chain is the SourceTexture uniform
+class PostFXChain
+{
+public:
+    enum class EffectType
+    {
+        Color,
+        Remap,
+    };
+
+public:
+    // Header paths are added before the generated code, the first one must have the #version
+    PostFXChain(std::shared_ptr<const Shader> vertexShader, std::span<const char*> headerPaths);
+
+    // Adds an effect at the end of the chain, loading the snippet from a file. Returns the effect index
+    unsigned int AddEffect(const char* name, EffectType type, const char* path);
+
+    unsigned int GetEffectCount() const { return static_cast<unsigned int>(m_effects.size()); }
+    const char* GetEffectName(unsigned int effectIndex) const { return m_effects[effectIndex].name.c_str(); }
+
+    // Disabled effects are left out of the generated shader. The program is rebuilt in the next Build()
+    bool IsEffectEnabled(unsigned int effectIndex) const { return m_effects[effectIndex].enabled; }
+    void SetEffectEnabled(unsigned int effectIndex, bool enabled);
+
+    // Generates and compiles the fused program if the chain changed, without using it yet
+    // Called while a ShaderBuildBatch is open, the program compiles with the others. Build() uses it after the batch finishes
+    void SubmitProgram();
+
+    // Submits the program if the chain changed, and uses it in the material. Returns true if it was rebuilt
+    bool Build();
+
+    // Material with the fused program. The same material is kept when the program is rebuilt
+    std::shared_ptr<Material> GetMaterial() const { return m_material; }
+
+    // Set a uniform of the fused shader. The values are kept and set again when the program is rebuilt
+    template<typename T>
+    void SetUniformValue(const char* name, const T& value);
+
+    // Set a uniform of an effect, using the name in the snippet
+    template<typename T>
+    void SetUniformValue(unsigned int effectIndex, const char* name, const T& value);
+
+    // Name of the uniform in the fused shader
+    std::string GetUniformName(unsigned int effectIndex, const char* name) const;
+
+    // Source code of the fused fragment shader, without the headers
+    std::string GenerateSource() const;
+
+private:
+    struct Effect
+    {
+        std::string name;
+        EffectType type;
+        std::string source;
+        std::vector<std::string> uniformNames;
+        bool enabled;
+    };
+
+    // Find the names of the uniforms declared in the snippet
+    static std::vector<std::string> FindUniformNames(const std::string& source);
+
+    static std::string LoadFile(const char* path);
+
+private:
+    std::shared_ptr<const Shader> m_vertexShader;
+
+    std::vector<std::string> m_headers;
+
+    std::vector<Effect> m_effects;
+
+    // If the chain changed since the program was built
+    bool m_dirty;
+
+    std::shared_ptr<Material> m_material;
+
+    // Program submitted and not used by the material yet
+    std::shared_ptr<ShaderProgram> m_pendingProgram;
+
+    // Functions to restore the uniform values after rebuilding, by uniform name
+    std::unordered_map<std::string, std::function<void(Material&)>> m_uniformSetters;
+};
+
+template<typename T>
+void PostFXChain::SetUniformValue(const char* name, const T& value)
+{
+    std::string uniformName(name);
+    std::function<void(Material&)> setter = [uniformName, value](Material& material)
+        {
+            material.SetUniformValue(uniformName.c_str(), value);
+        };
+
+    if (m_material)
+    {
+        setter(*m_material);
+    }
+    m_uniformSetters[uniformName] = std::move(setter);
+}
+
+template<typename T>
+void PostFXChain::SetUniformValue(unsigned int effectIndex, const char* name, const T& value)
+{
+    SetUniformValue(GetUniformName(effectIndex, name).c_str(), value);
+}
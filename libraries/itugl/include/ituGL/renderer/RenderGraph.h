@@ -0,0 +1,130 @@
+#pragma once
+
+#include <ituGL/renderer/RenderPass.h>
+#include <ituGL/texture/TextureObject.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Renderer;
+class Texture2DObject;
+class FramebufferObject;
+
+// Builds the list of render passes from the resources each pass reads and writes
+// - Passes that don't contribute to the outputs are culled
+// - Transient textures are created by the graph, and textures that are not alive at the same time are shared
+// - The last pass writing the output texture renders directly to the default framebuffer, without a copy
+class RenderGraph
+{
+public:
+    using ResourceId = unsigned int;
+
+    // Called once the textures are assigned, to set them in the materials of the pass
+    using BindFunction = std::function<void(const RenderGraph& renderGraph)>;
+
+    // Size and format of a transient texture
+    struct TextureDesc
+    {
+        int width;
+        int height;
+        TextureObject::Format format;
+        TextureObject::InternalFormat internalFormat;
+
+        bool operator == (const TextureDesc& other) const;
+    };
+
+public:
+    RenderGraph();
+    ~RenderGraph();
+
+    // Texture created and owned by the graph, shared with other transient textures of the same desc
+    ResourceId CreateTexture(const char* name, const TextureDesc& desc);
+
+    // Texture created outside the graph. Passes writing it keep their own target framebuffer
+    ResourceId ImportTexture(const char* name, std::shared_ptr<Texture2DObject> texture);
+
+    // The result of the graph. If it is a transient texture, its last writer renders to the default framebuffer
+    void SetOutput(ResourceId resource);
+
+    // Adds a pass, in execution order. Passes writing a transient texture get the target framebuffer from the graph
+    void AddPass(const char* name, std::unique_ptr<RenderPass> renderPass,
+        const std::vector<ResourceId>& reads, const std::vector<ResourceId>& writes, const BindFunction& bindFunction = nullptr);
+
+    // Culls the passes, assigns the textures and adds the remaining passes to the renderer. Can only be compiled once
+    // Returns false if the graph is not valid, without adding any pass. GetErrorMessage() tells why
+    bool Compile(Renderer& renderer);
+
+    inline const std::string& GetErrorMessage() const { return m_errorMessage; }
+
+    // Texture assigned to a resource. Null for the output redirected to the default framebuffer
+    std::shared_ptr<Texture2DObject> GetTexture(ResourceId resource) const;
+
+    // Passes, resources and textures of the compiled graph
+    std::string GetDebugDump() const;
+
+    // Memory of the textures created by the graph, and what it would be without sharing them
+    std::size_t GetRenderTargetMemory() const { return m_renderTargetMemory; }
+    std::size_t GetPeakRenderTargetMemory() const { return m_peakRenderTargetMemory; }
+    std::size_t GetUnaliasedRenderTargetMemory() const { return m_unaliasedRenderTargetMemory; }
+
+    static std::size_t GetBytesPerPixel(TextureObject::InternalFormat internalFormat);
+
+private:
+    struct Resource
+    {
+        std::string name;
+        bool imported;
+        TextureDesc desc;
+        std::shared_ptr<Texture2DObject> texture;
+
+        // Range of passes where the resource is used, -1 if not used
+        int firstPass;
+        int lastPass;
+
+        // Index in the texture pool, -1 if imported or redirected
+        int poolIndex;
+        bool redirected;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        std::unique_ptr<RenderPass> renderPass;
+        std::vector<ResourceId> reads;
+        std::vector<ResourceId> writes;
+        BindFunction bindFunction;
+        bool culled;
+    };
+
+    struct PooledTexture
+    {
+        TextureDesc desc = {};
+        std::shared_ptr<Texture2DObject> texture = nullptr;
+        std::shared_ptr<FramebufferObject> framebuffer = nullptr;
+    };
+
+private:
+    // Check the passes can get their targets from the graph, and set the error message if not
+    bool Validate();
+
+    void CullPasses();
+    void ComputeLifetimes();
+    void AllocateTextures();
+    void CreatePooledTexture(PooledTexture& pooledTexture) const;
+
+    static std::size_t GetMemorySize(const TextureDesc& desc);
+
+private:
+    std::vector<Resource> m_resources;
+    std::vector<Pass> m_passes;
+    std::vector<PooledTexture> m_pool;
+
+    int m_output;
+    bool m_compiled;
+    std::string m_errorMessage;
+
+    std::size_t m_renderTargetMemory;
+    std::size_t m_peakRenderTargetMemory;
+    std::size_t m_unaliasedRenderTargetMemory;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 class Renderer;
 class FramebufferObject;
@@ -12,6 +13,11 @@ public:
     virtual ~RenderPass();
 
     std::shared_ptr<const FramebufferObject> GetTargetFramebuffer() const;
+    void SetTargetFramebuffer(std::shared_ptr<const FramebufferObject> targetFramebuffer);
+
+    // Optional name, used by the profiler
+    const std::string& GetName() const { return m_name; }
+    void SetName(const std::string& name) { m_name = name; }
 
     virtual void Render() = 0;
 
@@ -28,4 +34,6 @@ private:
 
 private:
     Renderer* m_renderer;
+
+    std::string m_name;
 };
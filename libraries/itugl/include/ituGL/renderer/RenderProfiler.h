@@ -0,0 +1,119 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+class DearImGui;
+
+// Measures the CPU and GPU time of the scopes in a frame, like the render passes
+// - GPU time is measured with GL_TIME_ELAPSED queries, so scopes can't be nested
+// - Queries are double buffered and read back when their buffer is reused, the CPU never waits for the GPU
+// Results are one frame late
+class RenderProfiler
+{
+public:
+    // Times in milliseconds
+    struct Timing
+    {
+        std::string name;
+        // Start of the scope on the CPU, since the profiler was created
+        double cpuStart;
+        double cpuTime;
+        // Negative if the query result was not available
+        double gpuTime;
+    };
+
+    struct Frame
+    {
+        std::uint64_t index;
+        double cpuStart;
+        double cpuTime;
+        // Sum of the scopes with a result
+        double gpuTime;
+        std::vector<Timing> timings;
+    };
+
+public:
+    RenderProfiler();
+    ~RenderProfiler();
+
+    RenderProfiler(const RenderProfiler&) = delete;
+    void operator = (const RenderProfiler&) = delete;
+
+    bool IsEnabled() const { return m_enabled; }
+    void SetEnabled(bool enabled);
+
+    // Do nothing if the profiler is disabled
+    void BeginFrame();
+    void EndFrame();
+    void BeginScope(const char* name);
+    void EndScope();
+
+    // Last frame with the results read back
+    const Frame& GetLastFrame() const { return m_lastFrame; }
+
+    // Last frames read back, oldest first
+    const std::deque<Frame>& GetHistory() const { return m_history; }
+
+    // Write the history in the Chrome trace event format, for chrome://tracing or Perfetto
+    // GPU scopes only have a duration, they are placed one after the other from the start of the first CPU scope
+    bool ExportChromeTrace(const char* path) const;
+
+    void DrawGUI(DearImGui& imGui);
+
+private:
+    struct Scope
+    {
+        std::string name;
+        double cpuStart;
+        double cpuEnd;
+    };
+
+    struct FrameQueries
+    {
+        std::uint64_t index;
+        double cpuStart;
+        double cpuEnd;
+
+        // Scopes are reused between frames, only the first scopeCount are valid
+        std::vector<Scope> scopes;
+        unsigned int scopeCount;
+
+        // One query per scope, created when needed
+        std::vector<GLuint> queries;
+
+        // If it has results that were not read back
+        bool pending;
+    };
+
+    void ReadBack(FrameQueries& frameQueries);
+
+    double GetCpuTime() const;
+
+    static std::string EscapeJson(const std::string& text);
+
+private:
+    static constexpr unsigned int c_bufferCount = 2;
+    static constexpr unsigned int c_historySize = 120;
+
+    bool m_enabled;
+
+    std::array<FrameQueries, c_bufferCount> m_frameQueries;
+    unsigned int m_bufferIndex;
+    std::uint64_t m_frameCount;
+    bool m_inFrame;
+    bool m_inScope;
+
+    std::chrono::steady_clock::time_point m_startTime;
+
+    Frame m_lastFrame;
+    std::deque<Frame> m_history;
+
+    // Result of the last export, shown in the GUI
+    std::string m_exportMessage;
+};
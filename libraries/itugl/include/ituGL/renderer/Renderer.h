@@ -2,15 +2,22 @@
 
 #include <ituGL/core/DeviceGL.h>
 #include <ituGL/renderer/RenderPass.h>
+#include <ituGL/renderer/RenderProfiler.h>
 #include <ituGL/geometry/Drawcall.h>
 #include <ituGL/geometry/Mesh.h>
 #include <ituGL/shader/Material.h>
+#include <ituGL/shader/UniformBufferObject.h>
+#include <ituGL/scene/Bounds.h>
 #include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <array>
 #include <span>
 #include <functional>
+#include <unordered_set>
+#include <cstdint>
 
 class Camera;
 class Light;
@@ -20,6 +27,7 @@ class VertexArrayObject;
 class Drawcall;
 class Model;
 class FramebufferObject;
+class TextureBufferObject;
 
 class Renderer
 {
@@ -27,18 +35,37 @@ public:
     class DrawcallInfo
     {
     public:
-        DrawcallInfo(const Material& material, unsigned int worldMatrixIndex, const VertexArrayObject& vao, const Drawcall& drawcall);
+        DrawcallInfo(const Material& material, unsigned int worldMatrixIndex, const VertexArrayObject& vao, const Drawcall& drawcall, std::uint64_t sortKey = 0);
 
         const Material& GetMaterial() const { return m_material; }
         unsigned int GetWorldMatrixIndex() const { return m_worldMatrixIndex; }
         const VertexArrayObject& GetVAO() const { return m_vao; }
         const Drawcall& GetDrawcall() const { return m_drawcall; }
 
+        // Packed key: pass | shader program | material | VAO | quantized view depth (most to least significant)
+        std::uint64_t GetSortKey() const { return m_sortKey; }
+        void SetSortKey(std::uint64_t sortKey) { m_sortKey = sortKey; }
+
+        // Instanced drawcalls read their world matrices from the renderer object buffer, starting at first instance
+        bool IsInstanced() const { return m_firstInstance >= 0; }
+        int GetFirstInstance() const { return m_firstInstance; }
+        unsigned int GetInstanceCount() const { return m_instanceCount; }
+        void SetInstances(int firstInstance, unsigned int instanceCount);
+
+        // Merged drawcalls draw several element ranges of the same VAO at once, stored in the renderer
+        bool IsMultiDraw() const { return m_multiDrawIndex >= 0; }
+        int GetMultiDrawIndex() const { return m_multiDrawIndex; }
+        void SetMultiDrawIndex(int multiDrawIndex) { m_multiDrawIndex = multiDrawIndex; }
+
     private:
         std::reference_wrapper<const Material> m_material;
         unsigned int m_worldMatrixIndex;
         std::reference_wrapper<const VertexArrayObject> m_vao;
         std::reference_wrapper<const Drawcall> m_drawcall;
+        std::uint64_t m_sortKey;
+        int m_firstInstance;
+        unsigned int m_instanceCount;
+        int m_multiDrawIndex;
     };
 
     using DrawcallSupportedFunction = std::function<bool(const DrawcallInfo& drawcallInfo)>;
@@ -54,6 +81,7 @@ public:
         std::span<const DrawcallInfo> GetDrawcalls() const { return m_drawcallInfos; }
 
         void AddDrawcall(const DrawcallInfo& drawcallInfo);
+        void Resize(unsigned int count);
         void Clear();
 
     private:
@@ -63,6 +91,29 @@ public:
 
     using DrawcallSortFunction = std::function<bool(const DrawcallInfo&, const DrawcallInfo&)>;
 
+    // Orderings available from the precomputed sort keys
+    enum class DrawcallSortMode
+    {
+        State,       // Group by pass, program, material and VAO, then front to back
+        FrontToBack, // Closest first, within each pass. Ties grouped by state
+        BackToFront, // Farthest first, within each pass. Ties grouped by state
+    };
+
+    // Camera and time values shared by all the programs, in the std140 layout of the "FrameConstants" uniform block
+    struct FrameConstants
+    {
+        glm::mat4 viewMatrix;
+        glm::mat4 projMatrix;
+        glm::mat4 viewProjMatrix;
+        glm::mat4 invViewMatrix;
+        glm::mat4 invProjMatrix;
+        glm::vec3 cameraPosition;
+        float time;
+    };
+
+    // Uniform buffer binding point of the "FrameConstants" block
+    static constexpr GLuint c_frameConstantsBinding = 0;
+
     using UpdateTransformsFunction = std::function<void(const ShaderProgram&, const glm::mat4&, const Camera&, bool)>;
     using UpdateLightsFunction = std::function<bool(const ShaderProgram&, std::span<const Light* const>, unsigned int&)>;
 
@@ -72,12 +123,23 @@ public:
     const DeviceGL& GetDevice() const { return m_device; }
     DeviceGL& GetDevice() { return m_device; }
 
+    // Passes without a name are named by their index
     int AddRenderPass(std::unique_ptr<RenderPass> renderPass);
 
+    // Times each render pass, when enabled
+    const RenderProfiler& GetProfiler() const { return m_profiler; }
+    RenderProfiler& GetProfiler() { return m_profiler; }
+
     bool HasCamera() const;
     const Camera& GetCurrentCamera() const;
     void SetCurrentCamera(const Camera& camera);
 
+    // Time in seconds, available to the shaders in the frame constants
+    void SetTime(float time) { m_time = time; }
+
+    // Values uploaded at the start of Render. Valid during the passes
+    const FrameConstants& GetFrameConstants() const { return m_frameConstants; }
+
     std::shared_ptr<const FramebufferObject> GetDefaultFramebuffer() const;
     std::shared_ptr<const FramebufferObject> GetCurrentFramebuffer() const;
     void SetCurrentFramebuffer(std::shared_ptr<const FramebufferObject> framebuffer);
@@ -88,15 +150,32 @@ public:
     std::span<const DrawcallInfo> GetDrawcalls(unsigned int collectionIndex) const;
     void AddModel(const Model& model, const glm::mat4& worldMatrix);
 
+    // Models and submeshes outside of the current camera frustum are not added to the collections
+    bool IsFrustumCullingEnabled() const { return m_frustumCullingEnabled; }
+    void SetFrustumCullingEnabled(bool enabled) { m_frustumCullingEnabled = enabled; }
+    bool IsVisible(const BoxBounds& bounds) const;
+
     unsigned int AddDrawcallCollection(const DrawcallSupportedFunction &drawcallSupportedFunction);
     void SetDrawcallCollectionSupportedFunction(unsigned int index, const DrawcallSupportedFunction& drawcallSupportedFunction);
 
     void SortDrawcallCollection(unsigned int index, const DrawcallSortFunction& drawcallSortFunction);
+    void SortDrawcallCollection(unsigned int index, DrawcallSortMode sortMode);
     bool IsBackToFront(const DrawcallInfo& a, const DrawcallInfo& b) const;
     bool IsFrontToBack(const DrawcallInfo& a, const DrawcallInfo& b) const;
 
+    // Merge consecutive drawcalls of the same submesh and material into instanced drawcalls. Call after sorting.
+    // Only programs that read their world matrices from the object buffer are instanced
+    void MergeInstancedDrawcalls(unsigned int collectionIndex);
+
+    // Merge consecutive drawcalls with the same material, VAO and world matrix into a single multi-draw. Call after sorting.
+    // Different submeshes only share a VAO when their geometry is stored in a GeometryArena
+    void MergeMultiDrawcalls(unsigned int collectionIndex);
+
     const Mesh& GetFullscreenMesh() const;
 
+    // Programs with a "FrameConstants" uniform block get it connected to c_frameConstantsBinding
+    // Programs that declare the "ObjectMatrices" samplerBuffer and "ObjectIndex" int uniforms read the world matrix
+    // of each drawcall from the object buffer, at ObjectIndex + gl_InstanceID, instead of per drawcall uniforms
     void RegisterShaderProgram(std::shared_ptr<const ShaderProgram> shaderProgramPtr,
         const UpdateTransformsFunction& updateTransformFunction,
         const UpdateLightsFunction& updateLightsFunction);
@@ -109,6 +188,9 @@ public:
 
     void PrepareDrawcall(const DrawcallInfo& drawcallInfo, Material::OverrideFlags materialOverride = Material::NoOverride);
 
+    // Execute a drawcall after PrepareDrawcall, with its instances or merged element ranges
+    void Draw(const DrawcallInfo& drawcallInfo) const;
+
     void SetLightingRenderStates(bool firstPass);
 
     void Render();
@@ -120,11 +202,64 @@ private:
 
     const glm::mat4& GetWorldMatrix(const DrawcallInfo& drawcallInfo) const;
 
+    std::uint64_t ComputeSortKey(const Material& material, const VertexArrayObject& vao, std::uint32_t depthKey) const;
+    std::uint32_t ComputeDepthKey(const glm::mat4& worldMatrix) const;
+    void UpdateSortKeyDepths();
+
+    bool SupportsInstancing(const Material& material) const;
+    bool CanMergeInstances(const DrawcallInfo& a, const DrawcallInfo& b) const;
+    static bool CanMergeMultiDraw(const DrawcallInfo& a, const DrawcallInfo& b);
+    void PrepareObjectMatrices(const ShaderProgram& shaderProgram, const DrawcallInfo& drawcallInfo);
+
+    void UpdateFrameConstants();
+
+    static std::uint32_t GetSortKeyDepth(std::uint64_t sortKey);
+    static std::uint64_t GetModeSortKey(std::uint64_t sortKey, DrawcallSortMode sortMode);
+
+private:
+    // Sort key layout, in bits
+    static constexpr unsigned int c_sortKeyDepthBits = 24;
+    static constexpr unsigned int c_sortKeyStateBits = 12;
+    static constexpr unsigned int c_sortKeyPassBits = 4;
+
+    struct SortEntry
+    {
+        std::uint64_t key;
+        unsigned int index;
+    };
+
+    static void RadixSort(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch);
+
+    // Texture unit reserved for the object matrices, above the ones used by the materials
+    static constexpr GLint c_objectTextureUnit = 15;
+
+    // Object buffers are cycled every frame, so the upload doesn't wait for the GPU to finish with the previous frame
+    static constexpr unsigned int c_objectBufferCount = 3;
+
+    struct ObjectLocations
+    {
+        ShaderProgram::Location matrices;
+        ShaderProgram::Location index;
+    };
+
+    // Range of the multi-draw arrays used by a merged drawcall
+    struct MultiDraw
+    {
+        GLenum primitive;
+        GLenum eboType;
+        unsigned int first;
+        GLsizei count;
+    };
+
 private:
     DeviceGL& m_device;
 
     const Camera *m_currentCamera;
 
+    // Frustum of the current camera, in world space
+    FrustumBounds m_cameraFrustum;
+    bool m_frustumCullingEnabled;
+
     std::shared_ptr<const Material> m_currentMaterial;
 
     std::shared_ptr<const FramebufferObject> m_defaultFramebuffer;
@@ -132,14 +267,41 @@ private:
 
     std::vector<const Light*> m_lights;
 
+    // World matrices of the models, followed by the copies used by the instanced drawcalls
+    // Uploaded once per frame to the object buffer
     std::vector<glm::mat4> m_worldMatrices;
+    std::array<std::shared_ptr<TextureBufferObject>, c_objectBufferCount> m_objectTextures;
+    unsigned int m_objectTextureIndex;
+    bool m_objectDataDirty;
+    std::unordered_map<const ShaderProgram*, ObjectLocations> m_objectLocations;
+
+    // Per frame values, uploaded once at the start of Render
+    FrameConstants m_frameConstants;
+    UniformBufferObject m_frameConstantsBuffer;
+    float m_time;
+
+    // Programs that already received the camera uniforms with the current camera
+    std::unordered_set<const ShaderProgram*> m_cameraUpdatedPrograms;
+
+    // Parameters of the merged drawcalls, in the layout expected by glMultiDrawElementsBaseVertex
+    std::vector<MultiDraw> m_multiDraws;
+    std::vector<GLsizei> m_multiDrawCounts;
+    std::vector<const void*> m_multiDrawOffsets;
+    std::vector<GLint> m_multiDrawBaseVertices;
 
     std::vector<DrawcallCollection> m_drawcallCollections;
 
+    // Scratch buffers reused between sorts to avoid allocations every frame
+    std::vector<SortEntry> m_sortEntries;
+    std::vector<SortEntry> m_sortScratch;
+    std::vector<DrawcallInfo> m_sortedDrawcalls;
+
     std::unordered_map<std::shared_ptr<const ShaderProgram>, UpdateTransformsFunction> m_updateTransformsFunctions;
     std::unordered_map<std::shared_ptr<const ShaderProgram>, UpdateLightsFunction> m_updateLightsFunctions;
 
     Mesh m_fullscreenMesh;
 
     std::vector<std::unique_ptr<RenderPass>> m_passes;
+
+    RenderProfiler m_profiler;
 };
@@ -11,6 +11,11 @@ class SkyboxRenderPass : public RenderPass
 {
 public:
     SkyboxRenderPass(std::shared_ptr<TextureCubemapObject> texture);
+    // Use a program created with CreateShaderProgram(), that must be linked
+    SkyboxRenderPass(std::shared_ptr<TextureCubemapObject> texture, std::shared_ptr<const ShaderProgram> shaderProgram);
+
+    // Load the skybox shaders and build the program. In a ShaderBuildBatch, it compiles with the other programs
+    static std::shared_ptr<ShaderProgram> CreateShaderProgram();
 
     std::shared_ptr<TextureCubemapObject> GetTexture() const;
     void SetTexture(std::shared_ptr<TextureCubemapObject> texture);
@@ -20,7 +25,7 @@ public:
 private:
     std::shared_ptr<TextureCubemapObject> m_texture;
 
-    ShaderProgram m_shaderProgram;
+    std::shared_ptr<const ShaderProgram> m_shaderProgram;
     ShaderProgram::Location m_cameraPositionLocation;
     ShaderProgram::Location m_invViewProjMatrixLocation;
     ShaderProgram::Location m_skyboxTextureLocation;
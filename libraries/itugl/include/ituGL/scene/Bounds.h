@@ -1,7 +1,11 @@
 #pragma once
 
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 #include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <array>
+#include <cassert>
 
 class Bounds
 {
@@ -91,6 +95,8 @@ class BoxBounds : public RotatedBounds
 public:
     BoxBounds(const glm::vec3& center, const glm::mat3& rotationMatrix, const glm::vec3& size) : RotatedBounds(center, rotationMatrix), m_size(size) {}
     BoxBounds(const Bounds& bounds);
+    // Box containing the local bounds after being transformed by the matrix
+    BoxBounds(const AabbBounds& localBounds, const glm::mat4& matrix);
 
     inline Type GetType() const override { return Type::Box; }
 
@@ -103,21 +109,30 @@ private:
     glm::vec3 m_size;
 };
 
-class FrustumBounds : public RotatedBounds
+class FrustumBounds : public Bounds
 {
 public:
-    FrustumBounds(const glm::vec3& center, const glm::vec3& size);
+    // Frustum containing everything that the matrix projects inside the clip volume
+    FrustumBounds(const glm::mat4& viewProjMatrix);
 
     inline Type GetType() const override { return Type::Frustum; }
 
+    void SetMatrix(const glm::mat4& viewProjMatrix);
+
+    // Planes are normalized, with the normal pointing inwards: dot(xyz, point) + w >= 0 is inside
+    inline const glm::vec4& GetPlane(int index) const { return m_planes[index]; }
+    inline int GetPlaneCount() const { return static_cast<int>(m_planes.size()); }
+
 private:
+    // Left, right, bottom, top, near, far
+    std::array<glm::vec4, 6> m_planes;
 };
 
 
 template<typename T>
 bool Bounds::Intersects(const T& other) const
 {
-    Bounds::Intersects(this, other);
+    return Bounds::Intersects(*this, other);
 }
 
 template<typename TA, typename TB>
@@ -144,6 +159,8 @@ bool Bounds::Intersects(const Bounds& boundsA, const TB& boundsB)
         return Bounds::Intersects(static_cast<const AabbBounds&>(boundsA), boundsB);
     case Type::Box:
         return Bounds::Intersects(static_cast<const BoxBounds&>(boundsA), boundsB);
+    case Type::Frustum:
+        return Bounds::Intersects(static_cast<const FrustumBounds&>(boundsA), boundsB);
     default:
         assert(false);
         return false;
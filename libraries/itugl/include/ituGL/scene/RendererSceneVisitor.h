@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ituGL/scene/SceneVisitor.h>
+#include <vector>
 
 class Renderer;
 class SceneCamera;
@@ -19,6 +20,16 @@ public:
 
     void VisitModel(SceneModel& sceneModel) override;
 
+    // Call after the scene traversal. Adds the models still pending, without culling, if the scene had no camera
+    void Flush();
+
+private:
+    // Add the model to the renderer, unless it is outside of the camera frustum
+    void AddModel(SceneModel& sceneModel);
+
 private:
     Renderer& m_renderer;
+
+    // Models visited before the camera, they can't be culled until the camera is known
+    std::vector<SceneModel*> m_pendingModels;
 };
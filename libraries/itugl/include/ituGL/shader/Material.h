@@ -5,8 +5,10 @@
 #include <ituGL/core/Color.h>
 #include <functional>
 #include <array>
+#include <memory>
 
 // Class to group all the properties that may affect the look of a rendered geometry
+// Copies share the uniform values and the pipeline state with the original, until they change them
 class Material : public ShaderUniformCollection
 {
 public:
@@ -137,42 +139,56 @@ private:
     void UseBlend() const;
 
 private:
-    // Function pointer to prepare the shader used by the material
-    ShaderSetupFunction m_shaderSetupFunction;
+    // Depth, stencil and blend settings, and the shader setup function
+    // Shared by the copies of a material, until one of them changes them
+    struct PipelineState
+    {
+        PipelineState();
+
+        // Function pointer to prepare the shader used by the material
+        ShaderSetupFunction shaderSetupFunction;
+
+        // Test function for depth. Default: Less
+        TestFunction depthTestFunction;
 
-    // Test function for depth. Default: Less
-    TestFunction m_depthTestFunction;
+        // If it should write to depth or not. Default: True
+        bool depthWrite;
 
-    // If it should write to depth or not. Default: True
-    bool m_depthWrite;
+        // Test functions for front and back stencil. Default: Never
+        std::array<TestFunction, 2> stencilTestFunctions;
 
-    // Test functions for front and back stencil. Default: Never
-    std::array<TestFunction, 2> m_stencilTestFunctions;
+        // Ref values for front and back stencil. Default: 0
+        std::array<int, 2> stencilRefValues;
 
-    // Ref values for front and back stencil. Default: 0
-    std::array<int, 2> m_stencilRefValues;
+        // Mask for front and back stencil. Default: ~0
+        std::array<unsigned int, 2> stencilMasks;
 
-    // Mask for front and back stencil. Default: ~0
-    std::array<unsigned int, 2> m_stencilMasks;
+        // Stencil operation to perform if stencil test fails, front and back. Default: Keep
+        std::array<StencilOperation, 2> stencilFail;
 
-    // Stencil operation to perform if stencil test fails, front and back. Default: Keep
-    std::array<StencilOperation, 2> m_stencilFail;
+        // Stencil operation to perform if depth test fails, front and back. Default: Keep
+        std::array<StencilOperation, 2> stencilDepthFail;
 
-    // Stencil operation to perform if depth test fails, front and back. Default: Keep
-    std::array<StencilOperation, 2> m_stencilDepthFail;
+        // Stencil operation to perform if depth test passes, front and back. Default: Keep
+        std::array<StencilOperation, 2>stencilDepthPass;
 
-    // Stencil operation to perform if depth test passes, front and back. Default: Keep
-    std::array<StencilOperation, 2>m_stencilDepthPass;
+        // Blend equation for color and alpha. Default: None
+        std::array<BlendEquation, 2> blendEquations;
 
-    // Blend equation for color and alpha. Default: None
-    std::array<BlendEquation, 2> m_blendEquations;
+        // Blend parameters for source color, destination color, source alpha and destination alpha
+        // Default: One, Zero, One, Zero
+        std::array<BlendParam, 4> blendParams;
 
-    // Blend parameters for source color, destination color, source alpha and destination alpha
-    // Default: One, Zero, One, Zero
-    std::array<BlendParam, 4> m_blendParams;
+        // Blend color to use with ConstantColor or ConstantAlpha parameters. Default: white
+        Color blendColor;
+    };
+
+    // Copy the state if it is shared, before changing it
+    PipelineState& GetWritableState();
 
-    // Blend color to use with ConstantColor or ConstantAlpha parameters. Default: white
-    Color m_blendColor;
+private:
+    // Pipeline state, shared with the copies of the material
+    std::shared_ptr<PipelineState> m_state;
 };
 
 // Different conditions for depth and stencil tests
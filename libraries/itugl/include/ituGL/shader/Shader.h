@@ -2,6 +2,7 @@
 
 #include <ituGL/core/Object.h>
 
+#include <cstdint>
 #include <span>
 
 // Shader is an OpenGL Object that represents a program that runs on the GPU
@@ -44,12 +45,39 @@ public:
     // Set the source code of the shader (multiple sources)
     void SetSource(std::span<const char*> source);
 
+    // Hash of the source code, to identify shaders built from the same code
+    inline std::uint64_t GetSourceHash() const { return m_sourceHash; }
+
     // Compile the shader source code
     bool Compile();
 
-    // Check if the shader has been successfully compiled
+    // Compile the shader later, only if a program needs it. See ShaderProgramCache
+    inline void DeferCompile() { m_compileDeferred = true; }
+
+    // Compile the shader now if the compilation was deferred, printing the errors if it fails
+    bool CompileDeferred() const;
+
+    // Start the compilation if it was deferred, without waiting for the result. See ShaderBuildBatch
+    void SubmitDeferredCompile() const;
+
+    // Check if the shader has been successfully compiled. Waits for the driver to finish compiling
     bool IsCompiled() const;
 
+    // Check if the driver finished compiling, without waiting. Always true without parallel shader compilation
+    bool IsCompileComplete() const;
+
     // Get compilation error messages in case of a failure
     void GetCompilationErrors(std::span<char> errors) const;
+
+    // Print the compilation error messages to the console
+    inline void PrintCompilationErrors() const { PrintCompilationErrors(GetHandle()); }
+
+    // Print the compilation error messages of a shader object that is only referenced by handle, like the shaders attached to a program
+    static void PrintCompilationErrors(Handle handle);
+
+private:
+    std::uint64_t m_sourceHash;
+
+    // Compiling a shader doesn't change it from the outside, so it can be done from a const reference
+    mutable bool m_compileDeferred;
 };
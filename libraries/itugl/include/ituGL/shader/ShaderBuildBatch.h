@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+class ShaderProgram;
+
+// Builds many shader programs together: all the shaders and programs are submitted to the driver first,
+// and their status is only checked at the end, in Finish()
+// - With GL_KHR_parallel_shader_compile, the driver compiles them in its own threads, one per core.
+//   IsComplete() can be polled without waiting, to do other work on the main thread meanwhile
+// - Without the extension, the driver can still compile them asynchronously, but queries may wait
+// - While a batch is open, ShaderLoader and ShaderProgram::Build don't check the status, so their results are not known yet.
+//   The programs must not be used, or have their uniforms queried, before Finish(), or FinishProgram() for that program
+// Only one batch can be open at a time, ShaderLoader and ShaderProgram::Build use the current one
+class ShaderBuildBatch
+{
+public:
+    ShaderBuildBatch();
+    ~ShaderBuildBatch();
+
+    // The batch that is open, null if there is none
+    inline static ShaderBuildBatch* GetCurrent() { return s_current; }
+
+    // Register a program that was linked without checking the status. The program must be alive until Finish()
+    void AddProgram(ShaderProgram& shaderProgram, std::uint64_t cacheKey, bool storeInCache);
+
+    // Number of programs submitted, and not checked yet
+    inline unsigned int GetPendingCount() const { return static_cast<unsigned int>(m_programs.size()); }
+
+    // Check if the driver finished compiling and linking all the programs, without waiting
+    bool IsComplete() const;
+
+    // Wait for all the programs, print the errors and store them in the ShaderProgramCache
+    // Returns true if all of them linked. The batch is closed after this
+    bool Finish();
+
+    // Wait only for one program, so it can be used while the others are still compiling. The batch stays open
+    // Returns true if it linked
+    bool FinishProgram(ShaderProgram& shaderProgram);
+
+private:
+    struct PendingProgram
+    {
+        ShaderProgram* shaderProgram;
+        std::uint64_t cacheKey;
+        bool storeInCache;
+        std::chrono::steady_clock::time_point submitTime;
+    };
+
+    // Check the status of a program, print its errors or store it in the ShaderProgramCache. Waits until the driver finishes
+    static bool CheckProgram(const PendingProgram& pendingProgram);
+
+    // Print the errors of the program and of its attached shaders
+    static void PrintErrors(const ShaderProgram& shaderProgram);
+
+private:
+    std::vector<PendingProgram> m_programs;
+
+    // Batch that is open
+    static ShaderBuildBatch* s_current;
+};
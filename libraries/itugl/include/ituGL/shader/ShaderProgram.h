@@ -1,6 +1,8 @@
 #pragma once
 
 #include <ituGL/core/Object.h>
+#include <ituGL/core/FlatHashMap.h>
+#include <ituGL/shader/UniformName.h>
 
 // Include the glm types for vectors and matrices
 #include <glm/vec2.hpp>
@@ -16,7 +18,9 @@
 #include <glm/mat4x3.hpp>
 #include <glm/mat4x4.hpp>
 
+#include <cstdint>
 #include <span>
+#include <vector>
 
 class Shader;
 class TextureObject;
@@ -71,18 +75,37 @@ public:
         return Build(vertexShader, fragmentShader, tesselationControlShader, &tesselationEvaluationShader, &geometryShader);
     }
 
-    // Check if shaders have been linked to create a valid program
+    // Check if shaders have been linked to create a valid program. Waits for the driver to finish linking
     bool IsLinked() const;
 
+    // Check if the driver finished linking, without waiting. Always true without parallel shader compilation
+    bool IsLinkComplete() const;
+
     // Get a string with linking error messages
     // The max length of the string returned is determined by the capacity of the span
     void GetLinkingErrors(std::span<char> errors) const;
 
+    // Get the linked program in the binary format of the driver. Returns false if the driver doesn't provide it
+    bool GetBinary(GLenum& binaryFormat, std::vector<char>& binary) const;
+
+    // Load a program binary from GetBinary(), instead of linking. Returns false if the driver rejects it
+    bool LoadBinary(GLenum binaryFormat, std::span<const char> binary);
+
     // Find an attribute location by name
     Location GetAttributeLocation(const char* name) const;
 
-    // Find a uniform location by name
-    Location GetUniformLocation(const char *name) const;
+    // Find a uniform location by name, -1 if it is not active. Names can be strings, converted to UniformName
+    // The first search builds a table with the locations of all the uniforms. After that, searches don't reach the driver
+    Location GetUniformLocation(UniformName name) const;
+
+    // Find a uniform block index by name. Returns GL_INVALID_INDEX if not found
+    GLuint GetUniformBlockIndex(const char* name) const;
+
+    // Connect a uniform block to a uniform buffer binding point
+    void SetUniformBlockBinding(GLuint blockIndex, GLuint binding) const;
+
+    // Size in bytes of the buffer range needed by a uniform block
+    GLint GetUniformBlockDataSize(GLuint blockIndex) const;
 
     // Get how many uniforms exist in this shader program
     unsigned int GetUniformCount() const;
@@ -90,6 +113,9 @@ public:
     // Get information about a specific uniform
     void GetUniformInfo(unsigned int index, int& size, GLenum& glType, std::span<char> uniformName) const;
 
+    // Get where a uniform is stored in its uniform block, in bytes. The block index is -1 for uniforms outside blocks
+    void GetUniformBlockInfo(unsigned int index, GLint& blockIndex, GLint& offset, GLint& arrayStride, GLint& matrixStride) const;
+
     // Template method combinations to simplify getting uniforms
     template<typename T>
     void GetUniform(Location location, T& value) const;
@@ -113,6 +139,15 @@ public:
     // Set texture value for a texture uniform
     void SetTexture(Location location, GLint textureUnit, const TextureObject& texture) const;
 
+    // Revision of the value of a uniform, kept by ShaderUniformCollection to skip the uploads that would not change it. 0 if unknown
+    // Setting uniforms directly forgets the revisions of their locations, so the next upload is not skipped
+    std::uint64_t GetUniformRevision(Location location) const;
+    void SetUniformRevision(Location location, std::uint64_t revision) const;
+
+    // Revision of all the values uploaded by the last ShaderUniformCollection. 0 if other values were set after
+    inline std::uint64_t GetUniformsRevision() const { return m_uniformsRevision; }
+    inline void SetUniformsRevision(std::uint64_t revision) const { m_uniformsRevision = revision; }
+
     // Set the shader program as the active one to be used for rendering
     void Use() const;
 
@@ -128,10 +163,23 @@ private:
     // Link currently attached shaders
     bool Link();
 
+    // Forget the uniform locations and the revisions of the values, after the program is linked again
+    void ResetUniforms();
+
+    // Fill the table of uniform locations, with the names of all the active uniforms, and of each element of the arrays
+    void BuildUniformLocations() const;
+
+    // Load the program from the ShaderProgramCache, or compile, attach and link the shaders
+    // In a ShaderBuildBatch, returns true without checking the status, that is checked by ShaderBuildBatch::Finish()
+    bool Link(std::span<const Shader* const> shaders);
+
     // Helper template method for getting uniforms
     template<typename T>
     void GetUniform(Location location, std::span<T> value) const;
 
+    // The values at these locations were set directly, their revisions are not known
+    void ForgetUniformRevisions(Location location, GLsizei count) const;
+
     // Helper template methods for setting uniforms
     template<typename T, int N>
     void SetUniforms(Location location, const T* values, GLsizei count) const;
@@ -139,6 +187,14 @@ private:
     void SetUniforms(Location location, const T* values, GLsizei count) const;
 
 private:
+    // Uniform locations by the hash of their name, built on the first search, once the program is linked
+    mutable FlatHashMap<Location> m_uniformLocations;
+    mutable bool m_uniformLocationsBuilt;
+
+    // Revisions of the uniform values, by location
+    mutable std::vector<std::uint64_t> m_uniformRevisions;
+    mutable std::uint64_t m_uniformsRevision;
+
 #ifndef NDEBUG
     inline bool IsUsed() const { return s_usedHandle == GetHandle(); }
     static Handle s_usedHandle;
@@ -190,18 +246,21 @@ void ShaderProgram::SetUniform(Location location, const T& value) const
 template<typename T>
 void ShaderProgram::SetUniforms(Location location, std::span<const T> values) const
 {
+    ForgetUniformRevisions(location, static_cast<GLsizei>(values.size()));
     SetUniforms<T, 1>(location, &values[0], static_cast<GLsizei>(values.size()));
 }
 
 template<typename T, int N>
 void ShaderProgram::SetUniforms(Location location, std::span<const glm::vec<N, T>> values) const
 {
+    ForgetUniformRevisions(location, static_cast<GLsizei>(values.size()));
     SetUniforms<T, N>(location, &values[0][0], static_cast<GLsizei>(values.size()));
 }
 
 template<typename T, int C, int R>
 void ShaderProgram::SetUniforms(Location location, std::span<const glm::mat<C, R, T>> values) const
 {
+    ForgetUniformRevisions(location, static_cast<GLsizei>(values.size()));
     SetUniforms<T, C, R>(location, &values[0][0][0], static_cast<GLsizei>(values.size()));
 }
 
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+class Shader;
+class ShaderProgram;
+
+// Stores the linked shader programs in a directory, in the binary format of the driver, so they don't need to be built again
+// - Programs are identified by the hash of their shader sources and the driver strings. Any change builds them again
+// - While the cache is enabled, ShaderLoader defers the compilation of the shaders to ShaderProgram::Build,
+//   that only compiles them if the program is not in the cache, or if the driver rejects the cached binary
+// Implemented as a Singleton pattern, ShaderProgram::Build uses the current instance
+class ShaderProgramCache
+{
+public:
+    struct Stats
+    {
+        // Programs loaded from the cache, and programs built from source
+        unsigned int hitCount;
+        unsigned int missCount;
+
+        // Programs found in the cache, but rejected by the driver. Also counted as misses
+        unsigned int rejectedCount;
+
+        // Time it took to build the programs that were loaded from the cache, minus the time to load them, in ms
+        float savedTime;
+    };
+
+public:
+    ShaderProgramCache(const std::filesystem::path& directory);
+    ~ShaderProgramCache();
+
+    // Singleton method to get a pointer to the instance, null if there is none
+    inline static ShaderProgramCache* GetInstancePointer() { return m_instance; }
+
+    // Check that the driver supports program binaries, and identify it. Needs the GL context
+    void Initialize();
+
+    // The cache is enabled after Initialize(), if the driver supports it
+    inline bool IsEnabled() const { return m_enabled; }
+
+    // Key identifying a program built from these shaders with the current driver
+    std::uint64_t GetKey(std::span<const Shader* const> shaders) const;
+
+    // Load the program from the cache. Returns false if it is not found, or if the driver rejects it
+    bool LoadProgram(ShaderProgram& shaderProgram, std::uint64_t key);
+
+    // Store a linked program in the cache, with the time it took to build in ms
+    void StoreProgram(const ShaderProgram& shaderProgram, std::uint64_t key, float buildTime);
+
+    inline const Stats& GetStats() const { return m_stats; }
+
+private:
+    // Header of the cache files, followed by the program binary
+    struct FileHeader
+    {
+        std::uint32_t magic;
+        std::uint32_t binaryFormat;
+        std::uint32_t binarySize;
+        float buildTime;
+        std::uint64_t key;
+    };
+
+    std::filesystem::path GetFilePath(std::uint64_t key) const;
+
+private:
+    std::filesystem::path m_directory;
+
+    bool m_enabled;
+
+    // Hash of the vendor, renderer and version strings
+    std::uint64_t m_driverHash;
+
+    Stats m_stats;
+
+    static constexpr std::uint32_t c_fileMagic = 0x42505449; // "ITPB"
+
+private:
+    // Singleton instance
+    static ShaderProgramCache* m_instance;
+};
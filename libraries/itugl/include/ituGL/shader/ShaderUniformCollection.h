@@ -1,21 +1,37 @@
 #pragma once
 
 #include <ituGL/shader/ShaderProgram.h>
+#include <ituGL/shader/UniformBufferArena.h>
 #include <ituGL/texture/TextureObject.h>
 #include <ituGL/core/Data.h>
+#include <ituGL/core/FlatHashMap.h>
+#include <cstdint>
 #include <vector>
-#include <unordered_map>
 #include <unordered_set>
 #include <string>
 #include <cstring>
 #include <memory>
-
+#include <new>
+
+// Values of the uniforms of a shader program, to set them all together
+// - Each value has a revision, that changes when the value changes. The program keeps the revisions of the values it has,
+//   so SetUniforms() only uploads the values that are different from the ones set by the last collection using the program
+// - Copies have the same revisions as the original, because they have the same values until they change
+// - Copies share the properties and their values with the original. They are copied when a value is first set (copy-on-write)
+// - If the program declares a "MaterialParams" uniform block, the values of its members are packed in its std140 layout,
+//   in a range of the UniformBufferArena. The range is uploaded when the values change, and bound with a single call
 class ShaderUniformCollection
 {
 public:
     // Alias for a set of names
     using NameSet = std::unordered_set<std::string>;
 
+    // Name of the uniform block packed by the collection. Its members must be declared without an instance name
+    static constexpr const char* c_materialParamsBlockName = "MaterialParams";
+
+    // Uniform buffer binding point of the "MaterialParams" block. Renderer uses 0 for "FrameConstants"
+    static constexpr GLuint c_materialParamsBinding = 1;
+
 public:
     ShaderUniformCollection();
     // Initialize with the shader program, will extract all the properties. Skip the names in filtered uniforms
@@ -31,46 +47,56 @@ public:
     // Get the vertex attribute location by name
     ShaderProgram::Location GetAttributeLocation(const char* name) const;
 
-    // Get the shader uniform location by name
-    ShaderProgram::Location GetUniformLocation(const char* name) const;
+    // Get the shader uniform location by name. Names can be strings, converted to UniformName
+    // Uniforms in the "MaterialParams" block get locations of the collection, after the ones of the program
+    ShaderProgram::Location GetUniformLocation(UniformName name) const;
+
+    // Check if the values of the "MaterialParams" block are stored in the collection
+    inline bool HasMaterialParams() const { return !m_storage->materialParamsData.empty(); }
 
     // Get uniform value for different types, using the name or the uniform location
     template<typename T>
-    T GetUniformValue(const char* name) const;
+    T GetUniformValue(UniformName name) const;
     template<typename T>
     T GetUniformValue(ShaderProgram::Location location) const;
     template<typename T>
-    void GetUniformValue(const char* name, T& value) const;
+    void GetUniformValue(UniformName name, T& value) const;
     template<typename T>
     void GetUniformValue(ShaderProgram::Location location, T& value) const;
     template<typename T>
     void GetUniformValue(ShaderProgram::Location location, std::shared_ptr<T>& value) const;
     template<typename T>
-    void GetUniformValues(const char* name, std::span<T> value) const;
+    void GetUniformValues(UniformName name, std::span<T> value) const;
     template<typename T>
     void GetUniformValues(ShaderProgram::Location location, std::span<T> value) const;
 
     // Set uniform value for different types, using the name or the uniform location
     template<typename T>
-    void SetUniformValue(const char* name, const T& value);
+    void SetUniformValue(UniformName name, const T& value);
     template<typename T>
     void SetUniformValue(ShaderProgram::Location location, const T& value);
     template<typename T>
     void SetUniformValue(ShaderProgram::Location location, const std::shared_ptr<T>& value);
     template<typename T>
-    void SetUniformValues(const char* name, std::span<const T> value);
+    void SetUniformValues(UniformName name, std::span<const T> value);
     template<typename T>
     void SetUniformValues(ShaderProgram::Location location, std::span<const T> value);
 
-    // Get the pointer to the uniform data
+    // Get the pointer to the uniform data. Not available for the uniforms in the "MaterialParams" block
     template<typename T>
-    T* GetDataUniformPointer(const char* name);
+    T* GetDataUniformPointer(UniformName name);
     template<typename T>
     T* GetDataUniformPointer(ShaderProgram::Location location);
 
     // Set all the properties to the shader. Requires the shader program to be in use
+    // Values that the program already has are skipped. Textures are always bound, DeviceGL skips the bindings that don't change
     void SetUniforms() const;
 
+    // Number of uniform uploads issued and skipped by SetUniforms() since the last reset, for all the collections
+    static unsigned int GetIssuedUploads() { return s_issuedUploads; }
+    static unsigned int GetSkippedUploads() { return s_skippedUploads; }
+    static void ResetUploadStats();
+
 private:
     // Different dimensions of the properties
     enum class UniformDimension
@@ -95,8 +121,17 @@ private:
         UniformDimension dimension;
         // Number of elements of the property
         unsigned int count;
-        // Index in the data buffer
+        // Byte offset of the values in the data storage, right after this record
         int index;
+        // Bytes used by the values, padded so the next record is aligned
+        int valuesSize;
+        // Revision of the value
+        std::uint64_t revision;
+        // Byte offset in the "MaterialParams" block, -1 if the uniform is not in the block
+        int blockOffset;
+        // Bytes between array elements, and between matrix columns, in the block
+        int arrayStride;
+        int matrixStride;
     };
 
     // Struct to store a texture property
@@ -108,9 +143,37 @@ private:
         TextureObject::Target target;
         // Shared pointer to the texture object
         std::shared_ptr<const TextureObject> texture;
+        // Revision of the texture
+        std::uint64_t revision;
+    };
+
+    // Everything that a copy of the collection can share with the original
+    struct Storage
+    {
+        // Data properties, each record followed by its values, so setting them touches a single block of memory
+        // Records and values are padded to c_dataAlignment, the allocation is aligned for any of their types
+        std::vector<std::byte> data;
+        // The list of texture properties
+        std::vector<TextureUniform> textureUniforms;
+
+        // Offset of the data record of each location in the data storage, indexed by location
+        std::vector<int> locationDataOffsets;
+        // Index of the texture property of each location in the texture list, indexed by location
+        std::vector<int> locationTextureIndices;
+
+        // Locations given to the uniforms in the "MaterialParams" block, by the hash of their name
+        FlatHashMap<ShaderProgram::Location> blockUniformLocations;
+
+        // Values of the "MaterialParams" block in std140 layout, and the range of the buffer where they are uploaded
+        // Collections sharing the storage share the range too, so it is only uploaded once
+        std::vector<std::byte> materialParamsData;
+        UniformBufferArena::Range materialParamsRange;
     };
 
 private:
+    // Copy the storage if it is shared with other collections, before changing it
+    void MakeStorageUnique();
+
     // Get a data uniform
     DataUniform& GetDataUniform(ShaderProgram::Location location);
     const DataUniform& GetDataUniform(ShaderProgram::Location location) const;
@@ -135,17 +198,30 @@ private:
     void AddUniform(const DataUniform& uniform);
     void AddUniform(const TextureUniform& uniform);
 
-    // Use uniform property
+    // Use uniform property. Textures are bound, and the uniform is only set if setUniform is true
     void UseUniform(const DataUniform& uniform) const;
     template<typename T>
     void UseUniform(const DataUniform& uniform) const;
-    void UseUniform(const TextureUniform& uniform) const;
+    void UseUniform(const TextureUniform& uniform, bool setUniform) const;
 
-    // Get the buffer where data values are stored for a certain type
-    template<typename T>
-    std::vector<T>& GetDataValues();
+    // Give a new revision to a value that changed, and to the collection
+    void UpdateRevision(std::uint64_t& revision);
+
+    // Copy the value of a uniform to the std140 data of the "MaterialParams" block, and flag it to be uploaded
+    void PackBlockUniform(const DataUniform& uniform);
+
+    // Bytes of the stored value of a data uniform
+    const std::byte* GetDataUniformBytes(const DataUniform& uniform) const;
+
+    // Number of columns and rows of a dimension. Vectors are a single column
+    static void GetDimensionSize(UniformDimension dimension, int& columns, int& rows);
+
+    // Data record stored at an offset of the data storage
+    inline const DataUniform& GetDataRecord(std::size_t offset) const { return *reinterpret_cast<const DataUniform*>(&m_storage->data[offset]); }
+
+    // Pointer to the values of a data uniform, in the data storage
     template<typename T>
-    const std::vector<T>& GetDataValues() const;
+    inline const T* GetDataPointer(const DataUniform& uniform) const { return reinterpret_cast<const T*>(&m_storage->data[uniform.index]); }
 
     // Get a span of values for a specific uniform
     template<typename T>
@@ -180,26 +256,28 @@ protected:
     std::shared_ptr<ShaderProgram> m_shaderProgram;
 
 private:
-    // The list of data properties
-    std::vector<DataUniform> m_dataUniforms;
-    // The list of texture properties
-    std::vector<TextureUniform> m_textureUniforms;
-
-    // Map to find data properties in the data list
-    std::unordered_map<ShaderProgram::Location, int> m_locationDataIndex;
-    // Map to find texture properties in the texture list
-    std::unordered_map<ShaderProgram::Location, int> m_locationTextureIndex;
-
-    // Buffers that store the values for data properties
-    std::vector<int> m_intDataValues;
-    std::vector<unsigned int> m_uintDataValues;
-    std::vector<float> m_floatDataValues;
-    std::vector<double> m_doubleDataValues;
+    // Properties and their values. Shared by the copies of a collection, until one of them changes a value
+    std::shared_ptr<Storage> m_storage;
+
+    // Revision of all the values, changes when any of them changes
+    std::uint64_t m_revision;
+
+    // Marks the locations without a property in the location arrays
+    static constexpr int c_absentIndex = -1;
+
+    // Alignment of the records and the values in the data storage, enough for doubles
+    static constexpr int c_dataAlignment = 8;
+
+    // Next revision to give, shared by all the collections so they are never repeated
+    static std::uint64_t s_nextRevision;
+
+    static unsigned int s_issuedUploads;
+    static unsigned int s_skippedUploads;
 };
 
 
 template<typename T>
-inline T ShaderUniformCollection::GetUniformValue(const char* name) const
+inline T ShaderUniformCollection::GetUniformValue(UniformName name) const
 {
     T value;
     GetUniformValue(name, value);
@@ -215,7 +293,7 @@ inline T ShaderUniformCollection::GetUniformValue(ShaderProgram::Location locati
 }
 
 template<typename T>
-inline void ShaderUniformCollection::GetUniformValue(const char* name, T& value) const
+inline void ShaderUniformCollection::GetUniformValue(UniformName name, T& value) const
 {
     ShaderProgram::Location location = GetUniformLocation(name);
     assert(location >= 0);
@@ -240,7 +318,7 @@ template<>
 void ShaderUniformCollection::GetUniformValue(ShaderProgram::Location location, std::shared_ptr<const TextureObject>& value) const;
 
 template<typename T>
-inline void ShaderUniformCollection::GetUniformValues(const char* name, std::span<T> values) const
+inline void ShaderUniformCollection::GetUniformValues(UniformName name, std::span<T> values) const
 {
     ShaderProgram::Location location = GetUniformLocation(name);
     assert(location >= 0);
@@ -257,7 +335,7 @@ void ShaderUniformCollection::GetUniformValues(ShaderProgram::Location location,
 }
 
 template<typename T>
-inline void ShaderUniformCollection::SetUniformValue(const char* name, const T& value)
+inline void ShaderUniformCollection::SetUniformValue(UniformName name, const T& value)
 {
     ShaderProgram::Location location = GetUniformLocation(name);
     //assert(location >= 0);
@@ -284,7 +362,7 @@ template<>
 void ShaderUniformCollection::SetUniformValue(ShaderProgram::Location location, const std::shared_ptr<const TextureObject>& value);
 
 template<typename T>
-inline void ShaderUniformCollection::SetUniformValues(const char* name, std::span<const T> values)
+inline void ShaderUniformCollection::SetUniformValues(UniformName name, std::span<const T> values)
 {
     ShaderProgram::Location location = GetUniformLocation(name);
     assert(location >= 0);
@@ -294,23 +372,26 @@ inline void ShaderUniformCollection::SetUniformValues(const char* name, std::spa
 template<typename T>
 void ShaderUniformCollection::SetUniformValues(ShaderProgram::Location location, std::span<const T> values)
 {
-    std::span<T> storedValues;
-    GetDataValues(location, storedValues);
+    std::span<const T> storedValues;
+    const_cast<const ShaderUniformCollection*>(this)->GetDataValues(location, storedValues);
     assert(values.size() == storedValues.size());
-    std::memcpy(storedValues.data(), values.data(), values.size_bytes());
-}
 
-template<typename T>
-inline std::vector<T>& ShaderUniformCollection::GetDataValues()
-{
-    return const_cast<std::vector<T>&>(const_cast<const ShaderUniformCollection*>(this)->GetDataValues<T>());
+    // Setting the same value keeps the revision, so it is not uploaded again, and the storage can still be shared
+    if (std::memcmp(storedValues.data(), values.data(), values.size_bytes()) != 0)
+    {
+        MakeStorageUnique();
+        std::span<T> writableValues;
+        GetDataValues(location, writableValues);
+        std::memcpy(writableValues.data(), values.data(), values.size_bytes());
+        DataUniform& uniform = GetDataUniform(location);
+        UpdateRevision(uniform.revision);
+        if (uniform.blockOffset >= 0)
+        {
+            PackBlockUniform(uniform);
+        }
+    }
 }
 
-template<> inline const std::vector<int>& ShaderUniformCollection::GetDataValues() const { return m_intDataValues; }
-template<> inline const std::vector<unsigned int>& ShaderUniformCollection::GetDataValues() const { return m_uintDataValues; }
-template<> inline const std::vector<float>& ShaderUniformCollection::GetDataValues() const { return m_floatDataValues; }
-template<> inline const std::vector<double>& ShaderUniformCollection::GetDataValues() const { return m_doubleDataValues; }
-
 template<typename T>
 inline std::span<T> ShaderUniformCollection::GetDataValues(ShaderProgram::Location location)
 {
@@ -340,9 +421,7 @@ void ShaderUniformCollection::GetDataValues(ShaderProgram::Location location, st
     const DataUniform& uniform = GetDataUniform(location);
     assert(uniform.type == Data::GetType<T>());
     assert(IsScalar(uniform.dimension));
-    const std::vector<T>& allValues = GetDataValues<T>();
-    auto dataPtr = &allValues[uniform.index];
-    values = std::span(dataPtr, uniform.count);
+    values = std::span(GetDataPointer<T>(uniform), uniform.count);
 }
 
 template<typename T, int N>
@@ -352,9 +431,7 @@ void ShaderUniformCollection::GetDataValues(ShaderProgram::Location location, st
     assert(uniform.type == Data::GetType<T>());
     assert(IsVector(uniform.dimension));
     assert(IsVectorSize(uniform.dimension, N));
-    const std::vector<T>& allValues = GetDataValues<T>();
-    auto dataPtr = reinterpret_cast<const glm::vec<N, T>*>(&allValues[uniform.index]);
-    values = std::span(dataPtr, uniform.count);
+    values = std::span(GetDataPointer<glm::vec<N, T>>(uniform), uniform.count);
 }
 
 template<typename T, int C, int R>
@@ -364,13 +441,11 @@ void ShaderUniformCollection::GetDataValues(ShaderProgram::Location location, st
     assert(uniform.type == Data::GetType<T>());
     assert(IsMatrix(uniform.dimension));
     assert(IsMatrixSize(uniform.dimension, C, R));
-    const std::vector<T>& allValues = GetDataValues<T>();
-    auto dataPtr = reinterpret_cast<const glm::mat<C, R, T>*>(&allValues[uniform.index]);
-    values = std::span(dataPtr, uniform.count);
+    values = std::span(GetDataPointer<glm::mat<C, R, T>>(uniform), uniform.count);
 }
 
 template<typename T>
-T* ShaderUniformCollection::GetDataUniformPointer(const char* name)
+T* ShaderUniformCollection::GetDataUniformPointer(UniformName name)
 {
     ShaderProgram::Location location = GetUniformLocation(name);
     assert(location >= 0);
@@ -380,21 +455,36 @@ T* ShaderUniformCollection::GetDataUniformPointer(const char* name)
 template<typename T>
 T* ShaderUniformCollection::GetDataUniformPointer(ShaderProgram::Location location)
 {
-    const DataUniform& uniform = GetDataUniform(location);
-    std::vector<T>& allValues = GetDataValues<T>();
-    return &allValues[uniform.index];
+    // The value can be changed through the pointer, so it needs to be uploaded again
+    MakeStorageUnique();
+    DataUniform& uniform = GetDataUniform(location);
+    // Changes through the pointer would not be packed in the block
+    assert(uniform.blockOffset < 0);
+    UpdateRevision(uniform.revision);
+    return const_cast<T*>(GetDataPointer<T>(uniform));
 }
 
 template<typename T>
 void ShaderUniformCollection::AddUniform(const DataUniform& uniform)
 {
-    m_locationDataIndex.insert(std::make_pair(uniform.location, static_cast<int>(m_dataUniforms.size())));
-    m_dataUniforms.push_back(uniform);
+    static_assert(sizeof(T) <= c_dataAlignment && alignof(DataUniform) <= c_dataAlignment);
 
-    std::vector<T>& values = GetDataValues<T>();
-    m_dataUniforms.back().index = static_cast<int>(values.size());
-    int size = GetDataUniformSize(uniform);
-    values.insert(values.end(), size, T());
+    // The record goes at the end of the storage, followed by its values, all initialized to 0
+    int offset = static_cast<int>(m_storage->data.size());
+    int recordSize = (sizeof(DataUniform) + c_dataAlignment - 1) / c_dataAlignment * c_dataAlignment;
+    int valuesSize = (GetDataUniformSize(uniform) * sizeof(T) + c_dataAlignment - 1) / c_dataAlignment * c_dataAlignment;
+    m_storage->data.resize(offset + recordSize + valuesSize);
+
+    DataUniform* record = new (&m_storage->data[offset]) DataUniform(uniform);
+    record->index = offset + recordSize;
+    record->valuesSize = valuesSize;
+    UpdateRevision(record->revision);
+
+    if (m_storage->locationDataOffsets.size() <= static_cast<std::size_t>(uniform.location))
+    {
+        m_storage->locationDataOffsets.resize(uniform.location + 1, c_absentIndex);
+    }
+    m_storage->locationDataOffsets[uniform.location] = offset;
 }
 
 template<>
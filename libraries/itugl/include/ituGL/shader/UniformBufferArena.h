@@ -0,0 +1,113 @@
+#pragma once
+
+#include <ituGL/shader/UniformBufferObject.h>
+#include <ituGL/geometry/RangeAllocator.h>
+#include <memory>
+#include <span>
+#include <vector>
+
+// Large UBO shared by many uniform blocks, each one with its own range, so switching between them is a single glBindBufferRange
+// Ranges are aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT. When the buffers are full, another one is added to the arena
+// The arena must outlive its ranges
+// Implemented as a Singleton pattern, ShaderUniformCollection uses the current instance for the "MaterialParams" blocks
+class UniformBufferArena
+{
+private:
+    struct Block;
+
+public:
+    // Range reserved in the arena, released when it is destroyed
+    // Copies reserve a new range with the same size, and need to be updated before they are used
+    class Range
+    {
+    public:
+        Range();
+        Range(UniformBufferArena& arena, unsigned int size);
+        ~Range();
+
+        Range(const Range& range);
+        Range(Range&& range) noexcept;
+        Range& operator = (const Range& range);
+        Range& operator = (Range&& range) noexcept;
+
+        // False if the range is empty
+        inline bool IsValid() const { return m_offset != RangeAllocator::InvalidOffset; }
+
+        inline unsigned int GetOffset() const { return m_offset; }
+        inline unsigned int GetSize() const { return m_size; }
+
+        // Flag the contents as outdated, so the next Update() uploads them
+        inline void SetDirty() { m_dirty = true; }
+        inline bool IsDirty() const { return m_dirty; }
+
+        // Upload the data to the range if it is dirty. The size must match. Returns true if it was uploaded
+        bool Update(std::span<const std::byte> data) const;
+
+        // Bind the range to a uniform buffer binding point
+        void Bind(GLuint binding) const;
+
+    private:
+        // Give the reserved space back to the arena
+        void Free();
+
+    private:
+        UniformBufferArena* m_arena;
+        Block* m_block;
+        unsigned int m_offset;
+        unsigned int m_size;
+
+        // Data changed since the last upload
+        mutable bool m_dirty;
+    };
+
+public:
+    // Capacity of each buffer in bytes
+    UniformBufferArena(unsigned int capacity);
+    ~UniformBufferArena();
+
+    // Singleton method to get a pointer to the instance, null if there is none
+    inline static UniformBufferArena* GetInstancePointer() { return m_instance; }
+
+    // Reserve a range for a uniform block of this size. Adds a buffer if it doesn't fit in the current ones
+    inline Range Allocate(unsigned int size) { return Range(*this, size); }
+
+    // Total of all the buffers
+    unsigned int GetCapacity() const;
+    unsigned int GetUsedSize() const;
+
+    inline unsigned int GetBlockCount() const { return static_cast<unsigned int>(m_blocks.size()); }
+
+    // Number of ranges uploaded since the last reset
+    inline unsigned int GetUploadCount() const { return m_uploadCount; }
+    inline void ResetUploadCount() { m_uploadCount = 0; }
+
+private:
+    // Buffer with the ranges allocated in it
+    struct Block
+    {
+        Block(unsigned int capacity);
+
+        UniformBufferObject buffer;
+        RangeAllocator allocator;
+    };
+
+private:
+    // Size reserved for a range, rounded up so the next range is aligned too
+    unsigned int GetAlignedSize(unsigned int size) const;
+
+    // Reserve an aligned size in the first block with space for it, or in a new block. Returns the offset in the block
+    unsigned int Reserve(unsigned int alignedSize, Block*& block);
+
+private:
+    std::vector<std::unique_ptr<Block>> m_blocks;
+
+    // Declared before the block capacity, that is rounded to it
+    unsigned int m_alignment;
+
+    unsigned int m_blockCapacity;
+
+    unsigned int m_uploadCount;
+
+    // Singleton instance
+    static UniformBufferArena* m_instance;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <ituGL/core/BufferObject.h>
+#include <ituGL/core/Data.h>
+
+// Uniform Buffer Object (UBO) is a BufferObject used as storage for uniform blocks
+// Data must follow the std140 layout of the block. The buffer is connected to the blocks through binding points
+class UniformBufferObject : public BufferObjectBase<BufferObject::UniformBuffer>
+{
+public:
+    UniformBufferObject();
+
+    // Use the same AllocateData and UpdateData methods from the base class
+    using BufferObject::AllocateData;
+    using BufferObject::UpdateData;
+
+    // AllocateData template method for any type of data span, usually std140 structs updated every frame
+    template<typename T>
+    void AllocateData(std::span<const T> data, Usage usage = Usage::DynamicDraw);
+
+    // UpdateData template method for any type of data span
+    template<typename T>
+    void UpdateData(std::span<const T> data, size_t offsetBytes = 0);
+
+    // Bind the whole buffer to a binding point. It also binds the buffer to the generic target
+    void BindBase(GLuint binding) const;
+
+    // Bind a range of the buffer to a binding point. Offset must be a multiple of the offset alignment
+    void BindRange(GLuint binding, size_t offset, size_t size) const;
+
+    // Minimum alignment of the offsets used in BindRange
+    static GLint GetOffsetAlignment();
+};
+
+// Call the base implementation with the span converted to bytes
+template<typename T>
+void UniformBufferObject::AllocateData(std::span<const T> data, Usage usage)
+{
+    AllocateData(Data::GetBytes(data), usage);
+}
+
+// Call the base implementation with the span converted to bytes
+template<typename T>
+void UniformBufferObject::UpdateData(std::span<const T> data, size_t offsetBytes)
+{
+    UpdateData(Data::GetBytes(data), offsetBytes);
+}
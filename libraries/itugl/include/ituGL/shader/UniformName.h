@@ -0,0 +1,24 @@
+#pragma once
+
+#include <ituGL/core/Hash.h>
+#include <cstdint>
+#include <string_view>
+
+// Name of a uniform, with its hash to find the location in the table of the ShaderProgram
+// The hash is computed at compile time for constants: static constexpr UniformName c_timeName("Time");
+class UniformName
+{
+public:
+    constexpr UniformName(const char* name) : m_name(name), m_hash(Hash::FNV1a(name))
+    {
+    }
+
+    inline constexpr std::string_view GetName() const { return m_name; }
+
+    inline constexpr std::uint64_t GetHash() const { return m_hash; }
+
+private:
+    std::string_view m_name;
+
+    std::uint64_t m_hash;
+};
@@ -20,6 +20,13 @@ public:
         GLsizei width, GLsizei height,
         Format format, InternalFormat internalFormat,
         std::span<const T> data, Data::Type type = Data::Type::None);
+
+    // Initialize the texture2D with data read from the bound pixel unpack buffer, starting at the offset in bytes
+    // The call returns right away, the data is copied by OpenGL while the buffer is in use
+    void SetImageFromBuffer(GLint level,
+        GLsizei width, GLsizei height,
+        Format format, InternalFormat internalFormat,
+        size_t bufferOffset, Data::Type type);
 };
 
 // Set image with data in bytes
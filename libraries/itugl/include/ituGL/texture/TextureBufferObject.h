@@ -0,0 +1,28 @@
+#pragma once
+
+#include <ituGL/texture/TextureObject.h>
+#include <ituGL/core/BufferObject.h>
+#include <ituGL/core/Data.h>
+
+// Texture object whose texels are stored in a buffer object. Read in the shaders with texelFetch on a samplerBuffer
+class TextureBufferObject : public TextureObjectBase<TextureObject::TextureBuffer>
+{
+public:
+    TextureBufferObject();
+
+    // Allocate the buffer with the data, and use it as storage interpreted with the internal format
+    void SetData(std::span<const std::byte> data, InternalFormat internalFormat, BufferObject::Usage usage = BufferObject::StreamDraw);
+
+    // Template method to set the data with any kind of data span
+    template <typename T>
+    inline void SetData(std::span<const T> data, InternalFormat internalFormat, BufferObject::Usage usage = BufferObject::StreamDraw)
+    {
+        SetData(Data::GetBytes(data), internalFormat, usage);
+    }
+
+    inline const BufferObject& GetBuffer() const { return m_buffer; }
+
+private:
+    // Buffer that stores the texels
+    BufferObjectBase<BufferObject::TextureBuffer> m_buffer;
+};
@@ -219,6 +219,10 @@ enum TextureObject::InternalFormat : GLint
     InternalFormatRG32F = GL_RG32F,
     InternalFormatRGB32F = GL_RGB32F,
     InternalFormatRGBA32F = GL_RGBA32F,
+    // 32-bit unsigned integer
+    InternalFormatR32UI = GL_R32UI,
+    InternalFormatRG32UI = GL_RG32UI,
+    InternalFormatRGBA32UI = GL_RGBA32UI,
     // sRGB
     InternalFormatSRGB8 = GL_SRGB8,
     InternalFormatSRGBA8 = GL_SRGB8_ALPHA8,
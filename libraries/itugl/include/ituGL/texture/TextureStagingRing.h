@@ -0,0 +1,79 @@
+#pragma once
+
+#include <ituGL/core/BufferObject.h>
+#include <span>
+#include <vector>
+
+// Ring of pixel unpack buffers (PBOs) to stream texture data without stalling the main thread
+// - The main thread acquires a free slot, mapped unsynchronized, and any thread writes the pixels in it
+// - The main thread uploads from the slot, and fences it. The slot is free again once the GPU passes the fence
+// The renderer never waits: acquiring fails while every slot is in use, and the caller retries later
+// Implemented as a Singleton pattern, Texture2DLoader uses the current instance for its async loads
+class TextureStagingRing
+{
+public:
+    // Returned by Acquire() when every slot is in use. Trying again later can succeed
+    static constexpr int BusySlot = -1;
+
+    // Returned by Acquire() when the data can't be staged, because it doesn't fit in a slot or mapping failed
+    static constexpr int NoSlot = -2;
+
+public:
+    // Number of slots, and size in bytes of each one. Textures larger than a slot are not staged
+    TextureStagingRing(unsigned int slotCount, size_t slotSize);
+    ~TextureStagingRing();
+
+    // Singleton method to get a pointer to the instance, null if there is none
+    inline static TextureStagingRing* GetInstancePointer() { return m_instance; }
+
+    inline unsigned int GetSlotCount() const { return static_cast<unsigned int>(m_slots.size()); }
+    inline size_t GetSlotSize() const { return m_slotSize; }
+
+    // Slots that are not mapped or being read by the GPU
+    unsigned int GetFreeSlotCount() const;
+
+    // Map a free slot, and return its index and memory. Returns BusySlot if there is no free slot, or NoSlot if it can't be staged
+    int Acquire(size_t size, std::span<std::byte>& memory);
+
+    // Unmap the slot and bind it, so the next texture uploads read from it at offset 0
+    // Returns false if the contents were lost, then the slot is released and the data needs to be uploaded in another way
+    bool BeginUpload(unsigned int slot);
+
+    // Unbind the slot and fence it after the uploads that read from it
+    void EndUpload(unsigned int slot);
+
+    // Number of slots acquired, and of failed attempts because all of them were in use, since the last reset
+    inline unsigned int GetUploadCount() const { return m_uploadCount; }
+    inline unsigned int GetBusyCount() const { return m_busyCount; }
+    inline void ResetStats() { m_uploadCount = 0; m_busyCount = 0; }
+
+private:
+    struct Slot
+    {
+        BufferObjectBase<BufferObject::PixelUnpackBuffer> buffer;
+
+        // Mapped, waiting for its data or for the upload
+        bool mapped = false;
+
+        // Fence after the last upload from this slot, null if the GPU is done with it
+        GLsync fence = nullptr;
+    };
+
+private:
+    // Check if the GPU passed the fence of the slot, and delete it if it did
+    static bool IsFenceSignaled(Slot& slot);
+
+private:
+    std::vector<Slot> m_slots;
+
+    size_t m_slotSize;
+
+    // First slot to check when acquiring, the one after the last acquired
+    unsigned int m_nextSlot;
+
+    unsigned int m_uploadCount;
+    unsigned int m_busyCount;
+
+    // Singleton instance
+    static TextureStagingRing* m_instance;
+};
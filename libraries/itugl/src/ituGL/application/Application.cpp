@@ -6,10 +6,19 @@
 #include <chrono>
 // For error messages
 #include <iostream>
+// For the command line arguments
+#include <cstring>
+#include <cstdlib>
 
 // DeviceGL and main Window are constructed in the correct order because they were declared like that!
 Application::Application(int width, int height, const char* title)
-    : m_mainWindow(width, height, title), m_currentTime(0), m_deltaTime(0), m_exitCode(0)
+    : Application(width, height, title, RunSettings())
+{
+}
+
+Application::Application(int width, int height, const char* title, const RunSettings& runSettings)
+    : m_mainWindow(width, height, title, !runSettings.headless), m_currentTime(0), m_deltaTime(0), m_frameIndex(0)
+    , m_runSettings(runSettings), m_exitCode(0)
 {
     // If the main window is not valid, exit with error
     if (!m_mainWindow.IsValid())
@@ -26,6 +35,12 @@ Application::Application(int width, int height, const char* title)
         Terminate(-2, "Failed to initialize OpenGL with GLAD");
         return;
     }
+
+    // Nobody is watching, don't wait for the display
+    if (m_runSettings.headless)
+    {
+        m_device.SetVSyncEnabled(false);
+    }
 }
 
 Application::~Application()
@@ -50,9 +65,17 @@ int Application::Run()
         // Main loop
         while (IsRunning())
         {
-            // set current time relative to start time
-            std::chrono::duration<float> duration = std::chrono::steady_clock::now() - startTime;
-            UpdateTime(duration.count());
+            if (m_runSettings.fixedDeltaTime > 0.0f)
+            {
+                // Same times in every run, independent of how long the frames take
+                UpdateTime(m_frameIndex * m_runSettings.fixedDeltaTime);
+            }
+            else
+            {
+                // set current time relative to start time
+                std::chrono::duration<float> duration = std::chrono::steady_clock::now() - startTime;
+                UpdateTime(duration.count());
+            }
 
             Update();
 
@@ -61,6 +84,12 @@ int Application::Run()
             // Swap buffers and poll events at the end of the frame
             m_mainWindow.SwapBuffers();
             m_device.PollEvents();
+
+            ++m_frameIndex;
+            if (IsRunLimitReached())
+            {
+                Close();
+            }
         }
 
         Cleanup();
@@ -116,6 +145,39 @@ void Application::UpdateTime(float newCurrentTime)
     m_currentTime = newCurrentTime;
 }
 
+bool Application::IsRunLimitReached() const
+{
+    return (m_runSettings.frameCount > 0 && m_frameIndex >= m_runSettings.frameCount)
+        || (m_runSettings.duration > 0.0f && m_currentTime >= m_runSettings.duration);
+}
+
+Application::RunSettings Application::ParseRunSettings(int argc, char* argv[])
+{
+    RunSettings runSettings;
+    for (int i = 1; i < argc; ++i)
+    {
+        // Options with a value take the next argument
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--headless") == 0)
+        {
+            runSettings.headless = true;
+        }
+        else if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+        {
+            runSettings.frameCount = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--duration") == 0 && hasValue)
+        {
+            runSettings.duration = std::strtof(argv[++i], nullptr);
+        }
+        else if (std::strcmp(argv[i], "--timestep") == 0 && hasValue)
+        {
+            runSettings.fixedDeltaTime = std::strtof(argv[++i], nullptr);
+        }
+    }
+    return runSettings;
+}
+
 bool Application::IsRunning() const
 {
     // Run while the window is valid and it has not been requested to close
@@ -0,0 +1,277 @@
+#include <ituGL/application/Benchmark.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <regex>
+#include <sstream>
+
+Benchmark::Benchmark(const Settings& settings)
+    : m_settings(settings), m_recording(false), m_recordedFrames(0)
+{
+}
+
+Benchmark::Settings Benchmark::ParseSettings(int argc, char* argv[])
+{
+    Settings settings;
+    for (int i = 1; i < argc; ++i)
+    {
+        // Options with a value take the next argument
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--benchmark") == 0 && hasValue)
+        {
+            settings.outputPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--compare") == 0 && hasValue)
+        {
+            settings.baselinePath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--threshold") == 0 && hasValue)
+        {
+            settings.threshold = std::strtof(argv[++i], nullptr);
+        }
+        else if (std::strcmp(argv[i], "--warmup") == 0 && hasValue)
+        {
+            settings.warmupFrames = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--camera-path") == 0 && hasValue)
+        {
+            settings.cameraPath = argv[++i];
+        }
+    }
+    return settings;
+}
+
+void Benchmark::AdjustRunSettings(Application::RunSettings& runSettings) const
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+
+    if (runSettings.fixedDeltaTime <= 0.0f)
+    {
+        runSettings.fixedDeltaTime = c_defaultFixedDeltaTime;
+    }
+    if (runSettings.frameCount == 0 && runSettings.duration <= 0.0f)
+    {
+        runSettings.frameCount = m_settings.warmupFrames + c_defaultFrameCount;
+    }
+}
+
+void Benchmark::BeginFrame(unsigned int frameIndex)
+{
+    m_recording = IsEnabled() && frameIndex >= m_settings.warmupFrames;
+    m_frameStart = std::chrono::steady_clock::now();
+}
+
+void Benchmark::EndFrame()
+{
+    if (m_recording)
+    {
+        std::chrono::duration<double, std::milli> frameTime = std::chrono::steady_clock::now() - m_frameStart;
+        AddSample("cpu_frame_ms", frameTime.count());
+        m_recordedFrames++;
+    }
+}
+
+void Benchmark::AddSample(const std::string& metric, double value, Direction direction)
+{
+    if (m_recording)
+    {
+        Metric& samples = m_samples[metric];
+        assert(samples.values.empty() || samples.direction == direction);
+        samples.values.push_back(value);
+        samples.direction = direction;
+    }
+}
+
+Benchmark::Stats Benchmark::GetStats(const std::string& metric) const
+{
+    Stats stats{};
+
+    auto it = m_samples.find(metric);
+    if (it == m_samples.end() || it->second.values.empty())
+    {
+        return stats;
+    }
+
+    std::vector<double> values = it->second.values;
+    std::sort(values.begin(), values.end());
+
+    stats.count = static_cast<unsigned int>(values.size());
+    stats.min = values.front();
+    stats.median = GetPercentile(values, 0.5);
+    stats.p95 = GetPercentile(values, 0.95);
+    stats.p99 = GetPercentile(values, 0.99);
+    stats.mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+    return stats;
+}
+
+// Nearest rank: the smallest value with at least this fraction of the values below or equal to it
+double Benchmark::GetPercentile(const std::vector<double>& sortedValues, double percentile)
+{
+    std::size_t rank = static_cast<std::size_t>(std::ceil(percentile * sortedValues.size()));
+    return sortedValues[std::clamp<std::size_t>(rank, 1, sortedValues.size()) - 1];
+}
+
+std::string Benchmark::ToJson() const
+{
+    std::stringstream stream;
+    stream << "{\n";
+    stream << "  \"frames\": " << m_recordedFrames << ",\n";
+    stream << "  \"warmupFrames\": " << m_settings.warmupFrames << ",\n";
+    stream << "  \"metrics\": {";
+
+    bool first = true;
+    for (const auto& [metric, samples] : m_samples)
+    {
+        Stats stats = GetStats(metric);
+        stream << (first ? "\n" : ",\n");
+        stream << "    \"" << metric << "\": { \"count\": " << stats.count
+            << ", \"min\": " << stats.min << ", \"median\": " << stats.median
+            << ", \"p95\": " << stats.p95 << ", \"p99\": " << stats.p99
+            << ", \"mean\": " << stats.mean << " }";
+        first = false;
+    }
+
+    stream << "\n  }\n}\n";
+    return stream.str();
+}
+
+bool Benchmark::Save() const
+{
+    std::ofstream file(m_settings.outputPath);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    file << ToJson();
+    return file.good();
+}
+
+bool Benchmark::Compare(std::vector<std::string>& regressions) const
+{
+    std::ifstream file(m_settings.baselinePath);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    std::stringstream stringStream;
+    stringStream << file.rdbuf();
+
+    std::map<std::string, Stats> baseline;
+    if (!ParseJson(stringStream.str(), baseline))
+    {
+        return false;
+    }
+
+    auto compareValue = [&](const std::string& metric, Direction direction, const char* statName, double baselineValue, double value)
+        {
+            // Values that were 0 can't increase by a fraction, any value is a regression
+            bool regressed = direction == Direction::LowerIsBetter
+                ? value > baselineValue * (1.0 + m_settings.threshold) && value > 0.0
+                : value < baselineValue * (1.0 - m_settings.threshold);
+            if (regressed)
+            {
+                std::stringstream message;
+                message << metric << " " << statName << ": " << baselineValue << " -> " << value;
+                if (baselineValue > 0.0)
+                {
+                    message << " (" << std::showpos << (value / baselineValue - 1.0) * 100.0 << std::noshowpos << "%)";
+                }
+                regressions.push_back(message.str());
+            }
+        };
+
+    // Metrics that are only in one of the runs are not compared
+    for (const auto& [metric, baselineStats] : baseline)
+    {
+        auto it = m_samples.find(metric);
+        if (it != m_samples.end() && it->second.direction != Direction::Informational)
+        {
+            Stats stats = GetStats(metric);
+            compareValue(metric, it->second.direction, "median", baselineStats.median, stats.median);
+            compareValue(metric, it->second.direction, "p95", baselineStats.p95, stats.p95);
+        }
+    }
+    return true;
+}
+
+int Benchmark::Finish() const
+{
+    if (!Save())
+    {
+        std::cout << "Benchmark: failed to write " << m_settings.outputPath << std::endl;
+        return 2;
+    }
+    std::cout << "Benchmark: " << m_recordedFrames << " frames written to " << m_settings.outputPath << std::endl;
+
+    if (m_settings.baselinePath.empty())
+    {
+        return 0;
+    }
+
+    std::vector<std::string> regressions;
+    if (!Compare(regressions))
+    {
+        std::cout << "Benchmark: failed to read baseline " << m_settings.baselinePath << std::endl;
+        return 2;
+    }
+
+    for (const std::string& regression : regressions)
+    {
+        std::cout << "Benchmark regression: " << regression << std::endl;
+    }
+    return regressions.empty() ? 0 : 1;
+}
+
+bool Benchmark::ParseJson(const std::string& json, std::map<std::string, Stats>& metrics)
+{
+    // Each metric is an object without nested objects: "name": { "stat": value, ... }
+    std::regex metricRegex("\"([^\"]+)\"\\s*:\\s*\\{([^{}]*)\\}");
+    std::regex valueRegex("\"(\\w+)\"\\s*:\\s*([-+0-9.eE]+)");
+    for (auto it = std::sregex_iterator(json.begin(), json.end(), metricRegex); it != std::sregex_iterator(); ++it)
+    {
+        Stats stats{};
+        const std::string values = (*it)[2].str();
+        for (auto valueIt = std::sregex_iterator(values.begin(), values.end(), valueRegex); valueIt != std::sregex_iterator(); ++valueIt)
+        {
+            std::string name = (*valueIt)[1].str();
+            double value = std::strtod((*valueIt)[2].str().c_str(), nullptr);
+            if (name == "count")
+            {
+                stats.count = static_cast<unsigned int>(value);
+            }
+            else if (name == "min")
+            {
+                stats.min = value;
+            }
+            else if (name == "median")
+            {
+                stats.median = value;
+            }
+            else if (name == "p95")
+            {
+                stats.p95 = value;
+            }
+            else if (name == "p99")
+            {
+                stats.p99 = value;
+            }
+            else if (name == "mean")
+            {
+                stats.mean = value;
+            }
+        }
+        metrics[(*it)[1].str()] = stats;
+    }
+    return !metrics.empty();
+}
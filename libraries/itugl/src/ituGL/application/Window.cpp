@@ -1,13 +1,15 @@
 #include <ituGL/application/Window.h>
 
 // Create the internal GLFW window. We provide some hints about it to OpenGL
-Window::Window(int width, int height, const char* title) : m_window(nullptr)
+Window::Window(int width, int height, const char* title, bool visible) : m_window(nullptr)
 {
     // Set some hints for window creation
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
+    glfwWindowHint(GLFW_RESIZABLE, visible ? GLFW_TRUE : GLFW_FALSE);
 
     m_window = glfwCreateWindow(width, height, title, nullptr, nullptr);
 }
@@ -0,0 +1,170 @@
+#include <ituGL/asset/AssetJobQueue.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cassert>
+
+AssetJobQueue* AssetJobQueue::m_instance = nullptr;
+
+AssetJobQueue::AssetJobQueue(unsigned int workerCount) : m_pendingCount(0), m_stopping(false)
+{
+    assert(!m_instance);
+    m_instance = this;
+
+    if (workerCount == 0)
+    {
+        // hardware_concurrency() can return 0 if it is unknown
+        workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+
+    m_workers.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        m_workers.emplace_back(&AssetJobQueue::RunWorker, this);
+    }
+}
+
+AssetJobQueue::~AssetJobQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_workerCondition.notify_all();
+
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+
+    assert(m_instance == this);
+    m_instance = nullptr;
+}
+
+void AssetJobQueue::EnqueueWorkerJob(Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_workerJobs.push_back(std::move(job));
+        ++m_pendingCount;
+    }
+    m_workerCondition.notify_one();
+}
+
+void AssetJobQueue::EnqueueMainThreadJob(Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_mainThreadJobs.push_back(std::move(job));
+        ++m_pendingCount;
+    }
+    m_mainThreadCondition.notify_one();
+}
+
+unsigned int AssetJobQueue::ProcessMainThreadJobs(double budget)
+{
+    auto startTime = std::chrono::steady_clock::now();
+
+    // Jobs queued while processing wait for the next call, so a job can retry later by queueing itself again
+    size_t queuedCount;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        queuedCount = m_mainThreadJobs.size();
+    }
+
+    unsigned int jobCount = 0;
+    Job job;
+    while (jobCount < queuedCount && PopMainThreadJob(job))
+    {
+        job();
+        job = nullptr;
+        CompleteJob();
+        ++jobCount;
+
+        std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - startTime;
+        if (duration.count() >= budget)
+        {
+            break;
+        }
+    }
+    return jobCount;
+}
+
+void AssetJobQueue::Flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_pendingCount > 0)
+    {
+        if (m_mainThreadJobs.empty())
+        {
+            // Only worker jobs left, they will queue main thread jobs or complete
+            m_mainThreadCondition.wait(lock);
+            continue;
+        }
+
+        Job job = std::move(m_mainThreadJobs.front());
+        m_mainThreadJobs.pop_front();
+
+        lock.unlock();
+        job();
+        job = nullptr;
+        lock.lock();
+
+        --m_pendingCount;
+    }
+}
+
+bool AssetJobQueue::IsIdle() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pendingCount == 0;
+}
+
+void AssetJobQueue::RunWorker()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_workerCondition.wait(lock, [this]() { return m_stopping || !m_workerJobs.empty(); });
+        if (m_stopping)
+        {
+            break;
+        }
+
+        Job job = std::move(m_workerJobs.front());
+        m_workerJobs.pop_front();
+
+        // Release the job, and whatever it captured, outside of the lock
+        lock.unlock();
+        job();
+        job = nullptr;
+        CompleteJob();
+        lock.lock();
+    }
+}
+
+bool AssetJobQueue::PopMainThreadJob(Job& job)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool found = !m_mainThreadJobs.empty();
+    if (found)
+    {
+        job = std::move(m_mainThreadJobs.front());
+        m_mainThreadJobs.pop_front();
+    }
+    return found;
+}
+
+void AssetJobQueue::CompleteJob()
+{
+    bool complete;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        assert(m_pendingCount > 0);
+        complete = --m_pendingCount == 0;
+    }
+    if (complete)
+    {
+        m_mainThreadCondition.notify_all();
+    }
+}
@@ -3,17 +3,57 @@
 #include <ituGL/geometry/VertexFormat.h>
 #include <ituGL/shader/Material.h>
 #include <ituGL/asset/Texture2DLoader.h>
+#include <ituGL/asset/AssetJobQueue.h>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <glm/common.hpp>
 #include <iostream>
+#include <limits>
 #include <bit>
+#include <cstring>
+
+const unsigned int ModelLoader::c_importFlags = aiProcess_CalcTangentSpace | aiProcess_GenNormals | aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SortByPType;
+
+struct ModelLoader::MeshData
+{
+    VertexFormat vertexFormat;
+    bool interleaved = true;
+    std::vector<GLubyte> vertexData;
+
+    Data::Type elementType = Data::Type::None;
+    std::vector<GLubyte> elementData;
+
+    // Primitive of each group of elements, and the byte offsets where they end
+    std::vector<Drawcall::Primitive> primitives;
+    std::vector<int> elementCounts;
+
+    unsigned int vertexCount = 0;
+    unsigned int materialIndex = 0;
+
+    glm::vec3 boundsMin = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+};
+
+struct ModelLoader::AsyncLoad
+{
+    std::string path;
+
+    // Owns the scene until the model is complete
+    Assimp::Importer importer;
+
+    std::vector<MeshData> meshes;
+    std::vector<std::shared_ptr<Material>> materials;
+
+    std::shared_ptr<Model> model;
+};
 
 ModelLoader::ModelLoader(std::shared_ptr<Material> referenceMaterial)
     : m_referenceMaterial(referenceMaterial)
     , m_createMaterials(false)
+    , m_textureLoader(std::make_shared<Texture2DLoader>())
 {
-    m_textureLoader.SetGenerateMipmap(true);
+    m_textureLoader->SetGenerateMipmap(true);
 }
 
 std::shared_ptr<Material> ModelLoader::GetReferenceMaterial() const
@@ -41,12 +81,22 @@ void ModelLoader::SetCreateMaterials(bool createMaterials)
 
 Texture2DLoader& ModelLoader::GetTexture2DLoader()
 {
-    return m_textureLoader;
+    return *m_textureLoader;
 }
 
 const Texture2DLoader& ModelLoader::GetTexture2DLoader() const
 {
-    return m_textureLoader;
+    return *m_textureLoader;
+}
+
+std::shared_ptr<GeometryArena> ModelLoader::GetGeometryArena() const
+{
+    return m_geometryArena;
+}
+
+void ModelLoader::SetGeometryArena(std::shared_ptr<GeometryArena> geometryArena)
+{
+    m_geometryArena = geometryArena;
 }
 
 bool ModelLoader::SetMaterialAttribute(VertexAttribute::Semantic semantic, const char* attributeName)
@@ -79,63 +129,185 @@ Model ModelLoader::Load(const char* path)
 
     // Read the file using Assimp importer
     Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(path,
-        aiProcess_CalcTangentSpace | aiProcess_GenNormals | aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SortByPType);
+    const aiScene* scene = importer.ReadFile(path, c_importFlags);
 
-    m_baseFolder = path;
-    m_baseFolder.resize(m_baseFolder.rfind('/') + 1);
+    SetBaseFolder(path);
 
     // If the file was loaded, load all the meshes as submeshes
     if (scene)
     {
         model.SetMesh(std::make_shared<Mesh>());
-        Mesh& mesh = model.GetMesh();
+
+        // Submeshes using the same scene material share one generated material
+        std::vector<std::shared_ptr<Material>> materials(m_createMaterials ? scene->mNumMaterials : 0);
         for (unsigned int meshIndex = 0; meshIndex < scene->mNumMeshes; ++meshIndex)
         {
-            aiMesh& meshData = *scene->mMeshes[meshIndex];
-            GenerateSubmesh(mesh, meshData);
+            MeshData meshData = CollectMeshData(*scene->mMeshes[meshIndex]);
+            AddMesh(model, meshData, *scene, materials, false);
+        }
+    }
+
+    return model;
+}
+
+AssetHandle<Model> ModelLoader::LoadAsync(const char* path)
+{
+    AssetHandle<Model> handle = AssetHandle<Model>::Create();
+
+    AssetJobQueue* jobQueue = AssetJobQueue::GetInstancePointer();
+    if (!jobQueue)
+    {
+        handle.SetReady(std::make_shared<Model>(Load(path)));
+        return handle;
+    }
+
+    // The jobs can outlive this loader, they use a copy
+    std::shared_ptr<ModelLoader> loader = std::make_shared<ModelLoader>(*this);
+    loader->SetBaseFolder(path);
+
+    std::shared_ptr<AsyncLoad> load = std::make_shared<AsyncLoad>();
+    load->path = path;
+    load->model = std::make_shared<Model>();
+
+    jobQueue->EnqueueWorkerJob([loader, load, handle]()
+        {
+            // Parse and collect the data of all the meshes
+            const aiScene* scene = load->importer.ReadFile(load->path, c_importFlags);
+            if (scene)
+            {
+                // Nobody has the model yet, it can be modified here
+                load->model->SetMesh(std::make_shared<Mesh>());
+
+                load->meshes.reserve(scene->mNumMeshes);
+                for (unsigned int meshIndex = 0; meshIndex < scene->mNumMeshes; ++meshIndex)
+                {
+                    load->meshes.push_back(CollectMeshData(*scene->mMeshes[meshIndex]));
+                }
+                load->materials.resize(loader->m_createMaterials ? scene->mNumMaterials : 0);
+            }
 
-            std::shared_ptr<Material> material = m_referenceMaterial;
-            if (m_createMaterials)
+            // Create the buffers of each mesh in a separate job, so they can be spread over several frames
+            AssetJobQueue& jobQueue = *AssetJobQueue::GetInstancePointer();
+            for (unsigned int meshIndex = 0; meshIndex < load->meshes.size(); ++meshIndex)
             {
-                // Create a new material with the material data
-                material = GenerateMaterial(*scene->mMaterials[meshData.mMaterialIndex]);
+                jobQueue.EnqueueMainThreadJob([loader, load, meshIndex]()
+                    {
+                        MeshData& meshData = load->meshes[meshIndex];
+                        loader->AddMesh(*load->model, meshData, *load->importer.GetScene(), load->materials, true);
+
+                        // Collected data is not needed anymore
+                        meshData = MeshData();
+                    });
             }
-            model.AddMaterial(material);
+
+            jobQueue.EnqueueMainThreadJob([load, handle]() mutable
+                {
+                    // Release the scene before anyone gets the model
+                    load->importer.FreeScene();
+                    load->meshes.clear();
+                    load->materials.clear();
+
+                    handle.SetReady(load->model);
+                });
+        });
+
+    return handle;
+}
+
+void ModelLoader::SetBaseFolder(const char* path)
+{
+    m_baseFolder = path;
+    m_baseFolder.resize(m_baseFolder.rfind('/') + 1);
+}
+
+void ModelLoader::AddMesh(Model& model, MeshData& meshData, const aiScene& scene, std::vector<std::shared_ptr<Material>>& materials, bool loadTexturesAsync)
+{
+    GenerateSubmesh(model.GetMesh(), meshData);
+
+    std::shared_ptr<Material> material = m_referenceMaterial;
+    if (m_createMaterials)
+    {
+        // Create a new material with the material data, the first time it is used
+        std::shared_ptr<Material>& sceneMaterial = materials[meshData.materialIndex];
+        if (!sceneMaterial)
+        {
+            sceneMaterial = GenerateMaterial(*scene.mMaterials[meshData.materialIndex], loadTexturesAsync);
         }
+        material = sceneMaterial;
     }
-
-    return model;
+    model.AddMaterial(material);
 }
 
-void ModelLoader::GenerateSubmesh(Mesh& mesh, const aiMesh& meshData)
+ModelLoader::MeshData ModelLoader::CollectMeshData(const aiMesh& meshData)
 {
+    MeshData data;
+    data.vertexCount = meshData.mNumVertices;
+    data.materialIndex = meshData.mMaterialIndex;
+
     // Collect vertex data
-    VertexFormat vertexFormat;
-    bool interleaved = true;
-    std::vector<GLubyte> vertexData = CollectVertexData(meshData, vertexFormat, interleaved);
-    int vboIndex = mesh.AddVertexData<GLubyte>(vertexData);
+    data.vertexData = CollectVertexData(meshData, data.vertexFormat, data.interleaved);
 
     // Collect element data
-    Data::Type elementType;
-    std::vector<Drawcall::Primitive> primitives;
-    std::vector<int> elementCounts;
-    std::vector<GLubyte> elementData = CollectElementData(meshData, elementType, primitives, elementCounts);
-    int eboIndex = mesh.AddElementData<GLubyte>(elementData);
+    data.elementData = CollectElementData(meshData, data.elementType, data.primitives, data.elementCounts);
+
+    // Local bounds, shared by all the submeshes created from this mesh data
+    for (unsigned int vertexIndex = 0; vertexIndex < meshData.mNumVertices; ++vertexIndex)
+    {
+        const aiVector3D& position = meshData.mVertices[vertexIndex];
+        data.boundsMin = glm::min(data.boundsMin, glm::vec3(position.x, position.y, position.z));
+        data.boundsMax = glm::max(data.boundsMax, glm::vec3(position.x, position.y, position.z));
+    }
+
+    return data;
+}
 
-    // Add submeshes
+void ModelLoader::GenerateSubmesh(Mesh& mesh, MeshData& meshData)
+{
+    VertexFormat& vertexFormat = meshData.vertexFormat;
+    std::vector<GLubyte>& vertexData = meshData.vertexData;
+    std::vector<GLubyte>& elementData = meshData.elementData;
+    Data::Type elementType = meshData.elementType;
+    int elementSize = Data::GetTypeSize(elementType);
+
+    // Store the data in the arena if there is one, and in buffers owned by the mesh if the arena is full
+    GeometryArena::Allocation allocation;
+    if (m_geometryArena)
+    {
+        std::vector<GLuint> elements = WidenElementData(elementData, elementType);
+        allocation = mesh.AddArenaData(m_geometryArena, vertexFormat, Data::GetBytes(std::span<const GLubyte>(vertexData)), elements, m_materialAttributeMap);
+    }
+    int vboIndex = -1;
+    int eboIndex = -1;
+    if (!allocation.IsValid())
+    {
+        vboIndex = mesh.AddVertexData<GLubyte>(vertexData);
+        eboIndex = mesh.AddElementData<GLubyte>(elementData);
+    }
+
+    AabbBounds bounds(0.5f * (meshData.boundsMin + meshData.boundsMax), 0.5f * (meshData.boundsMax - meshData.boundsMin));
+
+    // Add submeshes. Element counts are the byte offsets where each group of primitives ends
+    std::vector<Drawcall::Primitive>& primitives = meshData.primitives;
+    std::vector<int>& elementCounts = meshData.elementCounts;
     int start = 0;
     assert(primitives.size() == elementCounts.size());
     for (int i = 0; i < primitives.size(); ++i)
     {
         Drawcall::Primitive primitive = primitives[i];
         int end = elementCounts[i];
-        mesh.AddSubmesh(primitive, start, end - start, elementType, eboIndex, vboIndex, vertexFormat.LayoutBegin(static_cast<int>(vertexData.size()), interleaved), vertexFormat.LayoutEnd(), m_materialAttributeMap);
+        int elementCount = (end - start) / elementSize;
+        unsigned int submeshIndex = allocation.IsValid()
+            ? mesh.AddArenaSubmesh(allocation, primitive, start / elementSize, elementCount)
+            : mesh.AddSubmesh(primitive, start, elementCount, elementType, vboIndex, eboIndex, vertexFormat.LayoutBegin(meshData.vertexCount, meshData.interleaved), vertexFormat.LayoutEnd(), m_materialAttributeMap);
+        if (meshData.vertexCount > 0)
+        {
+            mesh.SetSubmeshBounds(submeshIndex, bounds);
+        }
         start = end;
     }
 }
 
-std::shared_ptr<Material> ModelLoader::GenerateMaterial(const aiMaterial& materialData)
+std::shared_ptr<Material> ModelLoader::GenerateMaterial(const aiMaterial& materialData, bool loadTexturesAsync)
 {
     std::shared_ptr<Material> material = std::make_shared<Material>(*m_referenceMaterial);
     float value;
@@ -171,13 +343,13 @@ std::shared_ptr<Material> ModelLoader::GenerateMaterial(const aiMaterial& materi
             }
             break;
         case MaterialProperty::DiffuseTexture:
-            LoadTexture(materialData, aiTextureType_DIFFUSE, *material, location, TextureObject::FormatRGBA, TextureObject::InternalFormatSRGBA8);
+            LoadTexture(materialData, aiTextureType_DIFFUSE, *material, location, TextureObject::FormatRGBA, TextureObject::InternalFormatSRGBA8, loadTexturesAsync);
             break;
         case MaterialProperty::NormalTexture:
-            LoadTexture(materialData, aiTextureType_NORMALS, *material, location, TextureObject::FormatRGB, TextureObject::InternalFormatRGB8);
+            LoadTexture(materialData, aiTextureType_NORMALS, *material, location, TextureObject::FormatRGB, TextureObject::InternalFormatRGB8, loadTexturesAsync);
             break;
         case MaterialProperty::SpecularTexture:
-            LoadTexture(materialData, aiTextureType_SHININESS, *material, location, TextureObject::FormatRGB, TextureObject::InternalFormatSRGB8);
+            LoadTexture(materialData, aiTextureType_SHININESS, *material, location, TextureObject::FormatRGB, TextureObject::InternalFormatSRGB8, loadTexturesAsync);
             break;
         }
     }
@@ -185,7 +357,7 @@ std::shared_ptr<Material> ModelLoader::GenerateMaterial(const aiMaterial& materi
 }
 
 void ModelLoader::LoadTexture(const aiMaterial& materialData, int textureTypeValue, Material& material, ShaderProgram::Location location,
-    TextureObject::Format format, TextureObject::InternalFormat internalFormat) const
+    TextureObject::Format format, TextureObject::InternalFormat internalFormat, bool loadTexturesAsync) const
 {
     aiTextureType textureType = static_cast<aiTextureType>(textureTypeValue);
     if (materialData.GetTextureCount(textureType) > 0)
@@ -195,9 +367,11 @@ void ModelLoader::LoadTexture(const aiMaterial& materialData, int textureTypeVal
         if (materialData.GetTexture(textureType, 0, &texturePath) == aiReturn_SUCCESS)
         {
             texturePath = m_baseFolder + texturePath.C_Str();
-            m_textureLoader.SetFormat(format);
-            m_textureLoader.SetInternalFormat(internalFormat);
-            std::shared_ptr<Texture2DObject> texture = m_textureLoader.LoadShared(texturePath.C_Str());
+            m_textureLoader->SetFormat(format);
+            m_textureLoader->SetInternalFormat(internalFormat);
+            std::shared_ptr<Texture2DObject> texture = loadTexturesAsync
+                ? m_textureLoader->LoadSharedAsync(texturePath.C_Str()).Get()
+                : m_textureLoader->LoadShared(texturePath.C_Str());
             material.SetUniformValue(location, texture);
         }
     }
@@ -300,6 +474,34 @@ std::vector<GLubyte> ModelLoader::CollectElementData(const aiMesh& meshData, Dat
     return elementData;
 }
 
+std::vector<GLuint> ModelLoader::WidenElementData(std::span<const GLubyte> elementData, Data::Type elementType)
+{
+    int elementSize = Data::GetTypeSize(elementType);
+    std::vector<GLuint> elements(elementData.size() / elementSize);
+    for (size_t i = 0; i < elements.size(); ++i)
+    {
+        const GLubyte* element = &elementData[i * elementSize];
+        switch (elementType)
+        {
+        case Data::Type::UByte:
+            elements[i] = *element;
+            break;
+        case Data::Type::UShort:
+        {
+            GLushort value;
+            std::memcpy(&value, element, sizeof(value));
+            elements[i] = value;
+            break;
+        }
+        default:
+            assert(elementType == Data::Type::UInt);
+            std::memcpy(&elements[i], element, sizeof(GLuint));
+            break;
+        }
+    }
+    return elements;
+}
+
 const void* ModelLoader::GetVertexDataPointer(const aiMesh& meshData, VertexAttribute::Semantic semantic, int& stride)
 {
     const void* data = nullptr;
@@ -1,12 +1,15 @@
 #include <ituGL/asset/ShaderLoader.h>
 
+#include <ituGL/shader/ShaderBuildBatch.h>
+#include <ituGL/shader/ShaderProgramCache.h>
+#include <ituGL/core/Hash.h>
 #include <fstream>
 #include <sstream>
 #include <vector>
-#include <array>
 #include <cassert>
 
-#include <iostream>
+std::unordered_map<std::string, std::string> ShaderLoader::s_files;
+std::unordered_map<std::uint64_t, std::shared_ptr<Shader>> ShaderLoader::s_sharedShaders;
 
 ShaderLoader::ShaderLoader(Shader::Type type) : m_type(type)
 {
@@ -24,31 +27,14 @@ bool ShaderLoader::IsValid(std::span<const char*> paths)
 
 Shader ShaderLoader::Load(const char* path)
 {
-    Shader shader(m_type);
-    std::ifstream file(path);
-    assert(file.is_open());
-    std::stringstream stringStream;
-    stringStream << file.rdbuf() << '\0';
-    shader.SetSource(stringStream.str().c_str());
-    Compile(shader);
-    return shader;
+    return Load(std::span(&path, 1));
 }
 
 Shader ShaderLoader::Load(std::span<const char*> paths)
 {
+    std::string source = Preprocess(paths);
     Shader shader(m_type);
-    std::vector<std::stringstream> stringStreams(paths.size());
-    std::vector<std::string> sourceCodeStrings(paths.size());
-    std::vector<const char*> sourceCode(paths.size());
-    for (int i = 0; i < paths.size(); ++i)
-    {
-        std::ifstream file(paths[i]);
-        assert(file.is_open());
-        stringStreams[i] << file.rdbuf() << '\0';
-        sourceCodeStrings[i] = stringStreams[i].str();
-        sourceCode[i] = sourceCodeStrings[i].c_str();
-    }
-    shader.SetSource(sourceCode);
+    shader.SetSource(source.c_str());
     Compile(shader);
     return shader;
 }
@@ -73,36 +59,53 @@ bool ShaderLoader::LoadInto(Shader& shader, std::span<const char*> paths)
     return valid;
 }
 
-void ShaderLoader::Compile(Shader& shader)
+std::shared_ptr<Shader> ShaderLoader::LoadShared(const char* path)
+{
+    return LoadShared(std::span(&path, 1));
+}
+
+std::shared_ptr<Shader> ShaderLoader::LoadShared(std::span<const char*> paths)
 {
-    if (!shader.Compile())
+    std::string source = Preprocess(paths);
+
+    // Different lists of files can resolve to the same source, so the source is used as the key instead of the paths
+    std::uint64_t key = Hash::Combine(Hash::FNV1a(source), m_type);
+    auto itShader = s_sharedShaders.find(key);
+    if (itShader != s_sharedShaders.end())
     {
-        std::array<char, 512> infoLog;
-        shader.GetCompilationErrors(infoLog);
+        return itShader->second;
+    }
 
-        const char* typeName = "UNKNOWN";
-        switch (shader.GetType())
-        {
-        case Shader::ComputeShader:
-            typeName = "COMPUTE";
-            break;
-        case Shader::VertexShader:
-            typeName = "VERTEX";
-            break;
-        case Shader::TesselationControlShader:
-            typeName = "TCS";
-            break;
-        case Shader::TesselationEvaluationShader:
-            typeName = "TES";
-            break;
-        case Shader::GeometryShader:
-            typeName = "GEOMETRY";
-            break;
-        case Shader::FragmentShader:
-            typeName = "FRAGMENT";
-            break;
-        }
-        std::cout << "ERROR::SHADER::" << typeName << "::COMPILATION_FAILED\n" << infoLog.data() << std::endl;
+    std::shared_ptr<Shader> shader = std::make_shared<Shader>(m_type);
+    shader->SetSource(source.c_str());
+    Compile(*shader);
+    if (GetKeepShared())
+    {
+        s_sharedShaders.insert(std::make_pair(key, shader));
+    }
+    return shader;
+}
+
+Shader ShaderLoader::LoadSource(std::span<const char*> sourceCode)
+{
+    Shader shader(m_type);
+    shader.SetSource(sourceCode);
+    Compile(shader);
+    return shader;
+}
+
+void ShaderLoader::Compile(Shader& shader)
+{
+    // With the program cache, the shader is compiled by ShaderProgram::Build, only if the program is not in the cache
+    // In a batch, ShaderProgram::Build compiles it without waiting for the result
+    ShaderProgramCache* cache = ShaderProgramCache::GetInstancePointer();
+    if ((cache && cache->IsEnabled()) || ShaderBuildBatch::GetCurrent())
+    {
+        shader.DeferCompile();
+    }
+    else if (!shader.Compile())
+    {
+        shader.PrintCompilationErrors();
     }
 }
 
@@ -111,3 +114,107 @@ Shader ShaderLoader::Load(Shader::Type type, const char* path)
     ShaderLoader shaderLoader(type);
     return shaderLoader.Load(path);
 }
+
+std::string ShaderLoader::Preprocess(std::span<const char*> paths)
+{
+    std::string source;
+    std::unordered_set<std::string> includedFiles;
+    for (const char* path : paths)
+    {
+        AppendFile(path, source, includedFiles);
+    }
+    return source;
+}
+
+void ShaderLoader::ClearCache()
+{
+    s_files.clear();
+    s_sharedShaders.clear();
+}
+
+void ShaderLoader::AppendFile(const std::filesystem::path& path, std::string& source, std::unordered_set<std::string>& includedFiles)
+{
+    if (!includedFiles.insert(path.lexically_normal().generic_string()).second)
+    {
+        return;
+    }
+
+    // Each file gets its own source string number, so the errors point to the right file and line
+    // In GLSL 330, the line after "#line N" is N + 1. The #version line must be the first one, so the first file has no #line
+    std::string fileNumber = std::to_string(includedFiles.size() - 1);
+    if (!source.empty())
+    {
+        source += "#line 0 " + fileNumber + "\n";
+    }
+
+    const std::string& contents = ReadFile(path);
+    std::size_t lineStart = 0;
+    unsigned int lineNumber = 1;
+    while (lineStart < contents.size())
+    {
+        std::size_t lineEnd = contents.find('\n', lineStart);
+        lineEnd = lineEnd == std::string::npos ? contents.size() : lineEnd + 1;
+        std::string_view line(contents.data() + lineStart, lineEnd - lineStart);
+
+        std::string_view includePath;
+        if (FindInclude(line, includePath))
+        {
+            AppendFile(path.parent_path() / includePath, source, includedFiles);
+            source += "#line " + std::to_string(lineNumber) + " " + fileNumber + "\n";
+        }
+        else
+        {
+            source += line;
+        }
+
+        lineStart = lineEnd;
+        ++lineNumber;
+    }
+
+    // The last line could be joined with the first line of the next file
+    if (!source.empty() && source.back() != '\n')
+    {
+        source += '\n';
+    }
+}
+
+bool ShaderLoader::FindInclude(std::string_view line, std::string_view& includePath)
+{
+    // Matches: #include "path", with optional spaces
+    std::size_t position = line.find_first_not_of(" \t");
+    if (position == std::string_view::npos || line[position] != '#')
+    {
+        return false;
+    }
+
+    position = line.find_first_not_of(" \t", position + 1);
+    if (position == std::string_view::npos || line.compare(position, 7, "include") != 0)
+    {
+        return false;
+    }
+
+    std::size_t pathStart = line.find('"', position + 7);
+    std::size_t pathEnd = pathStart != std::string_view::npos ? line.find('"', pathStart + 1) : std::string_view::npos;
+    if (pathEnd == std::string_view::npos)
+    {
+        return false;
+    }
+
+    includePath = line.substr(pathStart + 1, pathEnd - pathStart - 1);
+    return true;
+}
+
+const std::string& ShaderLoader::ReadFile(const std::filesystem::path& path)
+{
+    std::string key = path.lexically_normal().generic_string();
+    auto itFile = s_files.find(key);
+    if (itFile == s_files.end())
+    {
+        std::ifstream file(path);
+        assert(file.is_open());
+        std::stringstream stringStream;
+        stringStream << file.rdbuf();
+        itFile = s_files.insert(std::make_pair(key, stringStream.str())).first;
+    }
+    return itFile->second;
+}
@@ -1,6 +1,27 @@
 #include <ituGL/asset/Texture2DLoader.h>
 
+#include <ituGL/asset/AssetJobQueue.h>
+#include <ituGL/texture/TextureStagingRing.h>
 #include <cassert>
+#include <cmath>
+#include <cstring>
+
+struct Texture2DLoader::AsyncLoad
+{
+    std::string path;
+
+    std::shared_ptr<Texture2DObject> texture2D;
+    AssetHandle<Texture2DObject> handle;
+
+    // Copy of the loader settings
+    TextureObject::Format format = TextureObject::FormatInvalid;
+    TextureObject::InternalFormat internalFormat = TextureObject::InternalFormatInvalid;
+    bool generateMipmap = false;
+    bool flipVertical = false;
+
+    // Written by the decoding worker
+    DecodedImage image;
+};
 
 Texture2DLoader::Texture2DLoader()
     : m_flipVertical(false)
@@ -13,43 +34,161 @@ Texture2DLoader::Texture2DLoader(TextureObject::Format format, TextureObject::In
 {
 }
 
+Texture2DLoader::DecodedImage::~DecodedImage()
+{
+    // Loaded data is not needed anymore
+    if (!data.empty())
+    {
+        TextureLoaderUtils::FreeTexture2DData(data);
+    }
+}
+
 Texture2DObject Texture2DLoader::Load(const char* path)
 {
     Texture2DObject texture2D;
 
     // Load texture data using stbimage library
-    int width, height;
-    Data::Type dataType;
-    std::span<const std::byte> data = LoadTexture2DData(path, width, height, dataType, m_flipVertical);
+    DecodedImage image;
+    image.data = LoadTexture2DData(path, image.width, image.height, image.dataType, m_flipVertical);
 
-    // If data was loaded, copy it to the texture object
-    assert(!data.empty());
-    if (!data.empty())
+    // If data was loaded, copy it to the texture object. Loaded data is freed with the image
+    assert(!image.data.empty());
+    if (!image.data.empty())
     {
-        texture2D.Bind();
-        texture2D.SetImage<std::byte>(0, width, height, m_format, m_internalFormat, data, dataType);
+        UploadImage(texture2D, image, m_format, m_internalFormat, m_generateMipmap);
+    }
+    return texture2D;
+}
+
+AssetHandle<Texture2DObject> Texture2DLoader::LoadSharedAsync(const char* path)
+{
+    std::string pathString(path);
+
+    // Requested before, return the same handle, even if it is not ready yet
+    auto itHandle = m_asyncTextures.find(pathString);
+    if (itHandle != m_asyncTextures.end())
+    {
+        return itHandle->second;
+    }
+
+    AssetHandle<Texture2DObject> handle = AssetHandle<Texture2DObject>::Create();
+
+    AssetJobQueue* jobQueue = AssetJobQueue::GetInstancePointer();
+    std::shared_ptr<Texture2DObject> texture2D = FindSharedAsset(pathString);
+    if (texture2D || !jobQueue)
+    {
+        // Already loaded, or no workers to load it
+        handle.SetReady(texture2D ? texture2D : LoadShared(path));
+        return handle;
+    }
+
+    // Create the object now, so it can be shared before it has the image
+    texture2D = std::make_shared<Texture2DObject>();
+    handle.SetAsset(texture2D);
+    AddSharedAsset(pathString, texture2D);
+    if (GetKeepShared())
+    {
+        m_asyncTextures.insert(std::make_pair(pathString, handle));
+    }
 
-        texture2D.SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR);
-        texture2D.SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
+    // The jobs can outlive the loader, they keep a copy of the settings
+    std::shared_ptr<AsyncLoad> load = std::make_shared<AsyncLoad>();
+    load->path = pathString;
+    load->texture2D = texture2D;
+    load->handle = handle;
+    load->format = m_format;
+    load->internalFormat = m_internalFormat;
+    load->generateMipmap = m_generateMipmap;
+    load->flipVertical = m_flipVertical;
 
-        // Generate mipmap if needed
-        if (m_generateMipmap)
+    jobQueue->EnqueueWorkerJob([load]()
         {
-            texture2D.GenerateMipmap();
-            texture2D.SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR_MIPMAP_LINEAR);
+            DecodedImage& image = load->image;
+            image.data = TextureLoaderUtils::LoadTexture2DData(load->path.c_str(), image.width, image.height, image.dataType,
+                load->format, load->internalFormat, load->flipVertical);
 
-            // Adjust mip levels
-            texture2D.SetParameter(TextureObject::ParameterFloat::MinLod, 0.0f);
-            float maxLod = 1.0f + std::floorf(std::log2f(static_cast<float>(std::max(width, height))));
-            texture2D.SetParameter(TextureObject::ParameterFloat::MaxLod, maxLod);
+            AssetJobQueue::GetInstancePointer()->EnqueueMainThreadJob([load]() { UploadAsync(load); });
+        });
+
+    return handle;
+}
+
+void Texture2DLoader::UploadAsync(std::shared_ptr<AsyncLoad> load)
+{
+    AssetJobQueue& jobQueue = *AssetJobQueue::GetInstancePointer();
+    TextureStagingRing* stagingRing = TextureStagingRing::GetInstancePointer();
+
+    const DecodedImage& image = load->image;
+    assert(!image.data.empty());
+    if (stagingRing && !image.data.empty() && image.data.size() <= stagingRing->GetSlotSize())
+    {
+        std::span<std::byte> memory;
+        int slot = stagingRing->Acquire(image.data.size(), memory);
+        if (slot == TextureStagingRing::BusySlot)
+        {
+            // The GPU is still reading all the slots, try again in the next frame
+            jobQueue.EnqueueMainThreadJob([load]() { UploadAsync(load); });
+            return;
         }
 
-        texture2D.Unbind();
+        if (slot >= 0)
+        {
+            // Copy to the mapped slot in a worker, and upload from the slot on the main thread
+            jobQueue.EnqueueWorkerJob([load, memory, slot]()
+                {
+                    std::memcpy(memory.data(), load->image.data.data(), load->image.data.size());
 
-        // Free loaded data (not needed anymore)
-        FreeTexture2DData(data);
+                    AssetJobQueue::GetInstancePointer()->EnqueueMainThreadJob([load, slot]()
+                        {
+                            UploadImage(*load->texture2D, load->image, load->format, load->internalFormat, load->generateMipmap, slot);
+                            load->handle.SetReady(load->texture2D);
+                        });
+                });
+            return;
+        }
     }
-    return texture2D;
+
+    // Without staging, too large for it, or if the slot couldn't be mapped, upload from the decoded data
+    if (!image.data.empty())
+    {
+        UploadImage(*load->texture2D, image, load->format, load->internalFormat, load->generateMipmap);
+    }
+    load->handle.SetReady(load->texture2D);
+}
+
+void Texture2DLoader::UploadImage(Texture2DObject& texture2D, const DecodedImage& image,
+    TextureObject::Format format, TextureObject::InternalFormat internalFormat, bool generateMipmap, int stagingSlot)
+{
+    texture2D.Bind();
+
+    // Read from the staging slot if there is one, and it was not lost while it was mapped
+    TextureStagingRing* stagingRing = TextureStagingRing::GetInstancePointer();
+    if (stagingSlot >= 0 && stagingRing->BeginUpload(stagingSlot))
+    {
+        texture2D.SetImageFromBuffer(0, image.width, image.height, format, internalFormat, 0, image.dataType);
+        stagingRing->EndUpload(stagingSlot);
+    }
+    else
+    {
+        texture2D.SetImage<std::byte>(0, image.width, image.height, format, internalFormat, image.data, image.dataType);
+    }
+
+    texture2D.SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR);
+    texture2D.SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
+
+    // Generate mipmap if needed
+    if (generateMipmap)
+    {
+        texture2D.GenerateMipmap();
+        texture2D.SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR_MIPMAP_LINEAR);
+
+        // Adjust mip levels
+        texture2D.SetParameter(TextureObject::ParameterFloat::MinLod, 0.0f);
+        float maxLod = 1.0f + std::floor(std::log2(static_cast<float>(std::max(image.width, image.height))));
+        texture2D.SetParameter(TextureObject::ParameterFloat::MaxLod, maxLod);
+    }
+
+    texture2D.Unbind();
 }
 
 std::shared_ptr<Texture2DObject> Texture2DLoader::LoadTextureShared(const char* path,
@@ -3,6 +3,8 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include <algorithm>
+
 std::span<const std::byte> TextureLoaderUtils::LoadTexture2DData(const char* path, int& width, int& height, Data::Type& dataType, TextureObject::Format format, TextureObject::InternalFormat internalFormat, bool flipVertical)
 {
     std::span<const std::byte> dataSpan;
@@ -10,9 +12,6 @@ std::span<const std::byte> TextureLoaderUtils::LoadTexture2DData(const char* pat
     int componentCount = TextureObject::GetComponentCount(format);
     int originalComponentCount;
 
-    // Set flip vertical on load if needed
-    stbi_set_flip_vertically_on_load(flipVertical ? 1 : 0);
-
     if (IsHDR(internalFormat))
     {
         float* data = stbi_loadf(path, &width, &height, &originalComponentCount, componentCount);
@@ -27,6 +26,12 @@ std::span<const std::byte> TextureLoaderUtils::LoadTexture2DData(const char* pat
         dataSpan = Data::GetBytes(dataSpanByte);
         dataType = Data::Type::UByte;
     }
+
+    // Flip here instead of with stbi_set_flip_vertically_on_load(), that setting is global and textures are decoded in several threads
+    if (flipVertical && !dataSpan.empty())
+    {
+        FlipVertical(const_cast<std::byte*>(dataSpan.data()), dataSpan.size() / height, height);
+    }
     return dataSpan;
 }
 
@@ -36,6 +41,16 @@ void TextureLoaderUtils::FreeTexture2DData(std::span<const std::byte> data)
     stbi_image_free(const_cast<void*>(dataPtr));
 }
 
+void TextureLoaderUtils::FlipVertical(std::byte* data, size_t rowSize, int rowCount)
+{
+    for (int row = 0; row < rowCount / 2; ++row)
+    {
+        std::byte* topRow = data + row * rowSize;
+        std::byte* bottomRow = data + (rowCount - 1 - row) * rowSize;
+        std::swap_ranges(topRow, topRow + rowSize, bottomRow);
+    }
+}
+
 bool TextureLoaderUtils::IsHDR(TextureObject::InternalFormat internalFormat)
 {
     switch (internalFormat)
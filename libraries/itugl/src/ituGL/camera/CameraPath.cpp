@@ -0,0 +1,117 @@
+#include <ituGL/camera/CameraPath.h>
+
+#include <ituGL/camera/Camera.h>
+#include <ituGL/scene/SceneCamera.h>
+#include <glm/gtx/spline.hpp>
+#include <fstream>
+#include <cmath>
+#include <cassert>
+
+CameraPath::CameraPath()
+{
+}
+
+float CameraPath::GetDuration() const
+{
+    return m_keyframes.empty() ? 0.0f : m_keyframes.back().time;
+}
+
+void CameraPath::AddKeyframe(float time, const glm::vec3& position, const glm::vec3& lookAt)
+{
+    assert(m_keyframes.empty() || time > m_keyframes.back().time);
+    m_keyframes.push_back(Keyframe{ time, position, lookAt });
+}
+
+void CameraPath::AddKeyframe(const Camera& camera, float timeStep)
+{
+    glm::vec3 right, up, forward;
+    camera.ExtractVectors(right, up, forward);
+
+    // The camera looks along its negative forward axis
+    glm::vec3 position = camera.ExtractTranslation();
+    float time = m_keyframes.empty() ? 0.0f : m_keyframes.back().time + timeStep;
+    AddKeyframe(time, position, position - forward);
+}
+
+void CameraPath::Evaluate(float time, glm::vec3& position, glm::vec3& lookAt) const
+{
+    assert(!m_keyframes.empty());
+
+    int count = static_cast<int>(m_keyframes.size());
+    float duration = GetDuration();
+    if (count == 1 || duration <= 0.0f)
+    {
+        position = m_keyframes.front().position;
+        lookAt = m_keyframes.front().lookAt;
+        return;
+    }
+
+    time = std::fmod(time, duration);
+    if (time < 0.0f)
+    {
+        time += duration;
+    }
+
+    // Find the segment, the keyframes are sorted by time
+    int index = 0;
+    while (index < count - 2 && m_keyframes[index + 1].time <= time)
+    {
+        ++index;
+    }
+
+    const Keyframe& keyframe0 = m_keyframes[std::max(index - 1, 0)];
+    const Keyframe& keyframe1 = m_keyframes[index];
+    const Keyframe& keyframe2 = m_keyframes[index + 1];
+    const Keyframe& keyframe3 = m_keyframes[std::min(index + 2, count - 1)];
+
+    float t = (time - keyframe1.time) / (keyframe2.time - keyframe1.time);
+    position = glm::catmullRom(keyframe0.position, keyframe1.position, keyframe2.position, keyframe3.position, t);
+    lookAt = glm::catmullRom(keyframe0.lookAt, keyframe1.lookAt, keyframe2.lookAt, keyframe3.lookAt, t);
+}
+
+void CameraPath::Apply(SceneCamera& sceneCamera, float time) const
+{
+    std::shared_ptr<Camera> camera = sceneCamera.GetCamera();
+    assert(camera);
+
+    glm::vec3 position, lookAt;
+    Evaluate(time, position, lookAt);
+    camera->SetViewMatrix(position, lookAt);
+    sceneCamera.MatchTransformToCamera();
+}
+
+bool CameraPath::Load(const char* path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    m_keyframes.clear();
+    Keyframe keyframe;
+    while (file >> keyframe.time
+        >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z
+        >> keyframe.lookAt.x >> keyframe.lookAt.y >> keyframe.lookAt.z)
+    {
+        AddKeyframe(keyframe.time, keyframe.position, keyframe.lookAt);
+    }
+    return !m_keyframes.empty();
+}
+
+bool CameraPath::Save(const char* path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    for (const Keyframe& keyframe : m_keyframes)
+    {
+        file << keyframe.time << " "
+            << keyframe.position.x << " " << keyframe.position.y << " " << keyframe.position.z << " "
+            << keyframe.lookAt.x << " " << keyframe.lookAt.y << " " << keyframe.lookAt.z << "\n";
+    }
+    return file.good();
+}
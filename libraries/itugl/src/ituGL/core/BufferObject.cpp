@@ -63,3 +63,20 @@ void BufferObject::UpdateData(std::span<const std::byte> data, size_t offset)
     Target target = GetTarget();
     glBufferSubData(target, offset, data.size_bytes(), data.data());
 }
+
+// Get buffer Target and map the range
+std::span<std::byte> BufferObject::MapRange(size_t offset, size_t size, GLbitfield access)
+{
+    assert(IsBound());
+    Target target = GetTarget();
+    void* data = glMapBufferRange(target, offset, size, access);
+    return std::span<std::byte>(static_cast<std::byte*>(data), data ? size : 0);
+}
+
+// Get buffer Target and unmap it
+bool BufferObject::Unmap()
+{
+    assert(IsBound());
+    Target target = GetTarget();
+    return glUnmapBuffer(target) == GL_TRUE;
+}
@@ -1,15 +1,22 @@
 #include <ituGL/core/DeviceGL.h>
 
 #include <ituGL/application/Window.h>
+#include <ituGL/core/GLStub.h>
 #include <GLFW/glfw3.h>
+#include <glm/vec4.hpp>
+#include <cstring>
+#include <numeric>
 #include <cassert>
 
 DeviceGL* DeviceGL::m_instance = nullptr;
 
-DeviceGL::DeviceGL() : m_contextLoaded(false)
+DeviceGL::DeviceGL() : m_contextLoaded(false), m_maxShaderCompilerThreads(nullptr), m_drawcallCount(0)
 {
     m_instance = this;
 
+    InvalidateState();
+    ResetStateChangeStats();
+
     // Init GLFW
     glfwInit();
 }
@@ -31,17 +38,52 @@ void DeviceGL::SetCurrentWindow(Window& window)
     // Load required GL libraries and initialize the context
     m_contextLoaded = gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
 
+    // New context, nothing is known about its state
+    InvalidateState();
+
     if (m_contextLoaded)
     {
+        LoadExtensions();
+
         // Set callback to be called when the window is resized
         glfwSetFramebufferSizeCallback(glfwWindow, FrameBufferResized);
     }
 }
 
+#ifdef ITUGL_GL_STUB
+// Use the recording stub instead of the context of a window, to run without GL
+void DeviceGL::SetCurrentStub(GLStub& stub)
+{
+    stub.Install();
+    m_contextLoaded = true;
+    m_maxShaderCompilerThreads = nullptr;
+
+    // New context, nothing is known about its state
+    InvalidateState();
+}
+#endif
+
 // Set the dimensions of the viewport
 void DeviceGL::SetViewport(GLint x, GLint y, GLsizei width, GLsizei height)
 {
-    glViewport(0, 0, width, height);
+    glm::ivec4 viewport(x, y, width, height);
+    if (UpdateState(StateChange::Viewport, !m_viewportKnown || m_viewport != viewport))
+    {
+        glViewport(x, y, width, height);
+        m_viewport = viewport;
+        m_viewportKnown = true;
+    }
+}
+
+// Get the viewport as (x, y, width, height). Only queries GL the first time, later it is the last one set
+glm::ivec4 DeviceGL::GetViewport() const
+{
+    if (!m_viewportKnown)
+    {
+        glGetIntegerv(GL_VIEWPORT, &m_viewport[0]);
+        m_viewportKnown = true;
+    }
+    return m_viewport;
 }
 
 // Poll the events in the window event queue
@@ -82,15 +124,40 @@ void DeviceGL::Clear(bool clearColor, const Color& color, bool clearDepth, GLdou
     glClear(mask);
 }
 
-// Get if a feature is enabled
+// Get if a feature is enabled. Only queries GL the first time for shadowed features
 bool DeviceGL::IsFeatureEnabled(GLenum feature) const
 {
-    return glIsEnabled(feature);
+    int slot = GetFeatureSlot(feature);
+    if (slot < 0)
+    {
+        return glIsEnabled(feature);
+    }
+
+    if (m_features[slot] == c_unknownState)
+    {
+        m_features[slot] = glIsEnabled(feature);
+    }
+    return m_features[slot];
 }
 
 // enable / disable a feature
 void DeviceGL::SetFeatureEnabled(GLenum feature, bool enabled)
 {
+    int slot = GetFeatureSlot(feature);
+    if (slot >= 0)
+    {
+        GLuint state = enabled ? GL_TRUE : GL_FALSE;
+        if (!UpdateState(StateChange::Feature, m_features[slot] != state))
+        {
+            return;
+        }
+        m_features[slot] = state;
+    }
+    else
+    {
+        UpdateState(StateChange::Feature, true);
+    }
+
     if (enabled)
     {
         glEnable(feature);
@@ -112,3 +179,439 @@ void DeviceGL::SetVSyncEnabled(bool enabled)
 {
     glfwSwapInterval(enabled ? 1 : 0);
 }
+
+// Number of threads the driver can use to compile shaders. 0xFFFFFFFF lets the driver decide
+void DeviceGL::SetMaxShaderCompilerThreads(GLuint count)
+{
+    if (m_maxShaderCompilerThreads)
+    {
+        m_maxShaderCompilerThreads(count);
+    }
+}
+
+// Set the shader program in use
+void DeviceGL::UseProgram(GLuint handle)
+{
+    if (UpdateState(StateChange::Program, m_program != handle))
+    {
+        glUseProgram(handle);
+        m_program = handle;
+    }
+}
+
+// Bind a vertex array object
+void DeviceGL::BindVertexArray(GLuint handle)
+{
+    if (UpdateState(StateChange::VertexArray, m_vertexArray != handle))
+    {
+        glBindVertexArray(handle);
+        m_vertexArray = handle;
+    }
+}
+
+// Bind a framebuffer to GL_FRAMEBUFFER, GL_READ_FRAMEBUFFER or GL_DRAW_FRAMEBUFFER
+void DeviceGL::BindFramebuffer(GLenum target, GLuint handle)
+{
+    bool setRead = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    bool setDraw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    bool changed = (setRead && m_readFramebuffer != handle) || (setDraw && m_drawFramebuffer != handle);
+    if (UpdateState(StateChange::Framebuffer, changed))
+    {
+        glBindFramebuffer(target, handle);
+        if (setRead)
+        {
+            m_readFramebuffer = handle;
+        }
+        if (setDraw)
+        {
+            m_drawFramebuffer = handle;
+        }
+    }
+}
+
+// Set the texture unit affected by BindTexture
+void DeviceGL::SetActiveTextureUnit(GLint textureUnit)
+{
+    if (UpdateState(StateChange::ActiveTexture, m_activeTextureUnit != textureUnit))
+    {
+        glActiveTexture(GL_TEXTURE0 + textureUnit);
+        m_activeTextureUnit = textureUnit;
+    }
+}
+
+// Bind a texture to the target in the active texture unit
+void DeviceGL::BindTexture(GLenum target, GLuint handle)
+{
+    int slot = GetTextureTargetSlot(target);
+    bool shadowed = slot >= 0 && m_activeTextureUnit >= 0 && m_activeTextureUnit < c_textureUnitCount;
+    if (!shadowed)
+    {
+        UpdateState(StateChange::Texture, true);
+        glBindTexture(target, handle);
+        return;
+    }
+
+    GLuint& boundTexture = m_textures[m_activeTextureUnit][slot];
+    if (UpdateState(StateChange::Texture, boundTexture != handle))
+    {
+        glBindTexture(target, handle);
+        boundTexture = handle;
+    }
+}
+
+// Bind a sampler object to a texture unit
+void DeviceGL::BindSampler(GLuint textureUnit, GLuint handle)
+{
+    if (textureUnit >= c_textureUnitCount)
+    {
+        UpdateState(StateChange::Sampler, true);
+        glBindSampler(textureUnit, handle);
+        return;
+    }
+
+    if (UpdateState(StateChange::Sampler, m_samplers[textureUnit] != handle))
+    {
+        glBindSampler(textureUnit, handle);
+        m_samplers[textureUnit] = handle;
+    }
+}
+
+// Depth test function
+void DeviceGL::SetDepthFunction(GLenum function)
+{
+    if (UpdateState(StateChange::Depth, m_depthFunction != function))
+    {
+        glDepthFunc(function);
+        m_depthFunction = function;
+    }
+}
+
+// Depth write
+void DeviceGL::SetDepthWrite(bool enabled)
+{
+    GLuint state = enabled ? GL_TRUE : GL_FALSE;
+    if (UpdateState(StateChange::Depth, m_depthWrite != state))
+    {
+        glDepthMask(static_cast<GLboolean>(state));
+        m_depthWrite = state;
+    }
+}
+
+// Stencil function, for one or both faces
+void DeviceGL::SetStencilFunction(GLenum face, GLenum function, GLint refValue, GLuint mask)
+{
+    bool setFront = face == GL_FRONT || face == GL_FRONT_AND_BACK;
+    bool setBack = face == GL_BACK || face == GL_FRONT_AND_BACK;
+
+    auto isSame = [&](const StencilFaceState& state)
+    {
+        return state.function == function && state.refValue == refValue && state.mask == mask;
+    };
+    bool changed = (setFront && !isSame(m_stencilFaces[0])) || (setBack && !isSame(m_stencilFaces[1]));
+    if (UpdateState(StateChange::Stencil, changed))
+    {
+        if (face == GL_FRONT_AND_BACK)
+        {
+            glStencilFunc(function, refValue, mask);
+        }
+        else
+        {
+            glStencilFuncSeparate(face, function, refValue, mask);
+        }
+
+        for (int i = 0; i < 2; ++i)
+        {
+            if (i == 0 ? setFront : setBack)
+            {
+                m_stencilFaces[i].function = function;
+                m_stencilFaces[i].refValue = refValue;
+                m_stencilFaces[i].mask = mask;
+            }
+        }
+    }
+}
+
+// Stencil operations, for one or both faces
+void DeviceGL::SetStencilOperations(GLenum face, GLenum stencilFail, GLenum depthFail, GLenum depthPass)
+{
+    bool setFront = face == GL_FRONT || face == GL_FRONT_AND_BACK;
+    bool setBack = face == GL_BACK || face == GL_FRONT_AND_BACK;
+
+    auto isSame = [&](const StencilFaceState& state)
+    {
+        return state.stencilFail == stencilFail && state.depthFail == depthFail && state.depthPass == depthPass;
+    };
+    bool changed = (setFront && !isSame(m_stencilFaces[0])) || (setBack && !isSame(m_stencilFaces[1]));
+    if (UpdateState(StateChange::Stencil, changed))
+    {
+        if (face == GL_FRONT_AND_BACK)
+        {
+            glStencilOp(stencilFail, depthFail, depthPass);
+        }
+        else
+        {
+            glStencilOpSeparate(face, stencilFail, depthFail, depthPass);
+        }
+
+        for (int i = 0; i < 2; ++i)
+        {
+            if (i == 0 ? setFront : setBack)
+            {
+                m_stencilFaces[i].stencilFail = stencilFail;
+                m_stencilFaces[i].depthFail = depthFail;
+                m_stencilFaces[i].depthPass = depthPass;
+            }
+        }
+    }
+}
+
+// Blend equations for color and alpha
+void DeviceGL::SetBlendEquation(GLenum equationColor, GLenum equationAlpha)
+{
+    bool changed = m_blendEquations[0] != equationColor || m_blendEquations[1] != equationAlpha;
+    if (UpdateState(StateChange::Blend, changed))
+    {
+        if (equationColor == equationAlpha)
+        {
+            glBlendEquation(equationColor);
+        }
+        else
+        {
+            glBlendEquationSeparate(equationColor, equationAlpha);
+        }
+        m_blendEquations = { equationColor, equationAlpha };
+    }
+}
+
+// Blend params for color and alpha
+void DeviceGL::SetBlendFunction(GLenum sourceColor, GLenum destColor, GLenum sourceAlpha, GLenum destAlpha)
+{
+    std::array<GLenum, 4> blendParams = { sourceColor, destColor, sourceAlpha, destAlpha };
+    if (UpdateState(StateChange::Blend, m_blendParams != blendParams))
+    {
+        if (sourceColor == sourceAlpha && destColor == destAlpha)
+        {
+            glBlendFunc(sourceColor, destColor);
+        }
+        else
+        {
+            glBlendFuncSeparate(sourceColor, destColor, sourceAlpha, destAlpha);
+        }
+        m_blendParams = blendParams;
+    }
+}
+
+// Constant blend color
+void DeviceGL::SetBlendColor(const Color& color)
+{
+    bool changed = !m_blendColorKnown || glm::vec4(m_blendColor) != glm::vec4(color);
+    if (UpdateState(StateChange::Blend, changed))
+    {
+        glBlendColor(color.GetRed(), color.GetGreen(), color.GetBlue(), color.GetAlpha());
+        m_blendColor = color;
+        m_blendColorKnown = true;
+    }
+}
+
+// Faces culled when GL_CULL_FACE is enabled
+void DeviceGL::SetCullFace(GLenum face)
+{
+    if (UpdateState(StateChange::CullFace, m_cullFace != face))
+    {
+        glCullFace(face);
+        m_cullFace = face;
+    }
+}
+
+// Rectangle of the scissor test
+void DeviceGL::SetScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    glm::ivec4 scissor(x, y, width, height);
+    if (UpdateState(StateChange::Scissor, !m_scissorKnown || m_scissor != scissor))
+    {
+        glScissor(x, y, width, height);
+        m_scissor = scissor;
+        m_scissorKnown = true;
+    }
+}
+
+// GL binds the program 0 when the program in use is deleted
+void DeviceGL::OnProgramDeleted(GLuint handle)
+{
+    if (m_program == handle)
+    {
+        m_program = c_unknownState;
+    }
+}
+
+// GL binds the vertex array 0 when the bound one is deleted
+void DeviceGL::OnVertexArrayDeleted(GLuint handle)
+{
+    if (m_vertexArray == handle)
+    {
+        m_vertexArray = 0;
+    }
+}
+
+// GL binds the framebuffer 0 when the bound one is deleted
+void DeviceGL::OnFramebufferDeleted(GLuint handle)
+{
+    if (m_readFramebuffer == handle)
+    {
+        m_readFramebuffer = 0;
+    }
+    if (m_drawFramebuffer == handle)
+    {
+        m_drawFramebuffer = 0;
+    }
+}
+
+// GL binds the texture 0 in every unit where the deleted texture was bound
+void DeviceGL::OnTextureDeleted(GLuint handle)
+{
+    for (auto& unitTextures : m_textures)
+    {
+        for (GLuint& texture : unitTextures)
+        {
+            if (texture == handle)
+            {
+                texture = 0;
+            }
+        }
+    }
+}
+
+// GL binds the sampler 0 in every unit where the deleted sampler was bound
+void DeviceGL::OnSamplerDeleted(GLuint handle)
+{
+    for (GLuint& sampler : m_samplers)
+    {
+        if (sampler == handle)
+        {
+            sampler = 0;
+        }
+    }
+}
+
+// Forget all the shadowed state, the next calls will always reach GL
+void DeviceGL::InvalidateState()
+{
+    m_program = c_unknownState;
+    m_vertexArray = c_unknownState;
+    m_readFramebuffer = c_unknownState;
+    m_drawFramebuffer = c_unknownState;
+    m_activeTextureUnit = -1;
+    for (auto& unitTextures : m_textures)
+    {
+        unitTextures.fill(c_unknownState);
+    }
+    m_samplers.fill(c_unknownState);
+    m_features.fill(c_unknownState);
+    m_depthFunction = c_unknownState;
+    m_depthWrite = c_unknownState;
+    m_stencilFaces.fill(StencilFaceState{ c_unknownState, c_unknownState, c_unknownState, c_unknownState, 0, 0 });
+    m_blendEquations.fill(c_unknownState);
+    m_blendParams.fill(c_unknownState);
+    m_blendColorKnown = false;
+    m_viewportKnown = false;
+    m_cullFace = c_unknownState;
+    m_scissorKnown = false;
+}
+
+unsigned int DeviceGL::GetIssuedStateChanges() const
+{
+    return std::accumulate(m_issuedStateChanges.begin(), m_issuedStateChanges.end(), 0u);
+}
+
+unsigned int DeviceGL::GetSkippedStateChanges() const
+{
+    return std::accumulate(m_skippedStateChanges.begin(), m_skippedStateChanges.end(), 0u);
+}
+
+void DeviceGL::ResetStateChangeStats()
+{
+    m_issuedStateChanges.fill(0);
+    m_skippedStateChanges.fill(0);
+}
+
+// Returns true if the call needs to be issued, and updates the counters
+bool DeviceGL::UpdateState(StateChange stateChange, bool changed) const
+{
+    auto& counters = changed ? m_issuedStateChanges : m_skippedStateChanges;
+    counters[static_cast<int>(stateChange)]++;
+    return changed;
+}
+
+// Index of the shadowed feature, -1 if it is not shadowed
+int DeviceGL::GetFeatureSlot(GLenum feature)
+{
+    switch (feature)
+    {
+    case GL_BLEND: return 0;
+    case GL_CULL_FACE: return 1;
+    case GL_DEPTH_TEST: return 2;
+    case GL_STENCIL_TEST: return 3;
+    case GL_SCISSOR_TEST: return 4;
+    case GL_FRAMEBUFFER_SRGB: return 5;
+    case GL_TEXTURE_CUBE_MAP_SEAMLESS: return 6;
+    case GL_POLYGON_OFFSET_FILL: return 7;
+    case GL_MULTISAMPLE: return 8;
+    case GL_DITHER: return 9;
+    case GL_DEPTH_CLAMP: return 10;
+    case GL_PROGRAM_POINT_SIZE: return 11;
+    case GL_RASTERIZER_DISCARD: return 12;
+    case GL_PRIMITIVE_RESTART: return 13;
+    default: return -1;
+    }
+}
+
+// Index of the shadowed texture target, -1 if it is not shadowed
+int DeviceGL::GetTextureTargetSlot(GLenum target)
+{
+    switch (target)
+    {
+    case GL_TEXTURE_1D: return 0;
+    case GL_TEXTURE_1D_ARRAY: return 1;
+    case GL_TEXTURE_2D: return 2;
+    case GL_TEXTURE_2D_ARRAY: return 3;
+    case GL_TEXTURE_2D_MULTISAMPLE: return 4;
+    case GL_TEXTURE_2D_MULTISAMPLE_ARRAY: return 5;
+    case GL_TEXTURE_3D: return 6;
+    case GL_TEXTURE_CUBE_MAP: return 7;
+    case GL_TEXTURE_CUBE_MAP_ARRAY: return 8;
+    case GL_TEXTURE_RECTANGLE: return 9;
+    case GL_TEXTURE_BUFFER: return 10;
+    default: return -1;
+    }
+}
+
+// Load the extensions that are used when available
+void DeviceGL::LoadExtensions()
+{
+    // Both extensions define the same function and the same query, only the suffix is different
+    m_maxShaderCompilerThreads = nullptr;
+    if (HasExtension("GL_KHR_parallel_shader_compile"))
+    {
+        m_maxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsFunction>(glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+    }
+    else if (HasExtension("GL_ARB_parallel_shader_compile"))
+    {
+        m_maxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsFunction>(glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+    }
+}
+
+// Check if the context exposes an extension
+bool DeviceGL::HasExtension(const char* name)
+{
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; ++i)
+    {
+        const GLubyte* extension = glGetStringi(GL_EXTENSIONS, i);
+        if (extension && std::strcmp(reinterpret_cast<const char*>(extension), name) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
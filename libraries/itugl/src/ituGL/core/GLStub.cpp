@@ -0,0 +1,1066 @@
+#include <ituGL/core/GLStub.h>
+
+#ifdef ITUGL_GL_STUB
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+GLStub* GLStub::m_instance = nullptr;
+
+GLStub::GLStub() : m_recording(false), m_callCount(0), m_stateChangeCount(0), m_nextHandle(1), m_activeTexture(GL_TEXTURE0),
+    m_viewport{}, m_scissor{}, m_fencesSignaled(true), m_mapFailing(false), m_unmapFailing(false)
+{
+    assert(!m_instance);
+    m_instance = this;
+}
+
+GLStub::~GLStub()
+{
+    m_instance = nullptr;
+}
+
+unsigned int GLStub::GetCallCount(std::string_view function) const
+{
+    auto it = m_callCounts.find(function);
+    return it != m_callCounts.end() ? it->second : 0;
+}
+
+void GLStub::ResetCalls()
+{
+    m_calls.clear();
+    m_callCounts.clear();
+    m_callCount = 0;
+    m_stateChangeCount = 0;
+}
+
+void GLStub::DeclareUniform(const char* name, GLenum type, GLint size)
+{
+    assert(size > 0);
+    GLint location = 0;
+    for (const Uniform& uniform : m_uniforms)
+    {
+        location = std::max(location, uniform.location + uniform.size);
+    }
+    m_uniforms.push_back({ name, type, size, location, -1, -1, 0, 0 });
+}
+
+void GLStub::DeclareUniformBlock(const char* name, GLint dataSize)
+{
+    m_uniformBlocks.push_back({ name, dataSize });
+}
+
+void GLStub::DeclareBlockUniform(const char* name, GLenum type, GLint size, GLint blockIndex, GLint offset,
+    GLint arrayStride, GLint matrixStride)
+{
+    assert(size > 0);
+    assert(blockIndex >= 0 && blockIndex < static_cast<GLint>(m_uniformBlocks.size()));
+    m_uniforms.push_back({ name, type, size, -1, blockIndex, offset, arrayStride, matrixStride });
+}
+
+void GLStub::ClearUniforms()
+{
+    m_uniforms.clear();
+    m_uniformBlocks.clear();
+}
+
+GLsizeiptr GLStub::GetBufferSize(GLuint handle) const
+{
+    auto it = m_bufferSizes.find(handle);
+    return it != m_bufferSizes.end() ? it->second : 0;
+}
+
+void GLStub::Record(const char* function, std::initializer_list<Argument> arguments, bool stateChange)
+{
+    ++m_callCount;
+    ++m_callCounts[function];
+    if (stateChange)
+    {
+        ++m_stateChangeCount;
+    }
+
+    if (m_recording)
+    {
+        m_calls.push_back({ function, arguments });
+    }
+}
+
+GLint GLStub::FindUniformLocation(const char* name) const
+{
+    // Split the array index, if there is one
+    std::string_view baseName(name);
+    GLint element = 0;
+    std::size_t bracket = baseName.find('[');
+    if (bracket != std::string_view::npos)
+    {
+        element = std::atoi(name + bracket + 1);
+        baseName = baseName.substr(0, bracket);
+    }
+
+    for (const Uniform& uniform : m_uniforms)
+    {
+        if (uniform.name == baseName)
+        {
+            return uniform.location >= 0 && element < uniform.size ? uniform.location + element : -1;
+        }
+    }
+    return -1;
+}
+
+void GLStub::CopyString(const std::string& source, GLsizei bufSize, GLsizei* length, GLchar* destination)
+{
+    GLsizei copyLength = 0;
+    if (bufSize > 0)
+    {
+        copyLength = std::min(static_cast<GLsizei>(source.size()), bufSize - 1);
+        std::memcpy(destination, source.data(), copyLength);
+        destination[copyLength] = '\0';
+    }
+    if (length)
+    {
+        *length = copyLength;
+    }
+}
+
+void GLStub::SkipErrorCheck(const char*, void*, int, ...)
+{
+}
+
+// One stub for each GL function used by the library, new GL calls need to be added here
+// Each function records the call, and then simulates the result
+void GLStub::Install()
+{
+    // The stub functions don't fail, skip the glGetError check that glad does after every call
+    glad_set_post_callback_gl(SkipErrorCheck);
+
+    glad_glActiveTexture = [](GLenum texture)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glActiveTexture", { texture }, true);
+            stub.m_activeTexture = texture;
+        };
+
+    glad_glAttachShader = [](GLuint program, GLuint shader)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glAttachShader", { program, shader }, false);
+        };
+
+    glad_glBeginQuery = [](GLenum target, GLuint id)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glBeginQuery", { target, id }, false);
+        };
+
+    glad_glBindBuffer = [](GLenum target, GLuint buffer)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glBindBuffer", { target, buffer }, true);
+            stub.m_boundBuffers[target] = buffer;
+        };
+
+    glad_glBindBufferBase = [](GLenum target, GLuint index, GLuint buffer)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glBindBufferBase", { target, index, buffer }, true);
+            stub.m_boundBuffers[target] = buffer;
+        };
+
+    glad_glBindBufferRange = [](GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glBindBufferRange", { target, index, buffer, offset, size }, true);
+            assert(offset + size <= stub.GetBufferSize(buffer));
+            stub.m_boundBuffers[target] = buffer;
+        };
+
+    glad_glBindFramebuffer = [](GLenum target, GLuint framebuffer)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glBindFramebuffer", { target, framebuffer }, true);
+        };
+
+    glad_glBindSampler = [](GLuint unit, GLuint sampler)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glBindSampler", { unit, sampler }, true);
+        };
+
+    glad_glBindTexture = [](GLenum target, GLuint texture)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glBindTexture", { target, texture }, true);
+        };
+
+    glad_glBindVertexArray = [](GLuint array)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glBindVertexArray", { array }, true);
+        };
+
+    glad_glBlendColor = [](GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glBlendColor", { red, green, blue, alpha }, true);
+        };
+
+    glad_glBlendEquation = [](GLenum mode)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glBlendEquation", { mode }, true);
+        };
+
+    glad_glBlendEquationSeparate = [](GLenum modeRGB, GLenum modeAlpha)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glBlendEquationSeparate", { modeRGB, modeAlpha }, true);
+        };
+
+    glad_glBlendFunc = [](GLenum sfactor, GLenum dfactor)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glBlendFunc", { sfactor, dfactor }, true);
+        };
+
+    glad_glBlendFuncSeparate = [](GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfactorAlpha, GLenum dfactorAlpha)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glBlendFuncSeparate", { sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha }, true);
+        };
+
+    glad_glBufferData = [](GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glBufferData", { target, size, data, usage }, false);
+            GLuint buffer = stub.m_boundBuffers[target];
+            assert(buffer != 0);
+            stub.m_bufferSizes[buffer] = size;
+        };
+
+    glad_glBufferSubData = [](GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glBufferSubData", { target, offset, size, data }, false);
+            assert(offset + size <= stub.GetBufferSize(stub.m_boundBuffers[target]));
+        };
+
+    glad_glClear = [](GLbitfield mask)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glClear", { mask }, false);
+        };
+
+    glad_glClearColor = [](GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glClearColor", { red, green, blue, alpha }, true);
+        };
+
+    glad_glClearDepth = [](GLdouble depth)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glClearDepth", { depth }, true);
+        };
+
+    glad_glClearStencil = [](GLint s)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glClearStencil", { s }, true);
+        };
+
+    glad_glClientWaitSync = [](GLsync sync, GLbitfield flags, GLuint64 timeout) -> GLenum
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glClientWaitSync", { sync, flags, timeout }, false);
+            // Commands complete right away, unless the GPU is simulated as busy
+            return stub.m_fencesSignaled ? GL_ALREADY_SIGNALED : GL_TIMEOUT_EXPIRED;
+        };
+
+    glad_glCompileShader = [](GLuint shader)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glCompileShader", { shader }, false);
+            stub.m_compiledShaders.insert(shader);
+        };
+
+    glad_glCreateProgram = []() -> GLuint
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glCreateProgram", {}, false);
+            return stub.CreateHandle();
+        };
+
+    glad_glCreateShader = [](GLenum type) -> GLuint
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glCreateShader", { type }, false);
+            GLuint handle = stub.CreateHandle();
+            stub.m_shaderTypes[handle] = type;
+            return handle;
+        };
+
+    glad_glCullFace = [](GLenum mode)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glCullFace", { mode }, true);
+        };
+
+    glad_glDeleteBuffers = [](GLsizei n, const GLuint* buffers)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glDeleteBuffers", { n, buffers }, false);
+            for (GLsizei i = 0; i < n; ++i)
+            {
+                stub.m_bufferSizes.erase(buffers[i]);
+                stub.m_mappedData.erase(buffers[i]);
+            }
+        };
+
+    glad_glDeleteFramebuffers = [](GLsizei n, const GLuint* framebuffers)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glDeleteFramebuffers", { n, framebuffers }, false);
+        };
+
+    glad_glDeleteProgram = [](GLuint program)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glDeleteProgram", { program }, false);
+            stub.m_linkedPrograms.erase(program);
+        };
+
+    glad_glDeleteQueries = [](GLsizei n, const GLuint* ids)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glDeleteQueries", { n, ids }, false);
+        };
+
+    glad_glDeleteShader = [](GLuint shader)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glDeleteShader", { shader }, false);
+            stub.m_shaderTypes.erase(shader);
+            stub.m_compiledShaders.erase(shader);
+        };
+
+    glad_glDeleteSync = [](GLsync sync)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glDeleteSync", { sync }, false);
+        };
+
+    glad_glDeleteTextures = [](GLsizei n, const GLuint* textures)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glDeleteTextures", { n, textures }, false);
+        };
+
+    glad_glDeleteVertexArrays = [](GLsizei n, const GLuint* arrays)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glDeleteVertexArrays", { n, arrays }, false);
+        };
+
+    glad_glDepthFunc = [](GLenum func)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glDepthFunc", { func }, true);
+        };
+
+    glad_glDepthMask = [](GLboolean flag)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glDepthMask", { flag }, true);
+        };
+
+    glad_glDisable = [](GLenum cap)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glDisable", { cap }, true);
+            stub.m_enabledFeatures.erase(cap);
+        };
+
+    glad_glDrawArrays = [](GLenum mode, GLint first, GLsizei count)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glDrawArrays", { mode, first, count }, false);
+        };
+
+    glad_glDrawArraysInstanced = [](GLenum mode, GLint first, GLsizei count, GLsizei instancecount)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glDrawArraysInstanced", { mode, first, count, instancecount }, false);
+        };
+
+    glad_glDrawBuffers = [](GLsizei n, const GLenum* bufs)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glDrawBuffers", { n, bufs }, true);
+        };
+
+    glad_glDrawElements = [](GLenum mode, GLsizei count, GLenum type, const void* indices)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glDrawElements", { mode, count, type, indices }, false);
+        };
+
+    glad_glDrawElementsBaseVertex = [](GLenum mode, GLsizei count, GLenum type, const void* indices, GLint basevertex)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glDrawElementsBaseVertex", { mode, count, type, indices, basevertex }, false);
+        };
+
+    glad_glDrawElementsInstancedBaseVertex = [](GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glDrawElementsInstancedBaseVertex", { mode, count, type, indices, instancecount, basevertex }, false);
+        };
+
+    glad_glEnable = [](GLenum cap)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glEnable", { cap }, true);
+            stub.m_enabledFeatures.insert(cap);
+        };
+
+    glad_glEnableVertexAttribArray = [](GLuint index)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glEnableVertexAttribArray", { index }, false);
+        };
+
+    glad_glEndQuery = [](GLenum target)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glEndQuery", { target }, false);
+        };
+
+    glad_glFenceSync = [](GLenum condition, GLbitfield flags) -> GLsync
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glFenceSync", { condition, flags }, false);
+            return reinterpret_cast<GLsync>(static_cast<std::uintptr_t>(stub.CreateHandle()));
+        };
+
+    glad_glFramebufferTexture2D = [](GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glFramebufferTexture2D", { target, attachment, textarget, texture, level }, false);
+        };
+
+    glad_glGenBuffers = [](GLsizei n, GLuint* buffers)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGenBuffers", { n, buffers }, false);
+            for (GLsizei i = 0; i < n; ++i)
+            {
+                buffers[i] = stub.CreateHandle();
+            }
+        };
+
+    glad_glGenerateMipmap = [](GLenum target)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGenerateMipmap", { target }, false);
+        };
+
+    glad_glGenFramebuffers = [](GLsizei n, GLuint* framebuffers)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGenFramebuffers", { n, framebuffers }, false);
+            for (GLsizei i = 0; i < n; ++i)
+            {
+                framebuffers[i] = stub.CreateHandle();
+            }
+        };
+
+    glad_glGenQueries = [](GLsizei n, GLuint* ids)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGenQueries", { n, ids }, false);
+            for (GLsizei i = 0; i < n; ++i)
+            {
+                ids[i] = stub.CreateHandle();
+            }
+        };
+
+    glad_glGenTextures = [](GLsizei n, GLuint* textures)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGenTextures", { n, textures }, false);
+            for (GLsizei i = 0; i < n; ++i)
+            {
+                textures[i] = stub.CreateHandle();
+            }
+        };
+
+    glad_glGenVertexArrays = [](GLsizei n, GLuint* arrays)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGenVertexArrays", { n, arrays }, false);
+            for (GLsizei i = 0; i < n; ++i)
+            {
+                arrays[i] = stub.CreateHandle();
+            }
+        };
+
+    glad_glGetActiveUniform = [](GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetActiveUniform", { program, index, bufSize, length, size, type, name }, false);
+            const Uniform& uniform = stub.m_uniforms[index];
+            *size = uniform.size;
+            *type = uniform.type;
+            // Like GL, arrays are reported with the name of the first element
+            CopyString(uniform.size > 1 ? uniform.name + "[0]" : uniform.name, bufSize, length, name);
+        };
+
+    glad_glGetActiveUniformBlockiv = [](GLuint program, GLuint uniformBlockIndex, GLenum pname, GLint* params)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetActiveUniformBlockiv", { program, uniformBlockIndex, pname, params }, false);
+            *params = pname == GL_UNIFORM_BLOCK_DATA_SIZE ? stub.m_uniformBlocks[uniformBlockIndex].dataSize : 0;
+        };
+
+    glad_glGetActiveUniformsiv = [](GLuint program, GLsizei uniformCount, const GLuint* uniformIndices, GLenum pname, GLint* params)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetActiveUniformsiv", { program, uniformCount, uniformIndices, pname, params }, false);
+            for (GLsizei i = 0; i < uniformCount; ++i)
+            {
+                const Uniform& uniform = stub.m_uniforms[uniformIndices[i]];
+                switch (pname)
+                {
+                case GL_UNIFORM_BLOCK_INDEX: params[i] = uniform.blockIndex; break;
+                case GL_UNIFORM_OFFSET: params[i] = uniform.offset; break;
+                case GL_UNIFORM_ARRAY_STRIDE: params[i] = uniform.arrayStride; break;
+                case GL_UNIFORM_MATRIX_STRIDE: params[i] = uniform.matrixStride; break;
+                default: params[i] = 0; break;
+                }
+            }
+        };
+
+    glad_glGetAttachedShaders = [](GLuint program, GLsizei maxCount, GLsizei* count, GLuint* shaders)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetAttachedShaders", { program, maxCount, count, shaders }, false);
+            if (count)
+            {
+                *count = 0;
+            }
+        };
+
+    glad_glGetAttribLocation = [](GLuint program, const GLchar* name) -> GLint
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetAttribLocation", { program, name }, false);
+            return -1;
+        };
+
+    glad_glGetError = []() -> GLenum
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetError", {}, false);
+            return GL_NO_ERROR;
+        };
+
+    glad_glGetIntegerv = [](GLenum pname, GLint* data)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetIntegerv", { pname, data }, false);
+            switch (pname)
+            {
+            case GL_VIEWPORT:
+                std::copy(stub.m_viewport.begin(), stub.m_viewport.end(), data);
+                break;
+            case GL_SCISSOR_BOX:
+                std::copy(stub.m_scissor.begin(), stub.m_scissor.end(), data);
+                break;
+            case GL_ACTIVE_TEXTURE:
+                *data = stub.m_activeTexture;
+                break;
+            case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT:
+                *data = 256;
+                break;
+            default:
+                *data = 0;
+                break;
+            }
+        };
+
+    glad_glGetnUniformdv = [](GLuint program, GLint location, GLsizei bufSize, GLdouble* params)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetnUniformdv", { program, location, bufSize, params }, false);
+            std::memset(params, 0, bufSize);
+        };
+
+    glad_glGetnUniformfv = [](GLuint program, GLint location, GLsizei bufSize, GLfloat* params)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetnUniformfv", { program, location, bufSize, params }, false);
+            std::memset(params, 0, bufSize);
+        };
+
+    glad_glGetnUniformiv = [](GLuint program, GLint location, GLsizei bufSize, GLint* params)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetnUniformiv", { program, location, bufSize, params }, false);
+            std::memset(params, 0, bufSize);
+        };
+
+    glad_glGetnUniformuiv = [](GLuint program, GLint location, GLsizei bufSize, GLuint* params)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetnUniformuiv", { program, location, bufSize, params }, false);
+            std::memset(params, 0, bufSize);
+        };
+
+    glad_glGetProgramBinary = [](GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetProgramBinary", { program, bufSize, length, binaryFormat, binary }, false);
+            // No binary formats, programs always need to be linked
+            if (length)
+            {
+                *length = 0;
+            }
+        };
+
+    glad_glGetProgramInfoLog = [](GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetProgramInfoLog", { program, bufSize, length, infoLog }, false);
+            CopyString("", bufSize, length, infoLog);
+        };
+
+    glad_glGetProgramiv = [](GLuint program, GLenum pname, GLint* params)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetProgramiv", { program, pname, params }, false);
+            switch (pname)
+            {
+            case GL_LINK_STATUS:
+            case GL_VALIDATE_STATUS:
+                *params = stub.m_linkedPrograms.contains(program) ? GL_TRUE : GL_FALSE;
+                break;
+            case GL_ACTIVE_UNIFORMS:
+                *params = static_cast<GLint>(stub.m_uniforms.size());
+                break;
+            case GL_ACTIVE_UNIFORM_BLOCKS:
+                *params = static_cast<GLint>(stub.m_uniformBlocks.size());
+                break;
+            default:
+                *params = 0;
+                break;
+            }
+        };
+
+    glad_glGetQueryObjectiv = [](GLuint id, GLenum pname, GLint* params)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetQueryObjectiv", { id, pname, params }, false);
+            *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+        };
+
+    glad_glGetQueryObjectui64v = [](GLuint id, GLenum pname, GLuint64* params)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetQueryObjectui64v", { id, pname, params }, false);
+            *params = 0;
+        };
+
+    glad_glGetShaderInfoLog = [](GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetShaderInfoLog", { shader, bufSize, length, infoLog }, false);
+            CopyString("", bufSize, length, infoLog);
+        };
+
+    glad_glGetShaderiv = [](GLuint shader, GLenum pname, GLint* params)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetShaderiv", { shader, pname, params }, false);
+            switch (pname)
+            {
+            case GL_COMPILE_STATUS:
+                *params = stub.m_compiledShaders.contains(shader) ? GL_TRUE : GL_FALSE;
+                break;
+            case GL_SHADER_TYPE:
+                *params = stub.m_shaderTypes[shader];
+                break;
+            default:
+                *params = 0;
+                break;
+            }
+        };
+
+    glad_glGetString = [](GLenum name) -> const GLubyte*
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetString", { name }, false);
+            return reinterpret_cast<const GLubyte*>("GLStub");
+        };
+
+    glad_glGetStringi = [](GLenum name, GLuint index) -> const GLubyte*
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetStringi", { name, index }, false);
+            return nullptr;
+        };
+
+    glad_glGetTexParameterfv = [](GLenum target, GLenum pname, GLfloat* params)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetTexParameterfv", { target, pname, params }, false);
+            *params = 0;
+        };
+
+    glad_glGetTexParameterIuiv = [](GLenum target, GLenum pname, GLuint* params)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetTexParameterIuiv", { target, pname, params }, false);
+            *params = 0;
+        };
+
+    glad_glGetTexParameteriv = [](GLenum target, GLenum pname, GLint* params)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetTexParameteriv", { target, pname, params }, false);
+            *params = 0;
+        };
+
+    glad_glGetUniformBlockIndex = [](GLuint program, const GLchar* uniformBlockName) -> GLuint
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetUniformBlockIndex", { program, uniformBlockName }, false);
+            auto it = std::find_if(stub.m_uniformBlocks.begin(), stub.m_uniformBlocks.end(),
+                [uniformBlockName](const UniformBlock& uniformBlock) { return uniformBlock.name == uniformBlockName; });
+            return it != stub.m_uniformBlocks.end() ? static_cast<GLuint>(it - stub.m_uniformBlocks.begin()) : GL_INVALID_INDEX;
+        };
+
+    glad_glGetUniformLocation = [](GLuint program, const GLchar* name) -> GLint
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glGetUniformLocation", { program, name }, false);
+            return stub.FindUniformLocation(name);
+        };
+
+    glad_glIsEnabled = [](GLenum cap) -> GLboolean
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glIsEnabled", { cap }, false);
+            return stub.m_enabledFeatures.contains(cap) ? GL_TRUE : GL_FALSE;
+        };
+
+    glad_glLinkProgram = [](GLuint program)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glLinkProgram", { program }, false);
+            stub.m_linkedPrograms.insert(program);
+        };
+
+    glad_glMapBufferRange = [](GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) -> void*
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glMapBufferRange", { target, offset, length, access }, false);
+            GLuint buffer = stub.m_boundBuffers[target];
+            assert(buffer != 0 && offset + length <= stub.GetBufferSize(buffer));
+            if (stub.m_mapFailing)
+            {
+                return nullptr;
+            }
+            // Client memory kept until the buffer is deleted
+            std::vector<std::byte>& data = stub.m_mappedData[buffer];
+            data.resize(stub.GetBufferSize(buffer));
+            return data.data() + offset;
+        };
+
+    glad_glMultiDrawElementsBaseVertex = [](GLenum mode, const GLsizei* count, GLenum type, const void* const*indices, GLsizei drawcount, const GLint* basevertex)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glMultiDrawElementsBaseVertex", { mode, count, type, indices, drawcount, basevertex }, false);
+        };
+
+    glad_glPolygonMode = [](GLenum face, GLenum mode)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glPolygonMode", { face, mode }, true);
+        };
+
+    glad_glProgramBinary = [](GLuint program, GLenum binaryFormat, const void* binary, GLsizei length)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glProgramBinary", { program, binaryFormat, binary, length }, false);
+        };
+
+    glad_glProgramParameteri = [](GLuint program, GLenum pname, GLint value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glProgramParameteri", { program, pname, value }, false);
+        };
+
+    glad_glScissor = [](GLint x, GLint y, GLsizei width, GLsizei height)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glScissor", { x, y, width, height }, true);
+            stub.m_scissor = { x, y, width, height };
+        };
+
+    glad_glShaderSource = [](GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glShaderSource", { shader, count, string, length }, false);
+        };
+
+    glad_glStencilFunc = [](GLenum func, GLint ref, GLuint mask)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glStencilFunc", { func, ref, mask }, true);
+        };
+
+    glad_glStencilFuncSeparate = [](GLenum face, GLenum func, GLint ref, GLuint mask)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glStencilFuncSeparate", { face, func, ref, mask }, true);
+        };
+
+    glad_glStencilOp = [](GLenum fail, GLenum zfail, GLenum zpass)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glStencilOp", { fail, zfail, zpass }, true);
+        };
+
+    glad_glStencilOpSeparate = [](GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glStencilOpSeparate", { face, sfail, dpfail, dppass }, true);
+        };
+
+    glad_glTexBuffer = [](GLenum target, GLenum internalformat, GLuint buffer)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glTexBuffer", { target, internalformat, buffer }, false);
+        };
+
+    glad_glTexImage2D = [](GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glTexImage2D", { target, level, internalformat, width, height, border, format, type, pixels }, false);
+        };
+
+    glad_glTexParameterf = [](GLenum target, GLenum pname, GLfloat param)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glTexParameterf", { target, pname, param }, false);
+        };
+
+    glad_glTexParameterfv = [](GLenum target, GLenum pname, const GLfloat* params)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glTexParameterfv", { target, pname, params }, false);
+        };
+
+    glad_glTexParameteri = [](GLenum target, GLenum pname, GLint param)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glTexParameteri", { target, pname, param }, false);
+        };
+
+    glad_glTexParameterIuiv = [](GLenum target, GLenum pname, const GLuint* params)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glTexParameterIuiv", { target, pname, params }, false);
+        };
+
+    glad_glUniform1dv = [](GLint location, GLsizei count, const GLdouble* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniform1dv", { location, count, value }, false);
+        };
+
+    glad_glUniform1fv = [](GLint location, GLsizei count, const GLfloat* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniform1fv", { location, count, value }, false);
+        };
+
+    glad_glUniform1iv = [](GLint location, GLsizei count, const GLint* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniform1iv", { location, count, value }, false);
+        };
+
+    glad_glUniform1uiv = [](GLint location, GLsizei count, const GLuint* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniform1uiv", { location, count, value }, false);
+        };
+
+    glad_glUniform2dv = [](GLint location, GLsizei count, const GLdouble* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniform2dv", { location, count, value }, false);
+        };
+
+    glad_glUniform2fv = [](GLint location, GLsizei count, const GLfloat* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniform2fv", { location, count, value }, false);
+        };
+
+    glad_glUniform2iv = [](GLint location, GLsizei count, const GLint* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniform2iv", { location, count, value }, false);
+        };
+
+    glad_glUniform2uiv = [](GLint location, GLsizei count, const GLuint* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniform2uiv", { location, count, value }, false);
+        };
+
+    glad_glUniform3dv = [](GLint location, GLsizei count, const GLdouble* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniform3dv", { location, count, value }, false);
+        };
+
+    glad_glUniform3fv = [](GLint location, GLsizei count, const GLfloat* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniform3fv", { location, count, value }, false);
+        };
+
+    glad_glUniform3iv = [](GLint location, GLsizei count, const GLint* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniform3iv", { location, count, value }, false);
+        };
+
+    glad_glUniform3uiv = [](GLint location, GLsizei count, const GLuint* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniform3uiv", { location, count, value }, false);
+        };
+
+    glad_glUniform4dv = [](GLint location, GLsizei count, const GLdouble* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniform4dv", { location, count, value }, false);
+        };
+
+    glad_glUniform4fv = [](GLint location, GLsizei count, const GLfloat* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniform4fv", { location, count, value }, false);
+        };
+
+    glad_glUniform4iv = [](GLint location, GLsizei count, const GLint* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniform4iv", { location, count, value }, false);
+        };
+
+    glad_glUniform4uiv = [](GLint location, GLsizei count, const GLuint* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniform4uiv", { location, count, value }, false);
+        };
+
+    glad_glUniformBlockBinding = [](GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniformBlockBinding", { program, uniformBlockIndex, uniformBlockBinding }, false);
+        };
+
+    glad_glUniformMatrix2fv = [](GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniformMatrix2fv", { location, count, transpose, value }, false);
+        };
+
+    glad_glUniformMatrix2x3fv = [](GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniformMatrix2x3fv", { location, count, transpose, value }, false);
+        };
+
+    glad_glUniformMatrix2x4fv = [](GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniformMatrix2x4fv", { location, count, transpose, value }, false);
+        };
+
+    glad_glUniformMatrix3fv = [](GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniformMatrix3fv", { location, count, transpose, value }, false);
+        };
+
+    glad_glUniformMatrix3x2fv = [](GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniformMatrix3x2fv", { location, count, transpose, value }, false);
+        };
+
+    glad_glUniformMatrix3x4fv = [](GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniformMatrix3x4fv", { location, count, transpose, value }, false);
+        };
+
+    glad_glUniformMatrix4fv = [](GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniformMatrix4fv", { location, count, transpose, value }, false);
+        };
+
+    glad_glUniformMatrix4x2fv = [](GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniformMatrix4x2fv", { location, count, transpose, value }, false);
+        };
+
+    glad_glUniformMatrix4x3fv = [](GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUniformMatrix4x3fv", { location, count, transpose, value }, false);
+        };
+
+    glad_glUnmapBuffer = [](GLenum target) -> GLboolean
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUnmapBuffer", { target }, false);
+            return stub.m_unmapFailing ? GL_FALSE : GL_TRUE;
+        };
+
+    glad_glUseProgram = [](GLuint program)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glUseProgram", { program }, true);
+        };
+
+    glad_glVertexAttribIPointer = [](GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glVertexAttribIPointer", { index, size, type, stride, pointer }, false);
+        };
+
+    glad_glVertexAttribPointer = [](GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glVertexAttribPointer", { index, size, type, normalized, stride, pointer }, false);
+        };
+
+    glad_glViewport = [](GLint x, GLint y, GLsizei width, GLsizei height)
+        {
+            GLStub& stub = GetInstance();
+            stub.Record("glViewport", { x, y, width, height }, true);
+            stub.m_viewport = { x, y, width, height };
+        };
+}
+
+#endif // ITUGL_GL_STUB
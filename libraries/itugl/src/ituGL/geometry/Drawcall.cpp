@@ -2,10 +2,11 @@
 
 #include <ituGL/geometry/VertexArrayObject.h>
 #include <ituGL/geometry/ElementBufferObject.h>
+#include <ituGL/core/DeviceGL.h>
 #include <cassert>
 
 Drawcall::Drawcall()
-    : m_primitive(Primitive::Invalid), m_first(0), m_count(0), m_eboType(Data::Type::None)
+    : m_primitive(Primitive::Invalid), m_first(0), m_count(0), m_eboType(Data::Type::None), m_baseVertex(0)
 {
 }
 
@@ -14,12 +15,13 @@ Drawcall::Drawcall(Primitive primitive, GLsizei count, GLint first)
 {
 }
 
-Drawcall::Drawcall(Primitive primitive, GLsizei count, Data::Type eboType, GLint first)
-    : m_primitive(primitive), m_first(first), m_count(count), m_eboType(eboType)
+Drawcall::Drawcall(Primitive primitive, GLsizei count, Data::Type eboType, GLint first, GLint baseVertex)
+    : m_primitive(primitive), m_first(first), m_count(count), m_eboType(eboType), m_baseVertex(baseVertex)
 {
     assert(primitive != Primitive::Invalid);
     assert(first >= 0);
     assert(count > 0);
+    assert(baseVertex == 0 || eboType != Data::Type::None);
 }
 
 // Execute the drawcall
@@ -28,6 +30,8 @@ void Drawcall::Draw() const
     assert(IsValid());
     assert(VertexArrayObject::IsAnyBound());
 
+    DeviceGL::GetInstance().AddDrawcall();
+
     GLenum primitive = static_cast<GLenum>(m_primitive);
     if (m_eboType == Data::Type::None)
     {
@@ -39,6 +43,41 @@ void Drawcall::Draw() const
         // If there is an EBO, use glDrawElements
         assert(ElementBufferObject::IsSupportedType(m_eboType));
         const char* basePointer = nullptr; // Actual element pointer is in VAO
-        glDrawElements(primitive, m_count, static_cast<GLenum>(m_eboType), basePointer + m_first);
+        if (m_baseVertex == 0)
+        {
+            glDrawElements(primitive, m_count, static_cast<GLenum>(m_eboType), basePointer + m_first);
+        }
+        else
+        {
+            glDrawElementsBaseVertex(primitive, m_count, static_cast<GLenum>(m_eboType), basePointer + m_first, m_baseVertex);
+        }
+    }
+}
+
+// Execute the drawcall several times
+void Drawcall::Draw(GLsizei instanceCount) const
+{
+    assert(IsValid());
+    assert(VertexArrayObject::IsAnyBound());
+    assert(instanceCount > 0);
+
+    if (instanceCount == 1)
+    {
+        Draw();
+        return;
+    }
+
+    DeviceGL::GetInstance().AddDrawcall();
+
+    GLenum primitive = static_cast<GLenum>(m_primitive);
+    if (m_eboType == Data::Type::None)
+    {
+        glDrawArraysInstanced(primitive, m_first, m_count, instanceCount);
+    }
+    else
+    {
+        assert(ElementBufferObject::IsSupportedType(m_eboType));
+        const char* basePointer = nullptr; // Actual element pointer is in VAO
+        glDrawElementsInstancedBaseVertex(primitive, m_count, static_cast<GLenum>(m_eboType), basePointer + m_first, instanceCount, m_baseVertex);
     }
 }
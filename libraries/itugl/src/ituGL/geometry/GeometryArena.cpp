@@ -0,0 +1,157 @@
+#include <ituGL/geometry/GeometryArena.h>
+
+#include <algorithm>
+#include <cassert>
+
+GeometryArena::GeometryArena(unsigned int poolVertexCapacity, unsigned int elementCapacity)
+    : m_poolVertexCapacity(poolVertexCapacity), m_elementAllocator(elementCapacity)
+{
+    m_ebo.Bind();
+    m_ebo.AllocateData<GLuint>(elementCapacity);
+    ElementBufferObject::Unbind();
+}
+
+GeometryArena::Pool::Pool(const VertexFormat& vertexFormat, const SemanticMap& locations, unsigned int vertexCapacity)
+    : vertexFormat(vertexFormat), locations(locations), allocator(vertexCapacity)
+{
+}
+
+GeometryArena::Allocation GeometryArena::Allocate(const VertexFormat& vertexFormat, std::span<const std::byte> vertexData, std::span<const GLuint> elements,
+    const SemanticMap& locations)
+{
+    Allocation allocation;
+
+    size_t vertexSize = vertexFormat.GetSize();
+    assert(vertexSize > 0 && vertexData.size() % vertexSize == 0);
+    unsigned int vertexCount = static_cast<unsigned int>(vertexData.size() / vertexSize);
+    unsigned int elementCount = static_cast<unsigned int>(elements.size());
+    if (vertexCount == 0 || elementCount == 0)
+    {
+        return allocation;
+    }
+
+    // Reserve the elements first, the EBO can't grow
+    unsigned int firstElement = m_elementAllocator.Allocate(elementCount);
+    if (firstElement == RangeAllocator::InvalidOffset)
+    {
+        return allocation;
+    }
+
+    unsigned int poolIndex = FindOrCreatePool(vertexFormat, locations, vertexCount);
+    Pool& pool = *m_pools[poolIndex];
+    unsigned int baseVertex = pool.allocator.Allocate(vertexCount);
+    assert(baseVertex != RangeAllocator::InvalidOffset);
+
+    pool.vbo.Bind();
+    pool.vbo.UpdateData(vertexData, baseVertex * vertexSize);
+    VertexBufferObject::Unbind();
+
+    // Element buffer binding is part of the VAO state, update it out of any VAO
+    VertexArrayObject::Unbind();
+    m_ebo.Bind();
+    m_ebo.UpdateData(elements, firstElement * sizeof(GLuint));
+    ElementBufferObject::Unbind();
+
+    allocation.poolIndex = poolIndex;
+    allocation.baseVertex = baseVertex;
+    allocation.vertexCount = vertexCount;
+    allocation.firstElement = firstElement;
+    allocation.elementCount = elementCount;
+    return allocation;
+}
+
+void GeometryArena::Free(const Allocation& allocation)
+{
+    if (allocation.IsValid())
+    {
+        m_pools[allocation.poolIndex]->allocator.Free(allocation.baseVertex, allocation.vertexCount);
+        m_elementAllocator.Free(allocation.firstElement, allocation.elementCount);
+    }
+}
+
+const VertexArrayObject& GeometryArena::GetVertexArray(unsigned int poolIndex) const
+{
+    assert(poolIndex < m_pools.size());
+    return m_pools[poolIndex]->vao;
+}
+
+GeometryArena::Stats GeometryArena::GetStats() const
+{
+    Stats stats = {};
+    stats.poolCount = GetPoolCount();
+    for (const std::unique_ptr<Pool>& pool : m_pools)
+    {
+        stats.vertexCapacity += pool->allocator.GetCapacity();
+        stats.vertexCount += pool->allocator.GetUsedSize();
+        stats.vertexFreeBlockCount += pool->allocator.GetFreeBlockCount();
+        stats.vertexLargestFreeBlock = std::max(stats.vertexLargestFreeBlock, pool->allocator.GetLargestFreeBlock());
+    }
+    stats.elementCapacity = m_elementAllocator.GetCapacity();
+    stats.elementCount = m_elementAllocator.GetUsedSize();
+    stats.elementFreeBlockCount = m_elementAllocator.GetFreeBlockCount();
+    stats.elementLargestFreeBlock = m_elementAllocator.GetLargestFreeBlock();
+    stats.elementFragmentation = m_elementAllocator.GetFragmentation();
+    return stats;
+}
+
+unsigned int GeometryArena::FindOrCreatePool(const VertexFormat& vertexFormat, const SemanticMap& locations, unsigned int vertexCount)
+{
+    for (unsigned int poolIndex = 0; poolIndex < m_pools.size(); ++poolIndex)
+    {
+        const Pool& pool = *m_pools[poolIndex];
+        if (pool.allocator.GetLargestFreeBlock() >= vertexCount && pool.locations == locations && IsSameFormat(pool.vertexFormat, vertexFormat))
+        {
+            return poolIndex;
+        }
+    }
+
+    // Bigger meshes get a pool of their own size
+    unsigned int poolIndex = GetPoolCount();
+    Pool& pool = *m_pools.emplace_back(std::make_unique<Pool>(vertexFormat, locations, std::max(vertexCount, m_poolVertexCapacity)));
+
+    pool.vbo.Bind();
+    pool.vbo.AllocateData(pool.allocator.GetCapacity() * vertexFormat.GetSize());
+
+    // Same attribute setup as Mesh, always interleaved
+    pool.vao.Bind();
+    GLuint location = 0;
+    auto itEnd = pool.vertexFormat.LayoutEnd();
+    for (auto it = pool.vertexFormat.LayoutBegin(pool.allocator.GetCapacity(), true); it != itEnd; it++)
+    {
+        const VertexAttribute& attribute = it->GetAttribute();
+        auto itLocation = locations.find(attribute.GetSemantic());
+        if (itLocation != locations.end())
+        {
+            location = itLocation->second;
+        }
+        pool.vao.SetAttribute(location, attribute, it->GetOffset(), it->GetStride());
+        location += attribute.GetLocationSize();
+    }
+    m_ebo.Bind();
+
+    VertexArrayObject::Unbind();
+    VertexBufferObject::Unbind();
+    ElementBufferObject::Unbind();
+
+    return poolIndex;
+}
+
+bool GeometryArena::IsSameFormat(const VertexFormat& a, const VertexFormat& b)
+{
+    if (a.GetSize() != b.GetSize() || a.GetAttributeCount() != b.GetAttributeCount())
+    {
+        return false;
+    }
+
+    for (int i = 0; i < a.GetAttributeCount(); ++i)
+    {
+        VertexAttribute attributeA = a.GetAttribute(i);
+        VertexAttribute attributeB = b.GetAttribute(i);
+        if (attributeA.GetType() != attributeB.GetType() || attributeA.GetComponents() != attributeB.GetComponents()
+            || attributeA.IsNormalized() != attributeB.IsNormalized() || attributeA.GetSemantic() != attributeB.GetSemantic())
+        {
+            return false;
+        }
+    }
+    return true;
+}
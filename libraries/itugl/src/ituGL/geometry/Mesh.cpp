@@ -1,9 +1,22 @@
 #include <ituGL/geometry/Mesh.h>
 
-Mesh::Mesh()
+#include <glm/common.hpp>
+#include <limits>
+#include <cassert>
+
+Mesh::Mesh() : m_bounds(glm::vec3(0.0f), glm::vec3(0.0f)), m_hasBounds(false)
 {
 }
 
+Mesh::~Mesh()
+{
+    // Give the ranges back to the arena, so other meshes can use them
+    for (const GeometryArena::Allocation& allocation : m_arenaAllocations)
+    {
+        m_arena->Free(allocation);
+    }
+}
+
 unsigned int Mesh::AddVertexData(size_t size)
 {
     unsigned int vboIndex = GetVertexBufferCount();
@@ -23,9 +36,9 @@ unsigned int Mesh::AddVertexArray()
 unsigned int Mesh::AddSubmesh(unsigned int vaoIndex, const Drawcall& drawcall)
 {
     unsigned int submeshIndex = GetSubmeshCount();
-    Submesh& submesh = m_submeshes.emplace_back();
-    submesh.vaoIndex = vaoIndex;
-    submesh.drawcall = drawcall;
+    m_submeshes.push_back(Submesh{ vaoIndex, drawcall, AabbBounds(glm::vec3(0.0f), glm::vec3(0.0f)), false, false });
+    // A submesh without bounds makes the whole mesh unbounded
+    m_hasBounds = false;
     return submeshIndex;
 }
 
@@ -35,11 +48,73 @@ unsigned int Mesh::AddSubmesh(unsigned int vaoIndex,
     return AddSubmesh(vaoIndex, Drawcall(primitive, count, eboType, first));
 }
 
+GeometryArena::Allocation Mesh::AddArenaData(std::shared_ptr<GeometryArena> arena, const VertexFormat& vertexFormat,
+    std::span<const std::byte> vertexData, std::span<const GLuint> elements, const SemanticMap& locations)
+{
+    assert(arena);
+    assert(!m_arena || m_arena == arena);
+
+    GeometryArena::Allocation allocation = arena->Allocate(vertexFormat, vertexData, elements, locations);
+    if (allocation.IsValid())
+    {
+        m_arena = arena;
+        m_arenaAllocations.push_back(allocation);
+    }
+    return allocation;
+}
+
+unsigned int Mesh::AddArenaSubmesh(const GeometryArena::Allocation& allocation, Drawcall::Primitive primitive, int firstElement, int elementCount)
+{
+    assert(allocation.IsValid());
+    assert(firstElement >= 0 && firstElement + elementCount <= static_cast<int>(allocation.elementCount));
+
+    // Arena elements are always 32-bit, and relative to the base vertex of the allocation
+    GLint firstByte = static_cast<GLint>((allocation.firstElement + firstElement) * sizeof(GLuint));
+    Drawcall drawcall(primitive, elementCount, Data::Type::UInt, firstByte, static_cast<GLint>(allocation.baseVertex));
+
+    unsigned int submeshIndex = AddSubmesh(allocation.poolIndex, drawcall);
+    GetSubmesh(submeshIndex).inArena = true;
+    return submeshIndex;
+}
+
+const VertexArrayObject& Mesh::GetSubmeshVertexArray(unsigned int submeshIndex) const
+{
+    const Submesh& submesh = GetSubmesh(submeshIndex);
+    return submesh.inArena ? m_arena->GetVertexArray(submesh.vaoIndex) : GetVertexArray(submesh.vaoIndex);
+}
+
+void Mesh::SetSubmeshBounds(unsigned int submeshIndex, const AabbBounds& bounds)
+{
+    Submesh& submesh = GetSubmesh(submeshIndex);
+    submesh.bounds = bounds;
+    submesh.hasBounds = true;
+    UpdateBounds();
+}
+
+void Mesh::UpdateBounds()
+{
+    m_hasBounds = !m_submeshes.empty();
+    glm::vec3 boundsMin(std::numeric_limits<float>::max());
+    glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+    for (const Submesh& submesh : m_submeshes)
+    {
+        m_hasBounds &= submesh.hasBounds;
+        boundsMin = glm::min(boundsMin, submesh.bounds.GetMin());
+        boundsMax = glm::max(boundsMax, submesh.bounds.GetMax());
+    }
+
+    if (m_hasBounds)
+    {
+        m_bounds.SetCenter(0.5f * (boundsMin + boundsMax));
+        m_bounds.SetSize(0.5f * (boundsMax - boundsMin));
+    }
+}
+
 // Bind the VAO and render the drawcall of the submesh
 void Mesh::DrawSubmesh(int submeshIndex) const
 {
     const Submesh& submesh = GetSubmesh(submeshIndex);
-    const VertexArrayObject& vao = GetVertexArray(submesh.vaoIndex);
+    const VertexArrayObject& vao = GetSubmeshVertexArray(submeshIndex);
     vao.Bind();
     submesh.drawcall.Draw();
     //VertexArrayObject::Unbind(); // No need to unbind
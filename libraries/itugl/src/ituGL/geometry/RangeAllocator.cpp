@@ -0,0 +1,92 @@
+#include <ituGL/geometry/RangeAllocator.h>
+
+#include <algorithm>
+#include <cassert>
+
+RangeAllocator::RangeAllocator(unsigned int capacity) : m_capacity(capacity), m_usedSize(0)
+{
+    Clear();
+}
+
+unsigned int RangeAllocator::Allocate(unsigned int size)
+{
+    assert(size > 0);
+
+    // First fit: the block with the lowest offset keeps the used ranges packed at the start
+    for (auto it = m_freeBlocks.begin(); it != m_freeBlocks.end(); ++it)
+    {
+        if (it->second >= size)
+        {
+            unsigned int offset = it->first;
+            unsigned int remainingSize = it->second - size;
+            m_freeBlocks.erase(it);
+            if (remainingSize > 0)
+            {
+                m_freeBlocks.emplace(offset + size, remainingSize);
+            }
+            m_usedSize += size;
+            return offset;
+        }
+    }
+    return InvalidOffset;
+}
+
+void RangeAllocator::Free(unsigned int offset, unsigned int size)
+{
+    assert(size > 0);
+    assert(offset + size <= m_capacity);
+    assert(size <= m_usedSize);
+
+    m_usedSize -= size;
+
+    auto itNext = m_freeBlocks.lower_bound(offset);
+    assert(itNext == m_freeBlocks.end() || offset + size <= itNext->first);
+
+    // Merge with the previous free block if they are contiguous
+    if (itNext != m_freeBlocks.begin())
+    {
+        auto itPrevious = std::prev(itNext);
+        assert(itPrevious->first + itPrevious->second <= offset);
+        if (itPrevious->first + itPrevious->second == offset)
+        {
+            offset = itPrevious->first;
+            size += itPrevious->second;
+            m_freeBlocks.erase(itPrevious);
+        }
+    }
+
+    // Merge with the next free block if they are contiguous
+    if (itNext != m_freeBlocks.end() && offset + size == itNext->first)
+    {
+        size += itNext->second;
+        m_freeBlocks.erase(itNext);
+    }
+
+    m_freeBlocks.emplace(offset, size);
+}
+
+void RangeAllocator::Clear()
+{
+    m_freeBlocks.clear();
+    if (m_capacity > 0)
+    {
+        m_freeBlocks.emplace(0u, m_capacity);
+    }
+    m_usedSize = 0;
+}
+
+unsigned int RangeAllocator::GetLargestFreeBlock() const
+{
+    unsigned int largestSize = 0;
+    for (const auto& freeBlock : m_freeBlocks)
+    {
+        largestSize = std::max(largestSize, freeBlock.second);
+    }
+    return largestSize;
+}
+
+float RangeAllocator::GetFragmentation() const
+{
+    unsigned int freeSize = GetFreeSize();
+    return freeSize > 0 ? 1.0f - static_cast<float>(GetLargestFreeBlock()) / freeSize : 0.0f;
+}
@@ -0,0 +1,111 @@
+#include <ituGL/renderer/BloomRenderPass.h>
+
+#include <ituGL/renderer/Renderer.h>
+#include <ituGL/shader/Material.h>
+#include <ituGL/texture/Texture2DObject.h>
+#include <ituGL/texture/FramebufferObject.h>
+#include <algorithm>
+#include <cassert>
+
+BloomRenderPass::BloomRenderPass(int width, int height, std::shared_ptr<Material> downsampleMaterial, std::shared_ptr<Material> upsampleMaterial,
+    unsigned int levelCount)
+    : m_downsampleMaterial(downsampleMaterial), m_upsampleMaterial(upsampleMaterial)
+    , m_sourceTexelSize(1.0f / width, 1.0f / height)
+    , m_range(1.0f, 2.0f), m_intensity(1.0f), m_radius(1.0f)
+{
+    assert(m_downsampleMaterial && m_upsampleMaterial);
+
+    // Each level is added to the one above
+    m_upsampleMaterial->SetBlendEquation(Material::BlendEquation::Add);
+    m_upsampleMaterial->SetBlendParams(Material::BlendParam::One, Material::BlendParam::One);
+
+    InitLevels(width, height, levelCount);
+}
+
+void BloomRenderPass::InitLevels(int width, int height, unsigned int levelCount)
+{
+    for (unsigned int i = 0; i < levelCount; ++i)
+    {
+        width /= 2;
+        height /= 2;
+        if (!m_levels.empty() && std::min(width, height) < 2)
+        {
+            break;
+        }
+
+        Level level;
+        level.width = std::max(width, 1);
+        level.height = std::max(height, 1);
+
+        // Bloom doesn't need alpha, half the memory of RGBA16F
+        level.texture = std::make_shared<Texture2DObject>();
+        level.texture->Bind();
+        level.texture->SetImage(0, level.width, level.height, TextureObject::FormatRGB, TextureObject::InternalFormatR11G11B10);
+        level.texture->SetParameter(TextureObject::ParameterEnum::WrapS, GL_CLAMP_TO_EDGE);
+        level.texture->SetParameter(TextureObject::ParameterEnum::WrapT, GL_CLAMP_TO_EDGE);
+        level.texture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR);
+        level.texture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
+        Texture2DObject::Unbind();
+
+        level.framebuffer = std::make_shared<FramebufferObject>();
+        level.framebuffer->Bind();
+        level.framebuffer->SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Color0, *level.texture);
+        level.framebuffer->SetDrawBuffers(std::array<FramebufferObject::Attachment, 1>({ FramebufferObject::Attachment::Color0 }));
+        FramebufferObject::Unbind();
+
+        m_levels.push_back(level);
+    }
+
+    // The upsample finishes in the first level, so the renderer keeps it bound after the pass
+    m_targetFramebuffer = m_levels.front().framebuffer;
+}
+
+void BloomRenderPass::Render()
+{
+    Renderer& renderer = GetRenderer();
+    DeviceGL& device = renderer.GetDevice();
+
+    assert(m_sourceTexture);
+
+    glm::ivec4 viewport = device.GetViewport();
+
+    // Downsample. The first level keeps only the bright pixels.
+    // The upsample adds one copy of the bloom per level, divide the intensity to keep the same brightness
+    m_downsampleMaterial->SetUniformValue("Range", m_range);
+    m_downsampleMaterial->SetUniformValue("Intensity", m_intensity / m_levels.size());
+    m_downsampleMaterial->SetUniformValue("Prefilter", 1);
+    DrawLevel(*m_downsampleMaterial, m_sourceTexture, m_sourceTexelSize, m_levels[0]);
+
+    m_downsampleMaterial->SetUniformValue("Prefilter", 0);
+    for (unsigned int i = 1; i < m_levels.size(); ++i)
+    {
+        const Level& sourceLevel = m_levels[i - 1];
+        DrawLevel(*m_downsampleMaterial, sourceLevel.texture, 1.0f / glm::vec2(sourceLevel.width, sourceLevel.height), m_levels[i]);
+    }
+
+    // Upsample, from the smallest level to the first one
+    m_upsampleMaterial->SetUniformValue("Radius", m_radius);
+    for (unsigned int i = static_cast<unsigned int>(m_levels.size()) - 1; i > 0; --i)
+    {
+        const Level& sourceLevel = m_levels[i];
+        DrawLevel(*m_upsampleMaterial, sourceLevel.texture, 1.0f / glm::vec2(sourceLevel.width, sourceLevel.height), m_levels[i - 1]);
+    }
+
+    // Restore the viewport for the next passes
+    device.SetViewport(viewport.x, viewport.y, viewport.z, viewport.w);
+}
+
+void BloomRenderPass::DrawLevel(Material& material, std::shared_ptr<Texture2DObject> sourceTexture, const glm::vec2& sourceTexelSize, const Level& targetLevel)
+{
+    Renderer& renderer = GetRenderer();
+    DeviceGL& device = renderer.GetDevice();
+
+    targetLevel.framebuffer->Bind();
+    device.SetViewport(0, 0, targetLevel.width, targetLevel.height);
+
+    material.SetUniformValue("SourceTexture", sourceTexture);
+    material.SetUniformValue("SourceTexelSize", sourceTexelSize);
+    material.Use();
+
+    renderer.GetFullscreenMesh().DrawSubmesh(0);
+}
@@ -4,12 +4,20 @@
 #include <ituGL/geometry/VertexFormat.h>
 #include <ituGL/lighting/Light.h>
 #include <ituGL/camera/Camera.h>
+#include <ituGL/scene/Bounds.h>
 #include <ituGL/shader/Material.h>
 #include <ituGL/texture/Texture2DObject.h>
 #include <glm/gtx/transform.hpp>
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <vector>
+
+// Tessellation of the light volumes
+const unsigned int c_volumeSegments = 16;
+const unsigned int c_volumeRings = 8;
 
 DeferredRenderPass::DeferredRenderPass(std::shared_ptr<Material> material, std::shared_ptr<const FramebufferObject> framebuffer)
-    : RenderPass(framebuffer), m_material(material)
+    : RenderPass(framebuffer), m_material(material), m_viewport(0)
 {
     InitializeMeshes();
 }
@@ -17,15 +25,22 @@ DeferredRenderPass::DeferredRenderPass(std::shared_ptr<Material> material, std::
 void DeferredRenderPass::Render()
 {
     Renderer& renderer = GetRenderer();
+    DeviceGL& device = renderer.GetDevice();
 
-    renderer.GetDevice().Clear(true, Color(0.0f, 0.0f, 0.0f, 1.0f), false, 1.0f);
+    device.Clear(true, Color(0.0f, 0.0f, 0.0f, 1.0f), false, 1.0f);
 
     const Camera& camera = renderer.GetCurrentCamera();
+    FrustumBounds frustum(camera.GetViewProjectionMatrix());
+
+    m_viewport = device.GetViewport();
 
     assert(m_material);
     m_material->Use();
     std::shared_ptr<const ShaderProgram> shaderProgram = m_material->GetShaderProgram();
 
+    // The g-buffer depth is attached to the target, to depth test the light volumes. It must not be modified
+    device.SetDepthWrite(false);
+
     // Our fullscreen triangle is directly in clip coordinates.
     // Use the inverse view proj matrix to cancel view projection from the camera
     glm::mat4 fullscreenMatrix = glm::inverse(camera.GetViewProjectionMatrix());
@@ -40,22 +55,187 @@ void DeferredRenderPass::Render()
 
         const Mesh* mesh = &renderer.GetFullscreenMesh();
         glm::mat4 worldMatrix = fullscreenMatrix;
+        glm::ivec4 scissor(0);
 
-        // TODO: select different meshes depending on the type
+        // The first pass also has the indirect lighting, and covers the whole screen
+        LightVolume volume = first ? LightVolume::Fullscreen : GetLightVolume(*light, camera, frustum, mesh, worldMatrix, scissor);
+        if (volume == LightVolume::Culled)
+        {
+            continue;
+        }
 
         // Set the render states for the first and additional lights
         renderer.SetLightingRenderStates(first);
 
-        renderer.UpdateTransforms(shaderProgram, fullscreenMatrix, first);
+        if (volume == LightVolume::Mesh)
+        {
+            // Draw the back faces behind the surfaces, it works with the camera inside the volume too
+            device.SetCullFace(GL_FRONT);
+            device.SetDepthFunction(GL_GEQUAL);
+        }
+        else
+        {
+            // Fullscreen triangle is not depth tested
+            device.SetCullFace(GL_BACK);
+            device.SetDepthFunction(GL_ALWAYS);
+        }
+
+        device.SetFeatureEnabled(GL_SCISSOR_TEST, volume == LightVolume::Scissor);
+        if (volume == LightVolume::Scissor)
+        {
+            device.SetScissor(scissor.x, scissor.y, scissor.z, scissor.w);
+        }
+
+        renderer.UpdateTransforms(shaderProgram, worldMatrix, first);
         mesh->DrawSubmesh(0);
         first = false;
     }
 
-    //TODO: temp hack
-    renderer.GetDevice().EnableFeature(GL_DEPTH_TEST);
+    // Restore the default states
+    device.SetCullFace(GL_BACK);
+    device.DisableFeature(GL_SCISSOR_TEST);
+    device.SetDepthFunction(GL_LESS);
+    device.SetDepthWrite(true);
+}
+
+DeferredRenderPass::LightVolume DeferredRenderPass::GetLightVolume(const Light& light, const Camera& camera, const FrustumBounds& frustum,
+    const Mesh*& mesh, glm::mat4& worldMatrix, glm::ivec4& scissor) const
+{
+    // Lights without range affect every pixel
+    glm::vec4 attenuation = light.GetAttenuation();
+    float range = attenuation.y;
+    if (light.GetType() == Light::Type::Directional || range <= 0.0f)
+    {
+        return LightVolume::Fullscreen;
+    }
+
+    glm::vec3 position = light.GetPosition();
+    if (!Bounds::Intersects(frustum, SphereBounds(position, range)))
+    {
+        return LightVolume::Culled;
+    }
+
+    // Back faces behind the far plane are clipped, and the pixels would be missed. Use the projected bounds instead
+    const glm::mat4& projMatrix = camera.GetProjectionMatrix();
+    glm::vec3 viewPosition = camera.GetViewMatrix() * glm::vec4(position, 1.0f);
+    float farDistance = projMatrix[3][2] / (projMatrix[2][2] + 1.0f);
+    if (-viewPosition.z + range >= farDistance)
+    {
+        scissor = ComputeScissor(projMatrix, viewPosition, range);
+        return scissor.z > 0 && scissor.w > 0 ? LightVolume::Scissor : LightVolume::Culled;
+    }
+
+    // The shader lights the points where the direction to the light matches the spot direction
+    // so the cone goes from the light position along the negative direction.
+    // The cone is smaller than the sphere while its radius is less than twice its length
+    // From a half angle of pi/2 the light also reaches behind it, and the tangent is negative, so it uses the sphere
+    float coneRadius = std::tan(attenuation.w);
+    if (light.GetType() == Light::Type::Spot && attenuation.w > 0.0f && attenuation.w < glm::half_pi<float>() && coneRadius < 2.0f)
+    {
+        glm::vec3 axisZ = light.GetDirection();
+        glm::vec3 up = std::abs(axisZ.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+        glm::vec3 axisX = glm::normalize(glm::cross(up, axisZ));
+        glm::vec3 axisY = glm::cross(axisZ, axisX);
+        glm::mat4 rotationMatrix(glm::vec4(axisX, 0.0f), glm::vec4(axisY, 0.0f), glm::vec4(axisZ, 0.0f), glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+
+        mesh = &m_coneMesh;
+        worldMatrix = glm::translate(position) * rotationMatrix * glm::scale(glm::vec3(coneRadius * range, coneRadius * range, range));
+    }
+    else
+    {
+        mesh = &m_sphereMesh;
+        worldMatrix = glm::translate(position) * glm::scale(glm::vec3(range));
+    }
+    return LightVolume::Mesh;
+}
+
+glm::ivec4 DeferredRenderPass::ComputeScissor(const glm::mat4& projMatrix, const glm::vec3& center, float radius) const
+{
+    float nearDistance = projMatrix[3][2] / (projMatrix[2][2] - 1.0f);
+
+    // Screen bounds of the box around the sphere, clamped to the front of the near plane
+    glm::vec2 minNdc(1.0f);
+    glm::vec2 maxNdc(-1.0f);
+    for (int i = 0; i < 8; ++i)
+    {
+        glm::vec3 corner = center + radius * glm::vec3(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f);
+        corner.z = std::min(corner.z, -nearDistance);
+        glm::vec4 clip = projMatrix * glm::vec4(corner, 1.0f);
+        glm::vec2 ndc = glm::vec2(clip) / clip.w;
+        minNdc = glm::min(minNdc, ndc);
+        maxNdc = glm::max(maxNdc, ndc);
+    }
+    minNdc = glm::clamp(minNdc, glm::vec2(-1.0f), glm::vec2(1.0f));
+    maxNdc = glm::clamp(maxNdc, glm::vec2(-1.0f), glm::vec2(1.0f));
+
+    // Round outwards to whole pixels
+    glm::vec2 viewportOffset(m_viewport.x, m_viewport.y);
+    glm::vec2 viewportSize(m_viewport.z, m_viewport.w);
+    glm::ivec2 minPixel = glm::ivec2(glm::floor(viewportOffset + (minNdc * 0.5f + 0.5f) * viewportSize));
+    glm::ivec2 maxPixel = glm::ivec2(glm::ceil(viewportOffset + (maxNdc * 0.5f + 0.5f) * viewportSize));
+    return glm::ivec4(minPixel, glm::max(maxPixel - minPixel, glm::ivec2(0)));
 }
 
 void DeferredRenderPass::InitializeMeshes()
 {
-    //TODO: Create meshes for spot and point lights
+    VertexFormat vertexFormat;
+    vertexFormat.AddVertexAttribute<float>(3, VertexAttribute::Semantic::Position);
+
+    // The faces are inside the round shapes, push the vertices out so the volumes contain the whole range
+    float segmentScale = 1.0f / std::cos(glm::pi<float>() / c_volumeSegments);
+    float ringScale = 1.0f / std::cos(glm::half_pi<float>() / c_volumeRings);
+
+    // Sphere, with rings from top to bottom. Faces are counter-clockwise seen from outside
+    {
+        std::vector<glm::vec3> vertices;
+        for (unsigned int ring = 0; ring <= c_volumeRings; ++ring)
+        {
+            float latitude = glm::half_pi<float>() - glm::pi<float>() * ring / c_volumeRings;
+            for (unsigned int segment = 0; segment <= c_volumeSegments; ++segment)
+            {
+                float longitude = glm::two_pi<float>() * segment / c_volumeSegments;
+                glm::vec3 direction(std::cos(latitude) * std::cos(longitude), std::sin(latitude), std::cos(latitude) * std::sin(longitude));
+                vertices.push_back(direction * segmentScale * ringScale);
+            }
+        }
+
+        std::vector<unsigned short> elements;
+        for (unsigned int ring = 0; ring < c_volumeRings; ++ring)
+        {
+            for (unsigned int segment = 0; segment < c_volumeSegments; ++segment)
+            {
+                unsigned short upper = static_cast<unsigned short>(ring * (c_volumeSegments + 1) + segment);
+                unsigned short lower = static_cast<unsigned short>(upper + c_volumeSegments + 1);
+                elements.insert(elements.end(), { upper, static_cast<unsigned short>(lower + 1), lower });
+                elements.insert(elements.end(), { upper, static_cast<unsigned short>(upper + 1), static_cast<unsigned short>(lower + 1) });
+            }
+        }
+
+        m_sphereMesh.AddSubmesh<glm::vec3, unsigned short, VertexFormat::LayoutIterator>(Drawcall::Primitive::Triangles,
+            vertices, elements, vertexFormat.LayoutBegin(static_cast<int>(vertices.size()), false), vertexFormat.LayoutEnd());
+    }
+
+    // Cone, with the apex first, then the center of the base and the base vertices
+    {
+        std::vector<glm::vec3> vertices;
+        vertices.emplace_back(0.0f, 0.0f, 0.0f);
+        vertices.emplace_back(0.0f, 0.0f, -1.0f);
+        for (unsigned int segment = 0; segment < c_volumeSegments; ++segment)
+        {
+            float angle = glm::two_pi<float>() * segment / c_volumeSegments;
+            vertices.emplace_back(std::cos(angle) * segmentScale, std::sin(angle) * segmentScale, -1.0f);
+        }
+
+        std::vector<unsigned short> elements;
+        for (unsigned int segment = 0; segment < c_volumeSegments; ++segment)
+        {
+            unsigned short current = static_cast<unsigned short>(2 + segment);
+            unsigned short next = static_cast<unsigned short>(2 + (segment + 1) % c_volumeSegments);
+            elements.insert(elements.end(), { 0, current, next });
+            elements.insert(elements.end(), { 1, next, current });
+        }
+
+        m_coneMesh.AddSubmesh<glm::vec3, unsigned short, VertexFormat::LayoutIterator>(Drawcall::Primitive::Triangles,
+            vertices, elements, vertexFormat.LayoutBegin(static_cast<int>(vertices.size()), false), vertexFormat.LayoutEnd());
+    }
 }
@@ -23,13 +23,33 @@ void ForwardRenderPass::Render()
     const auto& lights = renderer.GetLights();
     const auto& drawcallCollection = renderer.GetDrawcalls(m_drawcallCollectionIndex);
 
+    bool lightClustersBuilt = false;
+
     // for all drawcalls
     for (const Renderer::DrawcallInfo& drawcallInfo : drawcallCollection)
     {
+        std::shared_ptr<const ShaderProgram> shaderProgram = drawcallInfo.GetMaterial().GetShaderProgram();
+        bool clustered = LightClusterGrid::IsSupported(*shaderProgram);
+
+        // Build the clusters before preparing the drawcall, uploading the buffers changes the texture bindings
+        if (clustered && !lightClustersBuilt)
+        {
+            glm::ivec4 viewport = renderer.GetDevice().GetViewport();
+            m_lightClusterGrid.Build(camera, lights, glm::ivec2(viewport.z, viewport.w));
+            lightClustersBuilt = true;
+        }
+
         // Prepare drawcall states
         renderer.PrepareDrawcall(drawcallInfo);
 
-        std::shared_ptr<const ShaderProgram> shaderProgram = drawcallInfo.GetMaterial().GetShaderProgram();
+        if (clustered)
+        {
+            // All the lights in a single pass
+            m_lightClusterGrid.SetUniforms(*shaderProgram);
+            renderer.SetLightingRenderStates(true);
+            renderer.Draw(drawcallInfo);
+            continue;
+        }
 
         //for all lights
         bool first = true;
@@ -40,7 +60,7 @@ void ForwardRenderPass::Render()
             renderer.SetLightingRenderStates(first);
 
             // Draw
-            drawcallInfo.GetDrawcall().Draw();
+            renderer.Draw(drawcallInfo);
 
             first = false;
         }
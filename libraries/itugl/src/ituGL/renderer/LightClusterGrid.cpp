@@ -0,0 +1,187 @@
+#include <ituGL/renderer/LightClusterGrid.h>
+
+#include <ituGL/camera/Camera.h>
+#include <ituGL/lighting/Light.h>
+#include <ituGL/texture/TextureBufferObject.h>
+#include <glm/common.hpp>
+#include <glm/exponential.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+LightClusterGrid::LightClusterGrid(unsigned int countX, unsigned int countY, unsigned int countZ)
+    : m_counts(countX, countY, countZ)
+    , m_near(0.1f), m_far(100.0f), m_sliceScale(0.0f), m_tileScale(0.0f), m_globalLightCount(0)
+    , m_lightsTexture(std::make_shared<TextureBufferObject>())
+    , m_rangesTexture(std::make_shared<TextureBufferObject>())
+    , m_lightIndicesTexture(std::make_shared<TextureBufferObject>())
+{
+    assert(countX > 0 && countY > 0 && countZ > 0);
+}
+
+void LightClusterGrid::Build(const Camera& camera, std::span<const Light* const> lights, const glm::ivec2& viewportSize)
+{
+    const glm::mat4& viewMatrix = camera.GetViewMatrix();
+    const glm::mat4& projMatrix = camera.GetProjectionMatrix();
+
+    // Near and far distances, from the perspective projection matrix
+    assert(projMatrix[2][3] != 0.0f);
+    m_near = std::max(projMatrix[3][2] / (projMatrix[2][2] - 1.0f), 0.001f);
+    m_far = std::max(projMatrix[3][2] / (projMatrix[2][2] + 1.0f), m_near * 2.0f);
+    m_sliceScale = m_counts.z / std::log(m_far / m_near);
+
+    m_tileScale = glm::vec2(m_counts.x, m_counts.y) / glm::max(glm::vec2(viewportSize), glm::vec2(1.0f));
+
+    m_lightData.clear();
+    m_lightBounds.clear();
+    m_ranges.assign(GetClusterCount(), glm::uvec2(0));
+    m_lightIndices.clear();
+
+    // Lights without range go first, they are not assigned to clusters
+    for (const Light* light : lights)
+    {
+        if (light->GetAttenuation().y <= 0.0f)
+        {
+            AddLightData(*light);
+        }
+    }
+    m_globalLightCount = static_cast<unsigned int>(m_lightData.size() / 4);
+
+    // Find the clusters of the other lights, and count how many lights each cluster has
+    for (const Light* light : lights)
+    {
+        float range = light->GetAttenuation().y;
+        if (range <= 0.0f)
+        {
+            continue;
+        }
+
+        glm::vec3 viewPosition = viewMatrix * glm::vec4(light->GetPosition(), 1.0f);
+        ClusterBounds bounds;
+        if (!ComputeClusterBounds(projMatrix, viewPosition, range, bounds))
+        {
+            continue;
+        }
+
+        AddLightData(*light);
+        m_lightBounds.push_back(bounds);
+        for (unsigned int z = bounds.min.z; z <= bounds.max.z; ++z)
+            for (unsigned int y = bounds.min.y; y <= bounds.max.y; ++y)
+                for (unsigned int x = bounds.min.x; x <= bounds.max.x; ++x)
+                    m_ranges[(z * m_counts.y + y) * m_counts.x + x].y++;
+    }
+
+    // Offsets of each cluster list, and reset the counts to be used as insertion points
+    unsigned int offset = 0;
+    for (glm::uvec2& range : m_ranges)
+    {
+        range.x = offset;
+        offset += range.y;
+        range.y = 0;
+    }
+    m_lightIndices.resize(offset);
+
+    // Fill the lists. Lights are stored in order, so each list is sorted by light index
+    for (unsigned int i = 0; i < m_lightBounds.size(); ++i)
+    {
+        const ClusterBounds& bounds = m_lightBounds[i];
+        GLuint lightIndex = m_globalLightCount + i;
+        for (unsigned int z = bounds.min.z; z <= bounds.max.z; ++z)
+            for (unsigned int y = bounds.min.y; y <= bounds.max.y; ++y)
+                for (unsigned int x = bounds.min.x; x <= bounds.max.x; ++x)
+                {
+                    glm::uvec2& range = m_ranges[(z * m_counts.y + y) * m_counts.x + x];
+                    m_lightIndices[range.x + range.y++] = lightIndex;
+                }
+    }
+
+    // Buffer textures can't be empty
+    if (m_lightData.empty())
+    {
+        m_lightData.resize(4, glm::vec4(0.0f));
+    }
+    if (m_lightIndices.empty())
+    {
+        m_lightIndices.push_back(0);
+    }
+
+    m_lightsTexture->Bind();
+    m_lightsTexture->SetData(std::span<const glm::vec4>(m_lightData), TextureObject::InternalFormatRGBA32F);
+    m_rangesTexture->Bind();
+    m_rangesTexture->SetData(std::span<const glm::uvec2>(m_ranges), TextureObject::InternalFormatRG32UI);
+    m_lightIndicesTexture->Bind();
+    m_lightIndicesTexture->SetData(std::span<const GLuint>(m_lightIndices), TextureObject::InternalFormatR32UI);
+}
+
+// Locations come from the table of the program, so they are not kept here and can't outlive it
+bool LightClusterGrid::IsSupported(const ShaderProgram& shaderProgram)
+{
+    // The buffers are required, the parameters could be optimized out by the compiler
+    return shaderProgram.GetUniformLocation("ClusterLights") >= 0
+        && shaderProgram.GetUniformLocation("ClusterRanges") >= 0
+        && shaderProgram.GetUniformLocation("ClusterLightIndices") >= 0;
+}
+
+void LightClusterGrid::SetUniforms(const ShaderProgram& shaderProgram) const
+{
+    assert(IsSupported(shaderProgram));
+
+    shaderProgram.SetTexture(shaderProgram.GetUniformLocation("ClusterLights"), c_lightsTextureUnit, *m_lightsTexture);
+    shaderProgram.SetTexture(shaderProgram.GetUniformLocation("ClusterRanges"), c_rangesTextureUnit, *m_rangesTexture);
+    shaderProgram.SetTexture(shaderProgram.GetUniformLocation("ClusterLightIndices"), c_lightIndicesTextureUnit, *m_lightIndicesTexture);
+    shaderProgram.SetUniform(shaderProgram.GetUniformLocation("ClusterGlobalLightCount"), static_cast<int>(m_globalLightCount));
+    shaderProgram.SetUniform(shaderProgram.GetUniformLocation("ClusterCount"), glm::ivec3(m_counts));
+    shaderProgram.SetUniform(shaderProgram.GetUniformLocation("ClusterTileScale"), m_tileScale);
+    shaderProgram.SetUniform(shaderProgram.GetUniformLocation("ClusterDepthParams"), glm::vec2(m_near, m_sliceScale));
+}
+
+bool LightClusterGrid::ComputeClusterBounds(const glm::mat4& projMatrix, const glm::vec3& center, float radius, ClusterBounds& bounds) const
+{
+    // View space looks down the negative Z axis
+    float minDepth = std::max(-center.z - radius, m_near);
+    float maxDepth = std::min(-center.z + radius, m_far);
+    if (minDepth > maxDepth)
+    {
+        return false;
+    }
+
+    // Screen bounds of the box around the sphere, clamped to the front of the near plane
+    glm::vec2 minNdc(1.0f);
+    glm::vec2 maxNdc(-1.0f);
+    for (int i = 0; i < 8; ++i)
+    {
+        glm::vec3 corner = center + radius * glm::vec3(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f);
+        corner.z = std::min(corner.z, -m_near);
+        glm::vec4 clip = projMatrix * glm::vec4(corner, 1.0f);
+        glm::vec2 ndc = glm::vec2(clip) / clip.w;
+        minNdc = glm::min(minNdc, ndc);
+        maxNdc = glm::max(maxNdc, ndc);
+    }
+    if (minNdc.x > 1.0f || minNdc.y > 1.0f || maxNdc.x < -1.0f || maxNdc.y < -1.0f)
+    {
+        return false;
+    }
+
+    glm::vec2 tileCounts(m_counts.x, m_counts.y);
+    glm::vec2 minTile = glm::clamp((minNdc * 0.5f + 0.5f) * tileCounts, glm::vec2(0.0f), tileCounts - 1.0f);
+    glm::vec2 maxTile = glm::clamp((maxNdc * 0.5f + 0.5f) * tileCounts, glm::vec2(0.0f), tileCounts - 1.0f);
+    bounds.min = glm::uvec3(glm::uvec2(minTile), GetSlice(minDepth));
+    bounds.max = glm::uvec3(glm::uvec2(maxTile), GetSlice(maxDepth));
+    return true;
+}
+
+unsigned int LightClusterGrid::GetSlice(float depth) const
+{
+    // Same formula as in the shader
+    float slice = std::log(depth / m_near) * m_sliceScale;
+    return std::min(static_cast<unsigned int>(std::max(slice, 0.0f)), m_counts.z - 1);
+}
+
+void LightClusterGrid::AddLightData(const Light& light)
+{
+    // 4 texels per light, with the same values as the light uniforms
+    m_lightData.push_back(glm::vec4(light.GetColor() * light.GetIntensity(), 0.0f));
+    m_lightData.push_back(glm::vec4(light.GetPosition(), 0.0f));
+    m_lightData.push_back(glm::vec4(light.GetDirection(), 0.0f));
+    m_lightData.push_back(light.GetAttenuation());
+}
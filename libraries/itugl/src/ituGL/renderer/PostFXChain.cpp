@@ -0,0 +1,176 @@
+#include <ituGL/renderer/PostFXChain.h>
+
+#include <ituGL/asset/ShaderLoader.h>
+#include <ituGL/shader/ShaderProgram.h>
+#include <sstream>
+#include <regex>
+#include <cassert>
+
+PostFXChain::PostFXChain(std::shared_ptr<const Shader> vertexShader, std::span<const char*> headerPaths)
+    : m_vertexShader(vertexShader), m_dirty(true)
+{
+    for (const char* path : headerPaths)
+    {
+        m_headers.push_back(LoadFile(path));
+    }
+    assert(!m_headers.empty());
+}
+
+unsigned int PostFXChain::AddEffect(const char* name, EffectType type, const char* path)
+{
+    Effect effect;
+    effect.name = name;
+    effect.type = type;
+    effect.source = LoadFile(path);
+    effect.uniformNames = FindUniformNames(effect.source);
+    effect.enabled = true;
+    m_effects.push_back(std::move(effect));
+
+    m_dirty = true;
+    return static_cast<unsigned int>(m_effects.size() - 1);
+}
+
+void PostFXChain::SetEffectEnabled(unsigned int effectIndex, bool enabled)
+{
+    Effect& effect = m_effects[effectIndex];
+    if (effect.enabled != enabled)
+    {
+        effect.enabled = enabled;
+        m_dirty = true;
+    }
+}
+
+void PostFXChain::SubmitProgram()
+{
+    if (!m_dirty)
+    {
+        return;
+    }
+
+    std::string source = GenerateSource();
+    std::vector<const char*> sourceCode;
+    for (const std::string& header : m_headers)
+    {
+        sourceCode.push_back(header.c_str());
+    }
+    sourceCode.push_back(source.c_str());
+    Shader fragmentShader = ShaderLoader(Shader::FragmentShader).LoadSource(sourceCode);
+
+    m_pendingProgram = std::make_shared<ShaderProgram>();
+    m_pendingProgram->Build(*m_vertexShader, fragmentShader);
+
+    m_dirty = false;
+}
+
+bool PostFXChain::Build()
+{
+    SubmitProgram();
+    if (!m_pendingProgram)
+    {
+        return false;
+    }
+
+    std::shared_ptr<ShaderProgram> shaderProgramPtr = std::move(m_pendingProgram);
+
+    // Keep the same material, so the render passes using it don't need to change
+    if (m_material)
+    {
+        m_material->ChangeShader(shaderProgramPtr);
+    }
+    else
+    {
+        m_material = std::make_shared<Material>(shaderProgramPtr);
+    }
+
+    // Values of disabled effects are skipped, their uniforms are not in the program
+    for (const auto& [name, setter] : m_uniformSetters)
+    {
+        setter(*m_material);
+    }
+
+    return true;
+}
+
+std::string PostFXChain::GetUniformName(unsigned int effectIndex, const char* name) const
+{
+    return m_effects[effectIndex].name + "_" + name;
+}
+
+std::string PostFXChain::GenerateSource() const
+{
+    std::stringstream stream;
+
+    stream << "\n//Inputs\nin vec2 TexCoord;\n\n";
+    stream << "//Outputs\nout vec4 FragColor;\n\n";
+    stream << "//Uniforms\nuniform sampler2D SourceTexture;\n\n";
+
+    // Each stage is a function that returns the result of the chain up to that effect, for any coordinates
+    stream << "vec4 PostFX_Stage0(vec2 uv)\n{\n\treturn texture(SourceTexture, uv);\n}\n\n";
+
+    unsigned int stage = 0;
+    for (const Effect& effect : m_effects)
+    {
+        if (!effect.enabled)
+        {
+            continue;
+        }
+
+        std::string prefix = effect.name + "_";
+        std::string inputStage = "PostFX_Stage" + std::to_string(stage);
+        ++stage;
+
+        // Rename the effect function and uniforms with macros, the snippet is added unchanged
+        stream << "// " << effect.name << "\n";
+        stream << "#define ApplyEffect " << prefix << "ApplyEffect\n";
+        stream << "#define SampleInput " << inputStage << "\n";
+        for (const std::string& uniformName : effect.uniformNames)
+        {
+            stream << "#define " << uniformName << " " << prefix << uniformName << "\n";
+        }
+
+        stream << effect.source << "\n";
+
+        for (const std::string& uniformName : effect.uniformNames)
+        {
+            stream << "#undef " << uniformName << "\n";
+        }
+        stream << "#undef SampleInput\n";
+        stream << "#undef ApplyEffect\n\n";
+
+        stream << "vec4 PostFX_Stage" << stage << "(vec2 uv)\n{\n";
+        switch (effect.type)
+        {
+        case EffectType::Color:
+            stream << "\treturn " << prefix << "ApplyEffect(" << inputStage << "(uv), uv);\n";
+            break;
+        case EffectType::Remap:
+            stream << "\treturn " << prefix << "ApplyEffect(uv);\n";
+            break;
+        }
+        stream << "}\n\n";
+    }
+
+    stream << "void main()\n{\n\tFragColor = PostFX_Stage" << stage << "(TexCoord);\n}\n";
+
+    return stream.str();
+}
+
+std::vector<std::string> PostFXChain::FindUniformNames(const std::string& source)
+{
+    std::vector<std::string> uniformNames;
+
+    // Declarations of a single uniform, like "uniform float Intensity;"
+    std::regex uniformRegex("\\buniform\\s+\\w+\\s+(\\w+)");
+    for (auto it = std::sregex_iterator(source.begin(), source.end(), uniformRegex); it != std::sregex_iterator(); ++it)
+    {
+        uniformNames.push_back((*it)[1].str());
+    }
+
+    return uniformNames;
+}
+
+std::string PostFXChain::LoadFile(const char* path)
+{
+    // Read through the loader, to use its file cache and resolve the #include directives
+    return ShaderLoader::Preprocess(std::span(&path, 1));
+}
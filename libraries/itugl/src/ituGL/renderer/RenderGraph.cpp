@@ -0,0 +1,415 @@
+#include <ituGL/renderer/RenderGraph.h>
+
+#include <ituGL/renderer/Renderer.h>
+#include <ituGL/texture/Texture2DObject.h>
+#include <ituGL/texture/FramebufferObject.h>
+#include <algorithm>
+#include <array>
+#include <sstream>
+#include <iomanip>
+#include <unordered_set>
+#include <cassert>
+
+bool RenderGraph::TextureDesc::operator == (const TextureDesc& other) const
+{
+    return width == other.width && height == other.height && format == other.format && internalFormat == other.internalFormat;
+}
+
+RenderGraph::RenderGraph() : m_output(-1), m_compiled(false)
+    , m_renderTargetMemory(0), m_peakRenderTargetMemory(0), m_unaliasedRenderTargetMemory(0)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+}
+
+RenderGraph::ResourceId RenderGraph::CreateTexture(const char* name, const TextureDesc& desc)
+{
+    assert(!m_compiled);
+    Resource resource;
+    resource.name = name;
+    resource.imported = false;
+    resource.desc = desc;
+    resource.firstPass = -1;
+    resource.lastPass = -1;
+    resource.poolIndex = -1;
+    resource.redirected = false;
+    m_resources.push_back(std::move(resource));
+    return static_cast<ResourceId>(m_resources.size() - 1);
+}
+
+RenderGraph::ResourceId RenderGraph::ImportTexture(const char* name, std::shared_ptr<Texture2DObject> texture)
+{
+    assert(!m_compiled);
+    Resource resource;
+    resource.name = name;
+    resource.imported = true;
+    resource.desc = TextureDesc{ 0, 0, TextureObject::FormatInvalid, TextureObject::InternalFormatInvalid };
+    resource.texture = texture;
+    resource.firstPass = -1;
+    resource.lastPass = -1;
+    resource.poolIndex = -1;
+    resource.redirected = false;
+    m_resources.push_back(std::move(resource));
+    return static_cast<ResourceId>(m_resources.size() - 1);
+}
+
+void RenderGraph::SetOutput(ResourceId resource)
+{
+    assert(resource < m_resources.size());
+    m_output = static_cast<int>(resource);
+}
+
+void RenderGraph::AddPass(const char* name, std::unique_ptr<RenderPass> renderPass,
+    const std::vector<ResourceId>& reads, const std::vector<ResourceId>& writes, const BindFunction& bindFunction)
+{
+    assert(!m_compiled);
+    assert(renderPass);
+
+    Pass pass;
+    pass.name = name;
+    pass.renderPass = std::move(renderPass);
+    if (pass.renderPass->GetName().empty())
+    {
+        pass.renderPass->SetName(name);
+    }
+    pass.reads = reads;
+    pass.writes = writes;
+    pass.bindFunction = bindFunction;
+    pass.culled = false;
+    m_passes.push_back(std::move(pass));
+}
+
+bool RenderGraph::Compile(Renderer& renderer)
+{
+    assert(!m_compiled);
+    assert(m_output >= 0);
+
+    if (!Validate())
+    {
+        return false;
+    }
+
+    CullPasses();
+    ComputeLifetimes();
+
+    // The output is not stored in a texture, its last writer renders to the default framebuffer
+    Resource& output = m_resources[m_output];
+    if (!output.imported)
+    {
+        output.redirected = true;
+    }
+
+    AllocateTextures();
+
+    for (Pass& pass : m_passes)
+    {
+        if (pass.culled)
+        {
+            // Culled passes are released, only the name is kept for the debug dump
+            pass.renderPass.reset();
+            continue;
+        }
+
+        // The output is only in the default framebuffer, it can't be read
+        for (ResourceId resourceId : pass.reads)
+        {
+            assert(!m_resources[resourceId].redirected);
+        }
+
+        // Only one transient target per pass, checked by Validate()
+        for (ResourceId resourceId : pass.writes)
+        {
+            const Resource& resource = m_resources[resourceId];
+            if (resource.redirected)
+            {
+                pass.renderPass->SetTargetFramebuffer(renderer.GetDefaultFramebuffer());
+            }
+            else if (!resource.imported)
+            {
+                pass.renderPass->SetTargetFramebuffer(m_pool[resource.poolIndex].framebuffer);
+            }
+        }
+
+        if (pass.bindFunction)
+        {
+            pass.bindFunction(*this);
+        }
+
+        renderer.AddRenderPass(std::move(pass.renderPass));
+    }
+
+    m_compiled = true;
+    return true;
+}
+
+std::shared_ptr<Texture2DObject> RenderGraph::GetTexture(ResourceId resource) const
+{
+    return m_resources[resource].texture;
+}
+
+bool RenderGraph::Validate()
+{
+    for (const Pass& pass : m_passes)
+    {
+        // The graph only creates framebuffers with one color attachment, passes with more targets need to import them
+        auto transientCount = std::count_if(pass.writes.begin(), pass.writes.end(),
+            [&](ResourceId resourceId) { return !m_resources[resourceId].imported; });
+        if (transientCount > 1)
+        {
+            m_errorMessage = "Render graph: pass " + pass.name + " writes " + std::to_string(transientCount)
+                + " transient textures, only one is supported. Import the others with their own framebuffer";
+            return false;
+        }
+    }
+    return true;
+}
+
+void RenderGraph::CullPasses()
+{
+    // Walk the passes backwards, starting with the output. A pass is needed if it writes a resource that is read later
+    std::unordered_set<ResourceId> neededResources;
+    neededResources.insert(m_output);
+
+    for (auto it = m_passes.rbegin(); it != m_passes.rend(); ++it)
+    {
+        Pass& pass = *it;
+
+        pass.culled = std::none_of(pass.writes.begin(), pass.writes.end(),
+            [&](ResourceId resource) { return neededResources.contains(resource); });
+        if (pass.culled)
+        {
+            continue;
+        }
+
+        // Previous contents of the resources written and not read are not needed
+        for (ResourceId resource : pass.writes)
+        {
+            if (std::find(pass.reads.begin(), pass.reads.end(), resource) == pass.reads.end())
+            {
+                neededResources.erase(resource);
+            }
+        }
+        neededResources.insert(pass.reads.begin(), pass.reads.end());
+    }
+}
+
+void RenderGraph::ComputeLifetimes()
+{
+    for (int passIndex = 0; passIndex < static_cast<int>(m_passes.size()); ++passIndex)
+    {
+        const Pass& pass = m_passes[passIndex];
+        if (pass.culled)
+        {
+            continue;
+        }
+
+        for (const std::vector<ResourceId>* resources : { &pass.reads, &pass.writes })
+        {
+            for (ResourceId resourceId : *resources)
+            {
+                Resource& resource = m_resources[resourceId];
+                if (resource.firstPass < 0)
+                {
+                    resource.firstPass = passIndex;
+                }
+                resource.lastPass = passIndex;
+            }
+        }
+    }
+}
+
+void RenderGraph::AllocateTextures()
+{
+    // Pool textures that are free, because the resource using them is not alive anymore
+    std::vector<unsigned int> freeTextures;
+    std::size_t liveMemory = 0;
+
+    for (int passIndex = 0; passIndex < static_cast<int>(m_passes.size()); ++passIndex)
+    {
+        if (m_passes[passIndex].culled)
+        {
+            continue;
+        }
+
+        // Assign textures to the resources starting here, before releasing the ones ending here.
+        // That way a pass never reads and writes the same texture
+        for (Resource& resource : m_resources)
+        {
+            if (resource.imported || resource.redirected || resource.firstPass != passIndex)
+            {
+                continue;
+            }
+
+            auto itFree = std::find_if(freeTextures.begin(), freeTextures.end(),
+                [&](unsigned int poolIndex) { return m_pool[poolIndex].desc == resource.desc; });
+            if (itFree != freeTextures.end())
+            {
+                resource.poolIndex = *itFree;
+                freeTextures.erase(itFree);
+            }
+            else
+            {
+                resource.poolIndex = static_cast<int>(m_pool.size());
+                PooledTexture pooledTexture;
+                pooledTexture.desc = resource.desc;
+                m_pool.push_back(std::move(pooledTexture));
+            }
+
+            std::size_t memory = GetMemorySize(resource.desc);
+            m_unaliasedRenderTargetMemory += memory;
+            liveMemory += memory;
+            m_peakRenderTargetMemory = std::max(m_peakRenderTargetMemory, liveMemory);
+        }
+
+        for (Resource& resource : m_resources)
+        {
+            if (resource.poolIndex >= 0 && resource.lastPass == passIndex)
+            {
+                freeTextures.push_back(resource.poolIndex);
+                liveMemory -= GetMemorySize(resource.desc);
+            }
+        }
+    }
+
+    for (PooledTexture& pooledTexture : m_pool)
+    {
+        CreatePooledTexture(pooledTexture);
+        m_renderTargetMemory += GetMemorySize(pooledTexture.desc);
+    }
+
+    for (Resource& resource : m_resources)
+    {
+        if (resource.poolIndex >= 0)
+        {
+            resource.texture = m_pool[resource.poolIndex].texture;
+        }
+    }
+}
+
+void RenderGraph::CreatePooledTexture(PooledTexture& pooledTexture) const
+{
+    const TextureDesc& desc = pooledTexture.desc;
+
+    pooledTexture.texture = std::make_shared<Texture2DObject>();
+    pooledTexture.texture->Bind();
+    pooledTexture.texture->SetImage(0, desc.width, desc.height, desc.format, desc.internalFormat);
+    pooledTexture.texture->SetParameter(TextureObject::ParameterEnum::WrapS, GL_CLAMP_TO_EDGE);
+    pooledTexture.texture->SetParameter(TextureObject::ParameterEnum::WrapT, GL_CLAMP_TO_EDGE);
+    pooledTexture.texture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR);
+    pooledTexture.texture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
+    Texture2DObject::Unbind();
+
+    pooledTexture.framebuffer = std::make_shared<FramebufferObject>();
+    pooledTexture.framebuffer->Bind();
+    pooledTexture.framebuffer->SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Color0, *pooledTexture.texture);
+    pooledTexture.framebuffer->SetDrawBuffers(std::array<FramebufferObject::Attachment, 1>({ FramebufferObject::Attachment::Color0 }));
+    FramebufferObject::Unbind();
+}
+
+std::string RenderGraph::GetDebugDump() const
+{
+    std::stringstream stream;
+
+    unsigned int culledCount = static_cast<unsigned int>(std::count_if(m_passes.begin(), m_passes.end(), [](const Pass& pass) { return pass.culled; }));
+    stream << "Passes: " << m_passes.size() - culledCount << " (" << culledCount << " culled)\n";
+    for (int passIndex = 0; passIndex < static_cast<int>(m_passes.size()); ++passIndex)
+    {
+        const Pass& pass = m_passes[passIndex];
+        stream << "  " << std::setw(2) << passIndex << " " << pass.name << (pass.culled ? " [culled]" : "") << "\n";
+
+        for (const auto& [label, resources] : { std::make_pair("read", &pass.reads), std::make_pair("write", &pass.writes) })
+        {
+            for (ResourceId resourceId : *resources)
+            {
+                stream << "       " << label << " " << m_resources[resourceId].name << "\n";
+            }
+        }
+    }
+
+    stream << "Resources: " << m_resources.size() << "\n";
+    for (const Resource& resource : m_resources)
+    {
+        stream << "  " << resource.name << ": ";
+        if (resource.imported)
+        {
+            stream << "imported";
+        }
+        else
+        {
+            stream << resource.desc.width << "x" << resource.desc.height << ", " << GetBytesPerPixel(resource.desc.internalFormat) << " bytes/pixel";
+        }
+
+        if (resource.firstPass < 0)
+        {
+            stream << ", unused\n";
+            continue;
+        }
+        stream << ", passes " << resource.firstPass << "-" << resource.lastPass;
+
+        if (resource.redirected)
+        {
+            stream << ", default framebuffer";
+        }
+        else if (resource.poolIndex >= 0)
+        {
+            stream << ", texture " << resource.poolIndex;
+        }
+        stream << "\n";
+    }
+
+    const float megabyte = 1024.0f * 1024.0f;
+    stream << std::fixed << std::setprecision(2);
+    stream << "Textures: " << m_pool.size() << ", " << m_renderTargetMemory / megabyte << " MB\n";
+    stream << "Peak render target memory: " << m_peakRenderTargetMemory / megabyte << " MB\n";
+    stream << "Without aliasing: " << m_unaliasedRenderTargetMemory / megabyte << " MB\n";
+
+    return stream.str();
+}
+
+std::size_t RenderGraph::GetMemorySize(const TextureDesc& desc)
+{
+    return static_cast<std::size_t>(desc.width) * desc.height * GetBytesPerPixel(desc.internalFormat);
+}
+
+std::size_t RenderGraph::GetBytesPerPixel(TextureObject::InternalFormat internalFormat)
+{
+    switch (internalFormat)
+    {
+    case TextureObject::InternalFormatR8:
+        return 1;
+    case TextureObject::InternalFormatRG8:
+    case TextureObject::InternalFormatR16:
+    case TextureObject::InternalFormatR16F:
+        return 2;
+    case TextureObject::InternalFormatRGB8:
+    case TextureObject::InternalFormatSRGB8:
+        return 3;
+    case TextureObject::InternalFormatRGBA8:
+    case TextureObject::InternalFormatSRGBA8:
+    case TextureObject::InternalFormatRG16:
+    case TextureObject::InternalFormatRG16F:
+    case TextureObject::InternalFormatR32F:
+    case TextureObject::InternalFormatR32UI:
+    case TextureObject::InternalFormatR11G11B10:
+    case TextureObject::InternalFormatRGB10A2:
+        return 4;
+    case TextureObject::InternalFormatRGB16:
+    case TextureObject::InternalFormatRGB16F:
+        return 6;
+    case TextureObject::InternalFormatRGBA16:
+    case TextureObject::InternalFormatRGBA16F:
+    case TextureObject::InternalFormatRG32F:
+    case TextureObject::InternalFormatRG32UI:
+        return 8;
+    case TextureObject::InternalFormatRGB32F:
+        return 12;
+    case TextureObject::InternalFormatRGBA32F:
+    case TextureObject::InternalFormatRGBA32UI:
+        return 16;
+    default:
+        // Unsized formats, the driver chooses
+        return 4;
+    }
+}
@@ -18,6 +18,11 @@ std::shared_ptr<const FramebufferObject> RenderPass::GetTargetFramebuffer() cons
     return m_targetFramebuffer;
 }
 
+void RenderPass::SetTargetFramebuffer(std::shared_ptr<const FramebufferObject> targetFramebuffer)
+{
+    m_targetFramebuffer = targetFramebuffer;
+}
+
 void RenderPass::SetRenderer(Renderer* renderer)
 {
     m_renderer = renderer;
@@ -0,0 +1,280 @@
+#include <ituGL/renderer/RenderProfiler.h>
+
+#include <ituGL/utils/DearImGui.h>
+#include <imgui.h>
+#include <fstream>
+#include <cassert>
+
+RenderProfiler::RenderProfiler()
+    : m_enabled(false)
+    , m_frameQueries{}
+    , m_bufferIndex(0)
+    , m_frameCount(0)
+    , m_inFrame(false)
+    , m_inScope(false)
+    , m_startTime(std::chrono::steady_clock::now())
+    , m_lastFrame{}
+{
+}
+
+RenderProfiler::~RenderProfiler()
+{
+    for (FrameQueries& frameQueries : m_frameQueries)
+    {
+        if (!frameQueries.queries.empty())
+        {
+            glDeleteQueries(static_cast<GLsizei>(frameQueries.queries.size()), frameQueries.queries.data());
+        }
+    }
+}
+
+void RenderProfiler::SetEnabled(bool enabled)
+{
+    assert(!m_inFrame);
+    m_enabled = enabled;
+
+    // Results from before disabling would show up late
+    for (FrameQueries& frameQueries : m_frameQueries)
+    {
+        frameQueries.pending = false;
+    }
+}
+
+void RenderProfiler::BeginFrame()
+{
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    assert(!m_inFrame);
+
+    // The queries of this buffer were issued two frames ago, the GPU should be done with them
+    m_bufferIndex = (m_bufferIndex + 1) % c_bufferCount;
+    FrameQueries& frameQueries = m_frameQueries[m_bufferIndex];
+    if (frameQueries.pending)
+    {
+        ReadBack(frameQueries);
+    }
+
+    frameQueries.index = m_frameCount++;
+    frameQueries.cpuStart = GetCpuTime();
+    frameQueries.scopeCount = 0;
+    m_inFrame = true;
+}
+
+void RenderProfiler::EndFrame()
+{
+    if (!m_inFrame)
+    {
+        return;
+    }
+
+    assert(!m_inScope);
+
+    FrameQueries& frameQueries = m_frameQueries[m_bufferIndex];
+    frameQueries.cpuEnd = GetCpuTime();
+    frameQueries.pending = true;
+    m_inFrame = false;
+}
+
+void RenderProfiler::BeginScope(const char* name)
+{
+    if (!m_inFrame)
+    {
+        return;
+    }
+
+    // Only one GL_TIME_ELAPSED query can be active
+    assert(!m_inScope);
+
+    FrameQueries& frameQueries = m_frameQueries[m_bufferIndex];
+    unsigned int scopeIndex = frameQueries.scopeCount++;
+    if (scopeIndex == frameQueries.scopes.size())
+    {
+        GLuint query;
+        glGenQueries(1, &query);
+        frameQueries.queries.push_back(query);
+        frameQueries.scopes.emplace_back();
+    }
+
+    Scope& scope = frameQueries.scopes[scopeIndex];
+    scope.name = name;
+    scope.cpuStart = GetCpuTime();
+
+    glBeginQuery(GL_TIME_ELAPSED, frameQueries.queries[scopeIndex]);
+    m_inScope = true;
+}
+
+void RenderProfiler::EndScope()
+{
+    if (!m_inScope)
+    {
+        return;
+    }
+
+    glEndQuery(GL_TIME_ELAPSED);
+
+    FrameQueries& frameQueries = m_frameQueries[m_bufferIndex];
+    frameQueries.scopes[frameQueries.scopeCount - 1].cpuEnd = GetCpuTime();
+    m_inScope = false;
+}
+
+void RenderProfiler::ReadBack(FrameQueries& frameQueries)
+{
+    Frame frame;
+    frame.index = frameQueries.index;
+    frame.cpuStart = frameQueries.cpuStart;
+    frame.cpuTime = frameQueries.cpuEnd - frameQueries.cpuStart;
+    frame.gpuTime = 0.0;
+
+    for (unsigned int i = 0; i < frameQueries.scopeCount; ++i)
+    {
+        const Scope& scope = frameQueries.scopes[i];
+
+        Timing timing;
+        timing.name = scope.name;
+        timing.cpuStart = scope.cpuStart;
+        timing.cpuTime = scope.cpuEnd - scope.cpuStart;
+        timing.gpuTime = -1.0;
+
+        // Never wait for the result, if it is not ready we skip it
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(frameQueries.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+        {
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(frameQueries.queries[i], GL_QUERY_RESULT, &nanoseconds);
+            timing.gpuTime = nanoseconds * 1e-6;
+            frame.gpuTime += timing.gpuTime;
+        }
+
+        frame.timings.push_back(std::move(timing));
+    }
+
+    frameQueries.pending = false;
+
+    m_history.push_back(frame);
+    if (m_history.size() > c_historySize)
+    {
+        m_history.pop_front();
+    }
+    m_lastFrame = std::move(frame);
+}
+
+double RenderProfiler::GetCpuTime() const
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count();
+}
+
+// Names are written between quotes, escape the characters that would break the JSON
+std::string RenderProfiler::EscapeJson(const std::string& text)
+{
+    std::string result;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            result += '\\';
+        }
+        result += static_cast<unsigned char>(c) < 0x20 ? ' ' : c;
+    }
+    return result;
+}
+
+bool RenderProfiler::ExportChromeTrace(const char* path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    // Times in the trace are in microseconds. CPU scopes go in thread 1, GPU scopes in thread 2
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+    auto writeEvent = [&file](const std::string& name, const char* category, int thread, double start, double duration)
+        {
+            file << ",\n{\"name\":\"" << EscapeJson(name) << "\",\"cat\":\"" << category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+                << ",\"ts\":" << start * 1000.0 << ",\"dur\":" << duration * 1000.0 << "}";
+        };
+
+    file << std::fixed;
+    for (const Frame& frame : m_history)
+    {
+        writeEvent("Frame " + std::to_string(frame.index), "frame", 1, frame.cpuStart, frame.cpuTime);
+
+        double gpuStart = frame.timings.empty() ? frame.cpuStart : frame.timings.front().cpuStart;
+        for (const Timing& timing : frame.timings)
+        {
+            writeEvent(timing.name, "cpu", 1, timing.cpuStart, timing.cpuTime);
+            if (timing.gpuTime >= 0.0)
+            {
+                writeEvent(timing.name, "gpu", 2, gpuStart, timing.gpuTime);
+                gpuStart += timing.gpuTime;
+            }
+        }
+    }
+
+    file << "\n]}\n";
+    return file.good();
+}
+
+void RenderProfiler::DrawGUI(DearImGui& imGui)
+{
+    if (auto window = imGui.UseWindow("Profiler"))
+    {
+        bool enabled = m_enabled;
+        if (ImGui::Checkbox("Enabled", &enabled))
+        {
+            SetEnabled(enabled);
+        }
+
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        ImGui::Text("Frame %llu: CPU %.3f ms, GPU %.3f ms", static_cast<unsigned long long>(m_lastFrame.index), m_lastFrame.cpuTime, m_lastFrame.gpuTime);
+
+        if (ImGui::BeginTable("Timings", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("Pass");
+            ImGui::TableSetupColumn("CPU (ms)");
+            ImGui::TableSetupColumn("GPU (ms)");
+            ImGui::TableHeadersRow();
+
+            for (const Timing& timing : m_lastFrame.timings)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(timing.name.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", timing.cpuTime);
+                ImGui::TableNextColumn();
+                if (timing.gpuTime >= 0.0)
+                {
+                    ImGui::Text("%.3f", timing.gpuTime);
+                }
+                else
+                {
+                    ImGui::TextUnformatted("-");
+                }
+            }
+            ImGui::EndTable();
+        }
+
+        if (ImGui::Button("Export Chrome trace"))
+        {
+            const char* path = "profiler_trace.json";
+            m_exportMessage = ExportChromeTrace(path) ? std::string("Saved ") + path : std::string("Failed to write ") + path;
+        }
+        if (!m_exportMessage.empty())
+        {
+            ImGui::SameLine();
+            ImGui::TextUnformatted(m_exportMessage.c_str());
+        }
+    }
+}
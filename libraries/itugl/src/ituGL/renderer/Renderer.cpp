@@ -8,16 +8,29 @@
 #include <ituGL/lighting/Light.h>
 #include <ituGL/camera/Camera.h>
 #include <ituGL/texture/FramebufferObject.h>
+#include <ituGL/texture/TextureBufferObject.h>
 #include <ituGL/renderer/RenderPass.h>
+#include <glm/matrix.hpp>
 #include <span>
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
+#include <string>
 
-Renderer::DrawcallInfo::DrawcallInfo(const Material& material, unsigned int worldMatrixIndex, const VertexArrayObject& vao, const Drawcall& drawcall)
-    : m_material(material), m_worldMatrixIndex(worldMatrixIndex), m_vao(vao), m_drawcall(drawcall)
+Renderer::DrawcallInfo::DrawcallInfo(const Material& material, unsigned int worldMatrixIndex, const VertexArrayObject& vao, const Drawcall& drawcall, std::uint64_t sortKey)
+    : m_material(material), m_worldMatrixIndex(worldMatrixIndex), m_vao(vao), m_drawcall(drawcall), m_sortKey(sortKey)
+    , m_firstInstance(-1), m_instanceCount(1), m_multiDrawIndex(-1)
 {
 }
 
+void Renderer::DrawcallInfo::SetInstances(int firstInstance, unsigned int instanceCount)
+{
+    assert(instanceCount > 0);
+    m_firstInstance = firstInstance;
+    m_instanceCount = instanceCount;
+}
+
 Renderer::DrawcallCollection::DrawcallCollection(const DrawcallSupportedFunction& isSupported) : m_isSupported(isSupported)
 {
 }
@@ -40,6 +53,13 @@ void Renderer::DrawcallCollection::AddDrawcall(const DrawcallInfo& drawcallInfo)
     }
 }
 
+void Renderer::DrawcallCollection::Resize(unsigned int count)
+{
+    // Can only shrink, DrawcallInfo has no default value
+    assert(count <= m_drawcallInfos.size());
+    m_drawcallInfos.erase(m_drawcallInfos.begin() + count, m_drawcallInfos.end());
+}
+
 void Renderer::DrawcallCollection::Clear()
 {
     m_drawcallInfos.clear();
@@ -49,12 +69,27 @@ void Renderer::DrawcallCollection::Clear()
 Renderer::Renderer(DeviceGL& device)
     : m_device(device)
     , m_currentCamera(nullptr)
+    , m_cameraFrustum(glm::mat4(1.0f))
+    , m_frustumCullingEnabled(true)
     , m_defaultFramebuffer(FramebufferObject::GetDefault())
     , m_currentFramebuffer(m_defaultFramebuffer)
+    , m_objectTextureIndex(0)
+    , m_objectDataDirty(false)
+    , m_frameConstants{}
+    , m_time(0.0f)
     , m_drawcallCollections(1)
 {
     InitializeFullscreenMesh();
 
+    for (std::shared_ptr<TextureBufferObject>& objectTexture : m_objectTextures)
+    {
+        objectTexture = std::make_shared<TextureBufferObject>();
+    }
+
+    m_frameConstantsBuffer.Bind();
+    m_frameConstantsBuffer.AllocateData(std::span<const FrameConstants>(&m_frameConstants, 1));
+    UniformBufferObject::Unbind();
+
     device.EnableFeature(GL_FRAMEBUFFER_SRGB);
     device.EnableFeature(GL_DEPTH_TEST);
     device.EnableFeature(GL_CULL_FACE);
@@ -75,6 +110,11 @@ const Camera& Renderer::GetCurrentCamera() const
 void Renderer::SetCurrentCamera(const Camera& camera)
 {
     m_currentCamera = &camera;
+    m_cameraFrustum.SetMatrix(camera.GetViewProjectionMatrix());
+    m_cameraUpdatedPrograms.clear();
+
+    // Models added before the camera have no depth in their sort keys yet
+    UpdateSortKeyDepths();
 }
 
 std::shared_ptr<const FramebufferObject> Renderer::GetDefaultFramebuffer() const
@@ -106,18 +146,36 @@ void Renderer::Render()
 {
     assert(m_currentCamera);
 
+    UpdateFrameConstants();
+
+    // Use the next object buffer, the upload happens with the first drawcall that needs it
+    m_objectTextureIndex = (m_objectTextureIndex + 1) % c_objectBufferCount;
+    m_objectDataDirty = !m_worldMatrices.empty();
+
+    m_profiler.BeginFrame();
+
     for (auto& pass : m_passes)
     {
         SetCurrentFramebuffer(pass->GetTargetFramebuffer());
+
+        m_profiler.BeginScope(pass->GetName().c_str());
         pass->Render();
+        m_profiler.EndScope();
     }
 
+    m_profiler.EndFrame();
+
     Reset();
 }
 
 void Renderer::Reset()
 {
     m_worldMatrices.clear();
+    m_objectDataDirty = false;
+    m_multiDraws.clear();
+    m_multiDrawCounts.clear();
+    m_multiDrawOffsets.clear();
+    m_multiDrawBaseVertices.clear();
     m_lights.clear();
 
     for (auto& collection : m_drawcallCollections)
@@ -126,12 +184,38 @@ void Renderer::Reset()
     }
 
     m_currentCamera = nullptr;
+    m_cameraUpdatedPrograms.clear();
+}
+
+// No padding is added by std140 to the matrices, and the vec3 + float pair takes one vec4 slot
+static_assert(sizeof(Renderer::FrameConstants) == 5 * sizeof(glm::mat4) + sizeof(glm::vec4));
+
+void Renderer::UpdateFrameConstants()
+{
+    const Camera& camera = *m_currentCamera;
+    m_frameConstants.viewMatrix = camera.GetViewMatrix();
+    m_frameConstants.projMatrix = camera.GetProjectionMatrix();
+    m_frameConstants.viewProjMatrix = camera.GetViewProjectionMatrix();
+    m_frameConstants.invViewMatrix = glm::inverse(m_frameConstants.viewMatrix);
+    m_frameConstants.invProjMatrix = glm::inverse(m_frameConstants.projMatrix);
+    m_frameConstants.cameraPosition = m_frameConstants.invViewMatrix[3];
+    m_frameConstants.time = m_time;
+
+    // Reallocating lets the driver give us new storage instead of waiting for the previous frame
+    m_frameConstantsBuffer.Bind();
+    m_frameConstantsBuffer.AllocateData(std::span<const FrameConstants>(&m_frameConstants, 1));
+    m_frameConstantsBuffer.BindBase(c_frameConstantsBinding);
+    UniformBufferObject::Unbind();
 }
 
 int Renderer::AddRenderPass(std::unique_ptr<RenderPass> renderPass)
 {
     int passIndex = static_cast<int>(m_passes.size());
     renderPass->SetRenderer(this);
+    if (renderPass->GetName().empty())
+    {
+        renderPass->SetName("Pass " + std::to_string(passIndex));
+    }
     m_passes.push_back(std::move(renderPass));
     // After moving renderPass, the local variable is empty and unusable, pass is now owned by m_passes
     return passIndex;
@@ -152,12 +236,28 @@ void Renderer::RegisterShaderProgram(std::shared_ptr<const ShaderProgram> shader
     {
         m_updateLightsFunctions[shaderProgramPtr] = updateLightsFunction;
     }
+
+    // Frame constants are always in the same binding point
+    GLuint frameConstantsIndex = shaderProgramPtr->GetUniformBlockIndex("FrameConstants");
+    if (frameConstantsIndex != GL_INVALID_INDEX)
+    {
+        shaderProgramPtr->SetUniformBlockBinding(frameConstantsIndex, c_frameConstantsBinding);
+    }
+
+    // Programs opt in to the object buffer, and instancing, by declaring its uniforms
+    ObjectLocations objectLocations;
+    objectLocations.matrices = shaderProgramPtr->GetUniformLocation("ObjectMatrices");
+    objectLocations.index = shaderProgramPtr->GetUniformLocation("ObjectIndex");
+    if (objectLocations.matrices >= 0 && objectLocations.index >= 0)
+    {
+        m_objectLocations[shaderProgramPtr.get()] = objectLocations;
+    }
 }
 
 void Renderer::UpdateTransforms(std::shared_ptr<const ShaderProgram> shaderProgramPtr, unsigned int worldMatrixIndex, bool cameraChanged) const
 {
     const glm::mat4& worldMatrix = m_worldMatrices[worldMatrixIndex];
-    UpdateTransforms(shaderProgramPtr, worldMatrix);
+    UpdateTransforms(shaderProgramPtr, worldMatrix, cameraChanged);
 }
 
 void Renderer::UpdateTransforms(std::shared_ptr<const ShaderProgram> shaderProgramPtr, const glm::mat4& worldMatrix, bool cameraChanged) const
@@ -235,11 +335,26 @@ void Renderer::AddModel(const Model& model, const glm::mat4& worldMatrix)
     unsigned int worldMatrixIndex = static_cast<unsigned int>(m_worldMatrices.size());
     m_worldMatrices.push_back(worldMatrix);
 
+    // Depth is the same for all the submeshes, compute it once per model
+    std::uint32_t depthKey = ComputeDepthKey(worldMatrix);
+
     const Mesh& mesh = model.GetMesh();
+
+    // With a single submesh, the model test already covers it
+    bool cullSubmeshes = mesh.GetSubmeshCount() > 1;
+
     for (unsigned int submeshIndex = 0; submeshIndex < mesh.GetSubmeshCount(); ++submeshIndex)
     {
-        DrawcallInfo drawcallInfo(model.GetMaterial(submeshIndex), worldMatrixIndex,
-            mesh.GetSubmeshVertexArray(submeshIndex), mesh.GetSubmeshDrawcall(submeshIndex));
+        if (cullSubmeshes && mesh.HasSubmeshBounds(submeshIndex) && !IsVisible(BoxBounds(mesh.GetSubmeshBounds(submeshIndex), worldMatrix)))
+        {
+            continue;
+        }
+
+        const Material& material = model.GetMaterial(submeshIndex);
+        const VertexArrayObject& vao = mesh.GetSubmeshVertexArray(submeshIndex);
+
+        DrawcallInfo drawcallInfo(material, worldMatrixIndex, vao, mesh.GetSubmeshDrawcall(submeshIndex),
+            ComputeSortKey(material, vao, depthKey));
 
         for (DrawcallCollection& collection : m_drawcallCollections)
         {
@@ -248,6 +363,11 @@ void Renderer::AddModel(const Model& model, const glm::mat4& worldMatrix)
     }
 }
 
+bool Renderer::IsVisible(const BoxBounds& bounds) const
+{
+    return !m_frustumCullingEnabled || !m_currentCamera || Bounds::Intersects(m_cameraFrustum, bounds);
+}
+
 unsigned int Renderer::AddDrawcallCollection(const DrawcallSupportedFunction& drawcallSupportedFunction)
 {
     unsigned int index = static_cast<unsigned int>(m_drawcallCollections.size());
@@ -266,16 +386,37 @@ void Renderer::SortDrawcallCollection(unsigned int index, const DrawcallSortFunc
     std::sort(drawcalls.begin(), drawcalls.end(), drawcallSortFunction);
 }
 
-bool Renderer::IsBackToFront(const DrawcallInfo& a, const DrawcallInfo& b) const
+void Renderer::SortDrawcallCollection(unsigned int index, DrawcallSortMode sortMode)
 {
-    const Camera& camera = GetCurrentCamera();
-    glm::vec3 cameraPosition = camera.ExtractTranslation();
-    glm::vec3 right, up, forward;
-    camera.ExtractVectors(right, up, forward);
+    auto drawcalls = m_drawcallCollections[index].GetDrawcalls();
+    unsigned int count = static_cast<unsigned int>(drawcalls.size());
+    if (count < 2)
+    {
+        return;
+    }
+
+    // Gather the keys for the requested order, remembering where each drawcall came from
+    m_sortEntries.resize(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        m_sortEntries[i] = SortEntry{ GetModeSortKey(drawcalls[i].GetSortKey(), sortMode), i };
+    }
+
+    RadixSort(m_sortEntries, m_sortScratch);
 
-    glm::vec3 aDistance = glm::vec3(GetWorldMatrix(a)[3]) - cameraPosition;
-    glm::vec3 bDistance = glm::vec3(GetWorldMatrix(b)[3]) - cameraPosition;
-    return glm::dot(forward, aDistance) < glm::dot(forward, bDistance);
+    // Apply the permutation
+    m_sortedDrawcalls.clear();
+    m_sortedDrawcalls.reserve(count);
+    for (const SortEntry& entry : m_sortEntries)
+    {
+        m_sortedDrawcalls.push_back(drawcalls[entry.index]);
+    }
+    std::copy(m_sortedDrawcalls.begin(), m_sortedDrawcalls.end(), drawcalls.begin());
+}
+
+bool Renderer::IsBackToFront(const DrawcallInfo& a, const DrawcallInfo& b) const
+{
+    return GetSortKeyDepth(a.GetSortKey()) > GetSortKeyDepth(b.GetSortKey());
 }
 
 bool Renderer::IsFrontToBack(const DrawcallInfo& a, const DrawcallInfo& b) const
@@ -283,31 +424,197 @@ bool Renderer::IsFrontToBack(const DrawcallInfo& a, const DrawcallInfo& b) const
     return IsBackToFront(b, a);
 }
 
+void Renderer::MergeInstancedDrawcalls(unsigned int collectionIndex)
+{
+    DrawcallCollection& collection = m_drawcallCollections[collectionIndex];
+    std::span<DrawcallInfo> drawcalls = collection.GetDrawcalls();
+
+    unsigned int mergedCount = 0;
+    unsigned int runStart = 0;
+    while (runStart < drawcalls.size())
+    {
+        DrawcallInfo drawcallInfo = drawcalls[runStart];
+
+        // Find the end of the run of drawcalls that can be drawn together
+        unsigned int runEnd = runStart + 1;
+        if (!drawcallInfo.IsInstanced() && SupportsInstancing(drawcallInfo.GetMaterial()))
+        {
+            while (runEnd < drawcalls.size() && CanMergeInstances(drawcallInfo, drawcalls[runEnd]))
+            {
+                ++runEnd;
+            }
+        }
+
+        unsigned int instanceCount = runEnd - runStart;
+        if (instanceCount > 1)
+        {
+            // Copy the matrices next to each other. Reserve first, GetWorldMatrix references the same vector
+            int firstInstance = static_cast<int>(m_worldMatrices.size());
+            m_worldMatrices.reserve(m_worldMatrices.size() + instanceCount);
+            for (unsigned int i = runStart; i < runEnd; ++i)
+            {
+                m_worldMatrices.push_back(GetWorldMatrix(drawcalls[i]));
+            }
+            drawcallInfo.SetInstances(firstInstance, instanceCount);
+        }
+
+        // Compact the collection in place, mergedCount is never ahead of runStart
+        drawcalls[mergedCount++] = drawcallInfo;
+        runStart = runEnd;
+    }
+
+    collection.Resize(mergedCount);
+}
+
+void Renderer::MergeMultiDrawcalls(unsigned int collectionIndex)
+{
+    DrawcallCollection& collection = m_drawcallCollections[collectionIndex];
+    std::span<DrawcallInfo> drawcalls = collection.GetDrawcalls();
+
+    unsigned int mergedCount = 0;
+    unsigned int runStart = 0;
+    while (runStart < drawcalls.size())
+    {
+        DrawcallInfo drawcallInfo = drawcalls[runStart];
+
+        // Find the end of the run of drawcalls that can be drawn together
+        unsigned int runEnd = runStart + 1;
+        while (runEnd < drawcalls.size() && CanMergeMultiDraw(drawcallInfo, drawcalls[runEnd]))
+        {
+            ++runEnd;
+        }
+
+        if (runEnd - runStart > 1)
+        {
+            const Drawcall& drawcall = drawcallInfo.GetDrawcall();
+            MultiDraw multiDraw;
+            multiDraw.primitive = static_cast<GLenum>(drawcall.GetPrimitive());
+            multiDraw.eboType = static_cast<GLenum>(drawcall.GetEboType());
+            multiDraw.first = static_cast<unsigned int>(m_multiDrawCounts.size());
+            multiDraw.count = static_cast<GLsizei>(runEnd - runStart);
+            for (unsigned int i = runStart; i < runEnd; ++i)
+            {
+                const Drawcall& mergedDrawcall = drawcalls[i].GetDrawcall();
+                const char* basePointer = nullptr; // Actual element pointer is in VAO
+                m_multiDrawCounts.push_back(mergedDrawcall.GetCount());
+                m_multiDrawOffsets.push_back(basePointer + mergedDrawcall.GetFirst());
+                m_multiDrawBaseVertices.push_back(mergedDrawcall.GetBaseVertex());
+            }
+            drawcallInfo.SetMultiDrawIndex(static_cast<int>(m_multiDraws.size()));
+            m_multiDraws.push_back(multiDraw);
+        }
+
+        // Compact the collection in place, mergedCount is never ahead of runStart
+        drawcalls[mergedCount++] = drawcallInfo;
+        runStart = runEnd;
+    }
+
+    collection.Resize(mergedCount);
+}
+
+bool Renderer::CanMergeMultiDraw(const DrawcallInfo& a, const DrawcallInfo& b)
+{
+    // Without gl_DrawID all the ranges must share the per-drawcall uniforms, so the world matrix has to be the same
+    const Drawcall& drawcallA = a.GetDrawcall();
+    const Drawcall& drawcallB = b.GetDrawcall();
+    return !a.IsInstanced() && !b.IsInstanced() && !b.IsMultiDraw()
+        && &a.GetMaterial() == &b.GetMaterial()
+        && &a.GetVAO() == &b.GetVAO()
+        && a.GetWorldMatrixIndex() == b.GetWorldMatrixIndex()
+        && drawcallA.GetEboType() != Data::Type::None
+        && drawcallA.GetEboType() == drawcallB.GetEboType()
+        && drawcallA.GetPrimitive() == drawcallB.GetPrimitive();
+}
+
+bool Renderer::SupportsInstancing(const Material& material) const
+{
+    std::shared_ptr<const ShaderProgram> shaderProgram = material.GetShaderProgram();
+    return shaderProgram && m_objectLocations.find(shaderProgram.get()) != m_objectLocations.end();
+}
+
+bool Renderer::CanMergeInstances(const DrawcallInfo& a, const DrawcallInfo& b) const
+{
+    // Same submesh and same material instance
+    return !b.IsInstanced()
+        && &a.GetMaterial() == &b.GetMaterial()
+        && &a.GetVAO() == &b.GetVAO()
+        && &a.GetDrawcall() == &b.GetDrawcall();
+}
+
+void Renderer::PrepareObjectMatrices(const ShaderProgram& shaderProgram, const DrawcallInfo& drawcallInfo)
+{
+    const auto& itFind = m_objectLocations.find(&shaderProgram);
+    if (itFind == m_objectLocations.end())
+    {
+        return;
+    }
+
+    // Upload the world matrices the first time they are needed in the frame
+    const std::shared_ptr<TextureBufferObject>& objectTexture = m_objectTextures[m_objectTextureIndex];
+    if (m_objectDataDirty)
+    {
+        objectTexture->Bind();
+        objectTexture->SetData(std::span<const glm::mat4>(m_worldMatrices), TextureObject::InternalFormatRGBA32F);
+        m_objectDataDirty = false;
+    }
+
+    const ObjectLocations& locations = itFind->second;
+    int objectIndex = drawcallInfo.IsInstanced() ? drawcallInfo.GetFirstInstance() : static_cast<int>(drawcallInfo.GetWorldMatrixIndex());
+    shaderProgram.SetTexture(locations.matrices, c_objectTextureUnit, *objectTexture);
+    shaderProgram.SetUniform(locations.index, objectIndex);
+}
+
 void Renderer::PrepareDrawcall(const DrawcallInfo& drawcallInfo, Material::OverrideFlags materialOverride)
 {
     std::shared_ptr<const ShaderProgram> shaderProgram = drawcallInfo.GetMaterial().GetShaderProgram();
 
-    // TODO: Room for optimization here, caching current material, current worldMatrixIndex and current VAO
+    // Redundant program, VAO and render state changes are skipped by DeviceGL
 
     // Setup material
     drawcallInfo.GetMaterial().Use(materialOverride);
 
+    // Setup camera, only the first time the program is used with this camera
+    bool cameraChanged = m_cameraUpdatedPrograms.insert(shaderProgram.get()).second;
+
     // Setup world matrix
-    // Setup camera
-    UpdateTransforms(shaderProgram, drawcallInfo.GetWorldMatrixIndex());
+    if (drawcallInfo.IsInstanced())
+    {
+        // The world matrix of each instance is applied in the shader
+        UpdateTransforms(shaderProgram, glm::mat4(1.0f), cameraChanged);
+    }
+    else
+    {
+        UpdateTransforms(shaderProgram, drawcallInfo.GetWorldMatrixIndex(), cameraChanged);
+    }
+    PrepareObjectMatrices(*shaderProgram, drawcallInfo);
 
     // Setup VAO
     drawcallInfo.GetVAO().Bind();
 }
 
+void Renderer::Draw(const DrawcallInfo& drawcallInfo) const
+{
+    if (drawcallInfo.IsMultiDraw())
+    {
+        const MultiDraw& multiDraw = m_multiDraws[drawcallInfo.GetMultiDrawIndex()];
+        m_device.AddDrawcall();
+        glMultiDrawElementsBaseVertex(multiDraw.primitive, &m_multiDrawCounts[multiDraw.first], multiDraw.eboType,
+            &m_multiDrawOffsets[multiDraw.first], multiDraw.count, &m_multiDrawBaseVertices[multiDraw.first]);
+    }
+    else
+    {
+        drawcallInfo.GetDrawcall().Draw(drawcallInfo.GetInstanceCount());
+    }
+}
+
 void Renderer::SetLightingRenderStates(bool firstPass)
 {
     // Set the render states for the first and additional lights
     if (!firstPass)
     {
         m_device.SetFeatureEnabled(GL_BLEND, true);
-        glDepthFunc(firstPass ? GL_LESS : GL_EQUAL);
-        glBlendFunc(GL_ONE, GL_ONE);
+        m_device.SetDepthFunction(firstPass ? GL_LESS : GL_EQUAL);
+        m_device.SetBlendFunction(GL_ONE, GL_ONE, GL_ONE, GL_ONE);
     }
 }
 
@@ -328,3 +635,136 @@ const glm::mat4& Renderer::GetWorldMatrix(const DrawcallInfo& drawcallInfo) cons
 {
     return m_worldMatrices[drawcallInfo.GetWorldMatrixIndex()];
 }
+
+std::uint64_t Renderer::ComputeSortKey(const Material& material, const VertexArrayObject& vao, std::uint32_t depthKey) const
+{
+    static_assert(c_sortKeyPassBits + 3 * c_sortKeyStateBits + c_sortKeyDepthBits <= 64, "Sort key doesn't fit in 64 bits");
+    constexpr std::uint64_t passMask = (1ull << c_sortKeyPassBits) - 1;
+    constexpr std::uint64_t stateMask = (1ull << c_sortKeyStateBits) - 1;
+
+    // Opaque geometry goes in the first pass, blended geometry after it
+    std::uint64_t pass = (material.HasBlend() ? 1 : 0) & passMask;
+
+    // Handles are small integers, so the low bits are enough to group them.
+    // Materials have no id, fold the address instead. A collision only makes grouping less tight
+    std::shared_ptr<const ShaderProgram> shaderProgram = material.GetShaderProgram();
+    std::uint64_t program = shaderProgram ? (shaderProgram->GetHandle() & stateMask) : 0;
+    std::uint64_t materialId = (reinterpret_cast<std::uintptr_t>(&material) >> 4) & stateMask;
+    std::uint64_t vaoId = vao.GetHandle() & stateMask;
+
+    std::uint64_t sortKey = pass;
+    sortKey = (sortKey << c_sortKeyStateBits) | program;
+    sortKey = (sortKey << c_sortKeyStateBits) | materialId;
+    sortKey = (sortKey << c_sortKeyStateBits) | vaoId;
+    sortKey = (sortKey << c_sortKeyDepthBits) | depthKey;
+    return sortKey;
+}
+
+std::uint32_t Renderer::ComputeDepthKey(const glm::mat4& worldMatrix) const
+{
+    if (!m_currentCamera)
+    {
+        return 0;
+    }
+
+    // Distance along the view direction. The camera looks down -Z in view space
+    float depth = -(m_currentCamera->GetViewMatrix() * worldMatrix[3]).z;
+    if (!(depth > 0.0f))
+    {
+        return 0;
+    }
+
+    // Positive floats keep their order when compared as integers. Keep the top bits
+    return std::bit_cast<std::uint32_t>(depth) >> (31 - c_sortKeyDepthBits);
+}
+
+void Renderer::UpdateSortKeyDepths()
+{
+    constexpr std::uint64_t depthMask = (1ull << c_sortKeyDepthBits) - 1;
+
+    for (DrawcallCollection& collection : m_drawcallCollections)
+    {
+        for (DrawcallInfo& drawcallInfo : collection.GetDrawcalls())
+        {
+            std::uint32_t depthKey = ComputeDepthKey(GetWorldMatrix(drawcallInfo));
+            drawcallInfo.SetSortKey((drawcallInfo.GetSortKey() & ~depthMask) | depthKey);
+        }
+    }
+}
+
+std::uint32_t Renderer::GetSortKeyDepth(std::uint64_t sortKey)
+{
+    return static_cast<std::uint32_t>(sortKey & ((1ull << c_sortKeyDepthBits) - 1));
+}
+
+std::uint64_t Renderer::GetModeSortKey(std::uint64_t sortKey, DrawcallSortMode sortMode)
+{
+    constexpr unsigned int stateShift = c_sortKeyDepthBits;
+    constexpr unsigned int stateBits = 3 * c_sortKeyStateBits;
+    constexpr unsigned int passShift = stateShift + stateBits;
+    constexpr std::uint64_t depthMask = (1ull << c_sortKeyDepthBits) - 1;
+    constexpr std::uint64_t stateMask = (1ull << stateBits) - 1;
+
+    if (sortMode == DrawcallSortMode::State)
+    {
+        return sortKey;
+    }
+
+    // Move the depth above the state, keeping the pass on top
+    std::uint64_t pass = sortKey >> passShift;
+    std::uint64_t state = (sortKey >> stateShift) & stateMask;
+    std::uint64_t depth = sortKey & depthMask;
+    if (sortMode == DrawcallSortMode::BackToFront)
+    {
+        depth = ~depth & depthMask;
+    }
+
+    return (pass << passShift) | (depth << stateBits) | state;
+}
+
+// Stable LSD radix sort, 8 bits per digit. Digits where all the keys match are skipped
+void Renderer::RadixSort(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch)
+{
+    constexpr unsigned int digitBits = 8;
+    constexpr unsigned int digitCount = 1 << digitBits;
+    constexpr unsigned int passCount = 64 / digitBits;
+
+    scratch.resize(entries.size());
+
+    // Build all the histograms in a single read of the keys
+    std::array<std::array<unsigned int, digitCount>, passCount> histograms{};
+    for (const SortEntry& entry : entries)
+    {
+        for (unsigned int pass = 0; pass < passCount; ++pass)
+        {
+            histograms[pass][(entry.key >> (pass * digitBits)) & (digitCount - 1)]++;
+        }
+    }
+
+    for (unsigned int pass = 0; pass < passCount; ++pass)
+    {
+        std::array<unsigned int, digitCount>& histogram = histograms[pass];
+
+        // All keys have the same digit, nothing would move
+        unsigned int firstDigit = (entries[0].key >> (pass * digitBits)) & (digitCount - 1);
+        if (histogram[firstDigit] == entries.size())
+        {
+            continue;
+        }
+
+        // Turn the counts into offsets
+        unsigned int offset = 0;
+        for (unsigned int& bucket : histogram)
+        {
+            unsigned int bucketCount = bucket;
+            bucket = offset;
+            offset += bucketCount;
+        }
+
+        for (const SortEntry& entry : entries)
+        {
+            scratch[histogram[(entry.key >> (pass * digitBits)) & (digitCount - 1)]++] = entry;
+        }
+        entries.swap(scratch);
+    }
+}
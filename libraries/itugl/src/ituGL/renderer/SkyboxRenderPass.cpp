@@ -7,20 +7,31 @@
 #include <ituGL/texture/TextureCubemapObject.h>
 
 SkyboxRenderPass::SkyboxRenderPass(std::shared_ptr<TextureCubemapObject> texture)
+    : SkyboxRenderPass(texture, CreateShaderProgram())
+{
+}
+
+SkyboxRenderPass::SkyboxRenderPass(std::shared_ptr<TextureCubemapObject> texture, std::shared_ptr<const ShaderProgram> shaderProgram)
     : m_texture(texture)
+    , m_shaderProgram(shaderProgram)
     , m_cameraPositionLocation(-1)
     , m_invViewProjMatrixLocation(-1)
     , m_skyboxTextureLocation(-1)
+{
+    // Get uniform locations
+    m_cameraPositionLocation = m_shaderProgram->GetUniformLocation("CameraPosition");
+    m_invViewProjMatrixLocation = m_shaderProgram->GetUniformLocation("InvViewProjMatrix");
+    m_skyboxTextureLocation = m_shaderProgram->GetUniformLocation("SkyboxTexture");
+}
+
+std::shared_ptr<ShaderProgram> SkyboxRenderPass::CreateShaderProgram()
 {
     // Load shaders and build shader program
     Shader vertexShader = ShaderLoader(Shader::VertexShader).Load("shaders/renderer/skybox.vert");
     Shader fragmentShader = ShaderLoader(Shader::FragmentShader).Load("shaders/renderer/skybox.frag");
-    m_shaderProgram.Build(vertexShader, fragmentShader);
-
-    // Get uniform locations
-    m_cameraPositionLocation = m_shaderProgram.GetUniformLocation("CameraPosition");
-    m_invViewProjMatrixLocation = m_shaderProgram.GetUniformLocation("InvViewProjMatrix");
-    m_skyboxTextureLocation = m_shaderProgram.GetUniformLocation("SkyboxTexture");
+    std::shared_ptr<ShaderProgram> shaderProgram = std::make_shared<ShaderProgram>();
+    shaderProgram->Build(vertexShader, fragmentShader);
+    return shaderProgram;
 }
 
 std::shared_ptr<TextureCubemapObject> SkyboxRenderPass::GetTexture() const
@@ -37,19 +48,19 @@ void SkyboxRenderPass::Render()
 {
     Renderer& renderer = GetRenderer();
 
-    m_shaderProgram.Use();
+    m_shaderProgram->Use();
 
     const Camera& camera = renderer.GetCurrentCamera();
-    m_shaderProgram.SetUniform(m_cameraPositionLocation, camera.ExtractTranslation());
-    m_shaderProgram.SetUniform(m_invViewProjMatrixLocation, glm::inverse(camera.GetViewProjectionMatrix()));
-    m_shaderProgram.SetTexture(m_skyboxTextureLocation, 0, *m_texture);
+    m_shaderProgram->SetUniform(m_cameraPositionLocation, camera.ExtractTranslation());
+    m_shaderProgram->SetUniform(m_invViewProjMatrixLocation, glm::inverse(camera.GetViewProjectionMatrix()));
+    m_shaderProgram->SetTexture(m_skyboxTextureLocation, 0, *m_texture);
 
     // Only write to depth == 1
-    glDepthFunc(GL_EQUAL);
+    renderer.GetDevice().SetDepthFunction(GL_EQUAL);
 
     const Mesh& fullscreenMesh = renderer.GetFullscreenMesh();
     fullscreenMesh.DrawSubmesh(0);
     
     // Restore default value
-    glDepthFunc(GL_LESS);
+    renderer.GetDevice().SetDepthFunction(GL_LESS);
 }
@@ -1,5 +1,8 @@
 #include <ituGL/scene/Bounds.h>
 
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+
 SphereBounds::SphereBounds(const Bounds& bounds) : Bounds(bounds.GetCenter()), m_radius(0.0f)
 {
     switch (bounds.GetType())
@@ -8,10 +11,10 @@ SphereBounds::SphereBounds(const Bounds& bounds) : Bounds(bounds.GetCenter()), m
         m_radius = static_cast<const SphereBounds&>(bounds).GetRadius();
         break;
     case Type::AABB:
-        m_radius = static_cast<const AabbBounds&>(bounds).GetSize().length();
+        m_radius = glm::length(static_cast<const AabbBounds&>(bounds).GetSize());
         break;
     case Type::Box:
-        m_radius = static_cast<const BoxBounds&>(bounds).GetSize().length();
+        m_radius = glm::length(static_cast<const BoxBounds&>(bounds).GetSize());
         break;
     default:
         assert(false);
@@ -61,6 +64,48 @@ BoxBounds::BoxBounds(const Bounds& bounds) : RotatedBounds(bounds.GetCenter(), g
     }
 }
 
+BoxBounds::BoxBounds(const AabbBounds& localBounds, const glm::mat4& matrix)
+    : RotatedBounds(glm::vec3(matrix * glm::vec4(localBounds.GetCenter(), 1.0f)), glm::mat3(1.0f)), m_size(localBounds.GetSize())
+{
+    // Split the scale from the rotation. Shear is not supported
+    for (int i = 0; i < 3; ++i)
+    {
+        glm::vec3 axis(matrix[i]);
+        float scale = glm::length(axis);
+        if (scale > 0.0f)
+        {
+            m_rotationMatrix[i] = axis / scale;
+        }
+        m_size[i] *= scale;
+    }
+}
+
+FrustumBounds::FrustumBounds(const glm::mat4& viewProjMatrix) : Bounds(glm::vec3(0.0f))
+{
+    SetMatrix(viewProjMatrix);
+}
+
+void FrustumBounds::SetMatrix(const glm::mat4& viewProjMatrix)
+{
+    // Extract the planes from the rows of the matrix (Gribb-Hartmann)
+    glm::mat4 transposed = glm::transpose(viewProjMatrix);
+    m_planes[0] = transposed[3] + transposed[0];
+    m_planes[1] = transposed[3] - transposed[0];
+    m_planes[2] = transposed[3] + transposed[1];
+    m_planes[3] = transposed[3] - transposed[1];
+    m_planes[4] = transposed[3] + transposed[2];
+    m_planes[5] = transposed[3] - transposed[2];
+
+    for (glm::vec4& plane : m_planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+
+    // Center of the clip volume, back in world space
+    glm::vec4 center = glm::inverse(viewProjMatrix) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    m_center = glm::vec3(center) / center.w;
+}
+
 template<>
 bool Bounds::Intersects(const SphereBounds& boundsA, const SphereBounds& boundsB)
 {
@@ -135,21 +180,57 @@ bool Bounds::Intersects(const BoxBounds& boundsA, const BoxBounds& boundsB)
         && TestSeparationAxis(glm::cross(boundsA.GetZVector(), boundsB.GetZVector()), distance, mA, mB);
 }
 
+// The tests against the frustum are conservative: volumes close to the corners can be reported as intersecting
+
 template<>
 bool Bounds::Intersects(const FrustumBounds& boundsA, const SphereBounds& boundsB)
 {
+    glm::vec4 center(boundsB.GetCenter(), 1.0f);
+    for (int i = 0; i < boundsA.GetPlaneCount(); ++i)
+    {
+        if (glm::dot(boundsA.GetPlane(i), center) < -boundsB.GetRadius())
+        {
+            return false;
+        }
+    }
     return true;
 }
 
 template<>
 bool Bounds::Intersects(const FrustumBounds& boundsA, const AabbBounds& boundsB)
 {
+    glm::vec4 center(boundsB.GetCenter(), 1.0f);
+    for (int i = 0; i < boundsA.GetPlaneCount(); ++i)
+    {
+        const glm::vec4& plane = boundsA.GetPlane(i);
+        // Projected half size of the box on the plane normal
+        float radius = glm::dot(glm::abs(glm::vec3(plane)), boundsB.GetSize());
+        if (glm::dot(plane, center) < -radius)
+        {
+            return false;
+        }
+    }
     return true;
 }
 
 template<>
 bool Bounds::Intersects(const FrustumBounds& boundsA, const BoxBounds& boundsB)
 {
+    glm::vec4 center(boundsB.GetCenter(), 1.0f);
+    glm::mat3 scaledMatrix = boundsB.GetScaledMatrix();
+    for (int i = 0; i < boundsA.GetPlaneCount(); ++i)
+    {
+        const glm::vec4& plane = boundsA.GetPlane(i);
+        glm::vec3 normal(plane);
+        // Projected half size of the box on the plane normal
+        float radius = std::abs(glm::dot(normal, scaledMatrix[0]))
+            + std::abs(glm::dot(normal, scaledMatrix[1]))
+            + std::abs(glm::dot(normal, scaledMatrix[2]));
+        if (glm::dot(plane, center) < -radius)
+        {
+            return false;
+        }
+    }
     return true;
 }
 
@@ -163,6 +244,8 @@ bool Bounds::Intersects(const Bounds& boundsA, const Bounds& boundsB)
         return Bounds::Intersects(static_cast<const AabbBounds&>(boundsA), boundsB);
     case Type::Box:
         return Bounds::Intersects(static_cast<const BoxBounds&>(boundsA), boundsB);
+    case Type::Frustum:
+        return Bounds::Intersects(static_cast<const FrustumBounds&>(boundsA), boundsB);
     default:
         assert(false);
         return false;
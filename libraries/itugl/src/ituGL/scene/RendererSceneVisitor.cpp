@@ -5,6 +5,8 @@
 #include <ituGL/scene/SceneLight.h>
 #include <ituGL/scene/SceneModel.h>
 #include <ituGL/scene/Transform.h>
+#include <ituGL/geometry/Model.h>
+#include <ituGL/geometry/Mesh.h>
 
 RendererSceneVisitor::RendererSceneVisitor(Renderer& renderer) : m_renderer(renderer)
 {
@@ -14,6 +16,12 @@ void RendererSceneVisitor::VisitCamera(SceneCamera& sceneCamera)
 {
     assert(!m_renderer.HasCamera()); // Currently, only one camera per scene supported
     m_renderer.SetCurrentCamera(*sceneCamera.GetCamera());
+
+    for (SceneModel* sceneModel : m_pendingModels)
+    {
+        AddModel(*sceneModel);
+    }
+    m_pendingModels.clear();
 }
 
 void RendererSceneVisitor::VisitLight(SceneLight& sceneLight)
@@ -24,5 +32,31 @@ void RendererSceneVisitor::VisitLight(SceneLight& sceneLight)
 void RendererSceneVisitor::VisitModel(SceneModel& sceneModel)
 {
     assert(sceneModel.GetTransform());
-    m_renderer.AddModel(*sceneModel.GetModel(), sceneModel.GetTransform()->GetTransformMatrix());
+    if (m_renderer.HasCamera())
+    {
+        AddModel(sceneModel);
+    }
+    else
+    {
+        m_pendingModels.push_back(&sceneModel);
+    }
+}
+
+void RendererSceneVisitor::Flush()
+{
+    // Scene without camera, add the remaining models without culling
+    for (SceneModel* sceneModel : m_pendingModels)
+    {
+        AddModel(*sceneModel);
+    }
+    m_pendingModels.clear();
+}
+
+void RendererSceneVisitor::AddModel(SceneModel& sceneModel)
+{
+    const Mesh& mesh = sceneModel.GetModel()->GetMesh();
+    if (!mesh.HasBounds() || m_renderer.IsVisible(sceneModel.GetBoxBounds()))
+    {
+        m_renderer.AddModel(*sceneModel.GetModel(), sceneModel.GetTransform()->GetTransformMatrix());
+    }
 }
@@ -57,7 +57,13 @@ BoxBounds SceneModel::GetBoxBounds() const
 {
     assert(m_transform);
     assert(m_model);
-    return BoxBounds(m_transform->GetTranslation(), m_transform->GetRotationMatrix(), m_transform->GetScale() /* * m_model->GetSize()*/);
+    const Mesh& mesh = m_model->GetMesh();
+    if (mesh.HasBounds())
+    {
+        // Mesh bounds moved to world space
+        return BoxBounds(mesh.GetBounds(), m_transform->GetTransformMatrix());
+    }
+    return BoxBounds(m_transform->GetTranslation(), m_transform->GetRotationMatrix(), m_transform->GetScale());
 }
 
 void SceneModel::AcceptVisitor(SceneVisitor& visitor)
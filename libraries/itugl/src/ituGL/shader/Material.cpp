@@ -8,42 +8,57 @@ Material::Material() : Material(nullptr)
 
 Material::Material(std::shared_ptr<ShaderProgram> shaderProgram, const NameSet& filteredUniforms)
     : ShaderUniformCollection(shaderProgram, filteredUniforms)
-    , m_depthTestFunction(TestFunction::Less)
-    , m_depthWrite(true)
-    , m_stencilTestFunctions{ TestFunction::Never, TestFunction::Never }
-    , m_stencilRefValues{ 0, 0 }
-    , m_stencilMasks{ ~0u, ~0u }
-    , m_stencilFail{ StencilOperation::Keep, StencilOperation::Keep }
-    , m_stencilDepthFail{ StencilOperation::Keep, StencilOperation::Keep }
-    , m_stencilDepthPass{ StencilOperation::Keep, StencilOperation::Keep }
-    , m_blendEquations{ BlendEquation::None }
-    , m_blendParams{ BlendParam::One, BlendParam::Zero, BlendParam::One, BlendParam::Zero }
+    , m_state(std::make_shared<PipelineState>())
 {
 }
 
+Material::PipelineState::PipelineState()
+    : depthTestFunction(TestFunction::Less)
+    , depthWrite(true)
+    , stencilTestFunctions{ TestFunction::Never, TestFunction::Never }
+    , stencilRefValues{ 0, 0 }
+    , stencilMasks{ ~0u, ~0u }
+    , stencilFail{ StencilOperation::Keep, StencilOperation::Keep }
+    , stencilDepthFail{ StencilOperation::Keep, StencilOperation::Keep }
+    , stencilDepthPass{ StencilOperation::Keep, StencilOperation::Keep }
+    , blendEquations{ BlendEquation::None }
+    , blendParams{ BlendParam::One, BlendParam::Zero, BlendParam::One, BlendParam::Zero }
+{
+}
+
+Material::PipelineState& Material::GetWritableState()
+{
+    // Copy the state if it is shared with other materials, before changing it
+    if (m_state.use_count() > 1)
+    {
+        m_state = std::make_shared<PipelineState>(*m_state);
+    }
+    return *m_state;
+}
+
 void Material::SetShaderSetupFunction(ShaderSetupFunction shaderSetupFunction)
 {
-    m_shaderSetupFunction = shaderSetupFunction;
+    GetWritableState().shaderSetupFunction = shaderSetupFunction;
 }
 
 Material::TestFunction Material::GetDepthTestFunction() const
 {
-    return m_depthTestFunction;
+    return m_state->depthTestFunction;
 }
 
 void Material::SetDepthTestFunction(TestFunction function)
 {
-    m_depthTestFunction = function;
+    GetWritableState().depthTestFunction = function;
 }
 
 bool Material::GetDepthWrite() const
 {
-    return m_depthWrite;
+    return m_state->depthWrite;
 }
 
 void Material::SetDepthWrite(bool depthWrite)
 {
-    m_depthWrite = depthWrite;
+    GetWritableState().depthWrite = depthWrite;
 }
 
 void Material::SetStencilTestFunction(TestFunction function, int refValue, unsigned int mask)
@@ -54,30 +69,32 @@ void Material::SetStencilTestFunction(TestFunction function, int refValue, unsig
 
 Material::TestFunction Material::GetStencilFrontTestFunction(int &refValue, unsigned int &mask) const
 {
-    refValue = m_stencilRefValues[0];
-    mask = m_stencilMasks[0];
-    return m_stencilTestFunctions[0];
+    refValue = m_state->stencilRefValues[0];
+    mask = m_state->stencilMasks[0];
+    return m_state->stencilTestFunctions[0];
 }
 
 void Material::SetStencilFrontTestFunction(TestFunction function, int refValue, unsigned int mask)
 {
-    m_stencilTestFunctions[0] = function;
-    m_stencilRefValues[0] = refValue;
-    m_stencilMasks[0] = mask;
+    PipelineState& state = GetWritableState();
+    state.stencilTestFunctions[0] = function;
+    state.stencilRefValues[0] = refValue;
+    state.stencilMasks[0] = mask;
 }
 
 Material::TestFunction Material::GetStencilBackTestFunction(int& refValue, unsigned int& mask) const
 {
-    refValue = m_stencilRefValues[1];
-    mask = m_stencilMasks[1];
-    return m_stencilTestFunctions[1];
+    refValue = m_state->stencilRefValues[1];
+    mask = m_state->stencilMasks[1];
+    return m_state->stencilTestFunctions[1];
 }
 
 void Material::SetStencilBackTestFunction(TestFunction function, int refValue, unsigned int mask)
 {
-    m_stencilTestFunctions[1] = function;
-    m_stencilRefValues[1] = refValue;
-    m_stencilMasks[1] = mask;
+    PipelineState& state = GetWritableState();
+    state.stencilTestFunctions[1] = function;
+    state.stencilRefValues[1] = refValue;
+    state.stencilMasks[1] = mask;
 }
 
 void Material::SetStencilOperations(StencilOperation stencilFail, StencilOperation depthFail, StencilOperation depthPass)
@@ -88,45 +105,47 @@ void Material::SetStencilOperations(StencilOperation stencilFail, StencilOperati
 
 void Material::GetStencilFrontOperations(StencilOperation& stencilFail, StencilOperation& depthFail, StencilOperation& depthPass) const
 {
-    stencilFail = m_stencilFail[0];
-    depthFail = m_stencilDepthFail[0];
-    depthPass = m_stencilDepthPass[0];
+    stencilFail = m_state->stencilFail[0];
+    depthFail = m_state->stencilDepthFail[0];
+    depthPass = m_state->stencilDepthPass[0];
 }
 
 void Material::SetStencilFrontOperations(StencilOperation stencilFail, StencilOperation depthFail, StencilOperation depthPass)
 {
-    m_stencilFail[0] = stencilFail;
-    m_stencilDepthFail[0] = depthFail;
-    m_stencilDepthPass[0] = depthPass;
+    PipelineState& state = GetWritableState();
+    state.stencilFail[0] = stencilFail;
+    state.stencilDepthFail[0] = depthFail;
+    state.stencilDepthPass[0] = depthPass;
 }
 
 void Material::GetStencilBackOperations(StencilOperation& stencilFail, StencilOperation& depthFail, StencilOperation& depthPass) const
 {
-    stencilFail = m_stencilFail[1];
-    depthFail = m_stencilDepthFail[1];
-    depthPass = m_stencilDepthPass[1];
+    stencilFail = m_state->stencilFail[1];
+    depthFail = m_state->stencilDepthFail[1];
+    depthPass = m_state->stencilDepthPass[1];
 }
 
 void Material::SetStencilBackOperations(StencilOperation stencilFail, StencilOperation depthFail, StencilOperation depthPass)
 {
-    m_stencilFail[1] = stencilFail;
-    m_stencilDepthFail[1] = depthFail;
-    m_stencilDepthPass[1] = depthPass;
+    PipelineState& state = GetWritableState();
+    state.stencilFail[1] = stencilFail;
+    state.stencilDepthFail[1] = depthFail;
+    state.stencilDepthPass[1] = depthPass;
 }
 
 bool Material::HasBlend() const
 {
-    return m_blendEquations[0] != BlendEquation::None || m_blendEquations[1] != BlendEquation::None;
+    return m_state->blendEquations[0] != BlendEquation::None || m_state->blendEquations[1] != BlendEquation::None;
 }
 
 Material::BlendEquation Material::GetBlendEquationColor() const
 {
-    return m_blendEquations[0];
+    return m_state->blendEquations[0];
 }
 
 Material::BlendEquation Material::GetBlendEquationAlpha() const
 {
-    return m_blendEquations[1];
+    return m_state->blendEquations[1];
 }
 
 void Material::SetBlendEquation(BlendEquation blendEquation)
@@ -136,28 +155,29 @@ void Material::SetBlendEquation(BlendEquation blendEquation)
 
 void Material::SetBlendEquation(BlendEquation blendEquationColor, BlendEquation blendEquationAlpha)
 {
-    m_blendEquations[0] = blendEquationColor;
-    m_blendEquations[1] = blendEquationAlpha;
+    PipelineState& state = GetWritableState();
+    state.blendEquations[0] = blendEquationColor;
+    state.blendEquations[1] = blendEquationAlpha;
 }
 
 Material::BlendParam Material::GetBlendParamSourceColor() const
 {
-    return m_blendParams[0];
+    return m_state->blendParams[0];
 }
 
 Material::BlendParam Material::GetBlendParamSourceAlpha() const
 {
-    return m_blendParams[2];
+    return m_state->blendParams[2];
 }
 
 Material::BlendParam Material::GetBlendParamDestColor() const
 {
-    return m_blendParams[1];
+    return m_state->blendParams[1];
 }
 
 Material::BlendParam Material::GetBlendParamDestAlpha() const
 {
-    return m_blendParams[3];
+    return m_state->blendParams[3];
 }
 
 void Material::SetBlendParams(BlendParam source, BlendParam dest)
@@ -172,10 +192,11 @@ void Material::SetBlendParams(BlendParam source, BlendParam dest, Color blendCol
 
 void Material::SetBlendParams(BlendParam sourceColor, BlendParam destColor, BlendParam sourceAlpha, BlendParam destAlpha)
 {
-    m_blendParams[0] = sourceColor;
-    m_blendParams[1] = destColor;
-    m_blendParams[2] = sourceAlpha;
-    m_blendParams[3] = destAlpha;
+    PipelineState& state = GetWritableState();
+    state.blendParams[0] = sourceColor;
+    state.blendParams[1] = destColor;
+    state.blendParams[2] = sourceAlpha;
+    state.blendParams[3] = destAlpha;
 }
 
 void Material::SetBlendParams(BlendParam sourceColor, BlendParam destColor, BlendParam sourceAlpha, BlendParam destAlpha, Color blendColor)
@@ -186,13 +207,14 @@ void Material::SetBlendParams(BlendParam sourceColor, BlendParam destColor, Blen
 
 void Material::SetBlendColor(Color blendColor)
 {
+    PipelineState& state = GetWritableState();
     // Check that at least one of the parameters is ConstantColor or ConstantAlpha
-    assert(m_blendParams[0] == BlendParam::ConstantColor || m_blendParams[0] == BlendParam::ConstantAlpha
-        || m_blendParams[1] == BlendParam::ConstantColor || m_blendParams[1] == BlendParam::ConstantAlpha
-        || m_blendParams[2] == BlendParam::ConstantColor || m_blendParams[2] == BlendParam::ConstantAlpha
-        || m_blendParams[3] == BlendParam::ConstantColor || m_blendParams[3] == BlendParam::ConstantAlpha);
+    assert(state.blendParams[0] == BlendParam::ConstantColor || state.blendParams[0] == BlendParam::ConstantAlpha
+        || state.blendParams[1] == BlendParam::ConstantColor || state.blendParams[1] == BlendParam::ConstantAlpha
+        || state.blendParams[2] == BlendParam::ConstantColor || state.blendParams[2] == BlendParam::ConstantAlpha
+        || state.blendParams[3] == BlendParam::ConstantColor || state.blendParams[3] == BlendParam::ConstantAlpha);
 
-    m_blendColor = blendColor;
+    state.blendColor = blendColor;
 }
 
 void Material::Use(OverrideFlags overrideFlags) const
@@ -205,10 +227,10 @@ void Material::Use(OverrideFlags overrideFlags) const
     // Set the value of all the uniforms stored as properties
     SetUniforms();
 
-    if (m_shaderSetupFunction)
+    if (m_state->shaderSetupFunction)
     {
         // if needed, do extra set up for the shader
-        m_shaderSetupFunction(*m_shaderProgram);
+        m_state->shaderSetupFunction(*m_shaderProgram);
     }
 
     // If not skipped, set the depth settings
@@ -232,39 +254,43 @@ void Material::Use(OverrideFlags overrideFlags) const
 
 void Material::UseDepthTest() const
 {
+    DeviceGL& device = DeviceGL::GetInstance();
+
     // Depth function
-    glDepthFunc(static_cast<GLenum>(m_depthTestFunction));
+    device.SetDepthFunction(static_cast<GLenum>(m_state->depthTestFunction));
 
     // Depth write
-    glDepthMask(m_depthWrite ? GL_TRUE : GL_FALSE);
+    device.SetDepthWrite(m_state->depthWrite);
 }
 
 void Material::UseStencilTest() const
 {
+    DeviceGL& device = DeviceGL::GetInstance();
+
     // Stencil operations
-    if (m_stencilFail[0] == m_stencilFail[1] && m_stencilDepthFail[0] == m_stencilDepthFail[1] && m_stencilDepthPass[0] == m_stencilDepthPass[1])
+    if (m_state->stencilFail[0] == m_state->stencilFail[1] && m_state->stencilDepthFail[0] == m_state->stencilDepthFail[1] && m_state->stencilDepthPass[0] == m_state->stencilDepthPass[1])
     {
         // Same for front and back
-        glStencilOp(static_cast<GLenum>(m_stencilFail[0]), static_cast<GLenum>(m_stencilDepthFail[0]), static_cast<GLenum>(m_stencilDepthPass[0]));
+        device.SetStencilOperations(GL_FRONT_AND_BACK, static_cast<GLenum>(m_state->stencilFail[0]), static_cast<GLenum>(m_state->stencilDepthFail[0]), static_cast<GLenum>(m_state->stencilDepthPass[0]));
     }
     else
     {
         // Separate functions for front and back
-        glStencilOpSeparate(GL_FRONT, static_cast<GLenum>(m_stencilFail[0]), static_cast<GLenum>(m_stencilDepthFail[0]), static_cast<GLenum>(m_stencilDepthPass[0]));
-        glStencilOpSeparate(GL_BACK, static_cast<GLenum>(m_stencilFail[1]), static_cast<GLenum>(m_stencilDepthFail[1]), static_cast<GLenum>(m_stencilDepthPass[1]));
+        device.SetStencilOperations(GL_FRONT, static_cast<GLenum>(m_state->stencilFail[0]), static_cast<GLenum>(m_state->stencilDepthFail[0]), static_cast<GLenum>(m_state->stencilDepthPass[0]));
+        device.SetStencilOperations(GL_BACK, static_cast<GLenum>(m_state->stencilFail[1]), static_cast<GLenum>(m_state->stencilDepthFail[1]), static_cast<GLenum>(m_state->stencilDepthPass[1]));
     }
 
     // Stencil functions
-    if (m_stencilTestFunctions[0] == m_stencilTestFunctions[1] && m_stencilRefValues[0] == m_stencilRefValues[1] && m_stencilMasks[0] == m_stencilMasks[1])
+    if (m_state->stencilTestFunctions[0] == m_state->stencilTestFunctions[1] && m_state->stencilRefValues[0] == m_state->stencilRefValues[1] && m_state->stencilMasks[0] == m_state->stencilMasks[1])
     {
         // Same for front and back
-        glStencilFunc(static_cast<GLenum>(m_stencilTestFunctions[0]), m_stencilRefValues[0], m_stencilMasks[0]);
+        device.SetStencilFunction(GL_FRONT_AND_BACK, static_cast<GLenum>(m_state->stencilTestFunctions[0]), m_state->stencilRefValues[0], m_state->stencilMasks[0]);
     }
     else
     {
         // Separate functions for front and back
-        glStencilFuncSeparate(GL_FRONT, static_cast<GLenum>(m_stencilTestFunctions[0]), m_stencilRefValues[0], m_stencilMasks[0]);
-        glStencilFuncSeparate(GL_BACK, static_cast<GLenum>(m_stencilTestFunctions[1]), m_stencilRefValues[1], m_stencilMasks[1]);
+        device.SetStencilFunction(GL_FRONT, static_cast<GLenum>(m_state->stencilTestFunctions[0]), m_state->stencilRefValues[0], m_state->stencilMasks[0]);
+        device.SetStencilFunction(GL_BACK, static_cast<GLenum>(m_state->stencilTestFunctions[1]), m_state->stencilRefValues[1], m_state->stencilMasks[1]);
     }
 }
 
@@ -272,30 +298,31 @@ void Material::UseBlend() const
 {
     // If the blend equation is None for color and alpha, do nothing
     bool blending = HasBlend();
-    DeviceGL::GetInstance().SetFeatureEnabled(GL_BLEND, blending);
+    DeviceGL& device = DeviceGL::GetInstance();
+    device.SetFeatureEnabled(GL_BLEND, blending);
     if (blending)
     {
-        std::array<BlendParam, 4> blendParams = m_blendParams;
+        std::array<BlendParam, 4> blendParams = m_state->blendParams;
 
         // Set blend equation
-        if (m_blendEquations[0] == m_blendEquations[1])
+        if (m_state->blendEquations[0] == m_state->blendEquations[1])
         {
             // Set the same blend equation for color and alpha
-            glBlendEquation(static_cast<GLenum>(m_blendEquations[0]));
+            device.SetBlendEquation(static_cast<GLenum>(m_state->blendEquations[0]), static_cast<GLenum>(m_state->blendEquations[0]));
         }
         else
         {
-            GLenum blendEquationColor = static_cast<GLenum>(m_blendEquations[0]);
-            GLenum blendEquationAlpha = static_cast<GLenum>(m_blendEquations[1]);
+            GLenum blendEquationColor = static_cast<GLenum>(m_state->blendEquations[0]);
+            GLenum blendEquationAlpha = static_cast<GLenum>(m_state->blendEquations[1]);
 
             // Because there is no "None" equation, we replace it with (Source * 1 + Dest * 0)
-            if (m_blendEquations[0] == BlendEquation::None)
+            if (m_state->blendEquations[0] == BlendEquation::None)
             {
                 blendEquationColor = GL_FUNC_ADD;
                 blendParams[0] = BlendParam::One;
                 blendParams[1] = BlendParam::Zero;
             }
-            if (m_blendEquations[1] == BlendEquation::None)
+            if (m_state->blendEquations[1] == BlendEquation::None)
             {
                 blendEquationAlpha = GL_FUNC_ADD;
                 blendParams[2] = BlendParam::One;
@@ -303,22 +330,13 @@ void Material::UseBlend() const
             }
 
             // Set separate blend equation for color and alpha
-            glBlendEquationSeparate(blendEquationColor, blendEquationAlpha);
+            device.SetBlendEquation(blendEquationColor, blendEquationAlpha);
         }
 
-        // Set blend params
-        if (blendParams[0] == blendParams[2] && blendParams[1] == blendParams[3])
-        {
-            // Set the same blend params for color and alpha
-            glBlendFunc(static_cast<GLenum>(blendParams[0]), static_cast<GLenum>(blendParams[1]));
-        }
-        else
-        {
-            // Set separate blend params for color and alpha
-            glBlendFuncSeparate(
-                static_cast<GLenum>(blendParams[0]), static_cast<GLenum>(blendParams[1]),
-                static_cast<GLenum>(blendParams[2]), static_cast<GLenum>(blendParams[3]));
-        }
+        // Set blend params, DeviceGL uses glBlendFunc when color and alpha params are the same
+        device.SetBlendFunction(
+            static_cast<GLenum>(blendParams[0]), static_cast<GLenum>(blendParams[1]),
+            static_cast<GLenum>(blendParams[2]), static_cast<GLenum>(blendParams[3]));
 
         // Set blend color only if one param is using constant color or constant alpha
         if (blendParams[0] == BlendParam::ConstantColor || blendParams[0] == BlendParam::ConstantAlpha ||
@@ -326,7 +344,7 @@ void Material::UseBlend() const
             blendParams[2] == BlendParam::ConstantColor || blendParams[2] == BlendParam::ConstantAlpha ||
             blendParams[3] == BlendParam::ConstantColor || blendParams[3] == BlendParam::ConstantAlpha)
         {
-            glBlendColor(m_blendColor.GetRed(), m_blendColor.GetGreen(), m_blendColor.GetBlue(), m_blendColor.GetAlpha());
+            device.SetBlendColor(m_state->blendColor);
         }
     }
 }
@@ -1,8 +1,12 @@
 #include <ituGL/shader/Shader.h>
 
+#include <ituGL/core/DeviceGL.h>
+#include <ituGL/core/Hash.h>
+#include <array>
 #include <cassert>
+#include <iostream>
 
-Shader::Shader(Type type) : Object(NullHandle)
+Shader::Shader(Type type) : Object(NullHandle), m_sourceHash(Hash::c_seed), m_compileDeferred(false)
 {
     Handle& handle = GetHandle();
     handle = glCreateShader(type);
@@ -19,12 +23,15 @@ Shader::~Shader()
 }
 
 Shader::Shader(Shader&& shader) noexcept : Object(std::move(shader))
+    , m_sourceHash(shader.m_sourceHash), m_compileDeferred(shader.m_compileDeferred)
 {
 }
 
 Shader& Shader::operator = (Shader&& shader) noexcept
 {
     Object::operator=(std::move(shader));
+    m_sourceHash = shader.m_sourceHash;
+    m_compileDeferred = shader.m_compileDeferred;
     return *this;
 }
 
@@ -51,6 +58,13 @@ void Shader::SetSource(std::span<const char*> source)
     assert(IsValid());
 
     glShaderSource(GetHandle(), static_cast<int>(source.size()), source.data(), nullptr);
+
+    m_sourceHash = Hash::c_seed;
+    for (const char* sourceCode : source)
+    {
+        m_sourceHash = Hash::FNV1a(sourceCode, m_sourceHash);
+    }
+    m_compileDeferred = false;
 }
 
 // Compile the shader source code
@@ -59,9 +73,38 @@ bool Shader::Compile()
     assert(IsValid());
 
     glCompileShader(GetHandle());
+    m_compileDeferred = false;
     return IsCompiled();
 }
 
+// Compile the shader now if the compilation was deferred, printing the errors if it fails
+bool Shader::CompileDeferred() const
+{
+    assert(IsValid());
+
+    if (m_compileDeferred)
+    {
+        SubmitDeferredCompile();
+        if (!IsCompiled())
+        {
+            PrintCompilationErrors();
+        }
+    }
+    return IsCompiled();
+}
+
+// Start the compilation if it was deferred, without waiting for the result
+void Shader::SubmitDeferredCompile() const
+{
+    assert(IsValid());
+
+    if (m_compileDeferred)
+    {
+        glCompileShader(GetHandle());
+        m_compileDeferred = false;
+    }
+}
+
 // Check if the shader has been successfully compiled
 bool Shader::IsCompiled() const
 {
@@ -72,6 +115,22 @@ bool Shader::IsCompiled() const
     return success;
 }
 
+// Check if the driver finished compiling, without waiting
+bool Shader::IsCompileComplete() const
+{
+    assert(IsValid());
+
+    DeviceGL* device = DeviceGL::GetInstancePointer();
+    if (!device || !device->IsParallelShaderCompileSupported())
+    {
+        return true;
+    }
+
+    GLint complete;
+    glGetShaderiv(GetHandle(), GL_COMPLETION_STATUS_KHR, &complete);
+    return complete;
+}
+
 // Get compilation error messages in case of a failure
 void Shader::GetCompilationErrors(std::span<char> errors) const
 {
@@ -79,3 +138,37 @@ void Shader::GetCompilationErrors(std::span<char> errors) const
 
     glGetShaderInfoLog(GetHandle(), static_cast<int>(errors.size()), nullptr, errors.data());
 }
+
+// Print the compilation error messages of a shader object that is only referenced by handle
+void Shader::PrintCompilationErrors(Handle handle)
+{
+    std::array<char, 512> infoLog;
+    glGetShaderInfoLog(handle, static_cast<int>(infoLog.size()), nullptr, infoLog.data());
+
+    GLint type;
+    glGetShaderiv(handle, GL_SHADER_TYPE, &type);
+
+    const char* typeName = "UNKNOWN";
+    switch (type)
+    {
+    case Shader::ComputeShader:
+        typeName = "COMPUTE";
+        break;
+    case Shader::VertexShader:
+        typeName = "VERTEX";
+        break;
+    case Shader::TesselationControlShader:
+        typeName = "TCS";
+        break;
+    case Shader::TesselationEvaluationShader:
+        typeName = "TES";
+        break;
+    case Shader::GeometryShader:
+        typeName = "GEOMETRY";
+        break;
+    case Shader::FragmentShader:
+        typeName = "FRAGMENT";
+        break;
+    }
+    std::cout << "ERROR::SHADER::" << typeName << "::COMPILATION_FAILED\n" << infoLog.data() << std::endl;
+}
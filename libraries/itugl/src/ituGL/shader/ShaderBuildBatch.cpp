@@ -0,0 +1,140 @@
+#include <ituGL/shader/ShaderBuildBatch.h>
+
+#include <ituGL/shader/Shader.h>
+#include <ituGL/shader/ShaderProgram.h>
+#include <ituGL/shader/ShaderProgramCache.h>
+#include <ituGL/core/DeviceGL.h>
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <thread>
+#include <cassert>
+
+ShaderBuildBatch* ShaderBuildBatch::s_current = nullptr;
+
+ShaderBuildBatch::ShaderBuildBatch()
+{
+    assert(!s_current);
+    s_current = this;
+
+    // Let the driver compile in as many threads as there are cores
+    if (DeviceGL* device = DeviceGL::GetInstancePointer())
+    {
+        unsigned int threadCount = std::thread::hardware_concurrency();
+        device->SetMaxShaderCompilerThreads(threadCount > 0 ? threadCount : 0xFFFFFFFF);
+    }
+}
+
+ShaderBuildBatch::~ShaderBuildBatch()
+{
+    // Programs submitted must still be checked, so the cache and the error messages are up to date
+    if (s_current == this)
+    {
+        Finish();
+    }
+}
+
+// Register a program that was linked without checking the status
+void ShaderBuildBatch::AddProgram(ShaderProgram& shaderProgram, std::uint64_t cacheKey, bool storeInCache)
+{
+    assert(s_current == this);
+
+    PendingProgram& pendingProgram = m_programs.emplace_back();
+    pendingProgram.shaderProgram = &shaderProgram;
+    pendingProgram.cacheKey = cacheKey;
+    pendingProgram.storeInCache = storeInCache;
+    pendingProgram.submitTime = std::chrono::steady_clock::now();
+}
+
+// Check if the driver finished compiling and linking all the programs, without waiting
+bool ShaderBuildBatch::IsComplete() const
+{
+    for (const PendingProgram& pendingProgram : m_programs)
+    {
+        if (!pendingProgram.shaderProgram->IsLinkComplete())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Wait for all the programs, print the errors and store them in the ShaderProgramCache
+bool ShaderBuildBatch::Finish()
+{
+    assert(s_current == this);
+
+    // Close the batch first, so the programs can be used normally
+    s_current = nullptr;
+
+    bool allLinked = true;
+    for (const PendingProgram& pendingProgram : m_programs)
+    {
+        allLinked &= CheckProgram(pendingProgram);
+    }
+    m_programs.clear();
+
+    return allLinked;
+}
+
+// Wait only for one program, so it can be used while the others are still compiling
+bool ShaderBuildBatch::FinishProgram(ShaderProgram& shaderProgram)
+{
+    assert(s_current == this);
+
+    auto it = std::find_if(m_programs.begin(), m_programs.end(),
+        [&](const PendingProgram& pendingProgram) { return pendingProgram.shaderProgram == &shaderProgram; });
+
+    // Programs loaded from the ShaderProgramCache are not added to the batch
+    if (it == m_programs.end())
+    {
+        return shaderProgram.IsLinked();
+    }
+
+    bool linked = CheckProgram(*it);
+    m_programs.erase(it);
+    return linked;
+}
+
+// Check the status of a program, print its errors or store it in the ShaderProgramCache
+bool ShaderBuildBatch::CheckProgram(const PendingProgram& pendingProgram)
+{
+    // Querying the link status waits until the driver finishes
+    ShaderProgram& shaderProgram = *pendingProgram.shaderProgram;
+    if (!shaderProgram.IsLinked())
+    {
+        PrintErrors(shaderProgram);
+        return false;
+    }
+
+    ShaderProgramCache* cache = ShaderProgramCache::GetInstancePointer();
+    if (pendingProgram.storeInCache && cache && cache->IsEnabled())
+    {
+        // Programs are built in parallel, the time since they were submitted is an upper bound of their build time
+        auto buildDuration = std::chrono::steady_clock::now() - pendingProgram.submitTime;
+        cache->StoreProgram(shaderProgram, pendingProgram.cacheKey, std::chrono::duration<float, std::milli>(buildDuration).count());
+    }
+    return true;
+}
+
+// Print the errors of the program and of its attached shaders
+void ShaderBuildBatch::PrintErrors(const ShaderProgram& shaderProgram)
+{
+    // The shaders could be deleted already, but they are kept alive by GL while they are attached
+    std::array<GLuint, 5> shaderHandles;
+    GLsizei shaderCount = 0;
+    glGetAttachedShaders(shaderProgram.GetHandle(), static_cast<GLsizei>(shaderHandles.size()), &shaderCount, shaderHandles.data());
+    for (GLsizei i = 0; i < shaderCount; ++i)
+    {
+        GLint compiled;
+        glGetShaderiv(shaderHandles[i], GL_COMPILE_STATUS, &compiled);
+        if (!compiled)
+        {
+            Shader::PrintCompilationErrors(shaderHandles[i]);
+        }
+    }
+
+    std::array<char, 512> infoLog;
+    shaderProgram.GetLinkingErrors(infoLog);
+    std::cout << "ERROR::PROGRAM::LINKING_FAILED\n" << infoLog.data() << std::endl;
+}
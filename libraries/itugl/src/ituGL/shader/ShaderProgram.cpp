@@ -1,14 +1,21 @@
 #include <ituGL/shader/ShaderProgram.h>
 
 #include <ituGL/shader/Shader.h>
+#include <ituGL/shader/ShaderBuildBatch.h>
+#include <ituGL/shader/ShaderProgramCache.h>
 #include <ituGL/texture/TextureObject.h>
+#include <ituGL/core/DeviceGL.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <string>
 #include <cassert>
 
 #ifndef NDEBUG
 ShaderProgram::Handle ShaderProgram::s_usedHandle = ShaderProgram::NullHandle;
 #endif
 
-ShaderProgram::ShaderProgram() : Object(NullHandle)
+ShaderProgram::ShaderProgram() : Object(NullHandle), m_uniformLocationsBuilt(false), m_uniformsRevision(0)
 {
     Handle& handle = GetHandle();
     handle = glCreateProgram();
@@ -20,17 +27,27 @@ ShaderProgram::~ShaderProgram()
     {
         Handle& handle = GetHandle();
         glDeleteProgram(handle);
+        if (DeviceGL* device = DeviceGL::GetInstancePointer())
+        {
+            device->OnProgramDeleted(handle);
+        }
         handle = NullHandle;
     }
 }
 
 ShaderProgram::ShaderProgram(ShaderProgram&& shaderProgram) noexcept : Object(std::move(shaderProgram))
+    , m_uniformLocations(std::move(shaderProgram.m_uniformLocations)), m_uniformLocationsBuilt(shaderProgram.m_uniformLocationsBuilt)
+    , m_uniformRevisions(std::move(shaderProgram.m_uniformRevisions)), m_uniformsRevision(shaderProgram.m_uniformsRevision)
 {
 }
 
 ShaderProgram& ShaderProgram::operator = (ShaderProgram&& shaderProgram) noexcept
 {
     Object::operator=(std::move(shaderProgram));
+    m_uniformLocations = std::move(shaderProgram.m_uniformLocations);
+    m_uniformLocationsBuilt = shaderProgram.m_uniformLocationsBuilt;
+    m_uniformRevisions = std::move(shaderProgram.m_uniformRevisions);
+    m_uniformsRevision = shaderProgram.m_uniformsRevision;
     return *this;
 }
 
@@ -45,8 +62,8 @@ void ShaderProgram::Bind() const
 bool ShaderProgram::Build(const Shader& computeShader)
 {
     assert(computeShader.IsType(Shader::ComputeShader));
-    AttachShader(computeShader);
-    return Link();
+    std::array<const Shader*, 1> shaders = { &computeShader };
+    return Link(shaders);
 }
 
 // Build (Attach and link) all shaders provided for the rasterization pipeline
@@ -54,32 +71,35 @@ bool ShaderProgram::Build(const Shader& vertexShader, const Shader& fragmentShad
     const Shader* tesselationControlShader, const Shader* tesselationEvaluationShader,
     const Shader* geometryShader)
 {
+    std::array<const Shader*, 5> shaders;
+    unsigned int shaderCount = 0;
+
     assert(vertexShader.IsType(Shader::VertexShader));
-    AttachShader(vertexShader);
+    shaders[shaderCount++] = &vertexShader;
 
     assert(fragmentShader.IsType(Shader::FragmentShader));
-    AttachShader(fragmentShader);
+    shaders[shaderCount++] = &fragmentShader;
 
     if (tesselationControlShader)
     {
         assert(tesselationEvaluationShader);
         assert(tesselationControlShader->IsType(Shader::TesselationControlShader));
-        AttachShader(*tesselationControlShader);
+        shaders[shaderCount++] = tesselationControlShader;
     }
 
     if (tesselationEvaluationShader)
     {
         assert(tesselationEvaluationShader->IsType(Shader::TesselationEvaluationShader));
-        AttachShader(*tesselationEvaluationShader);
+        shaders[shaderCount++] = tesselationEvaluationShader;
     }
 
     if (geometryShader)
     {
         assert(geometryShader->IsType(Shader::GeometryShader));
-        AttachShader(*geometryShader);
+        shaders[shaderCount++] = geometryShader;
     }
 
-    return Link();
+    return Link(std::span(shaders.data(), shaderCount));
 }
 
 // Attach a shader to be linked
@@ -88,7 +108,8 @@ void ShaderProgram::AttachShader(const Shader& shader)
     assert(IsValid());
     assert(!IsLinked());
     assert(shader.IsValid());
-    assert(shader.IsCompiled());
+    // In a batch, the shader is still compiling. Its status is checked when the batch finishes
+    assert(ShaderBuildBatch::GetCurrent() || shader.IsCompiled());
     glAttachShader(GetHandle(), shader.GetHandle());
 }
 
@@ -97,9 +118,64 @@ bool ShaderProgram::Link()
 {
     assert(IsValid());
     glLinkProgram(GetHandle());
+    ResetUniforms();
     return IsLinked();
 }
 
+// Load the program from the ShaderProgramCache, or compile, attach and link the shaders
+bool ShaderProgram::Link(std::span<const Shader* const> shaders)
+{
+    ShaderProgramCache* cache = ShaderProgramCache::GetInstancePointer();
+    if (cache && !cache->IsEnabled())
+    {
+        cache = nullptr;
+    }
+
+    std::uint64_t key = 0;
+    if (cache)
+    {
+        key = cache->GetKey(shaders);
+        if (cache->LoadProgram(*this, key))
+        {
+            return true;
+        }
+
+        // Without the hint, some drivers don't keep the binary of the program
+        glProgramParameteri(GetHandle(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    // In a batch, the shaders are compiled and linked without waiting, and the batch stores the program in the cache
+    if (ShaderBuildBatch* batch = ShaderBuildBatch::GetCurrent())
+    {
+        for (const Shader* shader : shaders)
+        {
+            shader->SubmitDeferredCompile();
+            AttachShader(*shader);
+        }
+        glLinkProgram(GetHandle());
+        ResetUniforms();
+        batch->AddProgram(*this, key, cache != nullptr);
+        return true;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    // Shaders loaded with the cache enabled are compiled here, only when they are needed
+    for (const Shader* shader : shaders)
+    {
+        shader->CompileDeferred();
+        AttachShader(*shader);
+    }
+
+    bool linked = Link();
+    if (cache && linked)
+    {
+        float buildTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        cache->StoreProgram(*this, key, buildTime);
+    }
+    return linked;
+}
+
 // Check if shaders have been linked to create a valid program
 bool ShaderProgram::IsLinked() const
 {
@@ -110,6 +186,22 @@ bool ShaderProgram::IsLinked() const
     return success;
 }
 
+// Check if the driver finished linking, without waiting
+bool ShaderProgram::IsLinkComplete() const
+{
+    assert(IsValid());
+
+    DeviceGL* device = DeviceGL::GetInstancePointer();
+    if (!device || !device->IsParallelShaderCompileSupported())
+    {
+        return true;
+    }
+
+    GLint complete;
+    glGetProgramiv(GetHandle(), GL_COMPLETION_STATUS_KHR, &complete);
+    return complete;
+}
+
 // Get a string with linking error messages
 // The max length of the string returned is determined by the capacity of the span
 void ShaderProgram::GetLinkingErrors(std::span<char> errors) const
@@ -118,13 +210,42 @@ void ShaderProgram::GetLinkingErrors(std::span<char> errors) const
     glGetProgramInfoLog(GetHandle(), static_cast<GLsizei>(errors.size()), nullptr, errors.data());
 }
 
+// Get the linked program in the binary format of the driver. Returns false if the driver doesn't provide it
+bool ShaderProgram::GetBinary(GLenum& binaryFormat, std::vector<char>& binary) const
+{
+    assert(IsValid());
+    assert(IsLinked());
+
+    GLint binaryLength = 0;
+    glGetProgramiv(GetHandle(), GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+    if (binaryLength <= 0)
+    {
+        return false;
+    }
+
+    binary.resize(binaryLength);
+    GLsizei length = 0;
+    glGetProgramBinary(GetHandle(), binaryLength, &length, &binaryFormat, binary.data());
+    binary.resize(length);
+    return length > 0;
+}
+
+// Load a program binary from GetBinary(), instead of linking. Returns false if the driver rejects it
+bool ShaderProgram::LoadBinary(GLenum binaryFormat, std::span<const char> binary)
+{
+    assert(IsValid());
+    glProgramBinary(GetHandle(), binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+    ResetUniforms();
+    return IsLinked();
+}
+
 // Set the shader program as the active one to be used for rendering
 void ShaderProgram::Use() const
 {
     assert(IsValid());
     assert(IsLinked());
     Handle handle = GetHandle();
-    glUseProgram(handle);
+    DeviceGL::GetInstance().UseProgram(handle);
 #ifndef NDEBUG
     s_usedHandle = handle;
 #endif
@@ -138,12 +259,85 @@ ShaderProgram::Location ShaderProgram::GetAttributeLocation(const char* name) co
     return glGetAttribLocation(GetHandle(), name);
 }
 
-// Find a uniform location by name
-ShaderProgram::Location ShaderProgram::GetUniformLocation(const char* name) const
+// Find a uniform location by name, -1 if it is not active
+ShaderProgram::Location ShaderProgram::GetUniformLocation(UniformName name) const
+{
+    if (!m_uniformLocationsBuilt)
+    {
+        BuildUniformLocations();
+    }
+
+    const Location* location = m_uniformLocations.Find(name.GetHash());
+    return location ? *location : -1;
+}
+
+// Fill the table of uniform locations, with the names of all the active uniforms, and of each element of the arrays
+void ShaderProgram::BuildUniformLocations() const
 {
     assert(IsValid());
     assert(IsLinked());
-    return glGetUniformLocation(GetHandle(), name);
+
+    unsigned int uniformCount = GetUniformCount();
+    m_uniformLocations.Clear();
+    m_uniformLocations.Reserve(uniformCount);
+
+    for (unsigned int i = 0; i < uniformCount; ++i)
+    {
+        int size;
+        GLenum glType;
+        std::array<char, 256> uniformName;
+        GetUniformInfo(i, size, glType, uniformName);
+
+        // Uniforms inside uniform blocks have no location, searching them returns -1
+        Location location = glGetUniformLocation(GetHandle(), uniformName.data());
+        if (location < 0)
+        {
+            continue;
+        }
+
+        std::string_view name(uniformName.data());
+        m_uniformLocations.Insert(Hash::FNV1a(name), location);
+
+        // Arrays are reported as "name[0]". They can also be found as "name", and each element as "name[i]"
+        if (name.ends_with("[0]"))
+        {
+            std::string baseName(name.substr(0, name.size() - 3));
+            m_uniformLocations.Insert(Hash::FNV1a(baseName), location);
+            for (int element = 1; element < size; ++element)
+            {
+                std::string elementName = baseName + "[" + std::to_string(element) + "]";
+                m_uniformLocations.Insert(Hash::FNV1a(elementName), glGetUniformLocation(GetHandle(), elementName.c_str()));
+            }
+        }
+    }
+
+    m_uniformLocationsBuilt = true;
+}
+
+// Find a uniform block index by name
+GLuint ShaderProgram::GetUniformBlockIndex(const char* name) const
+{
+    assert(IsValid());
+    assert(IsLinked());
+    return glGetUniformBlockIndex(GetHandle(), name);
+}
+
+// Connect a uniform block to a uniform buffer binding point
+void ShaderProgram::SetUniformBlockBinding(GLuint blockIndex, GLuint binding) const
+{
+    assert(IsValid());
+    assert(blockIndex != GL_INVALID_INDEX);
+    glUniformBlockBinding(GetHandle(), blockIndex, binding);
+}
+
+// Size in bytes of the buffer range needed by a uniform block
+GLint ShaderProgram::GetUniformBlockDataSize(GLuint blockIndex) const
+{
+    assert(IsValid());
+    assert(blockIndex != GL_INVALID_INDEX);
+    GLint dataSize = 0;
+    glGetActiveUniformBlockiv(GetHandle(), blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize);
+    return dataSize;
 }
 
 // Get how many uniforms exist in this shader program
@@ -160,6 +354,16 @@ void ShaderProgram::GetUniformInfo(unsigned int index, int& size, GLenum& glType
     glGetActiveUniform(GetHandle(), index, uniformName.size(), nullptr, &size, &glType, uniformName.data());
 }
 
+// Get where a uniform is stored in its uniform block, in bytes
+void ShaderProgram::GetUniformBlockInfo(unsigned int index, GLint& blockIndex, GLint& offset, GLint& arrayStride, GLint& matrixStride) const
+{
+    GLuint uniformIndex = index;
+    glGetActiveUniformsiv(GetHandle(), 1, &uniformIndex, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+    glGetActiveUniformsiv(GetHandle(), 1, &uniformIndex, GL_UNIFORM_OFFSET, &offset);
+    glGetActiveUniformsiv(GetHandle(), 1, &uniformIndex, GL_UNIFORM_ARRAY_STRIDE, &arrayStride);
+    glGetActiveUniformsiv(GetHandle(), 1, &uniformIndex, GL_UNIFORM_MATRIX_STRIDE, &matrixStride);
+}
+
 // All the different combinations of Get/SetUniform
 template<>
 void ShaderProgram::GetUniform<GLint>(Location location, std::span<GLint> value) const
@@ -401,3 +605,39 @@ void ShaderProgram::SetTexture(Location location, GLint textureUnit, const Textu
     texture.Bind();
     SetUniform(location, textureUnit);
 }
+
+// Linking again can move the uniforms, and sets all their values to 0
+void ShaderProgram::ResetUniforms()
+{
+    m_uniformLocations.Clear();
+    m_uniformLocationsBuilt = false;
+    m_uniformRevisions.clear();
+    m_uniformsRevision = 0;
+}
+
+// Revision of the value of a uniform, 0 if unknown
+std::uint64_t ShaderProgram::GetUniformRevision(Location location) const
+{
+    return location >= 0 && location < static_cast<Location>(m_uniformRevisions.size()) ? m_uniformRevisions[location] : 0;
+}
+
+void ShaderProgram::SetUniformRevision(Location location, std::uint64_t revision) const
+{
+    assert(location >= 0);
+    if (location >= static_cast<Location>(m_uniformRevisions.size()))
+    {
+        m_uniformRevisions.resize(location + 1, 0);
+    }
+    m_uniformRevisions[location] = revision;
+}
+
+// The values at these locations were set directly, their revisions are not known
+void ShaderProgram::ForgetUniformRevisions(Location location, GLsizei count) const
+{
+    m_uniformsRevision = 0;
+    if (location >= 0)
+    {
+        Location end = std::min(location + count, static_cast<Location>(m_uniformRevisions.size()));
+        std::fill(m_uniformRevisions.begin() + std::min(location, end), m_uniformRevisions.begin() + end, 0);
+    }
+}
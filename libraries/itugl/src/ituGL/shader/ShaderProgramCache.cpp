@@ -0,0 +1,119 @@
+#include <ituGL/shader/ShaderProgramCache.h>
+
+#include <ituGL/shader/Shader.h>
+#include <ituGL/shader/ShaderProgram.h>
+#include <ituGL/core/Hash.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#include <cassert>
+
+ShaderProgramCache* ShaderProgramCache::m_instance = nullptr;
+
+ShaderProgramCache::ShaderProgramCache(const std::filesystem::path& directory)
+    : m_directory(directory), m_enabled(false), m_driverHash(Hash::c_seed), m_stats{}
+{
+    assert(!m_instance);
+    m_instance = this;
+}
+
+ShaderProgramCache::~ShaderProgramCache()
+{
+    m_instance = nullptr;
+}
+
+void ShaderProgramCache::Initialize()
+{
+    // Drivers can support program binaries without any binary format, in that case they can't be stored
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+
+    m_enabled = formatCount > 0 && !error;
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    // The binaries are only valid for the same driver
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+    {
+        const GLubyte* value = glGetString(name);
+        m_driverHash = Hash::FNV1a(value ? reinterpret_cast<const char*>(value) : "", m_driverHash);
+    }
+}
+
+std::uint64_t ShaderProgramCache::GetKey(std::span<const Shader* const> shaders) const
+{
+    std::uint64_t key = m_driverHash;
+    for (const Shader* shader : shaders)
+    {
+        key = Hash::Combine(key, shader->GetType());
+        key = Hash::Combine(key, shader->GetSourceHash());
+    }
+    return key;
+}
+
+bool ShaderProgramCache::LoadProgram(ShaderProgram& shaderProgram, std::uint64_t key)
+{
+    assert(m_enabled);
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::ifstream file(GetFilePath(key), std::ios::binary);
+    FileHeader header;
+    if (!file.is_open() || !file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || header.magic != c_fileMagic || header.key != key)
+    {
+        ++m_stats.missCount;
+        return false;
+    }
+
+    std::vector<char> binary(header.binarySize);
+    bool loaded = file.read(binary.data(), binary.size()) && shaderProgram.LoadBinary(header.binaryFormat, binary);
+    if (!loaded)
+    {
+        // The driver can reject binaries after an update that keeps the same version string
+        ++m_stats.rejectedCount;
+        ++m_stats.missCount;
+        return false;
+    }
+
+    float loadTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    ++m_stats.hitCount;
+    m_stats.savedTime += header.buildTime - loadTime;
+    return true;
+}
+
+void ShaderProgramCache::StoreProgram(const ShaderProgram& shaderProgram, std::uint64_t key, float buildTime)
+{
+    assert(m_enabled);
+
+    GLenum binaryFormat;
+    std::vector<char> binary;
+    if (!shaderProgram.GetBinary(binaryFormat, binary))
+    {
+        return;
+    }
+
+    FileHeader header;
+    header.magic = c_fileMagic;
+    header.binaryFormat = binaryFormat;
+    header.binarySize = static_cast<std::uint32_t>(binary.size());
+    header.buildTime = buildTime;
+    header.key = key;
+
+    std::ofstream file(GetFilePath(key), std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), binary.size());
+}
+
+std::filesystem::path ShaderProgramCache::GetFilePath(std::uint64_t key) const
+{
+    char fileName[32];
+    std::snprintf(fileName, sizeof(fileName), "%016llx.bin", static_cast<unsigned long long>(key));
+    return m_directory / fileName;
+}
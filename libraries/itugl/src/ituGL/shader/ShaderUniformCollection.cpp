@@ -1,12 +1,20 @@
 #include <ituGL/shader/ShaderUniformCollection.h>
 #include <cassert>
+#include <algorithm>
 #include <array>
+#include <string_view>
 
-ShaderUniformCollection::ShaderUniformCollection() : m_shaderProgram(nullptr)
+std::uint64_t ShaderUniformCollection::s_nextRevision = 1;
+unsigned int ShaderUniformCollection::s_issuedUploads = 0;
+unsigned int ShaderUniformCollection::s_skippedUploads = 0;
+
+ShaderUniformCollection::ShaderUniformCollection()
+    : m_shaderProgram(nullptr), m_storage(std::make_shared<Storage>()), m_revision(s_nextRevision++)
 {
 }
 
-ShaderUniformCollection::ShaderUniformCollection(std::shared_ptr<ShaderProgram> shaderProgram, const NameSet& filteredUniforms) : m_shaderProgram(shaderProgram)
+ShaderUniformCollection::ShaderUniformCollection(std::shared_ptr<ShaderProgram> shaderProgram, const NameSet& filteredUniforms)
+    : m_shaderProgram(shaderProgram), m_storage(std::make_shared<Storage>()), m_revision(s_nextRevision++)
 {
     ExtractUniforms(filteredUniforms);
 }
@@ -33,9 +41,26 @@ ShaderProgram::Location ShaderUniformCollection::GetAttributeLocation(const char
     return m_shaderProgram->GetAttributeLocation(name);
 }
 
-ShaderProgram::Location ShaderUniformCollection::GetUniformLocation(const char* name) const
+ShaderProgram::Location ShaderUniformCollection::GetUniformLocation(UniformName name) const
 {
-    return m_shaderProgram->GetUniformLocation(name);
+    ShaderProgram::Location location = m_shaderProgram->GetUniformLocation(name);
+    if (location < 0)
+    {
+        if (const ShaderProgram::Location* blockLocation = m_storage->blockUniformLocations.Find(name.GetHash()))
+        {
+            location = *blockLocation;
+        }
+    }
+    return location;
+}
+
+void ShaderUniformCollection::MakeStorageUnique()
+{
+    if (m_storage.use_count() > 1)
+    {
+        // The copy of the range reserves its own space in the arena
+        m_storage = std::make_shared<Storage>(*m_storage);
+    }
 }
 
 ShaderUniformCollection::DataUniform& ShaderUniformCollection::GetDataUniform(ShaderProgram::Location location)
@@ -45,8 +70,10 @@ ShaderUniformCollection::DataUniform& ShaderUniformCollection::GetDataUniform(Sh
 
 const ShaderUniformCollection::DataUniform& ShaderUniformCollection::GetDataUniform(ShaderProgram::Location location) const
 {
-    int uniformIndex = m_locationDataIndex.at(location);
-    const DataUniform& uniform = m_dataUniforms[uniformIndex];
+    assert(location >= 0 && static_cast<std::size_t>(location) < m_storage->locationDataOffsets.size());
+    int offset = m_storage->locationDataOffsets[location];
+    assert(offset != c_absentIndex);
+    const DataUniform& uniform = GetDataRecord(offset);
     assert(uniform.location == location);
     return uniform;
 }
@@ -58,8 +85,10 @@ ShaderUniformCollection::TextureUniform& ShaderUniformCollection::GetTextureUnif
 
 const ShaderUniformCollection::TextureUniform& ShaderUniformCollection::GetTextureUniform(ShaderProgram::Location location) const
 {
-    int uniformIndex = m_locationTextureIndex.at(location);
-    const TextureUniform& uniform = m_textureUniforms[uniformIndex];
+    assert(location >= 0 && static_cast<std::size_t>(location) < m_storage->locationTextureIndices.size());
+    int uniformIndex = m_storage->locationTextureIndices[location];
+    assert(uniformIndex != c_absentIndex);
+    const TextureUniform& uniform = m_storage->textureUniforms[uniformIndex];
     assert(uniform.location == location);
     return uniform;
 }
@@ -72,6 +101,25 @@ void ShaderUniformCollection::ExtractUniforms(const NameSet& filteredUniforms)
 
     unsigned int uniformCount = shaderProgram.GetUniformCount();
 
+    // The "MaterialParams" block gets its own range of the shared buffer, with the size of its std140 layout
+    GLuint materialParamsIndex = shaderProgram.GetUniformBlockIndex(c_materialParamsBlockName);
+    if (materialParamsIndex != GL_INVALID_INDEX)
+    {
+        shaderProgram.SetUniformBlockBinding(materialParamsIndex, c_materialParamsBinding);
+        m_storage->materialParamsData.resize(shaderProgram.GetUniformBlockDataSize(materialParamsIndex));
+
+        UniformBufferArena* arena = UniformBufferArena::GetInstancePointer();
+        assert(arena);
+        if (arena)
+        {
+            m_storage->materialParamsRange = arena->Allocate(static_cast<unsigned int>(m_storage->materialParamsData.size()));
+        }
+    }
+
+    // Uniforms of the block get their locations at the end, after all the locations of the program, so they stay dense
+    std::vector<std::pair<DataUniform, std::string>> blockUniforms;
+    ShaderProgram::Location nextBlockLocation = 0;
+
     // Loop over all the uniforms
     for (unsigned int i = 0; i < uniformCount; ++i)
     {
@@ -81,13 +129,26 @@ void ShaderUniformCollection::ExtractUniforms(const NameSet& filteredUniforms)
         char uniformName[256];
         shaderProgram.GetUniformInfo(i, size, glType, std::span(uniformName, sizeof(uniformName)));
 
+        // Get the uniform location. Arrays take one location per element
+        ShaderProgram::Location location = shaderProgram.GetUniformLocation(uniformName);
+        if (location >= 0)
+        {
+            nextBlockLocation = std::max(nextBlockLocation, location + size);
+        }
+
         // If the named is in the filtered list, skip
         if (filteredUniforms.contains(uniformName))
             continue;
 
-        // Get the uniform location
-        ShaderProgram::Location location = GetUniformLocation(uniformName);
-        assert(location >= 0);
+        // Uniforms inside uniform blocks have no location, their values come from a buffer
+        // Only the ones in the "MaterialParams" block are stored, with a location of the collection
+        GLint blockIndex = -1, blockOffset = -1, arrayStride = 0, matrixStride = 0;
+        if (location < 0)
+        {
+            shaderProgram.GetUniformBlockInfo(i, blockIndex, blockOffset, arrayStride, matrixStride);
+            if (materialParamsIndex == GL_INVALID_INDEX || blockIndex != static_cast<GLint>(materialParamsIndex))
+                continue;
+        }
 
         Data::Type type;
         UniformDimension dimension;
@@ -100,10 +161,21 @@ void ShaderUniformCollection::ExtractUniforms(const NameSet& filteredUniforms)
             uniform.type = type;
             uniform.dimension = dimension;
             uniform.count = size;
-            AddUniform(uniform);
+            uniform.blockOffset = blockOffset;
+            uniform.arrayStride = arrayStride;
+            uniform.matrixStride = matrixStride;
+            if (blockIndex < 0)
+            {
+                AddUniform(uniform);
+            }
+            else
+            {
+                blockUniforms.emplace_back(uniform, uniformName);
+            }
         }
         else if (IsTextureUniform(glType, target))
         {
+            assert(blockIndex < 0);
             // If it is a texture property, store as property
             TextureUniform uniform;
             uniform.location = location;
@@ -116,6 +188,19 @@ void ShaderUniformCollection::ExtractUniforms(const NameSet& filteredUniforms)
             assert(false);
         }
     }
+
+    for (auto& [uniform, name] : blockUniforms)
+    {
+        uniform.location = nextBlockLocation++;
+        AddUniform(uniform);
+        m_storage->blockUniformLocations.Insert(Hash::FNV1a(name), uniform.location);
+
+        // Arrays are reported as "name[0]", they can also be found as "name"
+        if (uniform.count > 1 && name.ends_with("[0]"))
+        {
+            m_storage->blockUniformLocations.Insert(Hash::FNV1a(name.substr(0, name.size() - 3)), uniform.location);
+        }
+    }
 }
 
 bool ShaderUniformCollection::IsDataUniform(GLenum glType, Data::Type& type, UniformDimension& dimension)
@@ -282,19 +367,128 @@ void ShaderUniformCollection::AddUniform(const DataUniform& uniform)
 
 void ShaderUniformCollection::AddUniform(const TextureUniform& uniform)
 {
-    m_locationTextureIndex.insert(std::make_pair(uniform.location, static_cast<int>(m_textureUniforms.size())));
-    m_textureUniforms.push_back(uniform);
+    if (m_storage->locationTextureIndices.size() <= static_cast<std::size_t>(uniform.location))
+    {
+        m_storage->locationTextureIndices.resize(uniform.location + 1, c_absentIndex);
+    }
+    m_storage->locationTextureIndices[uniform.location] = static_cast<int>(m_storage->textureUniforms.size());
+    m_storage->textureUniforms.push_back(uniform);
+    UpdateRevision(m_storage->textureUniforms.back().revision);
 }
 
 void ShaderUniformCollection::SetUniforms() const
 {
-    for (const DataUniform& uniform : m_dataUniforms)
+    const ShaderProgram& shaderProgram = *m_shaderProgram;
+
+    // If the program still has the values of this collection, or of a copy with the same values, nothing needs to be uploaded
+    bool upToDate = shaderProgram.GetUniformsRevision() == m_revision;
+
+    // Records are walked in order through the storage, each one followed by its values
+    for (std::size_t offset = 0; offset < m_storage->data.size(); )
     {
+        const DataUniform& uniform = GetDataRecord(offset);
+        offset = uniform.index + uniform.valuesSize;
+        // Uniforms in the "MaterialParams" block are uploaded all together, below
+        if (uniform.blockOffset >= 0)
+        {
+            continue;
+        }
+        if (upToDate || shaderProgram.GetUniformRevision(uniform.location) == uniform.revision)
+        {
+            ++s_skippedUploads;
+            continue;
+        }
         UseUniform(uniform);
+        shaderProgram.SetUniformRevision(uniform.location, uniform.revision);
+        ++s_issuedUploads;
     }
-    for (const TextureUniform& uniform : m_textureUniforms)
+    for (const TextureUniform& uniform : m_storage->textureUniforms)
     {
-        UseUniform(uniform);
+        bool setUniform = uniform.texture && !upToDate && shaderProgram.GetUniformRevision(uniform.location) != uniform.revision;
+        UseUniform(uniform, setUniform);
+        if (setUniform)
+        {
+            shaderProgram.SetUniformRevision(uniform.location, uniform.revision);
+            ++s_issuedUploads;
+        }
+        else if (uniform.texture)
+        {
+            ++s_skippedUploads;
+        }
+    }
+
+    // Set after uploading, setting the values resets it
+    shaderProgram.SetUniformsRevision(m_revision);
+
+    // Other collections bind their own range to the same binding point, so it is bound every time
+    if (m_storage->materialParamsRange.IsValid())
+    {
+        if (m_storage->materialParamsRange.Update(m_storage->materialParamsData))
+        {
+            ++s_issuedUploads;
+        }
+        else
+        {
+            ++s_skippedUploads;
+        }
+        m_storage->materialParamsRange.Bind(c_materialParamsBinding);
+    }
+}
+
+void ShaderUniformCollection::ResetUploadStats()
+{
+    s_issuedUploads = 0;
+    s_skippedUploads = 0;
+}
+
+void ShaderUniformCollection::UpdateRevision(std::uint64_t& revision)
+{
+    revision = s_nextRevision++;
+    m_revision = s_nextRevision++;
+}
+
+void ShaderUniformCollection::PackBlockUniform(const DataUniform& uniform)
+{
+    assert(uniform.blockOffset >= 0);
+
+    int columns, rows;
+    GetDimensionSize(uniform.dimension, columns, rows);
+    std::size_t columnSize = rows * Data::GetTypeSize(uniform.type);
+
+    // Values are stored tightly packed. In std140, array elements and matrix columns are placed with their strides
+    const std::byte* source = GetDataUniformBytes(uniform);
+    for (unsigned int element = 0; element < uniform.count; ++element)
+    {
+        for (int column = 0; column < columns; ++column)
+        {
+            std::size_t offset = uniform.blockOffset + element * uniform.arrayStride + column * uniform.matrixStride;
+            assert(offset + columnSize <= m_storage->materialParamsData.size());
+            std::memcpy(&m_storage->materialParamsData[offset], source, columnSize);
+            source += columnSize;
+        }
+    }
+
+    m_storage->materialParamsRange.SetDirty();
+}
+
+const std::byte* ShaderUniformCollection::GetDataUniformBytes(const DataUniform& uniform) const
+{
+    return &m_storage->data[uniform.index];
+}
+
+void ShaderUniformCollection::GetDimensionSize(UniformDimension dimension, int& columns, int& rows)
+{
+    if (dimension >= UniformDimension::MatrixFirst)
+    {
+        // Matrices are ordered by columns, then by rows, from 2 to 4
+        int offset = static_cast<int>(dimension) - static_cast<int>(UniformDimension::MatrixFirst);
+        columns = offset / 3 + 2;
+        rows = offset % 3 + 2;
+    }
+    else
+    {
+        columns = 1;
+        rows = static_cast<int>(dimension) - static_cast<int>(UniformDimension::Scalar) + 1;
     }
 }
 
@@ -319,13 +513,22 @@ void ShaderUniformCollection::UseUniform(const DataUniform& uniform) const
     }
 }
 
-void ShaderUniformCollection::UseUniform(const TextureUniform& uniform) const
+void ShaderUniformCollection::UseUniform(const TextureUniform& uniform, bool setUniform) const
 {
     //TODO: default texture
     if (uniform.texture)
     {
-        size_t textureIndex = &uniform - m_textureUniforms.data();
-        m_shaderProgram->SetTexture(uniform.location, static_cast<int>(textureIndex), *uniform.texture);
+        GLint textureUnit = static_cast<GLint>(&uniform - m_storage->textureUniforms.data());
+        if (setUniform)
+        {
+            m_shaderProgram->SetTexture(uniform.location, textureUnit, *uniform.texture);
+        }
+        else
+        {
+            // The program already has the texture unit, only the texture needs to be bound
+            TextureObject::SetActiveTexture(textureUnit);
+            uniform.texture->Bind();
+        }
     }
 }
 
@@ -389,9 +592,15 @@ void ShaderUniformCollection::GetUniformValue(ShaderProgram::Location location,
 template<>
 void ShaderUniformCollection::SetUniformValue(ShaderProgram::Location location, const std::shared_ptr<const TextureObject>& value)
 {
-    TextureUniform& uniform = GetTextureUniform(location);
-    assert(!value || uniform.target == value->GetTarget());
-    uniform.texture = value;
+    const TextureUniform& currentUniform = const_cast<const ShaderUniformCollection*>(this)->GetTextureUniform(location);
+    assert(!value || currentUniform.target == value->GetTarget());
+    if (currentUniform.texture != value)
+    {
+        MakeStorageUnique();
+        TextureUniform& uniform = GetTextureUniform(location);
+        uniform.texture = value;
+        UpdateRevision(uniform.revision);
+    }
 }
 
 int ShaderUniformCollection::GetDataUniformSize(const DataUniform& uniform) const
@@ -439,14 +648,9 @@ int ShaderUniformCollection::GetDataUniformSize(const DataUniform& uniform) cons
 void ShaderUniformCollection::Reset()
 {
     m_shaderProgram = nullptr;
-    m_dataUniforms.clear();
-    m_textureUniforms.clear();
-    m_locationDataIndex.clear();
-    m_locationTextureIndex.clear();
-    m_intDataValues.clear();
-    m_uintDataValues.clear();
-    m_floatDataValues.clear();
-    m_doubleDataValues.clear();
+    m_revision = s_nextRevision++;
+    // Copies may still be using the old storage
+    m_storage = std::make_shared<Storage>();
 }
 
 #ifndef NDEBUG
@@ -0,0 +1,160 @@
+#include <ituGL/shader/UniformBufferArena.h>
+
+#include <algorithm>
+#include <cassert>
+
+UniformBufferArena* UniformBufferArena::m_instance = nullptr;
+
+UniformBufferArena::UniformBufferArena(unsigned int capacity)
+    : m_alignment(static_cast<unsigned int>(std::max(UniformBufferObject::GetOffsetAlignment(), 1)))
+    , m_blockCapacity(capacity - capacity % m_alignment) // Rounded down, so every range fits whole in the buffer
+    , m_uploadCount(0)
+{
+    assert(!m_instance);
+    m_instance = this;
+
+    m_blocks.push_back(std::make_unique<Block>(m_blockCapacity));
+}
+
+UniformBufferArena::~UniformBufferArena()
+{
+    assert(m_instance == this);
+    m_instance = nullptr;
+}
+
+UniformBufferArena::Block::Block(unsigned int capacity) : allocator(capacity)
+{
+    buffer.Bind();
+    buffer.AllocateData(capacity, BufferObject::DynamicDraw);
+    UniformBufferObject::Unbind();
+}
+
+unsigned int UniformBufferArena::GetCapacity() const
+{
+    unsigned int capacity = 0;
+    for (const auto& block : m_blocks)
+    {
+        capacity += block->allocator.GetCapacity();
+    }
+    return capacity;
+}
+
+unsigned int UniformBufferArena::GetUsedSize() const
+{
+    unsigned int usedSize = 0;
+    for (const auto& block : m_blocks)
+    {
+        usedSize += block->allocator.GetUsedSize();
+    }
+    return usedSize;
+}
+
+unsigned int UniformBufferArena::GetAlignedSize(unsigned int size) const
+{
+    return (size + m_alignment - 1) / m_alignment * m_alignment;
+}
+
+unsigned int UniformBufferArena::Reserve(unsigned int alignedSize, Block*& block)
+{
+    for (const auto& existingBlock : m_blocks)
+    {
+        unsigned int offset = existingBlock->allocator.Allocate(alignedSize);
+        if (offset != RangeAllocator::InvalidOffset)
+        {
+            block = existingBlock.get();
+            return offset;
+        }
+    }
+
+    // All the buffers are full, add one. Big enough for the range if it is larger than the usual capacity
+    block = m_blocks.emplace_back(std::make_unique<Block>(std::max(m_blockCapacity, alignedSize))).get();
+    unsigned int offset = block->allocator.Allocate(alignedSize);
+    assert(offset != RangeAllocator::InvalidOffset);
+    return offset;
+}
+
+UniformBufferArena::Range::Range()
+    : m_arena(nullptr), m_block(nullptr), m_offset(RangeAllocator::InvalidOffset), m_size(0), m_dirty(false)
+{
+}
+
+UniformBufferArena::Range::Range(UniformBufferArena& arena, unsigned int size)
+    : m_arena(&arena), m_block(nullptr), m_offset(RangeAllocator::InvalidOffset), m_size(size), m_dirty(true)
+{
+    if (size > 0)
+    {
+        m_offset = arena.Reserve(arena.GetAlignedSize(size), m_block);
+    }
+}
+
+UniformBufferArena::Range::~Range()
+{
+    Free();
+}
+
+UniformBufferArena::Range::Range(const Range& range) : Range()
+{
+    *this = range;
+}
+
+UniformBufferArena::Range::Range(Range&& range) noexcept
+    : m_arena(range.m_arena), m_block(range.m_block), m_offset(range.m_offset), m_size(range.m_size), m_dirty(range.m_dirty)
+{
+    range.m_offset = RangeAllocator::InvalidOffset;
+}
+
+UniformBufferArena::Range& UniformBufferArena::Range::operator = (const Range& range)
+{
+    if (this != &range)
+    {
+        // The copy has its own space, with nothing uploaded yet
+        *this = range.m_arena ? Range(*range.m_arena, range.m_size) : Range();
+    }
+    return *this;
+}
+
+UniformBufferArena::Range& UniformBufferArena::Range::operator = (Range&& range) noexcept
+{
+    if (this != &range)
+    {
+        Free();
+        m_arena = range.m_arena;
+        m_block = range.m_block;
+        m_offset = range.m_offset;
+        m_size = range.m_size;
+        m_dirty = range.m_dirty;
+        range.m_offset = RangeAllocator::InvalidOffset;
+    }
+    return *this;
+}
+
+void UniformBufferArena::Range::Free()
+{
+    if (IsValid())
+    {
+        m_block->allocator.Free(m_offset, m_arena->GetAlignedSize(m_size));
+        m_offset = RangeAllocator::InvalidOffset;
+    }
+}
+
+bool UniformBufferArena::Range::Update(std::span<const std::byte> data) const
+{
+    assert(IsValid());
+    assert(data.size() == m_size);
+    if (!m_dirty)
+    {
+        return false;
+    }
+
+    m_block->buffer.Bind();
+    m_block->buffer.UpdateData(data, m_offset);
+    ++m_arena->m_uploadCount;
+    m_dirty = false;
+    return true;
+}
+
+void UniformBufferArena::Range::Bind(GLuint binding) const
+{
+    assert(IsValid());
+    m_block->buffer.BindRange(binding, m_offset, m_size);
+}
@@ -0,0 +1,32 @@
+#include <ituGL/shader/UniformBufferObject.h>
+
+#include <cassert>
+
+UniformBufferObject::UniformBufferObject()
+{
+    // Nothing to do here, it is done by the base class
+}
+
+void UniformBufferObject::BindBase(GLuint binding) const
+{
+    glBindBufferBase(GetTarget(), binding, GetHandle());
+#ifndef NDEBUG
+    s_boundHandle = GetHandle();
+#endif
+}
+
+void UniformBufferObject::BindRange(GLuint binding, size_t offset, size_t size) const
+{
+    assert(offset % GetOffsetAlignment() == 0);
+    glBindBufferRange(GetTarget(), binding, GetHandle(), offset, size);
+#ifndef NDEBUG
+    s_boundHandle = GetHandle();
+#endif
+}
+
+GLint UniformBufferObject::GetOffsetAlignment()
+{
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    return alignment;
+}
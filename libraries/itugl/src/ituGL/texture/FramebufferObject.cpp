@@ -1,6 +1,7 @@
 #include <ituGL/texture/FramebufferObject.h>
 
 #include <ituGL/texture/Texture2DObject.h>
+#include <ituGL/core/DeviceGL.h>
 #include <cassert>
 
 std::shared_ptr<const FramebufferObject> FramebufferObject::s_defaultFramebuffer(std::make_shared<FramebufferObject>(FramebufferObject(Object::NullHandle)));
@@ -23,6 +24,10 @@ FramebufferObject::~FramebufferObject()
     if (handle != NullHandle)
     {
         glDeleteFramebuffers(1, &handle);
+        if (DeviceGL* device = DeviceGL::GetInstancePointer())
+        {
+            device->OnFramebufferDeleted(handle);
+        }
     }
 }
 
@@ -34,7 +39,7 @@ void FramebufferObject::Bind() const
 void FramebufferObject::Bind(Target target) const
 {
     Handle handle = GetHandle();
-    glBindFramebuffer(static_cast<GLenum>(target), handle);
+    DeviceGL::GetInstance().BindFramebuffer(static_cast<GLenum>(target), handle);
 }
 
 void FramebufferObject::Unbind()
@@ -45,7 +50,7 @@ void FramebufferObject::Unbind()
 void FramebufferObject::Unbind(Target target)
 {
     Handle handle = NullHandle;
-    glBindFramebuffer(static_cast<GLenum>(target), handle);
+    DeviceGL::GetInstance().BindFramebuffer(static_cast<GLenum>(target), handle);
 }
 
 std::shared_ptr<const FramebufferObject> FramebufferObject::GetDefault()
@@ -20,3 +20,13 @@ void Texture2DObject::SetImage(GLint level, GLsizei width, GLsizei height, Forma
 {
     SetImage<float>(level, width, height, format, internalFormat, std::span<float>());
 }
+
+void Texture2DObject::SetImageFromBuffer(GLint level, GLsizei width, GLsizei height, Format format, InternalFormat internalFormat, size_t bufferOffset, Data::Type type)
+{
+    assert(IsBound());
+    assert(type != Data::Type::None);
+    assert(IsValidFormat(format, internalFormat));
+    // With a pixel unpack buffer bound, the data pointer is an offset in the buffer
+    const void* offset = reinterpret_cast<const void*>(bufferOffset);
+    glTexImage2D(GetTarget(), level, internalFormat, width, height, 0, format, static_cast<GLenum>(type), offset);
+}
@@ -0,0 +1,19 @@
+#include <ituGL/texture/TextureBufferObject.h>
+
+#include <cassert>
+
+TextureBufferObject::TextureBufferObject()
+{
+}
+
+void TextureBufferObject::SetData(std::span<const std::byte> data, InternalFormat internalFormat, BufferObject::Usage usage)
+{
+    assert(IsBound());
+
+    m_buffer.Bind();
+    m_buffer.AllocateData(data, usage);
+    m_buffer.Unbind();
+
+    // Attach the buffer again, the storage may have been reallocated
+    glTexBuffer(GetTarget(), internalFormat, GetBuffer().GetHandle());
+}
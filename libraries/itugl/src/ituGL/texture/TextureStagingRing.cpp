@@ -0,0 +1,127 @@
+#include <ituGL/texture/TextureStagingRing.h>
+
+#include <cassert>
+
+TextureStagingRing* TextureStagingRing::m_instance = nullptr;
+
+TextureStagingRing::TextureStagingRing(unsigned int slotCount, size_t slotSize)
+    : m_slots(slotCount), m_slotSize(slotSize), m_nextSlot(0), m_uploadCount(0), m_busyCount(0)
+{
+    assert(!m_instance);
+    m_instance = this;
+
+    // Storage is allocated once, slots are invalidated when they are mapped again
+    for (Slot& slot : m_slots)
+    {
+        slot.buffer.Bind();
+        slot.buffer.AllocateData(slotSize, BufferObject::StreamDraw);
+    }
+    BufferObjectBase<BufferObject::PixelUnpackBuffer>::Unbind();
+}
+
+TextureStagingRing::~TextureStagingRing()
+{
+    for (Slot& slot : m_slots)
+    {
+        if (slot.fence)
+        {
+            glDeleteSync(slot.fence);
+        }
+    }
+
+    assert(m_instance == this);
+    m_instance = nullptr;
+}
+
+unsigned int TextureStagingRing::GetFreeSlotCount() const
+{
+    unsigned int freeCount = 0;
+    for (const Slot& slot : m_slots)
+    {
+        // Fences are only checked when acquiring, this counts the slots that could be used for sure
+        if (!slot.mapped && !slot.fence)
+        {
+            ++freeCount;
+        }
+    }
+    return freeCount;
+}
+
+int TextureStagingRing::Acquire(size_t size, std::span<std::byte>& memory)
+{
+    if (size > m_slotSize || m_slots.empty())
+    {
+        return NoSlot;
+    }
+
+    // Start after the last acquired slot, that is usually the one that was used the longest time ago
+    int slotIndex = -1;
+    for (unsigned int i = 0; i < m_slots.size() && slotIndex < 0; ++i)
+    {
+        unsigned int index = (m_nextSlot + i) % m_slots.size();
+        if (!m_slots[index].mapped && IsFenceSignaled(m_slots[index]))
+        {
+            slotIndex = static_cast<int>(index);
+        }
+    }
+    if (slotIndex < 0)
+    {
+        ++m_busyCount;
+        return BusySlot;
+    }
+    Slot& slot = m_slots[slotIndex];
+
+    // The fence guarantees the GPU is done with the previous contents, no need for OpenGL to synchronize
+    slot.buffer.Bind();
+    memory = slot.buffer.MapRange(0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    BufferObjectBase<BufferObject::PixelUnpackBuffer>::Unbind();
+    if (memory.empty())
+    {
+        // Mapping again would likely fail too, the caller uploads without staging
+        return NoSlot;
+    }
+
+    slot.mapped = true;
+    ++m_uploadCount;
+
+    m_nextSlot = (slotIndex + 1) % m_slots.size();
+    return slotIndex;
+}
+
+bool TextureStagingRing::BeginUpload(unsigned int slot)
+{
+    assert(slot < m_slots.size() && m_slots[slot].mapped);
+    Slot& stagingSlot = m_slots[slot];
+
+    stagingSlot.buffer.Bind();
+    bool valid = stagingSlot.buffer.Unmap();
+    stagingSlot.mapped = false;
+    if (!valid)
+    {
+        BufferObjectBase<BufferObject::PixelUnpackBuffer>::Unbind();
+    }
+    return valid;
+}
+
+void TextureStagingRing::EndUpload(unsigned int slot)
+{
+    assert(slot < m_slots.size() && !m_slots[slot].mapped && !m_slots[slot].fence);
+    BufferObjectBase<BufferObject::PixelUnpackBuffer>::Unbind();
+    m_slots[slot].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool TextureStagingRing::IsFenceSignaled(Slot& slot)
+{
+    if (slot.fence)
+    {
+        // Don't wait, but flush so the fence is eventually signaled even if nothing else is submitted
+        GLenum result = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+        {
+            return false;
+        }
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+    return true;
+}
@@ -0,0 +1,122 @@
+#include <ituGL/asset/AssetJobQueue.h>
+#include <ituGL/asset/TextureLoader.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Runs jobs through the AssetJobQueue, and decodes a small image with and without the vertical flip
+// It doesn't use OpenGL, it is built with the other stub programs so it runs on any machine
+
+static bool Check(bool condition, const char* description)
+{
+    std::cout << (condition ? "PASS " : "FAIL ") << description << std::endl;
+    return condition;
+}
+
+// Write a binary PPM image, that stb can decode, with a different value in every byte
+static std::filesystem::path WriteTestImage(int width, int height)
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "itugl_stub_flip_test.ppm";
+    std::ofstream file(path, std::ios::binary);
+    file << "P6\n" << width << " " << height << "\n255\n";
+    for (int i = 0; i < width * height * 3; ++i)
+    {
+        file.put(static_cast<char>(i));
+    }
+    return path;
+}
+
+static bool TestFlush(AssetJobQueue& jobQueue)
+{
+    // Each worker job continues on the main thread, as the loaders do
+    const unsigned int jobCount = 64;
+    std::atomic<unsigned int> workerCount = 0;
+    unsigned int mainThreadCount = 0;
+    std::thread::id mainThreadId = std::this_thread::get_id();
+    bool allOnMainThread = true;
+
+    for (unsigned int i = 0; i < jobCount; ++i)
+    {
+        jobQueue.EnqueueWorkerJob([&]()
+            {
+                ++workerCount;
+                AssetJobQueue::GetInstancePointer()->EnqueueMainThreadJob([&]()
+                    {
+                        allOnMainThread &= std::this_thread::get_id() == mainThreadId;
+                        ++mainThreadCount;
+                    });
+            });
+    }
+    jobQueue.Flush();
+
+    bool passed = true;
+    passed &= Check(workerCount == jobCount && mainThreadCount == jobCount, "Flush() runs the worker jobs and their continuations");
+    passed &= Check(allOnMainThread, "main thread jobs run on the thread that flushes");
+    passed &= Check(jobQueue.IsIdle(), "the queue is idle after Flush()");
+    return passed;
+}
+
+static bool TestBudget(AssetJobQueue& jobQueue)
+{
+    const unsigned int jobCount = 4;
+    for (unsigned int i = 0; i < jobCount; ++i)
+    {
+        jobQueue.EnqueueMainThreadJob([]() { std::this_thread::sleep_for(std::chrono::milliseconds(20)); });
+    }
+
+    bool passed = true;
+    passed &= Check(jobQueue.ProcessMainThreadJobs(1.0) == 1, "a job runs even if it takes longer than the budget");
+    passed &= Check(jobQueue.ProcessMainThreadJobs(30.0) == 2, "jobs stop once the budget is spent");
+    passed &= Check(jobQueue.ProcessMainThreadJobs(1000.0) == 1, "the rest run in the next call");
+    passed &= Check(jobQueue.ProcessMainThreadJobs(1000.0) == 0 && jobQueue.IsIdle(), "nothing runs when the queue is empty");
+    return passed;
+}
+
+static bool TestFlipVertical()
+{
+    const int width = 2;
+    const int height = 3;
+    const size_t rowSize = width * 3;
+    std::filesystem::path path = WriteTestImage(width, height);
+
+    int loadedWidth, loadedHeight;
+    Data::Type dataType;
+    std::span<const std::byte> data = TextureLoaderUtils::LoadTexture2DData(path.string().c_str(), loadedWidth, loadedHeight, dataType,
+        TextureObject::FormatRGB, TextureObject::InternalFormatRGB8, false);
+    std::span<const std::byte> flippedData = TextureLoaderUtils::LoadTexture2DData(path.string().c_str(), loadedWidth, loadedHeight, dataType,
+        TextureObject::FormatRGB, TextureObject::InternalFormatRGB8, true);
+
+    bool passed = Check(data.size() == rowSize * height && flippedData.size() == data.size(), "the image is decoded");
+    if (passed)
+    {
+        // Rows in reverse order, and the middle row stays in place
+        bool flipped = true;
+        for (int row = 0; row < height; ++row)
+        {
+            flipped &= std::memcmp(&flippedData[row * rowSize], &data[(height - 1 - row) * rowSize], rowSize) == 0;
+        }
+        passed &= Check(flipped, "FlipVertical reverses the rows");
+    }
+
+    TextureLoaderUtils::FreeTexture2DData(data);
+    TextureLoaderUtils::FreeTexture2DData(flippedData);
+    std::filesystem::remove(path);
+    return passed;
+}
+
+int main()
+{
+    bool passed = true;
+    {
+        AssetJobQueue jobQueue(2);
+        passed &= TestFlush(jobQueue);
+        passed &= TestBudget(jobQueue);
+    }
+    passed &= TestFlipVertical();
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+#include <ituGL/core/GLStub.h>
+#include <ituGL/core/DeviceGL.h>
+#include <ituGL/renderer/Renderer.h>
+#include <ituGL/renderer/RenderGraph.h>
+#include <ituGL/renderer/RenderPass.h>
+#include <ituGL/texture/Texture2DObject.h>
+#include <iostream>
+#include <memory>
+
+// Compiles render graphs of transient textures with the recording GL stub, and checks the culling,
+// the textures shared by resources that are not alive at the same time, and the render target memory
+
+// Pass that only counts when it is released. The graph releases the culled ones, and the renderer owns the others
+class TestRenderPass : public RenderPass
+{
+public:
+    TestRenderPass(unsigned int& releasedCount) : m_releasedCount(releasedCount) {}
+    ~TestRenderPass() { ++m_releasedCount; }
+
+    void Render() override {}
+
+private:
+    unsigned int& m_releasedCount;
+};
+
+static bool Check(bool condition, const char* description)
+{
+    std::cout << (condition ? "PASS " : "FAIL ") << description << std::endl;
+    return condition;
+}
+
+static bool TestAliasing(DeviceGL& device)
+{
+    // Declared before the renderer, that releases its passes when destroyed
+    unsigned int debugReleasedCount = 0;
+    unsigned int releasedCount = 0;
+    Renderer renderer(device);
+
+    std::unique_ptr<RenderGraph> renderGraphPtr = std::make_unique<RenderGraph>();
+    RenderGraph& renderGraph = *renderGraphPtr;
+    RenderGraph::TextureDesc fullDesc{ 64, 64, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA16F };
+    RenderGraph::TextureDesc halfDesc{ 32, 32, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA16F };
+
+    RenderGraph::ResourceId scene = renderGraph.CreateTexture("Scene", fullDesc);
+    RenderGraph::ResourceId debug = renderGraph.CreateTexture("Debug", fullDesc);
+    RenderGraph::ResourceId blurX = renderGraph.CreateTexture("BlurX", fullDesc);
+    RenderGraph::ResourceId half = renderGraph.CreateTexture("Half", halfDesc);
+    RenderGraph::ResourceId blurY = renderGraph.CreateTexture("BlurY", fullDesc);
+    RenderGraph::ResourceId output = renderGraph.CreateTexture("Final", fullDesc);
+    renderGraph.SetOutput(output);
+
+    // Lifetimes, by pass index: Scene 0-2, BlurX 2-4, Half 3-5, BlurY 4-5. Debug is never read
+    std::shared_ptr<Texture2DObject> boundTexture;
+    std::unique_ptr<TestRenderPass> finalPass = std::make_unique<TestRenderPass>(releasedCount);
+    TestRenderPass* finalPassPtr = finalPass.get();
+    renderGraph.AddPass("Scene", std::make_unique<TestRenderPass>(releasedCount), {}, { scene });
+    renderGraph.AddPass("Debug", std::make_unique<TestRenderPass>(debugReleasedCount), { scene }, { debug });
+    renderGraph.AddPass("BlurX", std::make_unique<TestRenderPass>(releasedCount), { scene }, { blurX });
+    renderGraph.AddPass("Downsample", std::make_unique<TestRenderPass>(releasedCount), { blurX }, { half });
+    renderGraph.AddPass("BlurY", std::make_unique<TestRenderPass>(releasedCount), { blurX }, { blurY },
+        [&](const RenderGraph& renderGraph) { boundTexture = renderGraph.GetTexture(blurX); });
+    renderGraph.AddPass("Final", std::move(finalPass), { blurY, half }, { output });
+
+    bool passed = Check(renderGraph.Compile(renderer), "the graph compiles");
+    if (!passed)
+    {
+        std::cout << renderGraph.GetErrorMessage() << std::endl;
+        return false;
+    }
+
+    passed &= Check(debugReleasedCount == 1 && !renderGraph.GetTexture(debug), "the pass whose result is never read is culled");
+
+    // Scene is not alive anymore when BlurY starts, Half has another size
+    std::shared_ptr<Texture2DObject> sceneTexture = renderGraph.GetTexture(scene);
+    passed &= Check(sceneTexture && sceneTexture == renderGraph.GetTexture(blurY), "textures not alive at the same time are shared");
+    passed &= Check(renderGraph.GetTexture(blurX) != sceneTexture && renderGraph.GetTexture(half) != sceneTexture
+        && renderGraph.GetTexture(half) != renderGraph.GetTexture(blurX), "live textures, or of another size, are not shared");
+    passed &= Check(boundTexture && boundTexture == renderGraph.GetTexture(blurX), "the bind function gets the assigned textures");
+
+    // The output has no texture, the last pass draws to the default framebuffer
+    passed &= Check(!renderGraph.GetTexture(output) && finalPassPtr->GetTargetFramebuffer() == renderer.GetDefaultFramebuffer(),
+        "the output is redirected to the default framebuffer");
+
+    // 64x64 and 32x32 at 8 bytes per pixel. At most 2 full and 1 half textures are alive, during BlurY
+    const std::size_t fullSize = 64 * 64 * 8;
+    const std::size_t halfSize = 32 * 32 * 8;
+    passed &= Check(renderGraph.GetPeakRenderTargetMemory() == 2 * fullSize + halfSize, "peak memory of the live textures");
+    passed &= Check(renderGraph.GetRenderTargetMemory() == 2 * fullSize + halfSize, "memory of the textures created");
+    passed &= Check(renderGraph.GetUnaliasedRenderTargetMemory() == 3 * fullSize + halfSize, "memory without sharing");
+
+    // The renderer keeps the passes that were not culled
+    renderGraphPtr.reset();
+    passed &= Check(releasedCount == 0, "the other passes are added to the renderer");
+    return passed;
+}
+
+static bool TestValidation(DeviceGL& device)
+{
+    unsigned int releasedCount = 0;
+    Renderer renderer(device);
+
+    std::unique_ptr<RenderGraph> renderGraphPtr = std::make_unique<RenderGraph>();
+    RenderGraph& renderGraph = *renderGraphPtr;
+    RenderGraph::TextureDesc desc{ 64, 64, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA8 };
+    RenderGraph::ResourceId color = renderGraph.CreateTexture("Color", desc);
+    RenderGraph::ResourceId normal = renderGraph.CreateTexture("Normal", desc);
+    RenderGraph::ResourceId output = renderGraph.CreateTexture("Final", desc);
+    renderGraph.SetOutput(output);
+    renderGraph.AddPass("GBuffer", std::make_unique<TestRenderPass>(releasedCount), {}, { color, normal });
+    renderGraph.AddPass("Final", std::make_unique<TestRenderPass>(releasedCount), { color, normal }, { output });
+
+    bool passed = Check(!renderGraph.Compile(renderer) && !renderGraph.GetErrorMessage().empty(), "a pass with 2 transient targets is rejected");
+
+    // The passes are still owned by the graph
+    renderGraphPtr.reset();
+    passed &= Check(releasedCount == 2, "no pass is added when the graph is not valid");
+    return passed;
+}
+
+int main()
+{
+    DeviceGL device;
+    GLStub stub;
+    device.SetCurrentStub(stub);
+
+    bool passed = true;
+    passed &= TestAliasing(device);
+    passed &= TestValidation(device);
+    return passed ? 0 : 1;
+}
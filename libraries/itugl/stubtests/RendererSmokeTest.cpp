@@ -0,0 +1,136 @@
+#include <ituGL/core/GLStub.h>
+#include <ituGL/core/DeviceGL.h>
+#include <ituGL/camera/Camera.h>
+#include <ituGL/geometry/Mesh.h>
+#include <ituGL/geometry/Model.h>
+#include <ituGL/geometry/VertexFormat.h>
+#include <ituGL/renderer/Renderer.h>
+#include <ituGL/renderer/GBufferRenderPass.h>
+#include <ituGL/shader/Shader.h>
+#include <ituGL/shader/ShaderProgram.h>
+#include <ituGL/shader/Material.h>
+#include <glm/gtx/transform.hpp>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+// Draws the same models through the renderer with the recording GL stub, and checks the GL calls of each frame
+// Runs without a GL context, so it can check the renderer optimizations on any machine
+
+struct FrameCalls
+{
+    unsigned int useProgramCount;
+    unsigned int drawcallCount;
+};
+
+static bool Check(bool condition, const char* description, const FrameCalls& calls)
+{
+    std::cout << (condition ? "PASS " : "FAIL ") << description << ": "
+        << calls.useProgramCount << " glUseProgram, " << calls.drawcallCount << " drawcalls" << std::endl;
+    return condition;
+}
+
+int main()
+{
+    DeviceGL device;
+    GLStub stub;
+    device.SetCurrentStub(stub);
+
+    // Every program reads the world matrices from the object buffer, and has a material color
+    stub.DeclareUniform("ObjectMatrices", GL_SAMPLER_BUFFER);
+    stub.DeclareUniform("ObjectIndex", GL_INT);
+    stub.DeclareUniform("Color", GL_FLOAT_VEC3);
+
+    Shader vertexShader(Shader::VertexShader);
+    Shader fragmentShader(Shader::FragmentShader);
+    vertexShader.Compile();
+    fragmentShader.Compile();
+
+    Renderer renderer(device);
+    renderer.SetFrustumCullingEnabled(false);
+    renderer.AddRenderPass(std::make_unique<GBufferRenderPass>(64, 64));
+
+    // The object uniforms are set by the renderer, not by the materials
+    ShaderUniformCollection::NameSet filteredUniforms;
+    filteredUniforms.insert("ObjectMatrices");
+    filteredUniforms.insert("ObjectIndex");
+
+    // 2 programs with 2 materials each
+    std::vector<std::shared_ptr<Material>> materials;
+    for (int programIndex = 0; programIndex < 2; ++programIndex)
+    {
+        std::shared_ptr<ShaderProgram> shaderProgram = std::make_shared<ShaderProgram>();
+        shaderProgram->Build(vertexShader, fragmentShader);
+        renderer.RegisterShaderProgram(shaderProgram, nullptr, nullptr);
+
+        for (int materialIndex = 0; materialIndex < 2; ++materialIndex)
+        {
+            std::shared_ptr<Material> material = std::make_shared<Material>(shaderProgram, filteredUniforms);
+            material->SetUniformValue("Color", glm::vec3(static_cast<float>(materialIndex)));
+            materials.push_back(material);
+        }
+    }
+
+    // One triangle, shared by all the models
+    VertexFormat vertexFormat;
+    vertexFormat.AddVertexAttribute<float>(3, VertexAttribute::Semantic::Position);
+    std::vector<glm::vec3> vertices = { glm::vec3(-1.0f, -1.0f, 0.0f), glm::vec3(1.0f, -1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) };
+    std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>();
+    mesh->AddSubmesh<glm::vec3, VertexFormat::LayoutIterator>(Drawcall::Primitive::Triangles, vertices, vertexFormat.LayoutBegin(3, false), vertexFormat.LayoutEnd());
+
+    // 8 models, alternating the programs, so drawing them in order changes the program every time
+    const unsigned int modelCount = 8;
+    std::vector<std::shared_ptr<Model>> models;
+    for (unsigned int i = 0; i < modelCount; ++i)
+    {
+        std::shared_ptr<Model> model = std::make_shared<Model>(mesh);
+        model->AddMaterial(materials[(i % 2) * 2 + (i / 2) % 2]);
+        models.push_back(model);
+    }
+
+    Camera camera;
+    camera.SetViewMatrix(glm::vec3(0.0f, 0.0f, 20.0f), glm::vec3(0.0f));
+    camera.SetPerspectiveProjectionMatrix(1.0f, 1.0f, 0.1f, 100.0f);
+
+    // Render a frame, after warming up the state shadowing, and count the calls of the second one
+    auto renderFrame = [&](bool sort, bool mergeInstances)
+        {
+            FrameCalls calls{};
+            for (int frame = 0; frame < 2; ++frame)
+            {
+                renderer.SetCurrentCamera(camera);
+                for (unsigned int i = 0; i < modelCount; ++i)
+                {
+                    renderer.AddModel(*models[i], glm::translate(glm::vec3(static_cast<float>(i), 0.0f, 0.0f)));
+                }
+                if (sort)
+                {
+                    renderer.SortDrawcallCollection(0, Renderer::DrawcallSortMode::State);
+                }
+                if (mergeInstances)
+                {
+                    renderer.MergeInstancedDrawcalls(0);
+                }
+
+                stub.ResetCalls();
+                device.ResetDrawcallCount();
+                renderer.Render();
+                calls.useProgramCount = stub.GetCallCount("glUseProgram");
+                calls.drawcallCount = device.GetDrawcallCount();
+            }
+            return calls;
+        };
+
+    bool passed = true;
+
+    FrameCalls unsorted = renderFrame(false, false);
+    passed &= Check(unsorted.useProgramCount == modelCount && unsorted.drawcallCount == modelCount, "unsorted", unsorted);
+
+    FrameCalls sorted = renderFrame(true, false);
+    passed &= Check(sorted.useProgramCount == 2 && sorted.drawcallCount == modelCount, "sorted by state", sorted);
+
+    FrameCalls instanced = renderFrame(true, true);
+    passed &= Check(instanced.useProgramCount == 2 && instanced.drawcallCount == materials.size(), "sorted and instanced", instanced);
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+#include <ituGL/core/GLStub.h>
+#include <ituGL/core/DeviceGL.h>
+#include <ituGL/asset/AssetJobQueue.h>
+#include <ituGL/asset/Texture2DLoader.h>
+#include <ituGL/texture/TextureStagingRing.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Acquires and uploads the slots of a TextureStagingRing, and loads textures through it, with the recording GL stub
+// The stub simulates a busy GPU with fences that are not signaled, and buffers that fail to map or lose their contents
+
+static bool Check(bool condition, const char* description)
+{
+    std::cout << (condition ? "PASS " : "FAIL ") << description << std::endl;
+    return condition;
+}
+
+// Write a binary PPM image of 2x2 pixels, that stb can decode
+static std::string WriteTestImage(int index)
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / ("itugl_stub_staging_test" + std::to_string(index) + ".ppm");
+    std::ofstream file(path, std::ios::binary);
+    file << "P6\n2 2\n255\n";
+    for (int i = 0; i < 12; ++i)
+    {
+        file.put(static_cast<char>(index + i));
+    }
+    return path.string();
+}
+
+// Run the main thread jobs every millisecond, as the frames would, until the condition is true. Gives up after a second
+static bool ProcessUntil(AssetJobQueue& jobQueue, const std::function<bool()>& condition)
+{
+    for (int i = 0; i < 1000 && !condition(); ++i)
+    {
+        jobQueue.ProcessMainThreadJobs(1000.0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return condition();
+}
+
+static bool TestSlots(GLStub& stub)
+{
+    TextureStagingRing stagingRing(2, 64);
+    std::span<std::byte> memory;
+    bool passed = true;
+
+    passed &= Check(stagingRing.Acquire(128, memory) == TextureStagingRing::NoSlot, "data larger than a slot is not staged");
+
+    int slot0 = stagingRing.Acquire(16, memory);
+    bool mapped0 = memory.size() == 16;
+    int slot1 = stagingRing.Acquire(16, memory);
+    passed &= Check(slot0 >= 0 && slot1 >= 0 && slot0 != slot1 && mapped0 && memory.size() == 16, "each slot is acquired once, and mapped");
+    passed &= Check(stagingRing.Acquire(16, memory) == TextureStagingRing::BusySlot && stagingRing.GetBusyCount() == 1, "no slot while all are mapped");
+
+    // Slot 0 is uploaded and fenced, and the GPU is still reading it
+    stub.SetFencesSignaled(false);
+    passed &= Check(stagingRing.BeginUpload(slot0), "the upload reads from the slot");
+    stagingRing.EndUpload(slot0);
+    passed &= Check(stagingRing.Acquire(16, memory) == TextureStagingRing::BusySlot, "no slot while the fence is not signaled");
+
+    // Once the fence is signaled, the slot is used again
+    stub.SetFencesSignaled(true);
+    stub.ResetCalls();
+    passed &= Check(stagingRing.Acquire(16, memory) == slot0 && stub.GetCallCount("glDeleteSync") == 1, "the slot is reused after its fence");
+
+    // The contents of slot 1 are lost while it is mapped, the caller uploads in another way
+    stub.SetUnmapFailing(true);
+    passed &= Check(!stagingRing.BeginUpload(slot1), "BeginUpload() fails if the contents were lost");
+    stub.SetUnmapFailing(false);
+    passed &= Check(stagingRing.GetFreeSlotCount() == 1, "the slot with lost contents is free again");
+
+    // Slot 1 is free, but it can't be mapped
+    stub.SetMapFailing(true);
+    passed &= Check(stagingRing.Acquire(16, memory) == TextureStagingRing::NoSlot && memory.empty(), "a failed map is not reported as busy");
+    passed &= Check(stagingRing.GetFreeSlotCount() == 1, "the slot that failed to map is still free");
+    stub.SetMapFailing(false);
+
+    stagingRing.BeginUpload(slot0);
+    stagingRing.EndUpload(slot0);
+    return passed;
+}
+
+static bool TestAsyncLoads(GLStub& stub)
+{
+    AssetJobQueue jobQueue(1);
+    TextureStagingRing stagingRing(2, 1024);
+    Texture2DLoader loader(TextureObject::FormatRGB, TextureObject::InternalFormatRGB8);
+
+    std::vector<std::string> paths;
+    for (int i = 0; i < 5; ++i)
+    {
+        paths.push_back(WriteTestImage(i));
+    }
+    bool passed = true;
+
+    // With the GPU busy, 2 textures get the 2 slots, and the third one retries every frame
+    stub.SetFencesSignaled(false);
+    stub.ResetCalls();
+    std::vector<AssetHandle<Texture2DObject>> handles;
+    for (int i = 0; i < 3; ++i)
+    {
+        handles.push_back(loader.LoadSharedAsync(paths[i].c_str()));
+    }
+    passed &= Check(ProcessUntil(jobQueue, [&]() { return handles[0].IsReady() && handles[1].IsReady(); }), "the first textures are uploaded from the slots");
+    ProcessUntil(jobQueue, [&]() { return stagingRing.GetBusyCount() >= 5; });
+    passed &= Check(!handles[2].IsReady() && stagingRing.GetBusyCount() >= 5, "the third texture waits while the slots are busy");
+
+    // Once the GPU is done, Flush() completes the requeued upload
+    stub.SetFencesSignaled(true);
+    jobQueue.Flush();
+    passed &= Check(handles[2].IsReady() && stagingRing.GetUploadCount() == 3 && stub.GetCallCount("glFenceSync") == 3,
+        "the requeued texture is staged once a slot is free");
+
+    // A slot that can't be mapped uses the direct upload, instead of retrying forever
+    stub.SetMapFailing(true);
+    stub.ResetCalls();
+    AssetHandle<Texture2DObject> mapFailedHandle = loader.LoadSharedAsync(paths[3].c_str());
+    jobQueue.Flush();
+    stub.SetMapFailing(false);
+    passed &= Check(mapFailedHandle.IsReady() && stub.GetCallCount("glTexImage2D") == 1 && stub.GetCallCount("glFenceSync") == 0,
+        "a failed map uploads from the decoded data");
+
+    // A slot that loses its contents uploads from the decoded data too
+    stub.SetUnmapFailing(true);
+    stub.ResetCalls();
+    AssetHandle<Texture2DObject> unmapFailedHandle = loader.LoadSharedAsync(paths[4].c_str());
+    jobQueue.Flush();
+    stub.SetUnmapFailing(false);
+    passed &= Check(unmapFailedHandle.IsReady() && stub.GetCallCount("glTexImage2D") == 1 && stub.GetCallCount("glFenceSync") == 0,
+        "lost contents upload from the decoded data");
+
+    // Both slots can be acquired, none was left mapped
+    std::span<std::byte> memory;
+    int slot0 = stagingRing.Acquire(16, memory);
+    int slot1 = stagingRing.Acquire(16, memory);
+    passed &= Check(slot0 >= 0 && slot1 >= 0, "no slot is left mapped");
+    for (int slot : { slot0, slot1 })
+    {
+        if (slot >= 0)
+        {
+            stagingRing.BeginUpload(slot);
+            stagingRing.EndUpload(slot);
+        }
+    }
+
+    // The same path returns the same texture
+    passed &= Check(loader.LoadSharedAsync(paths[0].c_str()).Get() == handles[0].Get(), "textures loaded again are shared");
+
+    for (const std::string& path : paths)
+    {
+        std::filesystem::remove(path);
+    }
+    return passed;
+}
+
+int main()
+{
+    DeviceGL device;
+    GLStub stub;
+    device.SetCurrentStub(stub);
+
+    bool passed = true;
+    passed &= TestSlots(stub);
+    passed &= TestAsyncLoads(stub);
+    return passed ? 0 : 1;
+}